@@ -0,0 +1,13 @@
+CREATE TABLE IF NOT EXISTS `time_diff_log` (
+  `id` INT(10) UNSIGNED NOT NULL AUTO_INCREMENT,
+  `time` INT(10) UNSIGNED NOT NULL DEFAULT '0',
+  `average` INT(10) UNSIGNED NOT NULL DEFAULT '0',
+  `max` INT(10) UNSIGNED NOT NULL DEFAULT '0',
+  `players` INT(10) UNSIGNED NOT NULL DEFAULT '0',
+  PRIMARY KEY (`id`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8;
+
+ALTER TABLE `time_diff_log`
+  ADD COLUMN `p50` INT(10) UNSIGNED NOT NULL DEFAULT '0' AFTER `players`,
+  ADD COLUMN `p95` INT(10) UNSIGNED NOT NULL DEFAULT '0' AFTER `p50`,
+  ADD COLUMN `p99` INT(10) UNSIGNED NOT NULL DEFAULT '0' AFTER `p95`;
@@ -31,7 +31,15 @@
 #include <limits>
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define BIH_SSE2
+#endif
+
 #define MAX_STACK_SIZE 64
+#define BIH_RAY_PACKET_SIZE 4
+#define BIH_PACKET_MIN_COS 0.995f                           // rays of a packet are at most ~5.7 degrees apart
+#define BIH_PACKET_MAX_ORIGIN_DIST 4.0f                     // and start at most 4 yards apart
 
 static inline uint32 floatToRawIntBits(float f)
 {
@@ -256,6 +264,45 @@ class BIH
             }
         }
 
+        /**
+        Traces count rays at once. With SSE2 the rays are grouped in packets of BIH_RAY_PACKET_SIZE which
+        walk the hierarchy together, the slab tests of a node are done for the whole packet.
+        maxDist holds the distance of each ray, the callback also gets the index of the ray:
+            bool intersectCallback(const G3D::Ray& ray, uint32 rayIndex, uint32 entry, float& maxDist, bool stopAtFirst)
+        */
+        template<typename RayPacketCallback>
+        void intersectRays(const G3D::Ray* rays, uint32 count, RayPacketCallback& intersectCallback, float* maxDist, bool stopAtFirst=false) const
+        {
+            uint32 i = 0;
+            while (i < count)
+            {
+                uint32 size = 1;
+#ifdef BIH_SSE2
+                // only neighbouring rays running alongside the first one share a packet, diverging rays
+                // would drag each other through nodes they never cross
+                while (size < BIH_RAY_PACKET_SIZE && i + size < count && coherentRays(rays[i], rays[i + size]))
+                    ++size;
+
+                if (size > 1)
+                {
+                    intersectRayPacket(rays + i, size, i, intersectCallback, maxDist + i, stopAtFirst);
+                    i += size;
+                    continue;
+                }
+#endif
+                // a lone ray is cheaper on the single ray path
+                RayIndexCallback<RayPacketCallback> callback(intersectCallback, i);
+                intersectRay(rays[i], callback, maxDist[i], stopAtFirst);
+                ++i;
+            }
+        }
+
+        static bool coherentRays(const G3D::Ray& first, const G3D::Ray& other)
+        {
+            return first.direction().dot(other.direction()) >= BIH_PACKET_MIN_COS
+                && (first.origin() - other.origin()).squaredLength() <= BIH_PACKET_MAX_ORIGIN_DIST * BIH_PACKET_MAX_ORIGIN_DIST;
+        }
+
         template<typename IsectCallback>
         void intersectPoint(const G3D::Vector3 &p, IsectCallback& intersectCallback) const
         {
@@ -356,6 +403,257 @@ class BIH
             float tfar;
         };
 
+        template<typename RayPacketCallback>
+        struct RayIndexCallback
+        {
+            RayIndexCallback(RayPacketCallback& callback, uint32 rayIndex) : Callback(callback), RayIndex(rayIndex) { }
+            bool operator()(const G3D::Ray& ray, uint32 entry, float& maxDist, bool stopAtFirst)
+            {
+                return Callback(ray, RayIndex, entry, maxDist, stopAtFirst);
+            }
+
+            RayPacketCallback& Callback;
+            uint32 RayIndex;
+        };
+
+#ifdef BIH_SSE2
+        struct PacketStackNode
+        {
+            __m128 tnear;
+            __m128 tfar;
+            uint32 node;
+        };
+
+        enum PacketDirSign
+        {
+            PACKET_DIR_POSITIVE,
+            PACKET_DIR_NEGATIVE,
+            PACKET_DIR_MIXED
+        };
+
+        static inline __m128 planeLanes(uint32 plane)
+        {
+            return _mm_castsi128_ps(_mm_set1_epi32(int32(plane)));
+        }
+
+        static inline __m128 selectPs(__m128 mask, __m128 a, __m128 b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        // lanes of the packet whose interval is not empty
+        static inline int activeLanes(__m128 tnear, __m128 tfar, int alive)
+        {
+            return _mm_movemask_ps(_mm_cmple_ps(tnear, tfar)) & alive;
+        }
+
+        // same traversal as intersectRay, for up to BIH_RAY_PACKET_SIZE rays carried in the lanes of SSE registers
+        template<typename RayPacketCallback>
+        void intersectRayPacket(const G3D::Ray* rays, uint32 size, uint32 firstIndex, RayPacketCallback& intersectCallback, float* maxDist, bool stopAtFirst) const
+        {
+            float orgLanes[3][BIH_RAY_PACKET_SIZE];
+            float invDirLanes[3][BIH_RAY_PACKET_SIZE];
+            float nearLanes[BIH_RAY_PACKET_SIZE];
+            float farLanes[BIH_RAY_PACKET_SIZE];
+            float dist[BIH_RAY_PACKET_SIZE];
+            int alive = 0;
+
+            for (uint32 lane = 0; lane < BIH_RAY_PACKET_SIZE; ++lane)
+            {
+                // padding lanes repeat the first ray with an empty interval
+                G3D::Ray const& r = rays[lane < size ? lane : 0];
+                float intervalMin = -1.f;
+                float intervalMax = -1.f;
+                bool missed = lane >= size;
+                for (int i = 0; i < 3; ++i)
+                {
+                    orgLanes[i][lane] = r.origin()[i];
+                    invDirLanes[i][lane] = 1.f / r.direction()[i];
+                    if (!missed && G3D::fuzzyNe(r.direction()[i], 0.0f))
+                    {
+                        float t1 = (bounds.low()[i]  - r.origin()[i]) * invDirLanes[i][lane];
+                        float t2 = (bounds.high()[i] - r.origin()[i]) * invDirLanes[i][lane];
+                        if (t1 > t2)
+                            std::swap(t1, t2);
+                        if (t1 > intervalMin)
+                            intervalMin = t1;
+                        if (t2 < intervalMax || intervalMax < 0.f)
+                            intervalMax = t2;
+                        if (intervalMax <= 0 || intervalMin >= maxDist[lane])
+                            missed = true;
+                    }
+                }
+
+                dist[lane] = lane < size ? maxDist[lane] : -1.f;
+                if (missed || intervalMin > intervalMax)
+                {
+                    nearLanes[lane] = 1.f;
+                    farLanes[lane] = 0.f;
+                    continue;
+                }
+
+                nearLanes[lane] = std::max(intervalMin, 0.f);
+                farLanes[lane] = std::min(intervalMax, maxDist[lane]);
+                alive |= 1 << lane;
+            }
+
+            if (!alive)
+                return;
+
+            __m128 org[3];
+            __m128 invDir[3];
+            __m128 negDir[3];
+            uint8 dirSigns[3];
+            bool rightFirst[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                org[i] = _mm_loadu_ps(orgLanes[i]);
+                invDir[i] = _mm_loadu_ps(invDirLanes[i]);
+                // sign bit of the direction (1/dir keeps it), -0 counts as negative like in intersectRay
+                negDir[i] = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(invDir[i]), 31));
+                int negative = _mm_movemask_ps(negDir[i]) & alive;
+                dirSigns[i] = !negative ? PACKET_DIR_POSITIVE : (negative == alive ? PACKET_DIR_NEGATIVE : PACKET_DIR_MIXED);
+                // visit the child most of the packet reaches first before the other one
+                int negativeCount = 0;
+                int aliveCount = 0;
+                for (uint32 lane = 0; lane < BIH_RAY_PACKET_SIZE; ++lane)
+                {
+                    negativeCount += (negative >> lane) & 1;
+                    aliveCount += (alive >> lane) & 1;
+                }
+                rightFirst[i] = negativeCount * 2 > aliveCount;
+            }
+
+            __m128 intervalMin = _mm_loadu_ps(nearLanes);
+            __m128 intervalMax = _mm_loadu_ps(farLanes);
+
+            PacketStackNode stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (true) {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    bool BVH2 = tn & (1 << 29);
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            // "normal" interior node, left child ends at the first plane, right child starts at the second
+                            __m128 tl = _mm_mul_ps(_mm_sub_ps(planeLanes(tree[node + 1]), org[axis]), invDir[axis]);
+                            __m128 tr = _mm_mul_ps(_mm_sub_ps(planeLanes(tree[node + 2]), org[axis]), invDir[axis]);
+                            // the min/max operand order keeps the current interval when t is NaN
+                            __m128 leftMin = intervalMin;
+                            __m128 leftMax = intervalMax;
+                            __m128 rightMin = intervalMin;
+                            __m128 rightMax = intervalMax;
+                            switch (dirSigns[axis])
+                            {
+                                case PACKET_DIR_POSITIVE:
+                                    leftMax = _mm_min_ps(tl, intervalMax);
+                                    rightMin = _mm_max_ps(tr, intervalMin);
+                                    break;
+                                case PACKET_DIR_NEGATIVE:
+                                    leftMin = _mm_max_ps(tl, intervalMin);
+                                    rightMax = _mm_min_ps(tr, intervalMax);
+                                    break;
+                                default:
+                                    leftMin = selectPs(negDir[axis], _mm_max_ps(tl, intervalMin), intervalMin);
+                                    leftMax = selectPs(negDir[axis], intervalMax, _mm_min_ps(tl, intervalMax));
+                                    rightMin = selectPs(negDir[axis], intervalMin, _mm_max_ps(tr, intervalMin));
+                                    rightMax = selectPs(negDir[axis], _mm_min_ps(tr, intervalMax), intervalMax);
+                                    break;
+                            }
+                            bool left = activeLanes(leftMin, leftMax, alive) != 0;
+                            bool right = activeLanes(rightMin, rightMax, alive) != 0;
+                            // packet passes between clip zones
+                            if (!left && !right)
+                                break;
+                            if (left && right)
+                            {
+                                // push back the far node
+                                bool pushLeft = rightFirst[axis];
+                                stack[stackPos].node = pushLeft ? offset : offset + 3;
+                                stack[stackPos].tnear = pushLeft ? leftMin : rightMin;
+                                stack[stackPos].tfar = pushLeft ? leftMax : rightMax;
+                                stackPos++;
+                                left = !pushLeft;
+                            }
+                            node = left ? offset : offset + 3;
+                            intervalMin = left ? leftMin : rightMin;
+                            intervalMax = left ? leftMax : rightMax;
+                            continue;
+                        }
+                        else
+                        {
+                            // leaf - test some objects with every ray of the packet still inside it
+                            int lanes = activeLanes(intervalMin, intervalMax, alive);
+                            int n = tree[node + 1];
+                            while (n > 0 && lanes) {
+                                for (uint32 lane = 0; lane < size; ++lane)
+                                {
+                                    if (!(lanes & (1 << lane)))
+                                        continue;
+                                    bool hit = intersectCallback(rays[lane], firstIndex + lane, objects[offset], dist[lane], stopAtFirst);
+                                    if (stopAtFirst && hit)
+                                    {
+                                        alive &= ~(1 << lane);
+                                        lanes &= ~(1 << lane);
+                                    }
+                                }
+                                --n;
+                                ++offset;
+                            }
+                            if (!alive)
+                            {
+                                std::copy(dist, dist + size, maxDist);
+                                return;
+                            }
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        if (axis>2)
+                        {
+                            std::copy(dist, dist + size, maxDist);
+                            return; // should not happen
+                        }
+                        __m128 tl = _mm_mul_ps(_mm_sub_ps(planeLanes(tree[node + 1]), org[axis]), invDir[axis]);
+                        __m128 th = _mm_mul_ps(_mm_sub_ps(planeLanes(tree[node + 2]), org[axis]), invDir[axis]);
+                        node = offset;
+                        intervalMin = _mm_max_ps(selectPs(negDir[axis], th, tl), intervalMin);
+                        intervalMax = _mm_min_ps(selectPs(negDir[axis], tl, th), intervalMax);
+                        if (!activeLanes(intervalMin, intervalMax, alive))
+                            break;
+                        continue;
+                    }
+                } // traversal loop
+                do
+                {
+                    // stack is empty?
+                    if (stackPos == 0)
+                    {
+                        std::copy(dist, dist + size, maxDist);
+                        return;
+                    }
+                    // move back up the stack
+                    stackPos--;
+                    intervalMin = stack[stackPos].tnear;
+                    // rays that found a closer hit meanwhile drop out of the node
+                    intervalMax = _mm_min_ps(stack[stackPos].tfar, _mm_loadu_ps(dist));
+                    if (!activeLanes(intervalMin, intervalMax, alive))
+                        continue;
+                    node = stack[stackPos].node;
+                    break;
+                } while (true);
+            }
+        }
+#endif
+
         class BuildStats
         {
             private:
@@ -41,15 +41,24 @@ namespace VMAP
     #define VMAP_INVALID_HEIGHT       -100000.0f            // for check
     #define VMAP_INVALID_HEIGHT_VALUE -200000.0f            // real assigned value in unknown height case
 
+    // one segment of a batched line of sight check
+    struct LineOfSightQuery
+    {
+        float From[3];
+        float To[3];
+        bool Result;                                        // set by isInLineOfSight
+    };
+
     //===========================================================
     class IVMapManager
     {
         private:
             bool iEnableLineOfSightCalc;
             bool iEnableHeightCalc;
+            uint32 iRayCacheSize;
 
         public:
-            IVMapManager() : iEnableLineOfSightCalc(true), iEnableHeightCalc(true) { }
+            IVMapManager() : iEnableLineOfSightCalc(true), iEnableHeightCalc(true), iRayCacheSize(0) { }
 
             virtual ~IVMapManager(void) { }
 
@@ -61,6 +70,10 @@ namespace VMAP
             virtual void unloadMap(unsigned int pMapId) = 0;
 
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
+            /**
+            same result as the single check for every query, the rays missing the ray cache are traced together
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
             test if we hit an object. return true if we hit one. rx, ry, rz will hold the hit position or the dest position, if no intersection was found
@@ -83,6 +96,13 @@ namespace VMAP
             */
             void setEnableHeightCalc(bool pVal) { iEnableHeightCalc = pVal; }
 
+            /**
+            Entries of the recent ray result cache kept per map, 0 disables it
+            Only maps loaded afterwards use the new size
+            */
+            void setRayCacheSize(uint32 pVal) { iRayCacheSize = pVal; }
+            uint32 getRayCacheSize() const { return iRayCacheSize; }
+
             bool isLineOfSightCalcEnabled() const { return(iEnableLineOfSightCalc); }
             bool isHeightCalcEnabled() const { return(iEnableHeightCalc); }
             bool isMapLoadingEnabled() const { return(iEnableLineOfSightCalc || iEnableHeightCalc  ); }
@@ -94,6 +114,12 @@ namespace VMAP
             */
             virtual bool getAreaInfo(unsigned int pMapId, float x, float y, float &z, uint32 &flags, int32 &adtId, int32 &rootId, int32 &groupId) const=0;
             virtual bool GetLiquidLevel(uint32 pMapId, float x, float y, float z, uint8 ReqLiquidType, float &level, float &floor, uint32 &type) const=0;
+
+            /**
+            Re-read the vmap disables of the loaded maps, after the disables table was (re)loaded
+            */
+            virtual void refreshDisableFlags() = 0;
+            virtual void getRayCacheStats(uint64& hits, uint64& misses) const = 0;
     };
 
 }
@@ -36,6 +36,112 @@ using G3D::Vector3;
 
 namespace VMAP
 {
+    bool RayCacheKey::operator==(RayCacheKey const& other) const
+    {
+        return From[0] == other.From[0] && From[1] == other.From[1] && From[2] == other.From[2]
+            && To[0] == other.To[0] && To[1] == other.To[1] && To[2] == other.To[2]
+            && ModifyDist == other.ModifyDist && Type == other.Type;
+    }
+
+    RayResultCache::RayResultCache(uint32 size) : _shardSize((size + RAY_CACHE_SHARDS - 1) / RAY_CACHE_SHARDS)
+    {
+        for (uint32 i = 0; i < RAY_CACHE_SHARDS; ++i)
+            _shards[i].Entries.resize(_shardSize);
+    }
+
+    RayCacheKey RayResultCache::MakeKey(RayQueryType type, float x1, float y1, float z1, float x2, float y2, float z2, float modifyDist)
+    {
+        RayCacheKey key;
+        key.From[0] = int32(floor(x1 * RAY_CACHE_QUANTUM + 0.5f));
+        key.From[1] = int32(floor(y1 * RAY_CACHE_QUANTUM + 0.5f));
+        key.From[2] = int32(floor(z1 * RAY_CACHE_QUANTUM + 0.5f));
+        key.To[0] = int32(floor(x2 * RAY_CACHE_QUANTUM + 0.5f));
+        key.To[1] = int32(floor(y2 * RAY_CACHE_QUANTUM + 0.5f));
+        key.To[2] = int32(floor(z2 * RAY_CACHE_QUANTUM + 0.5f));
+        key.ModifyDist = modifyDist;
+        key.Type = uint8(type);
+        return key;
+    }
+
+    RayCacheEntry& RayResultCache::GetEntry(RayCacheKey const& key, Shard*& shard)
+    {
+        uint32 hash = 2166136261u;                          // FNV-1a over the quantized coordinates
+        for (uint8 i = 0; i < 3; ++i)
+        {
+            hash = (hash ^ uint32(key.From[i])) * 16777619u;
+            hash = (hash ^ uint32(key.To[i])) * 16777619u;
+        }
+        hash = (hash ^ key.Type) * 16777619u;
+
+        shard = &_shards[hash % RAY_CACHE_SHARDS];
+        return shard->Entries[(hash / RAY_CACHE_SHARDS) % _shardSize];
+    }
+
+    bool RayResultCache::Find(RayCacheKey const& key, bool& hit, float* hitPos)
+    {
+        if (!_shardSize)
+            return false;
+
+        Shard* shard;
+        RayCacheEntry& entry = GetEntry(key, shard);
+
+        TRINITY_GUARD(ACE_Thread_Mutex, shard->Lock);
+        if (!entry.Valid || !(entry.Key == key))
+        {
+            ++shard->Misses;
+            return false;
+        }
+
+        ++shard->Hits;
+        hit = entry.Hit;
+        if (hitPos)
+        {
+            hitPos[0] = entry.HitPos[0];
+            hitPos[1] = entry.HitPos[1];
+            hitPos[2] = entry.HitPos[2];
+        }
+        return true;
+    }
+
+    void RayResultCache::Store(RayCacheKey const& key, bool hit, float const* hitPos)
+    {
+        if (!_shardSize)
+            return;
+
+        Shard* shard;
+        RayCacheEntry& entry = GetEntry(key, shard);
+
+        TRINITY_GUARD(ACE_Thread_Mutex, shard->Lock);
+        entry.Key = key;
+        entry.Valid = true;
+        entry.Hit = hit;
+        if (hitPos)
+        {
+            entry.HitPos[0] = hitPos[0];
+            entry.HitPos[1] = hitPos[1];
+            entry.HitPos[2] = hitPos[2];
+        }
+    }
+
+    void RayResultCache::Clear()
+    {
+        for (uint32 i = 0; i < RAY_CACHE_SHARDS; ++i)
+        {
+            TRINITY_GUARD(ACE_Thread_Mutex, _shards[i].Lock);
+            for (std::vector<RayCacheEntry>::iterator itr = _shards[i].Entries.begin(); itr != _shards[i].Entries.end(); ++itr)
+                itr->Valid = false;
+        }
+    }
+
+    void RayResultCache::GetStats(uint64& hits, uint64& misses) const
+    {
+        for (uint32 i = 0; i < RAY_CACHE_SHARDS; ++i)
+        {
+            hits += _shards[i].Hits;
+            misses += _shards[i].Misses;
+        }
+    }
+
     VMapManager2::VMapManager2()
     {
     }
@@ -44,6 +150,7 @@ namespace VMAP
     {
         for (InstanceTreeMap::iterator i = iInstanceMapTrees.begin(); i != iInstanceMapTrees.end(); ++i)
         {
+            delete i->second->iTree;
             delete i->second;
         }
         for (ModelFileMap::iterator i = iLoadedModelFiles.begin(); i != iLoadedModelFiles.end(); ++i)
@@ -87,76 +194,216 @@ namespace VMAP
         return result;
     }
 
+    uint8 VMapManager2::_getDisableFlags(uint32 mapId)
+    {
+        uint8 flags = 0;
+        static uint8 const vmapDisables[] = { VMAP_DISABLE_AREAFLAG, VMAP_DISABLE_HEIGHT, VMAP_DISABLE_LOS, VMAP_DISABLE_LIQUIDSTATUS };
+        for (uint8 i = 0; i < sizeof(vmapDisables); ++i)
+            if (DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, vmapDisables[i]))
+                flags |= vmapDisables[i];
+
+        return flags;
+    }
+
+    ManagedTree* VMapManager2::_getOrCreateTree(uint32 mapId, const std::string& basePath)
+    {
+        {
+            TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+            InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+            if (instanceTree != iInstanceMapTrees.end())
+                return instanceTree->second;
+        }
+
+        TRINITY_WRITE_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        // another map thread may have created it meanwhile
+        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree != iInstanceMapTrees.end())
+            return instanceTree->second;
+
+        StaticMapTree* newTree = new StaticMapTree(mapId, basePath);
+        if (!newTree->InitMap(getMapFileName(mapId), this))
+        {
+            delete newTree;
+            return NULL;
+        }
+
+        ManagedTree* managedTree = new ManagedTree(newTree, getRayCacheSize());
+        managedTree->iDisableFlags = _getDisableFlags(mapId);
+        iInstanceMapTrees[mapId] = managedTree;
+        return managedTree;
+    }
+
     // load one tile (internal use only)
     bool VMapManager2::_loadMap(unsigned int mapId, const std::string& basePath, uint32 tileX, uint32 tileY)
     {
+        if (!_getOrCreateTree(mapId, basePath))
+            return false;
+
+        // trees are only erased under the write lock of the registry, hold its read lock while loading
+        TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return false;
+
+        ManagedTree* managedTree = instanceTree->second;
+        ACE_Write_Guard<ACE_RW_Thread_Mutex> treeGuard(managedTree->iLock);
+        managedTree->iRayCache.Clear();
+        return managedTree->iTree->LoadMapTile(tileX, tileY, this);
+    }
+
+    void VMapManager2::_unloadTree(uint32 mapId, bool allTiles, int x, int y)
+    {
+        TRINITY_WRITE_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
         if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        ManagedTree* managedTree = instanceTree->second;
         {
-            std::string mapFileName = getMapFileName(mapId);
-            StaticMapTree* newTree = new StaticMapTree(mapId, basePath);
-            if (!newTree->InitMap(mapFileName, this))
-            {
-                delete newTree;
-                return false;
-            }
-            instanceTree = iInstanceMapTrees.insert(InstanceTreeMap::value_type(mapId, newTree)).first;
+            ACE_Write_Guard<ACE_RW_Thread_Mutex> treeGuard(managedTree->iLock);
+            managedTree->iRayCache.Clear();
+            if (allTiles)
+                managedTree->iTree->UnloadMap(this);
+            else
+                managedTree->iTree->UnloadMapTile(x, y, this);
+
+            if (managedTree->iTree->numLoadedTiles() != 0)
+                return;
         }
 
-        return instanceTree->second->LoadMapTile(tileX, tileY, this);
+        delete managedTree->iTree;
+        delete managedTree;
+        iInstanceMapTrees.erase(instanceTree);
     }
 
     void VMapManager2::unloadMap(unsigned int mapId)
     {
-        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
-        if (instanceTree != iInstanceMapTrees.end())
-        {
-            instanceTree->second->UnloadMap(this);
-            if (instanceTree->second->numLoadedTiles() == 0)
-            {
-                delete instanceTree->second;
-                iInstanceMapTrees.erase(mapId);
-            }
-        }
+        _unloadTree(mapId, true, 0, 0);
     }
 
     void VMapManager2::unloadMap(unsigned int mapId, int x, int y)
     {
-        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
-        if (instanceTree != iInstanceMapTrees.end())
+        _unloadTree(mapId, false, x, y);
+    }
+
+    void VMapManager2::refreshDisableFlags()
+    {
+        TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        for (InstanceTreeMap::iterator itr = iInstanceMapTrees.begin(); itr != iInstanceMapTrees.end(); ++itr)
         {
-            instanceTree->second->UnloadMapTile(x, y, this);
-            if (instanceTree->second->numLoadedTiles() == 0)
-            {
-                delete instanceTree->second;
-                iInstanceMapTrees.erase(mapId);
-            }
+            ACE_Write_Guard<ACE_RW_Thread_Mutex> treeGuard(itr->second->iLock);
+            itr->second->iDisableFlags = _getDisableFlags(itr->first);
         }
     }
 
+    void VMapManager2::getRayCacheStats(uint64& hits, uint64& misses) const
+    {
+        hits = 0;
+        misses = 0;
+
+        TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        for (InstanceTreeMap::const_iterator itr = iInstanceMapTrees.begin(); itr != iInstanceMapTrees.end(); ++itr)
+            itr->second->iRayCache.GetStats(hits, misses);
+    }
+
     bool VMapManager2::isInLineOfSight(unsigned int mapId, float x1, float y1, float z1, float x2, float y2, float z2)
     {
-        if (!isLineOfSightCalcEnabled() || DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, VMAP_DISABLE_LOS))
+        if (!isLineOfSightCalcEnabled())
+            return true;
+
+        TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree != iInstanceMapTrees.end() && (instanceTree->second->iDisableFlags & VMAP_DISABLE_LOS))
             return true;
 
         // Don't calculate hit position, if wrong src/dest points provided!
         if (!VMAP::CheckPosition(x1,y1,z1) || !VMAP::CheckPosition(x2,y2,z2))
             return false;
 
-        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
         if (instanceTree != iInstanceMapTrees.end())
         {
             Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
             Vector3 pos2 = convertPositionToInternalRep(x2, y2, z2);
             if (pos1 != pos2)
             {
-                return instanceTree->second->isInLineOfSight(pos1, pos2);
+                ManagedTree* managedTree = instanceTree->second;
+                RayCacheKey key = RayResultCache::MakeKey(RAY_QUERY_LINE_OF_SIGHT, x1, y1, z1, x2, y2, z2);
+                bool inLos;
+                if (managedTree->iRayCache.Find(key, inLos, NULL))
+                    return inLos;
+
+                ACE_Read_Guard<ACE_RW_Thread_Mutex> treeGuard(managedTree->iLock);
+                inLos = managedTree->iTree->isInLineOfSight(pos1, pos2);
+                managedTree->iRayCache.Store(key, inLos, NULL);
+                return inLos;
             }
         }
 
         return true;
     }
 
+    void VMapManager2::isInLineOfSight(unsigned int mapId, LineOfSightQuery* queries, uint32 count)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            queries[i].Result = true;
+
+        if (!isLineOfSightCalcEnabled())
+            return;
+
+        TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree != iInstanceMapTrees.end() && (instanceTree->second->iDisableFlags & VMAP_DISABLE_LOS))
+            return;
+
+        ManagedTree* managedTree = instanceTree != iInstanceMapTrees.end() ? instanceTree->second : NULL;
+        std::vector<uint32> pending;
+        std::vector<Vector3> from;
+        std::vector<Vector3> to;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            LineOfSightQuery& query = queries[i];
+            // Don't calculate hit position, if wrong src/dest points provided!
+            if (!VMAP::CheckPosition(query.From[0], query.From[1], query.From[2]) || !VMAP::CheckPosition(query.To[0], query.To[1], query.To[2]))
+            {
+                query.Result = false;
+                continue;
+            }
+
+            if (!managedTree)
+                continue;
+
+            Vector3 pos1 = convertPositionToInternalRep(query.From[0], query.From[1], query.From[2]);
+            Vector3 pos2 = convertPositionToInternalRep(query.To[0], query.To[1], query.To[2]);
+            if (pos1 == pos2)
+                continue;
+
+            RayCacheKey key = RayResultCache::MakeKey(RAY_QUERY_LINE_OF_SIGHT, query.From[0], query.From[1], query.From[2], query.To[0], query.To[1], query.To[2]);
+            if (managedTree->iRayCache.Find(key, query.Result, NULL))
+                continue;
+
+            pending.push_back(i);
+            from.push_back(pos1);
+            to.push_back(pos2);
+        }
+
+        if (pending.empty())
+            return;
+
+        bool* inLos = new bool[pending.size()];
+        {
+            ACE_Read_Guard<ACE_RW_Thread_Mutex> treeGuard(managedTree->iLock);
+            managedTree->iTree->isInLineOfSight(&from[0], &to[0], inLos, uint32(pending.size()));
+            for (uint32 i = 0; i < pending.size(); ++i)
+            {
+                LineOfSightQuery& query = queries[pending[i]];
+                query.Result = inLos[i];
+                managedTree->iRayCache.Store(RayResultCache::MakeKey(RAY_QUERY_LINE_OF_SIGHT, query.From[0], query.From[1], query.From[2],
+                    query.To[0], query.To[1], query.To[2]), inLos[i], NULL);
+            }
+        }
+        delete[] inLos;
+    }
+
     /**
     get the hit position and return true if we hit something
     otherwise the result pos will be the dest pos
@@ -167,11 +414,25 @@ namespace VMAP
         rx=x2;
         ry=y2;
         rz=z2;
-        if (isLineOfSightCalcEnabled() && !DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, VMAP_DISABLE_LOS))
+        if (isLineOfSightCalcEnabled())
         {
-            InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
-            if (instanceTree != iInstanceMapTrees.end())
+            TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+            InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+            if (instanceTree != iInstanceMapTrees.end() && !(instanceTree->second->iDisableFlags & VMAP_DISABLE_LOS))
             {
+                ManagedTree* managedTree = instanceTree->second;
+                RayCacheKey key = RayResultCache::MakeKey(RAY_QUERY_HIT_POS, x1, y1, z1, x2, y2, z2, modifyDist);
+                float hitPos[3];
+                if (managedTree->iRayCache.Find(key, result, hitPos))
+                {
+                    rx = hitPos[0];
+                    ry = hitPos[1];
+                    rz = hitPos[2];
+                    return result;
+                }
+
+                // results are stored under the tree lock so a tile change cannot race a stale entry in
+                ACE_Read_Guard<ACE_RW_Thread_Mutex> treeGuard(managedTree->iLock);
                 Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
                 Vector3 pos2 = convertPositionToInternalRep(x2, y2, z2);
                 Vector3 resultPos;
@@ -184,12 +445,17 @@ namespace VMAP
                 }
                 else
                 {
-                    result = instanceTree->second->getObjectHitPos(pos1, pos2, resultPos, modifyDist);
+                    result = managedTree->iTree->getObjectHitPos(pos1, pos2, resultPos, modifyDist);
                     resultPos = convertPositionToInternalRep(resultPos.x,resultPos.y,resultPos.z);
                 }
                 rx = resultPos.x;
                 ry = resultPos.y;
                 rz = resultPos.z;
+
+                hitPos[0] = rx;
+                hitPos[1] = ry;
+                hitPos[2] = rz;
+                managedTree->iRayCache.Store(key, result, hitPos);
             }
         }
         return result;
@@ -201,13 +467,15 @@ namespace VMAP
 
     float VMapManager2::getHeight(unsigned int mapId, float x, float y, float z, float maxSearchDist)
     {
-        if (isHeightCalcEnabled() && !DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, VMAP_DISABLE_HEIGHT))
+        if (isHeightCalcEnabled())
         {
-            InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
-            if (instanceTree != iInstanceMapTrees.end())
+            TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+            InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+            if (instanceTree != iInstanceMapTrees.end() && !(instanceTree->second->iDisableFlags & VMAP_DISABLE_HEIGHT))
             {
                 Vector3 pos = convertPositionToInternalRep(x, y, z);
-                float height = instanceTree->second->getHeight(pos, maxSearchDist);
+                ACE_Read_Guard<ACE_RW_Thread_Mutex> treeGuard(instanceTree->second->iLock);
+                float height = instanceTree->second->iTree->getHeight(pos, maxSearchDist);
                 if (!(height < G3D::inf()))
                     return height = VMAP_INVALID_HEIGHT_VALUE; // No height
 
@@ -220,17 +488,16 @@ namespace VMAP
 
     bool VMapManager2::getAreaInfo(unsigned int mapId, float x, float y, float& z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const
     {
-        if (!DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, VMAP_DISABLE_AREAFLAG))
+        TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree != iInstanceMapTrees.end() && !(instanceTree->second->iDisableFlags & VMAP_DISABLE_AREAFLAG))
         {
-            InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
-            if (instanceTree != iInstanceMapTrees.end())
-            {
-                Vector3 pos = convertPositionToInternalRep(x, y, z);
-                bool result = instanceTree->second->getAreaInfo(pos, flags, adtId, rootId, groupId);
-                // z is not touched by convertPositionToInternalRep(), so just copy
-                z = pos.z;
-                return result;
-            }
+            Vector3 pos = convertPositionToInternalRep(x, y, z);
+            ACE_Read_Guard<ACE_RW_Thread_Mutex> treeGuard(instanceTree->second->iLock);
+            bool result = instanceTree->second->iTree->getAreaInfo(pos, flags, adtId, rootId, groupId);
+            // z is not touched by convertPositionToInternalRep(), so just copy
+            z = pos.z;
+            return result;
         }
 
         return false;
@@ -238,23 +505,22 @@ namespace VMAP
 
     bool VMapManager2::GetLiquidLevel(uint32 mapId, float x, float y, float z, uint8 reqLiquidType, float& level, float& floor, uint32& type) const
     {
-        if (!DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, VMAP_DISABLE_LIQUIDSTATUS))
+        TRINITY_READ_GUARD(ACE_RW_Thread_Mutex, iInstanceMapTreesLock);
+        InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree != iInstanceMapTrees.end() && !(instanceTree->second->iDisableFlags & VMAP_DISABLE_LIQUIDSTATUS))
         {
-            InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(mapId);
-            if (instanceTree != iInstanceMapTrees.end())
+            LocationInfo info;
+            Vector3 pos = convertPositionToInternalRep(x, y, z);
+            ACE_Read_Guard<ACE_RW_Thread_Mutex> treeGuard(instanceTree->second->iLock);
+            if (instanceTree->second->iTree->GetLocationInfo(pos, info))
             {
-                LocationInfo info;
-                Vector3 pos = convertPositionToInternalRep(x, y, z);
-                if (instanceTree->second->GetLocationInfo(pos, info))
-                {
-                    floor = info.ground_Z;
-                    ASSERT(floor < std::numeric_limits<float>::max());
-                    type = info.hitModel->GetLiquidType();  // entry from LiquidType.dbc
-                    if (reqLiquidType && !(GetLiquidFlags(type) & reqLiquidType))
-                        return false;
-                    if (info.hitInstance->GetLiquidLevel(pos, info, level))
-                        return true;
-                }
+                floor = info.ground_Z;
+                ASSERT(floor < std::numeric_limits<float>::max());
+                type = info.hitModel->GetLiquidType();  // entry from LiquidType.dbc
+                if (reqLiquidType && !(GetLiquidFlags(type) & reqLiquidType))
+                    return false;
+                if (info.hitInstance->GetLiquidLevel(pos, info, level))
+                    return true;
             }
         }
 
@@ -23,6 +23,8 @@
 #include "Dynamic/UnorderedMap.h"
 #include "Define.h"
 #include <ace/Thread_Mutex.h>
+#include <ace/RW_Thread_Mutex.h>
+#include <vector>
 
 //===========================================================
 
@@ -63,7 +65,83 @@ namespace VMAP
             int iRefCount;
     };
 
-    typedef UNORDERED_MAP<uint32, StaticMapTree*> InstanceTreeMap;
+    #define RAY_CACHE_SHARDS        16
+    #define RAY_CACHE_QUANTUM       8.0f                    // endpoints are rounded to 1/8 yard
+
+    enum RayQueryType
+    {
+        RAY_QUERY_LINE_OF_SIGHT,
+        RAY_QUERY_HIT_POS
+    };
+
+    struct RayCacheKey
+    {
+        bool operator==(RayCacheKey const& other) const;
+
+        int32 From[3];
+        int32 To[3];
+        float ModifyDist;                                   // getObjectHitPos only
+        uint8 Type;                                         // RayQueryType
+    };
+
+    struct RayCacheEntry
+    {
+        RayCacheEntry() : Valid(false), Hit(false) { }
+
+        RayCacheKey Key;
+        bool Valid;
+        bool Hit;
+        float HitPos[3];
+    };
+
+    /**
+    Recent isInLineOfSight / getObjectHitPos results of one map tree, keyed by the quantized endpoints.
+    Direct mapped, split in shards with their own lock so the map update threads rarely contend.
+    */
+    class RayResultCache
+    {
+        public:
+            explicit RayResultCache(uint32 size);
+
+            static RayCacheKey MakeKey(RayQueryType type, float x1, float y1, float z1, float x2, float y2, float z2, float modifyDist = 0.0f);
+
+            bool Find(RayCacheKey const& key, bool& hit, float* hitPos);
+            void Store(RayCacheKey const& key, bool hit, float const* hitPos);
+            void Clear();
+
+            bool IsEnabled() const { return _shardSize != 0; }
+            void GetStats(uint64& hits, uint64& misses) const;
+
+        private:
+            struct Shard
+            {
+                Shard() : Hits(0), Misses(0) { }
+
+                ACE_Thread_Mutex Lock;
+                std::vector<RayCacheEntry> Entries;
+                uint64 Hits;
+                uint64 Misses;
+            };
+
+            RayCacheEntry& GetEntry(RayCacheKey const& key, Shard*& shard);
+
+            Shard _shards[RAY_CACHE_SHARDS];
+            uint32 _shardSize;
+    };
+
+    // A map tree with the lock of its tiles: queries share it, tile loads and unloads take it alone
+    class ManagedTree
+    {
+        public:
+            ManagedTree(StaticMapTree* tree, uint32 rayCacheSize) : iTree(tree), iRayCache(rayCacheSize), iDisableFlags(0) { }
+
+            StaticMapTree* iTree;
+            ACE_RW_Thread_Mutex iLock;
+            RayResultCache iRayCache;
+            uint8 iDisableFlags;                            // VMAP_DISABLE_* of DisableMgr, see refreshDisableFlags()
+    };
+
+    typedef UNORDERED_MAP<uint32, ManagedTree*> InstanceTreeMap;
     typedef UNORDERED_MAP<std::string, ManagedModel> ModelFileMap;
 
     class VMapManager2 : public IVMapManager
@@ -74,8 +152,13 @@ namespace VMAP
             InstanceTreeMap iInstanceMapTrees;
             // Mutex for iLoadedModelFiles
             ACE_Thread_Mutex LoadedModelFilesLock;
+            // Guards iInstanceMapTrees itself, always taken before the lock of a ManagedTree
+            mutable ACE_RW_Thread_Mutex iInstanceMapTreesLock;
 
             bool _loadMap(uint32 mapId, const std::string& basePath, uint32 tileX, uint32 tileY);
+            ManagedTree* _getOrCreateTree(uint32 mapId, const std::string& basePath);
+            void _unloadTree(uint32 mapId, bool allTiles, int x, int y);
+            static uint8 _getDisableFlags(uint32 mapId);
             /* void _unloadMap(uint32 pMapId, uint32 x, uint32 y); */
 
         public:
@@ -92,6 +175,7 @@ namespace VMAP
             void unloadMap(unsigned int mapId);
 
             bool isInLineOfSight(unsigned int mapId, float x1, float y1, float z1, float x2, float y2, float z2) ;
+            void isInLineOfSight(unsigned int mapId, LineOfSightQuery* queries, uint32 count);
             /**
             fill the hit pos and return true, if an object was hit
             */
@@ -100,6 +184,9 @@ namespace VMAP
 
             bool processCommand(char* /*command*/) { return false; } // for debug and extensions
 
+            void refreshDisableFlags();
+            void getRayCacheStats(uint64& hits, uint64& misses) const;
+
             bool getAreaInfo(unsigned int pMapId, float x, float y, float& z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const;
             bool GetLiquidLevel(uint32 pMapId, float x, float y, float z, uint8 reqLiquidType, float& level, float& floor, uint32& type) const;
 
@@ -27,6 +27,7 @@
 #include <sstream>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
 
 using G3D::Vector3;
 
@@ -50,6 +51,31 @@ namespace VMAP
         bool hit;
     };
 
+    class MapRayPacketCallback
+    {
+        public:
+            MapRayPacketCallback(ModelInstance* val, std::vector<bool>& hitList): prims(val), hits(hitList) { }
+            bool operator()(const G3D::Ray& ray, uint32 rayIndex, uint32 entry, float& distance, bool pStopAtFirstHit=true)
+            {
+                bool result = prims[entry].intersectRay(ray, distance, pStopAtFirstHit);
+                if (result)
+                    hits[rayIndex] = true;
+                return result;
+            }
+    protected:
+        ModelInstance* prims;
+        std::vector<bool>& hits;
+    };
+
+    // orders the rays of a batch by heading, rays running alongside each other end up in the same BIH packet
+    struct RayHeadingOrder
+    {
+        RayHeadingOrder(std::vector<float> const& headings) : Headings(headings) { }
+        bool operator()(uint32 left, uint32 right) const { return Headings[left] < Headings[right]; }
+
+        std::vector<float> const& Headings;
+    };
+
     class AreaInfoCallback
     {
         public:
@@ -176,6 +202,52 @@ namespace VMAP
 
         return true;
     }
+
+    void StaticMapTree::isInLineOfSight(const Vector3* pos1, const Vector3* pos2, bool* results, uint32 count) const
+    {
+        std::vector<uint32> traced;
+        std::vector<float> headings;
+        std::vector<float> distances;
+        traced.reserve(count);
+        headings.resize(count);
+        distances.resize(count);
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            // same checks as the single ray version
+            float maxDist = (pos2[i] - pos1[i]).magnitude();
+            results[i] = maxDist != std::numeric_limits<float>::infinity() && maxDist < std::numeric_limits<float>::max();
+            if (!results[i] || maxDist < 1e-10f)
+                continue;
+
+            distances[i] = maxDist;
+            headings[i] = atan2(pos2[i].y - pos1[i].y, pos2[i].x - pos1[i].x);
+            traced.push_back(i);
+        }
+
+        if (traced.empty())
+            return;
+
+        std::sort(traced.begin(), traced.end(), RayHeadingOrder(headings));
+
+        std::vector<G3D::Ray> rays;
+        std::vector<float> maxDists;
+        rays.reserve(traced.size());
+        maxDists.reserve(traced.size());
+        for (std::vector<uint32>::const_iterator itr = traced.begin(); itr != traced.end(); ++itr)
+        {
+            // direction with length of 1
+            rays.push_back(G3D::Ray::fromOriginAndDirection(pos1[*itr], (pos2[*itr] - pos1[*itr]) / distances[*itr]));
+            maxDists.push_back(distances[*itr]);
+        }
+
+        std::vector<bool> hits(rays.size(), false);
+        MapRayPacketCallback intersectionCallBack(iTreeValues, hits);
+        iTree.intersectRays(&rays[0], uint32(rays.size()), intersectionCallBack, &maxDists[0], true);
+
+        for (uint32 i = 0; i < traced.size(); ++i)
+            results[traced[i]] = !hits[i];
+    }
     //=========================================================
     /**
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
@@ -264,11 +264,12 @@ void ScriptedAI::DoResetThreat()
         return;
     }
 
-    std::list<HostileReference*>& threatlist = me->getThreatManager().getThreatList();
+    std::vector<uint64> targetGuids;
+    me->getThreatManager().getThreatListGuids(targetGuids);
 
-    for (std::list<HostileReference*>::iterator itr = threatlist.begin(); itr != threatlist.end(); ++itr)
+    for (std::vector<uint64>::const_iterator itr = targetGuids.begin(); itr != targetGuids.end(); ++itr)
     {
-        Unit* unit = Unit::GetUnit(*me, (*itr)->getUnitGuid());
+        Unit* unit = Unit::GetUnit(*me, *itr);
 
         if (unit && DoGetThreat(unit))
             DoModifyThreatPercent(unit, -100);
@@ -523,9 +524,10 @@ void BossAI::TeleportCheaters()
 {
     float x, y, z;
     me->GetPosition(x, y, z);
-    std::list<HostileReference*>& threatList = me->getThreatManager().getThreatList();
-    for (std::list<HostileReference*>::iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
-        if (Unit* target = (*itr)->getTarget())
+    std::vector<uint64> targetGuids;
+    me->getThreatManager().getThreatListGuids(targetGuids);
+    for (std::vector<uint64>::const_iterator itr = targetGuids.begin(); itr != targetGuids.end(); ++itr)
+        if (Unit* target = Unit::GetUnit(*me, *itr))
             if (target->GetTypeId() == TYPEID_PLAYER && !CheckBoundary(target))
                 target->NearTeleportTo(x, y, z, 0);
 }
@@ -34,6 +34,7 @@
 #include "Vehicle.h"
 #include "ScriptedGossip.h"
 #include "CreatureTextMgr.h"
+#include "TickProfiler.h"
 
 class TrinityStringTextBuilder
 {
@@ -103,6 +104,10 @@ void SmartScript::OnReset()
 
 void SmartScript::ProcessEventsFor(SMART_EVENT e, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
+    TickProfileScope profileScope;
+    if (TickProfiler::IsEnabled())
+        profileScope.Start(TICK_PROFILE_SMARTAI, GetProfileId(), NULL);
+
     for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
     {
         SMART_EVENT eventType = SMART_EVENT((*i).GetEventType());
@@ -421,10 +426,13 @@ void SmartScript::ProcessAction(SmartScriptHolder& e, Unit* unit, uint32 var0, u
             if (!me)
                 break;
 
-            std::list<HostileReference*> const& threatList = me->getThreatManager().getThreatList();
-            for (std::list<HostileReference*>::const_iterator i = threatList.begin(); i != threatList.end(); ++i)
+            // modifying the threat of a pet can add its owner to the list, walk a copy of the targets
+            std::vector<uint64> targetGuids;
+            me->getThreatManager().getThreatListGuids(targetGuids);
+
+            for (std::vector<uint64>::const_iterator i = targetGuids.begin(); i != targetGuids.end(); ++i)
             {
-                if (Unit* target = Unit::GetUnit(*me, (*i)->getUnitGuid()))
+                if (Unit* target = Unit::GetUnit(*me, *i))
                 {
                     me->getThreatManager().modifyThreatPercent(target, e.action.threatPCT.threatINC ? (int32)e.action.threatPCT.threatINC : -(int32)e.action.threatPCT.threatDEC);
                     sLog->outDebug(LOG_FILTER_DATABASE_AI, "SmartScript::ProcessAction:: SMART_ACTION_THREAT_ALL_PCT: Creature guidLow %u modify threat for unit %u, value %i",
@@ -2429,8 +2437,8 @@ ObjectList* SmartScript::GetTargets(SmartScriptHolder const& e, Unit* invoker /*
         {
             if (me)
             {
-                std::list<HostileReference*> const& threatList = me->getThreatManager().getThreatList();
-                for (std::list<HostileReference*>::const_iterator i = threatList.begin(); i != threatList.end(); ++i)
+                ThreatContainer::StorageType const& threatList = me->getThreatManager().getThreatList();
+                for (ThreatContainer::StorageType::const_iterator i = threatList.begin(); i != threatList.end(); ++i)
                     if (Unit* temp = Unit::GetUnit(*me, (*i)->getUnitGuid()))
                         l->push_back(temp);
             }
@@ -3019,6 +3027,10 @@ void SmartScript::OnUpdate(uint32 const diff)
     if ((mScriptType == SMART_SCRIPT_TYPE_CREATURE || mScriptType == SMART_SCRIPT_TYPE_GAMEOBJECT) && !GetBaseObject())
         return;
 
+    TickProfileScope profileScope;
+    if (TickProfiler::IsEnabled())
+        profileScope.Start(TICK_PROFILE_SMARTAI, GetProfileId(), NULL);
+
     InstallEvents();//before UpdateTimers
 
     for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
@@ -3103,6 +3115,20 @@ void SmartScript::FillScript(SmartAIEventList e, WorldObject* obj, AreaTriggerEn
         sLog->outDebug(LOG_FILTER_SQL, "SmartScript: AreaTrigger %u has events but no events added to list because of instance flags. NOTE: triggers can not handle any instance flags.", at->id);
 }
 
+uint64 SmartScript::GetProfileId() const
+{
+    // the owner, not the events: a script without events still has its owner, per guid scripts count for their entry
+    uint32 entry = 0;
+    if (me)
+        entry = me->GetEntry();
+    else if (go)
+        entry = go->GetEntry();
+    else if (trigger)
+        entry = trigger->id;
+
+    return (uint64(mScriptType) << 32) | entry;
+}
+
 void SmartScript::GetScript()
 {
     SmartAIEventList e;
@@ -218,6 +218,9 @@ class SmartScript
         bool IsInPhase(uint32 p) const { return (1 << (mEventPhase - 1)) & p; }
         void SetPhase(uint32 p = 0) { mEventPhase = p; }
 
+        // source type << 32 | entry of the owner (creature, gameobject or areatrigger), the tick profiler key of the script
+        uint64 GetProfileId() const;
+
         SmartAIEventList mEvents;
         SmartAIEventList mInstallEvents;
         SmartAIEventList mTimedActionList;
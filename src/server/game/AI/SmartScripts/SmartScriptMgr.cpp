@@ -46,7 +46,7 @@ void SmartWaypointMgr::LoadFromDB()
     waypoint_map.clear();
 
     PreparedStatement* stmt = WorldDatabase.GetPreparedStatement(WORLD_SEL_SMARTAI_WP);
-    PreparedQueryResult result = WorldDatabase.Query(stmt);
+    PreparedQueryStream result = WorldDatabase.StreamQuery(stmt);
 
     if (!result)
     {
@@ -113,7 +113,7 @@ void SmartAIMgr::LoadSmartAIFromDB()
         mEventMap[i].clear();  //Drop Existing SmartAI List
 
     PreparedStatement* stmt = WorldDatabase.GetPreparedStatement(WORLD_SEL_SMART_SCRIPTS);
-    PreparedQueryResult result = WorldDatabase.Query(stmt);
+    PreparedQueryStream result = WorldDatabase.StreamQuery(stmt);
 
     if (!result)
     {
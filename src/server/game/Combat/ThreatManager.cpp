@@ -27,6 +27,9 @@
 #include "SpellAuras.h"
 #include "SpellMgr.h"
 
+#include <algorithm>
+#include <iterator>
+
 //==============================================================
 //================= ThreatCalcHelper ===========================
 //==============================================================
@@ -99,6 +102,8 @@ HostileReference::HostileReference(Unit* refUnit, ThreatManager* threatManager,
     iUnitGuid = refUnit->GetGUID();
     iOnline = true;
     iAccessible = true;
+    iListSlot = 0;
+    iNeedReorder = false;
 }
 
 //============================================================
@@ -253,12 +258,61 @@ Unit* HostileReference::getSourceUnit()
 
 void ThreatContainer::clearReferences()
 {
-    for (std::list<HostileReference*>::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
+    for (StorageType::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
     {
         (*i)->unlink();
         delete (*i);
     }
     iThreatList.clear();
+    iReorderList.clear();
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* hostileRef)
+{
+    uint32 slot = hostileRef->iListSlot;
+    if (slot >= iThreatList.size() || iThreatList[slot] != hostileRef)
+        return;
+
+    iThreatList.erase(iThreatList.begin() + slot);
+    updateSlots(slot, iThreatList.size());
+
+    if (hostileRef->iNeedReorder)
+    {
+        iReorderList.erase(std::find(iReorderList.begin(), iReorderList.end(), hostileRef));
+        hostileRef->iNeedReorder = false;
+    }
+}
+
+//============================================================
+// New references go to the end of the list and get their rank at the next update
+
+void ThreatContainer::addReference(HostileReference* hostileRef)
+{
+    hostileRef->iListSlot = iThreatList.size();
+    hostileRef->iNeedReorder = false;
+    iThreatList.push_back(hostileRef);
+    markForReorder(hostileRef);
+}
+
+//============================================================
+
+void ThreatContainer::markForReorder(HostileReference* hostileRef)
+{
+    if (hostileRef->iNeedReorder || hostileRef->iListSlot >= iThreatList.size() || iThreatList[hostileRef->iListSlot] != hostileRef)
+        return;
+
+    hostileRef->iNeedReorder = true;
+    iReorderList.push_back(hostileRef);
+}
+
+//============================================================
+
+void ThreatContainer::updateSlots(uint32 first, uint32 last)
+{
+    for (uint32 i = first; i < last; ++i)
+        iThreatList[i]->iListSlot = i;
 }
 
 //============================================================
@@ -269,7 +323,7 @@ HostileReference* ThreatContainer::getReferenceByTarget(Unit* victim)
         return NULL;
 
     uint64 guid = victim->GetGUID();
-    for (std::list<HostileReference*>::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
+    for (StorageType::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
         if ((*i) && (*i)->getUnitGuid() == guid)
             return (*i);
 
@@ -296,14 +350,60 @@ void ThreatContainer::modifyThreatPercent(Unit* victim, int32 percent)
 }
 
 //============================================================
-// Check if the list is dirty and sort if necessary
+// Check if the list is dirty and move the flagged references to their rank
 
 void ThreatContainer::update()
 {
-    if (iDirty && iThreatList.size() > 1)
-        iThreatList.sort(MoPCore::ThreatOrderPred());
+    if (!iDirty)
+        return;
 
     iDirty = false;
+
+    if (iReorderList.empty())
+        return;
+
+    MoPCore::ThreatOrderPred pred;
+
+    if (iReorderList.size() == 1)
+    {
+        // only one reference changed, the rest of the list is still ordered
+        HostileReference* ref = iReorderList.front();
+        ref->iNeedReorder = false;
+        iReorderList.clear();
+
+        StorageType::iterator from = iThreatList.begin() + ref->iListSlot;
+        if (from != iThreatList.begin() && pred(ref, *(from - 1)))
+        {
+            StorageType::iterator to = std::upper_bound(iThreatList.begin(), from, ref, pred);
+            std::rotate(to, from, from + 1);
+            updateSlots(to - iThreatList.begin(), ref->iListSlot + 1);
+        }
+        else if (from + 1 != iThreatList.end() && pred(*(from + 1), ref))
+        {
+            StorageType::iterator to = std::lower_bound(from + 1, iThreatList.end(), ref, pred);
+            std::rotate(from, from + 1, to);
+            updateSlots(ref->iListSlot, to - iThreatList.begin());
+        }
+        return;
+    }
+
+    // take the changed references out, order them and merge them back into the still ordered rest
+    std::stable_sort(iReorderList.begin(), iReorderList.end(), pred);
+
+    StorageType ordered;
+    ordered.reserve(iThreatList.size());
+    for (StorageType::const_iterator itr = iThreatList.begin(); itr != iThreatList.end(); ++itr)
+        if (!(*itr)->iNeedReorder)
+            ordered.push_back(*itr);
+
+    for (StorageType::const_iterator itr = iReorderList.begin(); itr != iReorderList.end(); ++itr)
+        (*itr)->iNeedReorder = false;
+
+    iThreatList.clear();
+    std::merge(ordered.begin(), ordered.end(), iReorderList.begin(), iReorderList.end(), std::back_inserter(iThreatList), pred);
+    iReorderList.clear();
+
+    updateSlots(0, iThreatList.size());
 }
 
 //============================================================
@@ -316,10 +416,10 @@ HostileReference* ThreatContainer::selectNextVictim(Creature* attacker, HostileR
     bool found = false;
     bool noPriorityTargetFound = false;
 
-    std::list<HostileReference*>::const_iterator lastRef = iThreatList.end();
+    StorageType::const_iterator lastRef = iThreatList.end();
     --lastRef;
 
-    for (std::list<HostileReference*>::const_iterator iter = iThreatList.begin(); iter != iThreatList.end() && !found;)
+    for (StorageType::const_iterator iter = iThreatList.begin(); iter != iThreatList.end() && !found;)
     {
         currentRef = (*iter);
 
@@ -455,6 +555,16 @@ void ThreatManager::_addThreat(Unit* victim, float threat)
 
 //============================================================
 
+void ThreatManager::getThreatListGuids(std::vector<uint64>& guids) const
+{
+    ThreatContainer::StorageType const& threatList = iThreatContainer.iThreatList;
+    guids.reserve(guids.size() + threatList.size());
+    for (ThreatContainer::StorageType::const_iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
+        guids.push_back((*itr)->getUnitGuid());
+}
+
+//============================================================
+
 void ThreatManager::modifyThreatPercent(Unit* victim, int32 percent)
 {
     iThreatContainer.modifyThreatPercent(victim, percent);
@@ -528,6 +638,8 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
     switch (threatRefStatusChangeEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
+            if (hostilRef->isOnline())
+                iThreatContainer.markForReorder(hostilRef);
             if ((getCurrentVictim() == hostilRef && threatRefStatusChangeEvent->getFValue()<0.0f) ||
                 (getCurrentVictim() != hostilRef && threatRefStatusChangeEvent->getFValue()>0.0f))
                 setDirty(true);                             // the order in the threat list might have changed
@@ -548,8 +660,9 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
             {
                 if (getCurrentVictim() && hostilRef->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
                     setDirty(true);
-                iThreatContainer.addReference(hostilRef);
+                // remove first, both containers use the slot and reorder flag of the reference
                 iThreatOfflineContainer.remove(hostilRef);
+                iThreatContainer.addReference(hostilRef);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
@@ -584,14 +697,13 @@ bool ThreatManager::isNeedUpdateToClient(uint32 time)
 // Reset all aggro without modifying the threadlist.
 void ThreatManager::resetAllAggro()
 {
-    std::list<HostileReference*> &threatList = getThreatList();
+    ThreatContainer::StorageType &threatList = getThreatList();
     if (threatList.empty())
         return;
 
-    for (std::list<HostileReference*>::iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
-    {
-        (*itr)->setThreat(0);
-    }
+    // by index, setting the threat can add the owner of a pet to the list
+    for (size_t i = 0; i < threatList.size(); ++i)
+        threatList[i]->setThreat(0);
 
     setDirty(true);
 }
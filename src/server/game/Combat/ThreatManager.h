@@ -24,7 +24,7 @@
 #include "LinkedReference/Reference.h"
 #include "UnitEvents.h"
 
-#include <list>
+#include <vector>
 
 //==============================================================
 
@@ -125,6 +125,8 @@ class HostileReference : public Reference<Unit, ThreatManager>
         // Tell our refFrom (source) object, that the link is cut (Target destroyed)
         void sourceObjectDestroyLink();
     private:
+        friend class ThreatContainer;
+
         // Inform the source, that the status of that reference was changed
         void fireStatusChanged(ThreatRefStatusChangeEvent& threatRefStatusChangeEvent);
 
@@ -135,24 +137,42 @@ class HostileReference : public Reference<Unit, ThreatManager>
         uint64 iUnitGuid;
         bool iOnline;
         bool iAccessible;
+        uint32 iListSlot;                                   // position in the ThreatContainer holding the reference
+        bool iNeedReorder;                                  // threat changed since the container was last ordered
 };
 
 //==============================================================
 class ThreatManager;
 
+/*
+ * The threat list is a vector ordered by threat, highest first, so the most
+ * hated reference is always at the front. Threat changes do not move the
+ * reference at once, they only flag it; update() moves the flagged
+ * references to their new rank by binary search and merge, so the order seen
+ * by code iterating the list only changes when the container is updated.
+ * Adding or removing a reference still invalidates the iterators, see
+ * ThreatManager::getThreatListGuids().
+ */
 class ThreatContainer
 {
+    public:
+        typedef std::vector<HostileReference*> StorageType;
+
     private:
-        std::list<HostileReference*> iThreatList;
+        StorageType iThreatList;
+        StorageType iReorderList;                           // references flagged with iNeedReorder
         bool iDirty;
     protected:
         friend class ThreatManager;
 
-        void remove(HostileReference* hostileRef) { iThreatList.remove(hostileRef); }
-        void addReference(HostileReference* hostileRef) { iThreatList.push_back(hostileRef); }
+        void remove(HostileReference* hostileRef);
+        void addReference(HostileReference* hostileRef);
         void clearReferences();
 
-        // Sort the list if necessary
+        // Flag the reference for reordering at the next update
+        void markForReorder(HostileReference* hostileRef);
+
+        // Reorder the list if necessary
         void update();
     public:
         ThreatContainer() { iDirty = false; }
@@ -174,7 +194,9 @@ class ThreatContainer
 
         HostileReference* getReferenceByTarget(Unit* victim);
 
-        std::list<HostileReference*>& getThreatList() { return iThreatList; }
+        StorageType& getThreatList() { return iThreatList; }
+    private:
+        void updateSlots(uint32 first, uint32 last);
 };
 
 //=================================================
@@ -223,13 +245,14 @@ class ThreatManager
         // Reset all aggro of unit in threadlist satisfying the predicate.
         template<class PREDICATE> void resetAggro(PREDICATE predicate)
         {
-            std::list<HostileReference*> &threatList = getThreatList();
+            ThreatContainer::StorageType &threatList = getThreatList();
             if (threatList.empty())
                 return;
 
-            for (std::list<HostileReference*>::iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
+            // by index, setting the threat can add the owner of a pet to the list
+            for (size_t i = 0; i < threatList.size(); ++i)
             {
-                HostileReference* ref = (*itr);
+                HostileReference* ref = threatList[i];
 
                 if (predicate(ref->getTarget()))
                 {
@@ -239,10 +262,15 @@ class ThreatManager
             }
         }
 
+        // Guids of the online targets in list order. Loops that cast spells, deal damage, add threat or teleport
+        // must walk these instead of the list: a kill or a teleport removes references from the list while the
+        // loop runs and new threat can add some, either one invalidates the iterators and the references
+        void getThreatListGuids(std::vector<uint64>& guids) const;
+
         // methods to access the lists from the outside to do some dirty manipulation (scriping and such)
         // I hope they are used as little as possible.
-        std::list<HostileReference*>& getThreatList() { return iThreatContainer.getThreatList(); }
-        std::list<HostileReference*>& getOfflineThreatList() { return iThreatOfflineContainer.getThreatList(); }
+        ThreatContainer::StorageType& getThreatList() { return iThreatContainer.getThreatList(); }
+        ThreatContainer::StorageType& getOfflineThreatList() { return iThreatOfflineContainer.getThreatList(); }
         ThreatContainer& getOnlineContainer() { return iThreatContainer; }
         ThreatContainer& getOfflineContainer() { return iThreatOfflineContainer; }
     private:
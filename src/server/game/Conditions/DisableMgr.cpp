@@ -21,6 +21,7 @@
 #include "OutdoorPvP.h"
 #include "SpellMgr.h"
 #include "VMapManager2.h"
+#include "VMapFactory.h"
 
 namespace DisableMgr
 {
@@ -60,7 +61,7 @@ void LoadDisables()
     if (!result)
     {
         sLog->outInfo(LOG_FILTER_SERVER_LOADING, ">> Loaded 0 disables. DB table `disables` is empty!");
-
+        VMAP::VMapFactory::createOrGetVMapManager()->refreshDisableFlags();
         return;
     }
 
@@ -246,6 +247,9 @@ void LoadDisables()
     }
     while (result->NextRow());
 
+    // the vmap manager keeps the vmap disables of its loaded maps
+    VMAP::VMapFactory::createOrGetVMapManager()->refreshDisableFlags();
+
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, ">> Loaded %u disables in %u ms", total_count, GetMSTimeDiffToNow(oldMSTime));
 
 }
@@ -45,6 +45,7 @@ void AreaTrigger::AddToWorld()
     if (!IsInWorld())
     {
         sObjectAccessor->AddObject(this);
+        GetMap()->AddToObjectIndex(this);
         WorldObject::AddToWorld();
         BindToCaster();
     }
@@ -57,6 +58,7 @@ void AreaTrigger::RemoveFromWorld()
     {
         UnbindFromCaster();
         WorldObject::RemoveFromWorld();
+        GetMap()->RemoveFromObjectIndex(this);
         sObjectAccessor->RemoveObject(this);
     }
 }
@@ -145,7 +145,8 @@ m_PlayerDamageReq(0), m_lootRecipient(0), m_lootRecipientGroup(0), m_corpseRemov
 m_respawnDelay(300), m_corpseDelay(60), m_respawnradius(0.0f), m_reactState(REACT_AGGRESSIVE),
 m_defaultMovementType(IDLE_MOTION_TYPE), m_DBTableGuid(0), m_equipmentId(0), m_AlreadyCallAssistance(false),
 m_AlreadySearchedAssistance(false), m_regenHealth(true), m_AI_locked(false), m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL),
-m_creatureInfo(NULL), m_creatureData(NULL), m_path_id(0), m_formation(NULL), m_battleground(NULL)
+m_creatureInfo(NULL), m_creatureData(NULL), m_path_id(0), m_formation(NULL), m_battleground(NULL),
+m_updateTier(CREATURE_UPDATE_TIER_ACTIVE), m_updateTierTimer(urand(0, CREATURE_UPDATE_TIER_CHECK_INTERVAL)), m_updateTierDiff(0)
 {
     m_regenTimer = CREATURE_REGEN_INTERVAL;
     m_valuesCount = UNIT_END;
@@ -189,6 +190,7 @@ void Creature::AddToWorld()
         if (m_zoneScript)
             m_zoneScript->OnCreatureCreate(this);
         sObjectAccessor->AddObject(this);
+        GetMap()->AddToObjectIndex(this);
         Unit::AddToWorld();
         SearchFormation();
         AIM_Initialize();
@@ -206,6 +208,7 @@ void Creature::RemoveFromWorld()
         if (m_formation)
             sFormationMgr->RemoveCreatureFromGroup(m_formation, this);
         Unit::RemoveFromWorld();
+        GetMap()->RemoveFromObjectIndex(this);
         sObjectAccessor->RemoveObject(this);
     }
 }
@@ -496,19 +499,8 @@ void Creature::Update(uint32 diff)
     else
         m_LOSCheckTimer -= diff;
 
-    // Zone Skip Update
-    if ((sObjectMgr->IsSkipZone(GetZoneId()) && (!isInCombat() && !GetMap()->Instanceable())) && (!isTotem() || GetOwner()))
-    {
-        _skipCount++;
-        _skipDiff += diff;
-
-        if (_skipCount != sObjectMgr->GetSkipUpdateCount())
-            return;
-
-        diff = _skipDiff;
-        _skipCount = 0;
-        _skipDiff = 0;
-    }
+    if (!UpdateLevelOfDetail(diff))
+        return;
 
     if (IsAIEnabled && TriggerJustRespawned)
     {
@@ -676,6 +668,97 @@ void Creature::Update(uint32 diff)
     sScriptMgr->OnCreatureUpdate(this, diff);
 }
 
+// finds the distance to the closest player in the position indexes of the cells around a creature
+class NearestPlayerDistance
+{
+    public:
+        NearestPlayerDistance(Creature const* creature) : _creature(creature), _distSq(std::numeric_limits<float>::max()) { }
+
+        void Visit(std::vector<WorldObject*> const& objects)
+        {
+            for (std::vector<WorldObject*>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr)
+                _distSq = std::min(_distSq, _creature->GetExactDist2dSq(*itr));
+        }
+
+        float GetDistance() const { return std::sqrt(_distSq); }
+
+    private:
+        Creature const* _creature;
+        float _distSq;
+};
+
+// creatures which must keep up with every map update whatever the distance to the players
+bool Creature::NeedsEveryUpdate() const
+{
+    return !sWorld->getBoolConfig(CONFIG_CREATURE_UPDATE_LOD) || isInCombat() || IsInEvadeMode() || GetCharmerOrOwnerGUID()
+        || isTotem() || IsWorldObject() || GetVehicle() || IsVehicle() || TriggerJustRespawned || GetMap()->Instanceable();
+}
+
+uint8 Creature::SelectUpdateTier() const
+{
+    if (NeedsEveryUpdate())
+        return CREATURE_UPDATE_TIER_ACTIVE;
+
+    float nearDistance = sWorld->getFloatConfig(CONFIG_CREATURE_UPDATE_LOD_NEAR_DISTANCE);
+    float farDistance = sWorld->getFloatConfig(CONFIG_CREATURE_UPDATE_LOD_FAR_DISTANCE);
+
+    CellCoord p(MoPCore::ComputeCellCoord(GetPositionX(), GetPositionY()));
+    Cell cell(p);
+    cell.SetNoCreate();
+
+    NearestPlayerDistance nearest(this);
+    cell.VisitIndexed(p, nearest, *GetMap(), farDistance, GetPositionX(), GetPositionY(),
+        GRID_MAP_TYPE_MASK_PLAYER | CELL_INDEX_WORLD_CONTAINER, GetPhaseMask());
+
+    float distance = nearest.GetDistance();
+    if (distance <= nearDistance)
+        return CREATURE_UPDATE_TIER_ACTIVE;
+    if (distance <= farDistance)
+        return CREATURE_UPDATE_TIER_NEAR;
+    return CREATURE_UPDATE_TIER_FAR;
+}
+
+// Accumulates the elapsed time of the skipped map updates, returns true when the creature
+// update has to run this time with diff set to the time since its last update
+bool Creature::UpdateLevelOfDetail(uint32& diff)
+{
+    if (m_updateTierTimer <= diff)
+    {
+        m_updateTier = SelectUpdateTier();
+        m_updateTierTimer = CREATURE_UPDATE_TIER_CHECK_INTERVAL;
+    }
+    else
+    {
+        m_updateTierTimer -= diff;
+        // getting engaged or controlled wakes the creature without waiting for the next check
+        if (m_updateTier != CREATURE_UPDATE_TIER_ACTIVE && NeedsEveryUpdate())
+            m_updateTier = CREATURE_UPDATE_TIER_ACTIVE;
+    }
+
+    CreatureUpdateTierStats& stats = GetMap()->GetCreatureUpdateTierCounters();
+    ++stats.Creatures[m_updateTier];
+
+    m_updateTierDiff += diff;
+    switch (m_updateTier)
+    {
+        case CREATURE_UPDATE_TIER_NEAR:
+            if (m_updateTierDiff < sWorld->getIntConfig(CONFIG_CREATURE_UPDATE_LOD_NEAR_INTERVAL))
+                return false;
+            break;
+        case CREATURE_UPDATE_TIER_FAR:
+            if (m_updateTierDiff < sWorld->getIntConfig(CONFIG_CREATURE_UPDATE_LOD_FAR_INTERVAL))
+                return false;
+            break;
+        default:
+            break;
+    }
+
+    diff = m_updateTierDiff;
+    m_updateTierDiff = 0;
+    ++stats.Updated;
+    return true;
+}
+
 void Creature::RegenerateMana()
 {
     uint32 curValue = GetPower(POWER_MANA);
@@ -149,6 +149,7 @@ enum CreatureFlagsExtra
 
 #define MAX_KILL_CREDIT 2
 #define CREATURE_REGEN_INTERVAL 2 * IN_MILLISECONDS
+#define CREATURE_UPDATE_TIER_CHECK_INTERVAL IN_MILLISECONDS
 
 #define MAX_CREATURE_QUEST_ITEMS 6
 
@@ -845,6 +846,8 @@ class Creature : public Unit, public GridObject<Creature>, public MapCreature
         Battleground* GetBattleground() const { return m_battleground; }
         void SetBattleground(Battleground* bg) { m_battleground = bg; }
 
+        uint8 GetUpdateTier() const { return m_updateTier; }
+
     protected:
         bool CreateFromProto(uint32 guidlow, uint32 Entry, uint32 vehId, uint32 team, const CreatureData* data = NULL);
         bool InitEntry(uint32 entry, uint32 team=ALLIANCE, const CreatureData* data=NULL);
@@ -905,6 +908,15 @@ class Creature : public Unit, public GridObject<Creature>, public MapCreature
         //Formation var
         CreatureGroup* m_formation;
         bool TriggerJustRespawned;
+
+        // Update level of detail
+        bool UpdateLevelOfDetail(uint32& diff);
+        bool NeedsEveryUpdate() const;
+        uint8 SelectUpdateTier() const;
+
+        uint8 m_updateTier;                                 // CreatureUpdateTier
+        uint32 m_updateTierTimer;                           // time until the tier is selected again
+        uint32 m_updateTierDiff;                            // time elapsed since the last update ran
 };
 
 class AssistDelayEvent : public BasicEvent
@@ -54,6 +54,7 @@ void DynamicObject::AddToWorld()
     if (!IsInWorld())
     {
         sObjectAccessor->AddObject(this);
+        GetMap()->AddToObjectIndex(this);
         WorldObject::AddToWorld();
 
         if (GetType() != DYNAMIC_OBJECT_RAID_MARKER)
@@ -80,6 +81,7 @@ void DynamicObject::RemoveFromWorld()
             UnbindFromCaster();
 
         WorldObject::RemoveFromWorld();
+        GetMap()->RemoveFromObjectIndex(this);
         sObjectAccessor->RemoveObject(this);
     }
 }
@@ -138,6 +138,7 @@ void GameObject::AddToWorld()
             m_zoneScript->OnGameObjectCreate(this);
 
         sObjectAccessor->AddObject(this);
+        GetMap()->AddToObjectIndex(this);
         // The state can be changed after GameObject::Create but before GameObject::AddToWorld
         bool toggledState = GetGoType() == GAMEOBJECT_TYPE_CHEST ? getLootState() == GO_READY : GetGoState() == GO_STATE_READY;
         if (m_model)
@@ -161,6 +162,7 @@ void GameObject::RemoveFromWorld()
             if (GetMap()->ContainsGameObjectModel(*m_model))
                 GetMap()->RemoveGameObjectModel(*m_model);
         WorldObject::RemoveFromWorld();
+        GetMap()->RemoveFromObjectIndex(this);
         sObjectAccessor->RemoveObject(this);
     }
 }
@@ -2278,65 +2280,50 @@ bool GameObject::IsLootAllowedFor(Player const* player) const
     return true;
 }
 
-void GameObject::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* target) const
+uint32 GameObject::GetUpdateFieldData(Player const* target, uint32*& flags) const
 {
-    if (!target)
-        return;
+    flags = GameObjectUpdateFieldFlags;
+
+    uint32 visibleFlag = UF_FLAG_PUBLIC;
+    if (GetOwnerGUID() == target->GetGUID())
+        visibleFlag |= UF_FLAG_OWNER;
 
+    return visibleFlag;
+}
+
+void GameObject::BuildValuesUpdateFields(uint8 updateType, ByteBuffer* data, uint32 visibleFlag, uint32 const* flags, Player* target, std::vector<ValuesUpdatePatch>* patches) const
+{
     bool forcedFlags = GetGoType() == GAMEOBJECT_TYPE_CHEST && GetGOInfo()->chest.groupLootRules && HasLootRecipient();
-    bool targetIsGM = target->isGameMaster();
 
     ByteBuffer fieldBuffer;
 
     UpdateMask updateMask;
     updateMask.SetCount(m_valuesCount);
 
-    uint32* flags = GameObjectUpdateFieldFlags;
-    uint32 visibleFlag = UF_FLAG_PUBLIC;
-    if (GetOwnerGUID() == target->GetGUID())
-        visibleFlag |= UF_FLAG_OWNER;
+    UpdateFieldFlagMasks const& flagMasks = GetUpdateFieldFlagMasks(flags);
 
-    for (uint16 index = 0; index < m_valuesCount; ++index)
+    uint64 forcedWords = UpdateFieldWordOf(GAMEOBJECT_FLAGS) | UpdateFieldWordOf(OBJECT_FIELD_DYNAMIC_FLAGS) | UpdateFieldWordOf(GAMEOBJECT_BYTES_1);
+    uint32 wordCount = _changedFields.GetWordCount();
+    for (uint32 word = NextValuesUpdateWord(updateType, 0, flagMasks, _fieldNotifyFlags, forcedWords); word < wordCount;
+        word = NextValuesUpdateWord(updateType, word + 1, flagMasks, _fieldNotifyFlags, forcedWords))
     {
-        if (_fieldNotifyFlags & flags[index] ||
-            ((updateType == UPDATETYPE_VALUES ? _changedFields[index] : m_uint32Values[index]) && (flags[index] & visibleFlag)) ||
-            (index == GAMEOBJECT_FLAGS && forcedFlags) || index == OBJECT_FIELD_DYNAMIC_FLAGS || index == GAMEOBJECT_BYTES_1)
+        uint64 candidates = GetValuesUpdateCandidates(updateType, word, flagMasks, _fieldNotifyFlags) |
+            UpdateFieldWordBit(word, GAMEOBJECT_FLAGS) | UpdateFieldWordBit(word, OBJECT_FIELD_DYNAMIC_FLAGS) | UpdateFieldWordBit(word, GAMEOBJECT_BYTES_1);
 
+        uint64 sent = 0;
+        for (; candidates; candidates &= candidates - 1)
         {
-            updateMask.SetBit(index);
+            uint32 bit = UpdateFieldLowestBit(candidates);
+            uint16 index = uint16(word * 64 + bit);
+            if (!(_fieldNotifyFlags & flags[index] ||
+                ((updateType == UPDATETYPE_VALUES ? _changedFields.Test(index) : m_uint32Values[index]) && (flags[index] & visibleFlag)) ||
+                (index == GAMEOBJECT_FLAGS && forcedFlags) || index == OBJECT_FIELD_DYNAMIC_FLAGS || index == GAMEOBJECT_BYTES_1))
+                continue;
 
-            if (index == OBJECT_FIELD_DYNAMIC_FLAGS)
-            {
-                uint16 dynFlags = 0;
-                switch (GetGoType())
-                {
-                    case GAMEOBJECT_TYPE_CHEST:
-                    case GAMEOBJECT_TYPE_GOOBER:
-                        if (ActivateToQuest(target))
-                            dynFlags |= GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE;
-                        else if (targetIsGM)
-                            dynFlags |= GO_DYNFLAG_LO_ACTIVATE;
-                        break;
-                    case GAMEOBJECT_TYPE_GENERIC:
-                        if (ActivateToQuest(target))
-                            dynFlags |= GO_DYNFLAG_LO_SPARKLE;
-                        break;
-                }
-
-                fieldBuffer << uint16(dynFlags);
-                fieldBuffer << uint16(-1);
-            }
-            else if (index == GAMEOBJECT_FLAGS)
-            {
-                uint32 flags = m_uint32Values[GAMEOBJECT_FLAGS];
-                if (GetGoType() == GAMEOBJECT_TYPE_CHEST)
-                {
-                    if (GetGOInfo()->chest.groupLootRules && (!IsLootAllowedFor(target) || GetOwner() && GetOwner()->ToCreature() && !target->CanLootWeeklyBoss(GetOwner()->ToCreature())))
-                        flags |= GO_FLAG_LOCKED | GO_FLAG_NOT_SELECTABLE;
-                }
+            sent |= uint64(1) << bit;
 
-                fieldBuffer << flags;
-            }
+            if (index == OBJECT_FIELD_DYNAMIC_FLAGS || (index == GAMEOBJECT_FLAGS && GetGoType() == GAMEOBJECT_TYPE_CHEST))
+                AppendValuesUpdateFieldForTarget(fieldBuffer, index, target, patches);
             else if (index == GAMEOBJECT_BYTES_1)
             {
                 if (GetGoType() == GAMEOBJECT_TYPE_TRANSPORT && !IsDynTransport() && (m_updateFlag & UPDATEFLAG_TRANSPORT_ARR))
@@ -2347,9 +2334,49 @@ void GameObject::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* t
             else
                 fieldBuffer << m_uint32Values[index]; // other cases
         }
+
+        if (sent)
+            updateMask.SetWord64(word, sent);
+    }
+
+    AppendValuesUpdateFields(data, updateMask, fieldBuffer, patches);
+}
+
+uint32 GameObject::GetValuesUpdateFieldForTarget(uint16 index, Player* target) const
+{
+    if (index == OBJECT_FIELD_DYNAMIC_FLAGS)
+    {
+        uint16 dynFlags = 0;
+        switch (GetGoType())
+        {
+            case GAMEOBJECT_TYPE_CHEST:
+            case GAMEOBJECT_TYPE_GOOBER:
+                if (ActivateToQuest(target))
+                    dynFlags |= GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE;
+                else if (target->isGameMaster())
+                    dynFlags |= GO_DYNFLAG_LO_ACTIVATE;
+                break;
+            case GAMEOBJECT_TYPE_GENERIC:
+                if (ActivateToQuest(target))
+                    dynFlags |= GO_DYNFLAG_LO_SPARKLE;
+                break;
+        }
+
+        // dynamic flags in the low half, path progress (-1) in the high half
+        return uint32(dynFlags) | 0xFFFF0000;
+    }
+
+    if (index == GAMEOBJECT_FLAGS)
+    {
+        uint32 flags = m_uint32Values[GAMEOBJECT_FLAGS];
+        if (GetGoType() == GAMEOBJECT_TYPE_CHEST)
+        {
+            if (GetGOInfo()->chest.groupLootRules && (!IsLootAllowedFor(target) || GetOwner() && GetOwner()->ToCreature() && !target->CanLootWeeklyBoss(GetOwner()->ToCreature())))
+                flags |= GO_FLAG_LOCKED | GO_FLAG_NOT_SELECTABLE;
+        }
+
+        return flags;
     }
 
-    *data << uint8(updateMask.GetBlockCount());
-    updateMask.AppendToPacket(data);
-    data->append(fieldBuffer);
+    return m_uint32Values[index];
 }
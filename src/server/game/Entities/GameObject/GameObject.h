@@ -670,7 +670,9 @@ class GameObject : public WorldObject, public GridObject<GameObject>
         explicit GameObject();
         ~GameObject();
         
-        void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const;
+        uint32 GetUpdateFieldData(Player const* target, uint32*& flags) const;
+        void BuildValuesUpdateFields(uint8 updatetype, ByteBuffer* data, uint32 visibleFlag, uint32 const* flags, Player* target, std::vector<ValuesUpdatePatch>* patches) const;
+        uint32 GetValuesUpdateFieldForTarget(uint16 index, Player* target) const;
 
         void AddToWorld();
         void RemoveFromWorld();
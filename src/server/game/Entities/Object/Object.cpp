@@ -79,7 +79,6 @@ Object::Object() : m_PackGUID(sizeof(uint64)+1)
     m_objectType        = TYPEMASK_OBJECT;
 
     m_uint32Values      = NULL;
-    _changedFields      = NULL;
     _dynamicFields      = NULL;
     m_valuesCount       = 0;
     _dynamicTabCount    = 0;
@@ -93,6 +92,8 @@ Object::Object() : m_PackGUID(sizeof(uint64)+1)
 
 WorldObject::~WorldObject()
 {
+    RemoveFromCellIndex();
+
     // this may happen because there are many !create/delete
     if (IsWorldObject() && m_currMap)
     {
@@ -124,7 +125,6 @@ Object::~Object()
     }
 
     delete [] m_uint32Values;
-    delete [] _changedFields;
     delete [] _dynamicFields;
 }
 
@@ -133,8 +133,7 @@ void Object::_InitValues()
     m_uint32Values = new uint32[m_valuesCount];
     memset(m_uint32Values, 0, m_valuesCount*sizeof(uint32));
 
-    _changedFields = new bool[m_valuesCount];
-    memset(_changedFields, 0, m_valuesCount*sizeof(bool));
+    _changedFields.SetCount(m_valuesCount);
 
     _dynamicFields = new DynamicFields[_dynamicTabCount];
 
@@ -326,37 +325,90 @@ void Object::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* targe
     if (!target)
         return;
 
+    uint32* flags = NULL;
+    uint32 visibleFlag = GetUpdateFieldData(target, flags);
+
+    BuildValuesUpdateFields(updateType, data, visibleFlag, flags, target, NULL);
+}
+
+void Object::BuildValuesUpdateFields(uint8 updateType, ByteBuffer* data, uint32 visibleFlag, uint32 const* flags, Player* /*target*/, std::vector<ValuesUpdatePatch>* patches) const
+{
     ByteBuffer fieldBuffer;
     UpdateMask updateMask;
     updateMask.SetCount(m_valuesCount);
 
-    uint32* flags = NULL;
-    uint32 visibleFlag = GetUpdateFieldData(target, flags);
-
-    int sendedCount = 0;
+    UpdateFieldFlagMasks const& flagMasks = GetUpdateFieldFlagMasks(flags);
 
-    for (uint16 index = 0; index < m_valuesCount; ++index)
+    uint32 wordCount = _changedFields.GetWordCount();
+    for (uint32 word = NextValuesUpdateWord(updateType, 0, flagMasks, _fieldNotifyFlags, 0); word < wordCount;
+        word = NextValuesUpdateWord(updateType, word + 1, flagMasks, _fieldNotifyFlags, 0))
     {
-        if (_fieldNotifyFlags & flags[index] ||
-            ((updateType == UPDATETYPE_VALUES ? _changedFields[index] : m_uint32Values[index]) && (flags[index] & visibleFlag)))
+        uint64 sent = 0;
+        for (uint64 bits = GetValuesUpdateCandidates(updateType, word, flagMasks, _fieldNotifyFlags); bits; bits &= bits - 1)
         {
-            updateMask.SetBit(index);
-            fieldBuffer << m_uint32Values[index];
-
-            ++sendedCount;
+            uint32 bit = UpdateFieldLowestBit(bits);
+            uint16 index = uint16(word * 64 + bit);
+            if (_fieldNotifyFlags & flags[index] ||
+                ((updateType == UPDATETYPE_VALUES ? _changedFields.Test(index) : m_uint32Values[index]) && (flags[index] & visibleFlag)))
+            {
+                sent |= uint64(1) << bit;
+                fieldBuffer << m_uint32Values[index];
+            }
         }
+
+        if (sent)
+            updateMask.SetWord64(word, sent);
     }
 
-    for (uint16 index = 0; index < m_valuesCount; ++index)
+    AppendValuesUpdateFields(data, updateMask, fieldBuffer, patches);
+}
+
+uint64 Object::GetValuesUpdateCandidates(uint8 updateType, uint32 word, UpdateFieldFlagMasks const& flagMasks, uint32 alwaysFlags) const
+{
+    uint64 bits = ~uint64(0);
+    if (updateType == UPDATETYPE_VALUES)
+        bits = _changedFields.GetWord(word) | flagMasks.GetWord(word, alwaysFlags);
+
+    return bits & UpdateFieldWordMask(word, m_valuesCount);
+}
+
+uint32 Object::NextValuesUpdateWord(uint8 updateType, uint32 word, UpdateFieldFlagMasks const& flagMasks, uint32 alwaysFlags, uint64 forcedWords) const
+{
+    uint32 wordCount = _changedFields.GetWordCount();
+    if (updateType != UPDATETYPE_VALUES || word >= wordCount)
+        return std::min(word, wordCount);
+
+    uint32 next = std::min(_changedFields.NextWord(word), flagMasks.NextWord(word, alwaysFlags));
+
+    forcedWords &= word < 64 ? ~uint64(0) << word : 0;
+    if (forcedWords)
+        next = std::min(next, UpdateFieldLowestBit(forcedWords));
+
+    return next;
+}
+
+void Object::AppendValuesUpdateFieldForTarget(ByteBuffer& fieldBuffer, uint16 index, Player* target, std::vector<ValuesUpdatePatch>* patches) const
+{
+    if (target)
     {
-        if (updateMask.GetBit(index))
-            --sendedCount;
+        fieldBuffer << uint32(GetValuesUpdateFieldForTarget(index, target));
+        return;
     }
 
-    ASSERT(sendedCount == 0);
+    // offset inside fieldBuffer for now, made relative to the block by AppendValuesUpdateFields
+    patches->push_back(ValuesUpdatePatch(uint32(fieldBuffer.wpos()), index));
+    fieldBuffer << uint32(0);
+}
 
+void Object::AppendValuesUpdateFields(ByteBuffer* data, UpdateMask& updateMask, ByteBuffer const& fieldBuffer, std::vector<ValuesUpdatePatch>* patches)
+{
     *data << uint8(updateMask.GetBlockCount());
     updateMask.AppendToPacket(data);
+
+    if (patches)
+        for (std::vector<ValuesUpdatePatch>::iterator itr = patches->begin(); itr != patches->end(); ++itr)
+            itr->Offset += uint32(data->wpos());
+
     data->append(fieldBuffer);
 }
 
@@ -371,9 +423,9 @@ void Object::BuildDynamicValuesUpdate(ByteBuffer* data) const
     }
 
     uint32 dynamicTabMask = 0;                      // Mask for changed fields.
-    std::vector<uint32> dynamicFieldsMask;          // Mask for changed offsets.
+    uint32 dynamicFieldsMask[sizeof(uint32) * 8];   // Mask for changed offsets.
 
-    dynamicFieldsMask.resize(_dynamicTabCount);
+    ASSERT(_dynamicTabCount <= sizeof(uint32) * 8);
 
     for (uint32 i = 0; i < _dynamicTabCount; ++i) // For all fields.
     {
@@ -422,7 +474,7 @@ void Object::BuildDynamicValuesUpdate(ByteBuffer* data) const
 
 void Object::ClearUpdateMask(bool remove)
 {
-    memset(_changedFields, 0, m_valuesCount * sizeof(bool));
+    _changedFields.Clear();
     
     if (m_objectUpdated)
     {
@@ -437,7 +489,7 @@ void Object::ClearUpdateMask(bool remove)
     }
 }
 
-void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) const
+void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map, ValuesUpdateCache* cache) const
 {
     UpdateDataMapType::iterator iter = data_map.find(player);
 
@@ -448,7 +500,31 @@ void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) cons
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    if (!cache)
+    {
+        BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+        return;
+    }
+
+    uint32* flags = NULL;
+    uint32 visibleFlag = GetUpdateFieldData(player, flags);
+
+    ValuesUpdateCache::Entry* entry = cache->Find(visibleFlag);
+    if (!entry)
+    {
+        entry = &cache->Add(visibleFlag);
+        entry->Block << uint8(UPDATETYPE_VALUES);
+        entry->Block.append(GetPackGUID());
+
+        BuildValuesUpdateFields(UPDATETYPE_VALUES, &entry->Block, visibleFlag, flags, NULL, &entry->Patches);
+        BuildDynamicValuesUpdate(&entry->Block);
+    }
+
+    // every receiver of the class overwrites all the placeholders, the block can be patched in place
+    for (std::vector<ValuesUpdatePatch>::const_iterator itr = entry->Patches.begin(); itr != entry->Patches.end(); ++itr)
+        entry->Block.put<uint32>(itr->Offset, GetValuesUpdateFieldForTarget(itr->Index, player));
+
+    iter->second.AddUpdateBlock(entry->Block);
 }
 
 void Object::_LoadIntoDataField(char const* data, uint32 startOffset, uint32 count)
@@ -464,7 +540,7 @@ void Object::_LoadIntoDataField(char const* data, uint32 startOffset, uint32 cou
     for (uint32 index = 0; index < count; ++index)
     {
         m_uint32Values[startOffset + index] = atol(tokens[index]);
-        _changedFields[startOffset + index] = true;
+        _changedFields.Set(startOffset + index);
     }
 }
 
@@ -532,7 +608,7 @@ void Object::SetInt32Value(uint16 index, int32 value)
     if (m_int32Values[index] != value)
     {
         m_int32Values[index] = value;
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -549,7 +625,7 @@ void Object::SetUInt32Value(uint16 index, uint32 value)
     if (m_uint32Values[index] != value)
     {
         m_uint32Values[index] = value;
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -564,7 +640,7 @@ void Object::UpdateInt32Value(uint16 index, int32 value)
     ASSERT(index < m_valuesCount || PrintIndexError(index, true));
 
     m_uint32Values[index] = value;
-    _changedFields[index] = true;
+    _changedFields.Set(index);
 }
 
 void Object::UpdateUInt32Value(uint16 index, uint32 value)
@@ -572,7 +648,7 @@ void Object::UpdateUInt32Value(uint16 index, uint32 value)
     ASSERT(index < m_valuesCount || PrintIndexError(index, true));
 
     m_uint32Values[index] = value;
-    _changedFields[index] = true;
+    _changedFields.Set(index);
 }
 
 void Object::SetUInt64Value(uint16 index, uint64 value)
@@ -582,8 +658,8 @@ void Object::SetUInt64Value(uint16 index, uint64 value)
     {
         m_uint32Values[index] = PAIR64_LOPART(value);
         m_uint32Values[index + 1] = PAIR64_HIPART(value);
-        _changedFields[index] = true;
-        _changedFields[index + 1] = true;
+        _changedFields.Set(index);
+        _changedFields.Set(index + 1);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -600,8 +676,8 @@ bool Object::AddUInt64Value(uint16 index, uint64 value)
     {
         m_uint32Values[index] = PAIR64_LOPART(value);
         m_uint32Values[index + 1] = PAIR64_HIPART(value);
-        _changedFields[index] = true;
-        _changedFields[index + 1] = true;
+        _changedFields.Set(index);
+        _changedFields.Set(index + 1);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -622,8 +698,8 @@ bool Object::RemoveUInt64Value(uint16 index, uint64 value)
     {
         m_uint32Values[index] = 0;
         m_uint32Values[index + 1] = 0;
-        _changedFields[index] = true;
-        _changedFields[index + 1] = true;
+        _changedFields.Set(index);
+        _changedFields.Set(index + 1);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -644,7 +720,11 @@ void Object::SetFloatValue(uint16 index, float value)
     if (m_floatValues[index] != value)
     {
         m_floatValues[index] = value;
-        _changedFields[index] = true;
+        _changedFields.Set(index);
+
+        // the cell position index keeps the combat reach used by the distance checks
+        if (index == UNIT_FIELD_COMBAT_REACH && isType(TYPEMASK_UNIT))
+            static_cast<WorldObject*>(this)->UpdateCellIndex();
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -668,7 +748,7 @@ void Object::SetByteValue(uint16 index, uint8 offset, uint8 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFF) << (offset * 8));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 8));
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -692,7 +772,7 @@ void Object::SetUInt16Value(uint16 index, uint8 offset, uint16 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFFFF) << (offset * 16));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 16));
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -759,7 +839,7 @@ void Object::SetFlag(uint16 index, uint32 newFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -774,7 +854,7 @@ void Object::SetFixedFlag(uint16 index, uint32 newFlag)
     ASSERT(index < m_valuesCount || PrintIndexError(index, true));
 
     m_uint32Values[index] = newFlag;
-    _changedFields[index] = true;
+    _changedFields.Set(index);
 
     if (m_inWorld && !m_objectUpdated)
     {
@@ -794,7 +874,7 @@ void Object::RemoveFlag(uint16 index, uint32 oldFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -817,7 +897,7 @@ void Object::SetByteFlag(uint16 index, uint8 offset, uint8 newFlag)
     if (!(uint8(m_uint32Values[index] >> (offset * 8)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (offset * 8));
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -840,7 +920,7 @@ void Object::RemoveByteFlag(uint16 index, uint8 offset, uint8 oldFlag)
     if (uint8(m_uint32Values[index] >> (offset * 8)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (offset * 8));
-        _changedFields[index] = true;
+        _changedFields.Set(index);
 
         if (m_inWorld && !m_objectUpdated)
         {
@@ -1297,7 +1377,7 @@ void WorldObject::SendPlaySound(uint32 Sound, bool OnlySelf)
 
 void Object::ForceValuesUpdateAtIndex(uint32 i)
 {
-    _changedFields[i] = true;
+    _changedFields.Set(i);
     if (m_inWorld && !m_objectUpdated)
     {
         sObjectAccessor->AddUpdateObject(this);
@@ -2205,6 +2285,7 @@ void WorldObject::GetCreatureListWithEntryInGridAppend(std::list<Creature*>& cre
 void WorldObject::SetPhaseMask(uint32 newPhaseMask, bool update)
 {
     m_phaseMask = newPhaseMask;
+    UpdateCellIndex();
 
     if (update && IsInWorld())
         UpdateObjectVisibility();
@@ -2318,16 +2399,21 @@ void WorldObject::DestroyForNearbyPlayers()
 void WorldObject::UpdateObjectVisibility(bool /*forced*/)
 {
     //updates object's visibility for nearby players
+    if (!IsInWorld())
+        return;
+
     MoPCore::VisibleChangesNotifier notifier(*this);
     VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+    GetMap()->GetRelocationNotifyCounters().VisibilityVisits++;
 }
 
 struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
+    ValuesUpdateCache& i_cache;
     std::set<uint64> plr_list;
-    WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj) {}
+    WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d, ValuesUpdateCache& cache) : i_updateDatas(d), i_object(obj), i_cache(cache) {}
     void Visit(PlayerMapType &m)
     {
         Player* source = NULL;
@@ -2384,7 +2470,7 @@ struct WorldObjectChangeAccumulator
         // Only send update once to a player
         if (plr_list.find(player->GetGUID()) == plr_list.end() && player->HaveAtClient(&i_object))
         {
-            i_object.BuildFieldsUpdate(player, i_updateDatas);
+            i_object.BuildFieldsUpdate(player, i_updateDatas, &i_cache);
             plr_list.insert(player->GetGUID());
         }
     }
@@ -2397,11 +2483,13 @@ void WorldObject::BuildUpdate(UpdateDataMapType& data_map)
     CellCoord p = MoPCore::ComputeCellCoord(GetPositionX(), GetPositionY());
     Cell cell(p);
     cell.SetNoCreate();
-    WorldObjectChangeAccumulator notifier(*this, data_map);
+    ValuesUpdateCache& cache = sObjectAccessor->GetValuesUpdateCache();
+    WorldObjectChangeAccumulator notifier(*this, data_map, cache);
     TypeContainerVisitor<WorldObjectChangeAccumulator, WorldTypeMapContainer > player_notifier(notifier);
     Map& map = *GetMap();
     //we must build packets for all visible players
     cell.Visit(p, player_notifier, map, *this, GetVisibilityRange());
+    cache.Reset();
 
     ClearUpdateMask(false);
 }
@@ -21,8 +21,10 @@
 
 #include "Common.h"
 #include "UpdateFields.h"
+#include "UpdateFieldFlags.h"
 #include "UpdateData.h"
 #include "GridReference.h"
+#include "CellPositionIndex.h"
 #include "ObjectDefines.h"
 #include "ObjectMovement.h"
 #include "GridDefines.h"
@@ -380,7 +382,8 @@ class Object
         virtual bool hasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool hasInvolvedQuest(uint32 /* quest_id */) const { return false; }
         virtual void BuildUpdate(UpdateDataMapType&) {}
-        void BuildFieldsUpdate(Player*, UpdateDataMapType &) const;
+        // with a cache the values block is serialized once per visibility class, see ValuesUpdateCache
+        void BuildFieldsUpdate(Player*, UpdateDataMapType &, ValuesUpdateCache* cache = NULL) const;
 
         void SetFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags |= flag; }
         void RemoveFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags &= ~flag; }
@@ -417,12 +420,23 @@ class Object
         std::string _ConcatFields(uint16 startIndex, uint16 size) const;
         void _LoadIntoDataField(const char* data, uint32 startOffset, uint32 count);
 
-        uint32 GetUpdateFieldData(Player const* target, uint32*& flags) const;
+        virtual uint32 GetUpdateFieldData(Player const* target, uint32*& flags) const;
 
         bool IsUpdateFieldVisible(uint32 flags, bool isSelf, bool isOwner, bool isItemOwner, bool isPartyMember) const;
 
         void BuildMovementUpdate(ByteBuffer * data, uint16 flags) const;
-        virtual void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const;
+        void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const;
+        // writes the update mask and the fields visible to visibleFlag, without a target the fields
+        // depending on the receiver get a placeholder recorded in patches instead of their value
+        virtual void BuildValuesUpdateFields(uint8 updatetype, ByteBuffer* data, uint32 visibleFlag, uint32 const* flags, Player* target, std::vector<ValuesUpdatePatch>* patches) const;
+        virtual uint32 GetValuesUpdateFieldForTarget(uint16 index, Player* /*target*/) const { return m_uint32Values[index]; }
+        // fields of word a values update may contain: all of them for a create, otherwise the changed ones and the ones carrying alwaysFlags
+        uint64 GetValuesUpdateCandidates(uint8 updatetype, uint32 word, UpdateFieldFlagMasks const& flagMasks, uint32 alwaysFlags) const;
+        // first word at or after word with candidates, forcedWords (UpdateFieldWordOf) holds the fields a builder adds itself.
+        // The word count of the bitset when there is none
+        uint32 NextValuesUpdateWord(uint8 updatetype, uint32 word, UpdateFieldFlagMasks const& flagMasks, uint32 alwaysFlags, uint64 forcedWords) const;
+        void AppendValuesUpdateFieldForTarget(ByteBuffer& fieldBuffer, uint16 index, Player* target, std::vector<ValuesUpdatePatch>* patches) const;
+        static void AppendValuesUpdateFields(ByteBuffer* data, UpdateMask& updateMask, ByteBuffer const& fieldBuffer, std::vector<ValuesUpdatePatch>* patches);
         void BuildDynamicValuesUpdate(ByteBuffer* data) const;
 
         uint16 m_objectType;
@@ -437,7 +451,7 @@ class Object
             float  *m_floatValues;
         };
 
-        bool* _changedFields;
+        UpdateFieldBitset _changedFields;
 
         uint16 m_valuesCount;
 
@@ -481,7 +495,7 @@ class GridObject
     public:
         bool IsInGrid() const { return _gridRef.isValid(); }
         void AddToGrid(GridRefManager<T>& m) { ASSERT(!IsInGrid()); _gridRef.link(&m, (T*)this); }
-        void RemoveFromGrid() { ASSERT(IsInGrid()); _gridRef.unlink(); }
+        void RemoveFromGrid() { ASSERT(IsInGrid()); _gridRef.unlink(); static_cast<T*>(this)->RemoveFromCellIndex(); }
     private:
         GridReference<T> _gridRef;
 };
@@ -723,6 +737,18 @@ class WorldObject : public Object, public WorldLocation
         bool IsPermanentWorldObject() const { return m_isWorldObject; }
         bool IsWorldObject() const;
 
+        // position copy in the index of the grid cell holding the object, see CellPositionIndex
+        CellIndexEntry& GetCellIndexEntry() { return m_cellIndexEntry; }
+        void UpdateCellIndex() { if (m_cellIndexEntry.Index) m_cellIndexEntry.Index->Update(this, m_cellIndexEntry.Slot); }
+        void RemoveFromCellIndex() { if (m_cellIndexEntry.Index) m_cellIndexEntry.Index->Remove(m_cellIndexEntry); }
+
+        // hide the Position ones so every move of an object linked in a cell refreshes its index copy
+        void Relocate(float x, float y) { Position::Relocate(x, y); UpdateCellIndex(); }
+        void Relocate(float x, float y, float z) { Position::Relocate(x, y, z); UpdateCellIndex(); }
+        void Relocate(float x, float y, float z, float orientation) { Position::Relocate(x, y, z, orientation); UpdateCellIndex(); }
+        void Relocate(Position const& pos) { Position::Relocate(pos); UpdateCellIndex(); }
+        void Relocate(Position const* pos) { Position::Relocate(pos); UpdateCellIndex(); }
+
         template<class NOTIFIER> void VisitNearbyObject(const float &radius, NOTIFIER &notifier, bool loadGrids = false) const { if (IsInWorld()) GetMap()->VisitAll(GetPositionX(), GetPositionY(), radius, notifier, loadGrids); }
         template<class NOTIFIER> void VisitNearbyGridObject(const float &radius, NOTIFIER &notifier, bool loadGrids = false) const { if (IsInWorld()) GetMap()->VisitGrid(GetPositionX(), GetPositionY(), radius, notifier, loadGrids); }
         template<class NOTIFIER> void VisitNearbyWorldObject(const float &radius, NOTIFIER &notifier, bool loadGrids = false) const { if (IsInWorld()) GetMap()->VisitWorld(GetPositionX(), GetPositionY(), radius, notifier, loadGrids); }
@@ -790,6 +816,7 @@ class WorldObject : public Object, public WorldLocation
         //uint32 m_mapId;                                     // object at map with map_id
         uint32 m_InstanceId;                                // in map copy with instance id
         uint32 m_phaseMask;                                 // in area phase state
+        CellIndexEntry m_cellIndexEntry;
 
         std::list<uint64/* guid*/> _visibilityPlayerList;
 
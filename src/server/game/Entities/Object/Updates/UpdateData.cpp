@@ -29,8 +29,9 @@ UpdateData::UpdateData(uint16 map) : m_map(map), m_blockCount(0)
 {
 }
 
-void UpdateData::AddOutOfRangeGUID(std::set<uint64>& guids)
+void UpdateData::AddOutOfRangeGUID(FlatSet<uint64> const& guids)
 {
+    m_outOfRangeGUIDs.reserve(m_outOfRangeGUIDs.size() + guids.size());
     m_outOfRangeGUIDs.insert(guids.begin(), guids.end());
 }
 
@@ -61,7 +62,7 @@ bool UpdateData::BuildPacket(WorldPacket* packet)
         *packet << uint8(UPDATETYPE_OUT_OF_RANGE_OBJECTS);
         *packet << uint32(m_outOfRangeGUIDs.size());
 
-        for (std::set<uint64>::const_iterator i = m_outOfRangeGUIDs.begin(); i != m_outOfRangeGUIDs.end(); ++i)
+        for (FlatSet<uint64>::const_iterator i = m_outOfRangeGUIDs.begin(); i != m_outOfRangeGUIDs.end(); ++i)
             packet->appendPackGUID(*i);
     }
 
@@ -77,3 +78,29 @@ void UpdateData::Clear()
     m_map = 0;
 }
 
+ValuesUpdateCache::Entry* ValuesUpdateCache::Find(uint32 visibleFlag)
+{
+    for (size_t i = 0; i < _used; ++i)
+    {
+        if (_entries[i].VisibleFlag == visibleFlag)
+        {
+            ++_hits;
+            return &_entries[i];
+        }
+    }
+
+    ++_misses;
+    return NULL;
+}
+
+ValuesUpdateCache::Entry& ValuesUpdateCache::Add(uint32 visibleFlag)
+{
+    if (_used == _entries.size())
+        _entries.push_back(Entry());
+
+    Entry& entry = _entries[_used++];
+    entry.VisibleFlag = visibleFlag;
+    entry.Block.clear();
+    entry.Patches.clear();
+    return entry;
+}
@@ -20,6 +20,10 @@
 #define __UPDATEDATA_H
 
 #include "ByteBuffer.h"
+#include "FlatSet.h"
+#include <deque>
+#include <vector>
+
 class WorldPacket;
 
 enum OBJECT_UPDATE_TYPE
@@ -54,20 +58,66 @@ class UpdateData
     public:
         UpdateData(uint16 map);
 
-        void AddOutOfRangeGUID(std::set<uint64>& guids);
+        void AddOutOfRangeGUID(FlatSet<uint64> const& guids);
         void AddOutOfRangeGUID(uint64 guid);
         void AddUpdateBlock(const ByteBuffer &block);
         bool BuildPacket(WorldPacket* packet);
         bool HasData() const { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
         void Clear();
 
-        std::set<uint64> const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
+        FlatSet<uint64> const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
 
     protected:
         uint16 m_map;
         uint32 m_blockCount;
-        std::set<uint64> m_outOfRangeGUIDs;
+        FlatSet<uint64> m_outOfRangeGUIDs;
         ByteBuffer m_data;
 };
+
+// offset of a field whose value depends on the receiving player in a cached values update block
+struct ValuesUpdatePatch
+{
+    ValuesUpdatePatch(uint32 offset, uint16 index) : Offset(offset), Index(index) { }
+
+    uint32 Offset;
+    uint16 Index;
+};
+
+/*
+ * Values update blocks of one object, serialized once per visibility class while
+ * WorldObject::BuildUpdate hands the object's changes to every player around it.
+ * The class is the UF_FLAG_* mask a receiver may see (public, party member, owner,
+ * self...), the fields whose value also depends on the receiver (gm flags, tapping,
+ * per caster aura states) are recorded as patches and written for each receiver.
+ *
+ * Only valid between Reset calls, the object must not change in between.
+ */
+class ValuesUpdateCache
+{
+    public:
+        struct Entry
+        {
+            uint32 VisibleFlag;
+            ByteBuffer Block;
+            std::vector<ValuesUpdatePatch> Patches;
+        };
+
+        ValuesUpdateCache() : _used(0), _hits(0), _misses(0) { }
+
+        // forgets the entries, their buffers are kept for the next object
+        void Reset() { _used = 0; }
+
+        Entry* Find(uint32 visibleFlag);
+        Entry& Add(uint32 visibleFlag);
+
+        uint64 GetHits() const { return _hits; }
+        uint64 GetMisses() const { return _misses; }
+
+    private:
+        std::deque<Entry> _entries;
+        size_t _used;
+        uint64 _hits;
+        uint64 _misses;
+};
 #endif
 
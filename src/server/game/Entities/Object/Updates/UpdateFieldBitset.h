@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __UPDATEFIELDBITSET_H
+#define __UPDATEFIELDBITSET_H
+
+#include "Define.h"
+#include "Errors.h"
+#include <cstring>
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+// number of the lowest set bit, value must not be 0
+inline uint32 UpdateFieldLowestBit(uint64 value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+    _BitScanForward64(&bit, value);
+    return uint32(bit);
+#elif defined(_MSC_VER)
+    unsigned long bit;
+    if (_BitScanForward(&bit, uint32(value)))
+        return uint32(bit);
+    _BitScanForward(&bit, uint32(value >> 32));
+    return uint32(bit) + 32;
+#else
+    return uint32(__builtin_ctzll(value));
+#endif
+}
+
+// bits of word that are fields below count
+inline uint64 UpdateFieldWordMask(uint32 word, uint32 count)
+{
+    if ((word + 1) * 64 <= count)
+        return ~uint64(0);
+
+    if (word * 64 >= count)
+        return 0;
+
+    return (uint64(1) << (count & 63)) - 1;
+}
+
+// bit of index when it belongs to word
+inline uint64 UpdateFieldWordBit(uint32 word, uint32 index)
+{
+    return (index >> 6) == word ? uint64(1) << (index & 63) : 0;
+}
+
+// bit of the word holding index in a bitmap of words, for the first 64 words
+inline uint64 UpdateFieldWordOf(uint32 index)
+{
+    return uint64(1) << (index >> 6);
+}
+
+/*
+ * One bit per update field packed in 64 bit words, with a summary bitmap of the
+ * non zero words. Clearing only touches the words that were set, and the update
+ * builders walk the set bits of a word instead of testing every field.
+ */
+class UpdateFieldBitset
+{
+    public:
+        UpdateFieldBitset() : _words(NULL), _summary(NULL), _wordCount(0), _summaryCount(0) { }
+        ~UpdateFieldBitset()
+        {
+            delete[] _words;
+            delete[] _summary;
+        }
+
+        void SetCount(uint32 count)
+        {
+            delete[] _words;
+            delete[] _summary;
+
+            _wordCount = (count + 63) / 64;
+            _summaryCount = (_wordCount + 63) / 64;
+            _words = new uint64[_wordCount];
+            _summary = new uint64[_summaryCount];
+            memset(_words, 0, _wordCount * sizeof(uint64));
+            memset(_summary, 0, _summaryCount * sizeof(uint64));
+        }
+
+        void Set(uint32 index)
+        {
+            uint32 word = index >> 6;
+            _words[word] |= uint64(1) << (index & 63);
+            _summary[word >> 6] |= uint64(1) << (word & 63);
+        }
+
+        bool Test(uint32 index) const { return (_words[index >> 6] & (uint64(1) << (index & 63))) != 0; }
+
+        void Clear()
+        {
+            for (uint32 s = 0; s < _summaryCount; ++s)
+            {
+                for (uint64 bits = _summary[s]; bits; bits &= bits - 1)
+                    _words[s * 64 + UpdateFieldLowestBit(bits)] = 0;
+
+                _summary[s] = 0;
+            }
+        }
+
+        uint32 GetWordCount() const { return _wordCount; }
+        uint64 GetWord(uint32 word) const { return _words[word]; }
+
+        // first non zero word at or after word, GetWordCount() when there is none
+        uint32 NextWord(uint32 word) const
+        {
+            if (word >= _wordCount)
+                return _wordCount;
+
+            uint32 s = word >> 6;
+            uint64 bits = _summary[s] & (~uint64(0) << (word & 63));
+            while (!bits)
+            {
+                if (++s >= _summaryCount)
+                    return _wordCount;
+
+                bits = _summary[s];
+            }
+
+            return s * 64 + UpdateFieldLowestBit(bits);
+        }
+
+    private:
+        UpdateFieldBitset(UpdateFieldBitset const&);
+        UpdateFieldBitset& operator=(UpdateFieldBitset const&);
+
+        uint64* _words;
+        uint64* _summary;
+        uint32 _wordCount;
+        uint32 _summaryCount;
+};
+
+#endif
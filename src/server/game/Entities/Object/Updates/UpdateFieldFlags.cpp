@@ -2253,3 +2253,51 @@ uint32 AreaTriggerUpdateFieldFlags[AREATRIGGER_END] =
     UF_FLAG_PUBLIC,                                         // AREATRIGGER_SPELLVISUALID
     UF_FLAG_PUBLIC,                                         // AREATRIGGER_FIELD_EXPLICIT_SCALE
 };
+
+UpdateFieldFlagMasks::UpdateFieldFlagMasks(uint32 const* flags, uint32 count) : _wordCount((count + 63) / 64)
+{
+    ASSERT(_wordCount <= 64);
+
+    for (uint32 bit = 0; bit < FLAG_BITS; ++bit)
+    {
+        _words[bit].resize(_wordCount, 0);
+        _summary[bit] = 0;
+    }
+
+    for (uint32 index = 0; index < count; ++index)
+    {
+        for (uint32 bit = 0; bit < FLAG_BITS; ++bit)
+        {
+            if (flags[index] & (1 << bit))
+            {
+                _words[bit][index >> 6] |= uint64(1) << (index & 63);
+                _summary[bit] |= UpdateFieldWordOf(index);
+            }
+        }
+    }
+}
+
+// built during static initialization, after the tables of this file
+static UpdateFieldFlagMasks const ItemUpdateFieldFlagMasks(ItemUpdateFieldFlags, CONTAINER_END);
+static UpdateFieldFlagMasks const UnitUpdateFieldFlagMasks(UnitUpdateFieldFlags, PLAYER_END);
+static UpdateFieldFlagMasks const GameObjectUpdateFieldFlagMasks(GameObjectUpdateFieldFlags, GAMEOBJECT_END);
+static UpdateFieldFlagMasks const DynamicObjectUpdateFieldFlagMasks(DynamicObjectUpdateFieldFlags, DYNAMICOBJECT_END);
+static UpdateFieldFlagMasks const CorpseUpdateFieldFlagMasks(CorpseUpdateFieldFlags, CORPSE_END);
+static UpdateFieldFlagMasks const AreaTriggerUpdateFieldFlagMasks(AreaTriggerUpdateFieldFlags, AREATRIGGER_END);
+
+UpdateFieldFlagMasks const& GetUpdateFieldFlagMasks(uint32 const* flags)
+{
+    if (flags == UnitUpdateFieldFlags)
+        return UnitUpdateFieldFlagMasks;
+    if (flags == ItemUpdateFieldFlags)
+        return ItemUpdateFieldFlagMasks;
+    if (flags == GameObjectUpdateFieldFlags)
+        return GameObjectUpdateFieldFlagMasks;
+    if (flags == DynamicObjectUpdateFieldFlags)
+        return DynamicObjectUpdateFieldFlagMasks;
+    if (flags == CorpseUpdateFieldFlags)
+        return CorpseUpdateFieldFlagMasks;
+
+    ASSERT(flags == AreaTriggerUpdateFieldFlags);
+    return AreaTriggerUpdateFieldFlagMasks;
+}
@@ -20,6 +20,8 @@
 
 #include "UpdateFields.h"
 #include "Define.h"
+#include "UpdateFieldBitset.h"
+#include <vector>
 
 enum UpdatefieldFlags
 {
@@ -43,4 +45,48 @@ extern uint32 DynamicObjectUpdateFieldFlags[DYNAMICOBJECT_END];
 extern uint32 CorpseUpdateFieldFlags[CORPSE_END];
 extern uint32 AreaTriggerUpdateFieldFlags[AREATRIGGER_END];
 
+// fields of a flags table carrying each UF_FLAG_* bit, in the word layout of UpdateFieldBitset
+class UpdateFieldFlagMasks
+{
+    public:
+        enum { FLAG_BITS = 10 };
+
+        UpdateFieldFlagMasks(uint32 const* flags, uint32 count);
+
+        // fields in word carrying any of flagMask
+        uint64 GetWord(uint32 word, uint32 flagMask) const
+        {
+            if (word >= _wordCount)
+                return 0;
+
+            uint64 bits = 0;
+            for (flagMask &= (1 << FLAG_BITS) - 1; flagMask; flagMask &= flagMask - 1)
+                bits |= _words[UpdateFieldLowestBit(flagMask)][word];
+
+            return bits;
+        }
+
+        // first word at or after word with a field carrying any of flagMask, GetWordCount() of the bitset when there is none
+        uint32 NextWord(uint32 word, uint32 flagMask) const
+        {
+            if (word >= _wordCount)
+                return _wordCount;
+
+            uint64 words = 0;
+            for (flagMask &= (1 << FLAG_BITS) - 1; flagMask; flagMask &= flagMask - 1)
+                words |= _summary[UpdateFieldLowestBit(flagMask)];
+
+            words &= ~uint64(0) << word;
+            return words ? UpdateFieldLowestBit(words) : _wordCount;
+        }
+
+    private:
+        std::vector<uint64> _words[FLAG_BITS];
+        uint64 _summary[FLAG_BITS];                         // words with a field carrying the flag, tables have at most 64 words
+        uint32 _wordCount;
+};
+
+// masks of one of the tables above
+UpdateFieldFlagMasks const& GetUpdateFieldFlagMasks(uint32 const* flags);
+
 #endif // _UPDATEFIELDFLAGS_H
@@ -3982,7 +3982,7 @@ void Player::InitTalentForLevel()
 
 void Player::InitSpellForLevel()
 {
-    auto spellList = sSpellMgr->GetSpellClassList(getClass());
+    std::set<uint32> const& spellList = sSpellMgr->GetSpellClassList(getClass());
     uint8 level = getLevel();
     uint32 specializationId = GetSpecializationId(GetActiveSpec());
 
@@ -6047,7 +6047,7 @@ void Player::DeleteFromDB(uint64 playerguid, uint32 accountId, bool updateRealmC
             stmt->setUInt32(0, guid);
             trans->Append(stmt);
 
-            CharacterDatabase.CommitTransaction(trans);
+            CharacterDatabase.CommitTransaction(trans, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, accountId));
             break;
         }
         // The character gets unlinked from the account, the name gets freed up and appears as deleted ingame
@@ -6057,7 +6057,7 @@ void Player::DeleteFromDB(uint64 playerguid, uint32 accountId, bool updateRealmC
 
             stmt->setUInt32(0, guid);
 
-            CharacterDatabase.Execute(stmt);
+            CharacterDatabase.Execute(stmt, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, accountId));
             break;
         }
         default:
@@ -22205,8 +22205,8 @@ void Player::SaveToDB(bool create /*=false*/)
     if (m_session->isLogingOut() || !sWorld->getBoolConfig(CONFIG_STATS_SAVE_ONLY_ON_LOGOUT))
         _SaveStats(trans);
 
-    CharacterDatabase.CommitTransaction(trans);
-    LoginDatabase.CommitTransaction(accountTrans);
+    CharacterDatabase.CommitTransaction(trans, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetSession()->GetAccountId()));
+    LoginDatabase.CommitTransaction(accountTrans, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetSession()->GetAccountId()));
 
     // we save the data here to prevent spamming
     sAnticheatMgr->SavePlayerData(this);
@@ -25781,13 +25781,13 @@ bool Player::IsVisibleGloballyFor(Player* u) const
 }
 
 template<class T>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, T* target, std::set<Unit*>& /*v*/)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, T* target, std::set<Unit*>& /*v*/)
 {
     s64.insert(target->GetGUID());
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, GameObject* target, std::set<Unit*>& /*v*/)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, GameObject* target, std::set<Unit*>& /*v*/)
 {
     // Limited updates done in UpdateVisibilityOf for GAMEOBJECT_TYPE_TRANSPORT - SOTA, Deeprun tram, tram in Ulduar.
     if (target->GetGOInfo()->entry != 193182 && target->GetGOInfo()->entry != 193183 && target->GetGOInfo()->entry != 193184 && target->GetGOInfo()->entry != 193185 && target->GetGOInfo()->entry != 19080 && target->GetGOInfo()->entry != 194675)
@@ -25795,14 +25795,14 @@ inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, GameObject* target,
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, Creature* target, std::set<Unit*>& v)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, Creature* target, std::set<Unit*>& v)
 {
     s64.insert(target->GetGUID());
     v.insert(target);
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, Player* target, std::set<Unit*>& v)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, Player* target, std::set<Unit*>& v)
 {
     s64.insert(target->GetGUID());
     v.insert(target);
@@ -25967,6 +25967,9 @@ void Player::UpdateVisibilityForPlayer()
     MoPCore::VisibleNotifier notifier(*this);
     m_seer->VisitNearbyObject(GetSightRange(), notifier, true);
     notifier.SendToSelf();   // send gathered data
+
+    if (IsInWorld())
+        GetMap()->GetRelocationNotifyCounters().VisibilityVisits++;
 }
 
 void Player::InitPrimaryProfessions()
@@ -27,6 +27,7 @@
 #include "BattlePetMgr.h"
 #include "Bag.h"
 #include "Common.h"
+#include "FlatSet.h"
 #include "DatabaseEnv.h"
 #include "DBCEnums.h"
 #include "GroupReference.h"
@@ -2799,8 +2800,9 @@ class Player : public Unit, public GridObject<Player>
         }
 
         // currently visible objects at player client
-        typedef std::set<uint64> ClientGUIDs;
+        typedef FlatSet<uint64> ClientGUIDs;
         ClientGUIDs m_clientGUIDs;
+        std::vector<uint64> m_visibleGUIDsBuffer;           // reused by VisibleNotifier to collect objects found in range
 
         bool HaveAtClient(WorldObject const* u) const { return u == this || m_clientGUIDs.find(u->GetGUID()) != m_clientGUIDs.end(); }
 
@@ -288,7 +288,11 @@ Unit::Unit(bool isWorldObject): WorldObject(isWorldObject)
     _skipDiff = 0;
 
     m_IsInKillingProcess = false;
-    m_VisibilityUpdScheduled = false;
+    m_relocationNotifyFlags = RELOCATION_NOTIFY_NONE;
+    m_relocationQueueIndex = 0;
+    m_relocationBatchIndex = 0;
+    m_auraModifierCacheHits = 0;
+    m_auraModifierCacheMisses = 0;
 
 	m_SendTransportMoveTimer = 0;
 	m_lastVisibilityUpdPos = *this;
@@ -3992,6 +3996,8 @@ void Unit::_RegisterAuraEffect(AuraEffectPtr aurEff, bool apply)
         m_modAuras[aurEff->GetAuraType()].push_back(aurEff);
     else
         m_modAuras[aurEff->GetAuraType()].remove(aurEff);
+
+    InvalidateAuraModifierCache(aurEff->GetAuraType());
 }
 
 // All aura base removes should go threw this function!
@@ -5059,12 +5065,79 @@ uint32 Unit::GetDoTsByCaster(uint64 casterGUID) const
     return dots;
 }
 
+static uint64 MakeAuraModifierKey(AuraType auratype, AuraModifierQuery query, uint32 misc)
+{
+    return (uint64(auratype) << 40) | (uint64(query) << 32) | misc;
+}
+
+AuraModifierCacheEntry const* Unit::FindAuraModifier(AuraType auratype, AuraModifierQuery query, uint32 misc) const
+{
+    AuraModifierCacheEntry entry;
+    entry.Key = MakeAuraModifierKey(auratype, query, misc);
+
+    AuraModifierCache::const_iterator itr = std::lower_bound(m_auraModifierCache.begin(), m_auraModifierCache.end(), entry);
+    if (itr == m_auraModifierCache.end() || itr->Key != entry.Key)
+    {
+        ++m_auraModifierCacheMisses;
+        return NULL;
+    }
+
+    ++m_auraModifierCacheHits;
+    return &*itr;
+}
+
+void Unit::StoreAuraModifierEntry(AuraModifierCacheEntry const& entry) const
+{
+    // the keys in use are bounded by the aura types and misc values the combat code asks for,
+    // running full means something queries with unbounded misc values: start over
+    if (m_auraModifierCache.size() >= MAX_AURA_MODIFIER_CACHE_ENTRIES)
+        m_auraModifierCache.clear();
+
+    m_auraModifierCache.insert(std::lower_bound(m_auraModifierCache.begin(), m_auraModifierCache.end(), entry), entry);
+}
+
+void Unit::StoreAuraModifier(AuraType auratype, AuraModifierQuery query, uint32 misc, int32 modifier) const
+{
+    AuraModifierCacheEntry entry;
+    entry.Key = MakeAuraModifierKey(auratype, query, misc);
+    entry.Modifier = modifier;
+    StoreAuraModifierEntry(entry);
+}
+
+void Unit::StoreAuraMultiplier(AuraType auratype, AuraModifierQuery query, uint32 misc, float multiplier) const
+{
+    AuraModifierCacheEntry entry;
+    entry.Key = MakeAuraModifierKey(auratype, query, misc);
+    entry.Multiplier = multiplier;
+    StoreAuraModifierEntry(entry);
+}
+
+void Unit::InvalidateAuraModifierCache(AuraType auratype)
+{
+    if (m_auraModifierCache.empty())
+        return;
+
+    // all entries of one aura type are adjacent
+    AuraModifierCacheEntry first, last;
+    first.Key = MakeAuraModifierKey(auratype, AuraModifierQuery(0), 0);
+    last.Key = MakeAuraModifierKey(AuraType(auratype + 1), AuraModifierQuery(0), 0);
+
+    m_auraModifierCache.erase(std::lower_bound(m_auraModifierCache.begin(), m_auraModifierCache.end(), first),
+        std::lower_bound(m_auraModifierCache.begin(), m_auraModifierCache.end(), last));
+}
+
 int32 Unit::GetTotalAuraModifier(AuraType auratype) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_TOTAL, 0))
+        return cached->Modifier;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
          if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
              modifier += (*i)->GetAmount();
@@ -5072,39 +5145,60 @@ int32 Unit::GetTotalAuraModifier(AuraType auratype) const
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         modifier += itr->second;
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_TOTAL, 0, modifier);
     return modifier;
 }
 
 float Unit::GetTotalAuraMultiplier(AuraType auratype) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 1.0f;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MULTIPLIER, 0))
+        return cached->Multiplier;
+
     float multiplier = 1.0f;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
         AddPct(multiplier, (*i)->GetAmount());
 
+    StoreAuraMultiplier(auratype, AURA_MODIFIER_MULTIPLIER, 0, multiplier);
     return multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype)
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MAX_POSITIVE, 0))
+        return cached->Modifier;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if ((*i)->GetAmount() > modifier)
             modifier = (*i)->GetAmount();
     }
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_MAX_POSITIVE, 0, modifier);
     return modifier;
 }
 
 int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MAX_NEGATIVE, 0))
+        return cached->Modifier;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if ((*i)->GetAmount() < modifier)
@@ -5116,16 +5210,22 @@ int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
         }
     }
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_MAX_NEGATIVE, 0, modifier);
     return modifier;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_TOTAL_BY_MISC_MASK, misc_mask))
+        return cached->Modifier;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
          if ((*i)->GetMiscValue() & misc_mask)
              if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
@@ -5134,15 +5234,22 @@ int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask)
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         modifier += itr->second;
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_TOTAL_BY_MISC_MASK, misc_mask, modifier);
     return modifier;
 }
 
 float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 1.0f;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MULTIPLIER_BY_MISC_MASK, misc_mask))
+        return cached->Multiplier;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if (((*i)->GetMiscValue() & misc_mask))
@@ -5157,43 +5264,67 @@ float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         AddPct(multiplier, itr->second);
 
+    StoreAuraMultiplier(auratype, AURA_MODIFIER_MULTIPLIER_BY_MISC_MASK, misc_mask, multiplier);
     return multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask, constAuraEffectPtr except) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    // results excluding one effect are not shared with the plain query
+    if (!except)
+        if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MAX_POSITIVE_BY_MISC_MASK, misc_mask))
+            return cached->Modifier;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if (except != (*i) && (*i)->GetMiscValue()& misc_mask && (*i)->GetAmount() > modifier)
             modifier = (*i)->GetAmount();
     }
 
+    if (!except)
+        StoreAuraModifier(auratype, AURA_MODIFIER_MAX_POSITIVE_BY_MISC_MASK, misc_mask, modifier);
     return modifier;
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MAX_NEGATIVE_BY_MISC_MASK, misc_mask))
+        return cached->Modifier;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if ((*i)->GetMiscValue()& misc_mask && (*i)->GetAmount() < modifier)
             modifier = (*i)->GetAmount();
     }
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_MAX_NEGATIVE_BY_MISC_MASK, misc_mask, modifier);
     return modifier;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_TOTAL_BY_MISC_VALUE, uint32(misc_value)))
+        return cached->Modifier;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if ((*i)->GetMiscValue() == misc_value)
@@ -5204,15 +5335,22 @@ int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value)
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         modifier += itr->second;
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_TOTAL_BY_MISC_VALUE, uint32(misc_value), modifier);
     return modifier;
 }
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 1.0f;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MULTIPLIER_BY_MISC_VALUE, uint32(misc_value)))
+        return cached->Multiplier;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if ((*i)->GetMiscValue() == misc_value)
@@ -5223,34 +5361,49 @@ float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_valu
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         AddPct(multiplier, itr->second);
 
+    StoreAuraMultiplier(auratype, AURA_MODIFIER_MULTIPLIER_BY_MISC_VALUE, uint32(misc_value), multiplier);
     return multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MAX_POSITIVE_BY_MISC_VALUE, uint32(misc_value)))
+        return cached->Modifier;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if ((*i)->GetMiscValue() == misc_value && (*i)->GetAmount() > modifier)
             modifier = (*i)->GetAmount();
     }
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_MAX_POSITIVE_BY_MISC_VALUE, uint32(misc_value), modifier);
     return modifier;
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return 0;
+
+    if (AuraModifierCacheEntry const* cached = FindAuraModifier(auratype, AURA_MODIFIER_MAX_NEGATIVE_BY_MISC_VALUE, uint32(misc_value)))
+        return cached->Modifier;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
     {
         if ((*i)->GetMiscValue() == misc_value && (*i)->GetAmount() < modifier)
             modifier = (*i)->GetAmount();
     }
 
+    StoreAuraModifier(auratype, AURA_MODIFIER_MAX_NEGATIVE_BY_MISC_VALUE, uint32(misc_value), modifier);
     return modifier;
 }
 
@@ -16870,8 +17023,6 @@ int32 Unit::GetCreatePowers(Powers power) const
 
 SpellPowerEntry const* Unit::GetSpellPowerEntryBySpell(SpellInfo const* spell) const
 {
-    auto list = sSpellMgr->GetSpellPowerList(spell->Id);
-
     if (GetTypeId() == TYPEID_PLAYER)
     {
         if (getClass() == CLASS_MONK)
@@ -16932,6 +17083,8 @@ void Unit::RemoveFromWorld()
             }
         }
 
+        GetMap()->RemoveUnitFromRelocationQueue(this);
+
         WorldObject::RemoveFromWorld();
         m_duringRemoveFromWorld = false;
     }
@@ -20071,15 +20224,12 @@ void Unit::SetPhaseMask(uint32 newPhaseMask, bool update)
             // modify threat lists for new phasemask
             if (GetTypeId() != TYPEID_PLAYER)
             {
-                std::list<HostileReference*> threatList = getThreatManager().getThreatList();
-                std::list<HostileReference*> offlineThreatList = getThreatManager().getOfflineThreatList();
-
-                // merge expects sorted lists
-                threatList.sort();
-                offlineThreatList.sort();
-                threatList.merge(offlineThreatList);
+                // copy both lists, changing the online state moves references between them
+                ThreatContainer::StorageType threatList = getThreatManager().getThreatList();
+                ThreatContainer::StorageType const& offlineThreatList = getThreatManager().getOfflineThreatList();
+                threatList.insert(threatList.end(), offlineThreatList.begin(), offlineThreatList.end());
 
-                for (std::list<HostileReference*>::const_iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
+                for (ThreatContainer::StorageType::const_iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
                     if (Unit* unit = (*itr)->getTarget())
                         unit->getHostileRefManager().setOnlineOfflineState(ToCreature(), unit->InSamePhase(newPhaseMask));
             }
@@ -20101,75 +20251,57 @@ void Unit::SetPhaseMask(uint32 newPhaseMask, bool update)
                 summon->SetPhaseMask(newPhaseMask, true);
 }
 
-class Unit::AINotifyTask : public BasicEvent
+void Unit::ProcessRelocationAINotify()
 {
-    Unit& m_owner;
-public:
-    explicit AINotifyTask(Unit * me) : m_owner(*me) {
-        m_owner.m_VisibilityUpdScheduled = true;
-    }
-
-    ~AINotifyTask() {
-        m_owner.m_VisibilityUpdScheduled = false;
-    }
-
-    virtual bool Execute(uint64 , uint32)
-    {
-        MoPCore::AIRelocationNotifier notifier(m_owner);
-        m_owner.VisitNearbyObject(m_owner.GetVisibilityRange(), notifier);
-        return true;
-    }
-
-    static void ScheduleAINotify(Unit* me)
-    {
-        if (!me->m_VisibilityUpdScheduled)
-            me->m_Events.AddEvent(new AINotifyTask(me), me->m_Events.CalculateTime(World::Visibility_AINotifyDelay));
-    }
-};
+    MoPCore::AIRelocationNotifier notifier(*this);
+    VisitNearbyObject(GetVisibilityRange(), notifier);
+    GetMap()->GetRelocationNotifyCounters().AIVisits++;
+}
 
-class Unit::VisibilityUpdateTask : public BasicEvent
+void Unit::ProcessRelocationVisibility()
 {
-    Unit& m_owner;
-public:
-    explicit VisibilityUpdateTask(Unit * me) : m_owner(*me) {}
+    if (!m_sharedVision.empty())
+        for (SharedVisionList::const_iterator it = m_sharedVision.begin();it!= m_sharedVision.end();)
+        {
+            Player * tmp = *it;
+            ++it;
+            tmp->UpdateVisibilityForPlayer();
+        }
+    if (isType(TYPEMASK_PLAYER))
+        ((Player*)this)->UpdateVisibilityForPlayer();
+    WorldObject::UpdateObjectVisibility(true);
+}
 
-    virtual bool Execute(uint64 , uint32)
-    {
-        UpdateVisibility(&m_owner);
-        return true;
-    }
+void Unit::ScheduleRelocationNotify(uint8 notifyFlags)
+{
+    // out of world units get a full visibility update when added to a map
+    if (!IsInWorld())
+        return;
 
-    static void UpdateVisibility(Unit* me)
-     {
-        if (!me->m_sharedVision.empty())
-            for (SharedVisionList::const_iterator it = me->m_sharedVision.begin();it!= me->m_sharedVision.end();)
-            {
-                Player * tmp = *it;
-                ++it;
-                tmp->UpdateVisibilityForPlayer();
-            }
-        if (me->isType(TYPEMASK_PLAYER))
-            ((Player*)me)->UpdateVisibilityForPlayer();
-        me->WorldObject::UpdateObjectVisibility(true);
-    }
-};
+    GetMap()->AddUnitToRelocationQueue(this, notifyFlags);
+}
 
 void Unit::OnRelocated()
 {
-    if (!m_lastVisibilityUpdPos.IsInDist(this, World::Visibility_RelocationLowerLimit)) {
+    uint8 notifyFlags = RELOCATION_NOTIFY_AI;
+    if (!m_lastVisibilityUpdPos.IsInDist(this, World::Visibility_RelocationLowerLimit))
+    {
         m_lastVisibilityUpdPos = *this;
-        m_Events.AddEvent(new VisibilityUpdateTask(this), m_Events.CalculateTime(1));
+        notifyFlags |= RELOCATION_NOTIFY_VISIBILITY;
     }
-    AINotifyTask::ScheduleAINotify(this);
+
+    ScheduleRelocationNotify(notifyFlags);
 }
 
 void Unit::UpdateObjectVisibility(bool forced)
 {
     if (forced)
-        VisibilityUpdateTask::UpdateVisibility(this);
+    {
+        ProcessRelocationVisibility();
+        ScheduleRelocationNotify(RELOCATION_NOTIFY_AI);
+    }
     else
-        m_Events.AddEvent(new VisibilityUpdateTask(this), m_Events.CalculateTime(1));
-    AINotifyTask::ScheduleAINotify(this);
+        ScheduleRelocationNotify(RELOCATION_NOTIFY_VISIBILITY | RELOCATION_NOTIFY_AI);
 }
 
 float Unit::GetCombatRatingReduction(CombatRating cr) const
@@ -21381,8 +21513,8 @@ void Unit::SendThreatListUpdate()
 
         data.WriteBits(count, 21);
 
-        std::list<HostileReference*>& tlist = getThreatManager().getThreatList();
-        for (std::list<HostileReference*>::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
+        ThreatContainer::StorageType& tlist = getThreatManager().getThreatList();
+        for (ThreatContainer::StorageType::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
         {
             ObjectGuid unitGuid = (*itr)->getUnitGuid();
 
@@ -21396,7 +21528,7 @@ void Unit::SendThreatListUpdate()
 
         data.FlushBits();
 
-        for (std::list<HostileReference*>::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
+        for (ThreatContainer::StorageType::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
         {
             ObjectGuid unitGuid = (*itr)->getUnitGuid();
 
@@ -21443,8 +21575,8 @@ void Unit::SendChangeCurrentVictimOpcode(HostileReference* pHostileReference)
         data.WriteBit(thisGuid[2]);
         data.WriteBit(thisGuid[1]);
 
-        std::list<HostileReference*>& tlist = getThreatManager().getThreatList();
-        for (std::list<HostileReference*>::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
+        ThreatContainer::StorageType& tlist = getThreatManager().getThreatList();
+        for (ThreatContainer::StorageType::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
         {
             ObjectGuid iterGuid = (*itr)->getUnitGuid();
 
@@ -21462,7 +21594,7 @@ void Unit::SendChangeCurrentVictimOpcode(HostileReference* pHostileReference)
 
         data.WriteByteSeq(hostileGuid[7]);
 
-        for (std::list<HostileReference*>::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
+        for (ThreatContainer::StorageType::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
         {
             ObjectGuid iterGuid = (*itr)->getUnitGuid();
 
@@ -22172,59 +22304,60 @@ Unit* Unit::GetSimulacrumTarget()
         return NULL;
 }
 
-void Unit::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* target) const
+// fields whose value sent to a player depends on the player, see GetValuesUpdateFieldForTarget
+static bool IsUnitUpdateFieldForTarget(uint16 index)
 {
-    if (!target)
-        return;
+    switch (index)
+    {
+        case UNIT_NPC_FLAGS:
+        case UNIT_FIELD_AURASTATE:
+        case UNIT_FIELD_FLAGS:
+        case UNIT_FIELD_DISPLAYID:
+        case OBJECT_FIELD_DYNAMIC_FLAGS:
+        case UNIT_FIELD_BYTES_2:
+        case UNIT_FIELD_FACTIONTEMPLATE:
+            return true;
+        default:
+            return false;
+    }
+}
 
+void Unit::BuildValuesUpdateFields(uint8 updateType, ByteBuffer* data, uint32 visibleFlag, uint32 const* flags, Player* target, std::vector<ValuesUpdatePatch>* patches) const
+{
     ByteBuffer fieldBuffer;
 
     UpdateMask updateMask;
     updateMask.SetCount(m_valuesCount);
 
-    uint32* flags = UnitUpdateFieldFlags;
-    uint32 visibleFlag = UF_FLAG_PUBLIC | UF_FLAG_DYNAMIC;
-
-    if (target == this)
-        visibleFlag |= UF_FLAG_PRIVATE;
+    bool perCasterAuraState = HasFlag(UNIT_FIELD_AURASTATE, PER_CASTER_AURA_STATE_MASK);
 
-    Player* plr = GetCharmerOrOwnerPlayerOrPlayerItself();
-    if (GetOwnerGUID() == target->GetGUID())
-        visibleFlag |= UF_FLAG_OWNER;
+    UpdateFieldFlagMasks const& flagMasks = GetUpdateFieldFlagMasks(flags);
+    uint32 alwaysFlags = _fieldNotifyFlags | (visibleFlag & UF_FLAG_SPECIAL_INFO);
 
-    if (HasFlag(OBJECT_FIELD_DYNAMIC_FLAGS, UNIT_DYNFLAG_SPECIALINFO))
-        if (HasAuraTypeWithCaster(SPELL_AURA_EMPATHY, target->GetGUID()))
-            visibleFlag |= UF_FLAG_SPECIAL_INFO;
-
-    if (plr && plr->IsInSameRaidWith(target))
-        visibleFlag |= UF_FLAG_PARTY_MEMBER;
-
-    Creature const* creature = ToCreature();
-
-    for (uint16 index = 0; index < m_valuesCount; ++index)
+    uint64 forcedWords = perCasterAuraState ? UpdateFieldWordOf(UNIT_FIELD_AURASTATE) : 0;
+    uint32 wordCount = _changedFields.GetWordCount();
+    for (uint32 word = NextValuesUpdateWord(updateType, 0, flagMasks, alwaysFlags, forcedWords); word < wordCount;
+        word = NextValuesUpdateWord(updateType, word + 1, flagMasks, alwaysFlags, forcedWords))
     {
-        if (_fieldNotifyFlags & flags[index] ||
-            ((flags[index] & visibleFlag) & UF_FLAG_SPECIAL_INFO) ||
-            ((updateType == UPDATETYPE_VALUES ? _changedFields[index] : m_uint32Values[index]) && (flags[index] & visibleFlag)) ||
-            (index == UNIT_FIELD_AURASTATE && HasFlag(UNIT_FIELD_AURASTATE, PER_CASTER_AURA_STATE_MASK)))
-        {
-            updateMask.SetBit(index);
+        uint64 candidates = GetValuesUpdateCandidates(updateType, word, flagMasks, alwaysFlags);
+        if (perCasterAuraState)
+            candidates |= UpdateFieldWordBit(word, UNIT_FIELD_AURASTATE);
 
-            if (index == UNIT_NPC_FLAGS)
-            {
-                uint32 appendValue = m_uint32Values[UNIT_NPC_FLAGS];
+        uint64 sent = 0;
+        for (; candidates; candidates &= candidates - 1)
+        {
+            uint32 bit = UpdateFieldLowestBit(candidates);
+            uint16 index = uint16(word * 64 + bit);
+            if (!(_fieldNotifyFlags & flags[index] ||
+                ((flags[index] & visibleFlag) & UF_FLAG_SPECIAL_INFO) ||
+                ((updateType == UPDATETYPE_VALUES ? _changedFields.Test(index) : m_uint32Values[index]) && (flags[index] & visibleFlag)) ||
+                (index == UNIT_FIELD_AURASTATE && perCasterAuraState)))
+                continue;
 
-                if (creature)
-                    if (!target->canSeeSpellClickOn(creature))
-                        appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
+            sent |= uint64(1) << bit;
 
-                fieldBuffer << uint32(appendValue);
-            }
-            else if (index == UNIT_FIELD_AURASTATE)
-            {
-                // Check per caster aura states to not enable using a spell in client if specified aura is not by target
-                fieldBuffer << BuildAuraStateUpdateForTarget(target);
-            }
+            if (IsUnitUpdateFieldForTarget(index))
+                AppendValuesUpdateFieldForTarget(fieldBuffer, index, target, patches);
             // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
             else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
             {
@@ -22239,112 +22372,136 @@ void Unit::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* target)
             {
                 fieldBuffer << uint32(m_floatValues[index]);
             }
-            // Gamemasters should be always able to select units - remove not selectable flag
-            else if (index == UNIT_FIELD_FLAGS)
+            else
             {
-                uint32 appendValue = m_uint32Values[UNIT_FIELD_FLAGS];
-                if (target->isGameMaster())
-                    appendValue &= ~UNIT_FLAG_NOT_SELECTABLE;
-
-                fieldBuffer << uint32(appendValue);
+                // send in current format (float as float, uint32 as uint32)
+                fieldBuffer << m_uint32Values[index];
             }
-            // use modelid_a if not gm, _h if gm for CREATURE_FLAG_EXTRA_TRIGGER creatures
-            else if (index == UNIT_FIELD_DISPLAYID)
+        }
+
+        if (sent)
+            updateMask.SetWord64(word, sent);
+    }
+
+    AppendValuesUpdateFields(data, updateMask, fieldBuffer, patches);
+}
+
+uint32 Unit::GetValuesUpdateFieldForTarget(uint16 index, Player* target) const
+{
+    Creature const* creature = ToCreature();
+
+    switch (index)
+    {
+        case UNIT_NPC_FLAGS:
+        {
+            uint32 appendValue = m_uint32Values[UNIT_NPC_FLAGS];
+
+            if (creature)
+                if (!target->canSeeSpellClickOn(creature))
+                    appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
+
+            return appendValue;
+        }
+        // Check per caster aura states to not enable using a spell in client if specified aura is not by target
+        case UNIT_FIELD_AURASTATE:
+            return BuildAuraStateUpdateForTarget(target);
+        // Gamemasters should be always able to select units - remove not selectable flag
+        case UNIT_FIELD_FLAGS:
+        {
+            uint32 appendValue = m_uint32Values[UNIT_FIELD_FLAGS];
+            if (target->isGameMaster())
+                appendValue &= ~UNIT_FLAG_NOT_SELECTABLE;
+
+            return appendValue;
+        }
+        // use modelid_a if not gm, _h if gm for CREATURE_FLAG_EXTRA_TRIGGER creatures
+        case UNIT_FIELD_DISPLAYID:
+        {
+            uint32 displayId = m_uint32Values[UNIT_FIELD_DISPLAYID];
+            if (creature)
             {
-                uint32 displayId = m_uint32Values[UNIT_FIELD_DISPLAYID];
-                if (creature)
+                CreatureTemplate const* cinfo = creature->GetCreatureTemplate();
+
+                // this also applies for transform auras
+                if (SpellInfo const* transform = sSpellMgr->GetSpellInfo(getTransForm()))
+                    for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+                        if (transform->Effects[i].IsAura(SPELL_AURA_TRANSFORM))
+                            if (CreatureTemplate const* transformInfo = sObjectMgr->GetCreatureTemplate(transform->Effects[i].MiscValue))
+                            {
+                                cinfo = transformInfo;
+                                break;
+                            }
+
+                if (cinfo->flags_extra & CREATURE_FLAG_EXTRA_TRIGGER)
                 {
-                    CreatureTemplate const* cinfo = creature->GetCreatureTemplate();
-
-                    // this also applies for transform auras
-                    if (SpellInfo const* transform = sSpellMgr->GetSpellInfo(getTransForm()))
-                        for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
-                            if (transform->Effects[i].IsAura(SPELL_AURA_TRANSFORM))
-                                if (CreatureTemplate const* transformInfo = sObjectMgr->GetCreatureTemplate(transform->Effects[i].MiscValue))
-                                {
-                                    cinfo = transformInfo;
-                                    break;
-                                }
-
-                    if (cinfo->flags_extra & CREATURE_FLAG_EXTRA_TRIGGER)
+                    if (target->isGameMaster())
                     {
-                        if (target->isGameMaster())
-                        {
-                            if (cinfo->Modelid1)
-                                displayId = cinfo->Modelid1; // Modelid1 is a visible model for gms
-                            else
-                                displayId = 17519; // world visible trigger's model
-                        }
+                        if (cinfo->Modelid1)
+                            displayId = cinfo->Modelid1; // Modelid1 is a visible model for gms
                         else
-                        {
-                            if (cinfo->Modelid2)
-                                displayId = cinfo->Modelid2; // Modelid2 is an invisible model for players
-                            else
-                                displayId = 11686; // world invisible trigger's model
-                        }
+                            displayId = 17519; // world visible trigger's model
+                    }
+                    else
+                    {
+                        if (cinfo->Modelid2)
+                            displayId = cinfo->Modelid2; // Modelid2 is an invisible model for players
+                        else
+                            displayId = 11686; // world invisible trigger's model
                     }
                 }
-
-                fieldBuffer << uint32(displayId);
             }
-            // hide lootable animation for unallowed players
-            else if (index == OBJECT_FIELD_DYNAMIC_FLAGS)
-            {
-                uint32 dynamicFlags = m_uint32Values[OBJECT_FIELD_DYNAMIC_FLAGS] & ~(UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
 
-                if (creature)
-                {
-                    if (creature->hasLootRecipient())
-                    {
-                        dynamicFlags |= UNIT_DYNFLAG_TAPPED;
-                        if (creature->isTappedBy(target))
-                            dynamicFlags |= UNIT_DYNFLAG_TAPPED_BY_PLAYER;
-                    }
+            return displayId;
+        }
+        // hide lootable animation for unallowed players
+        case OBJECT_FIELD_DYNAMIC_FLAGS:
+        {
+            uint32 dynamicFlags = m_uint32Values[OBJECT_FIELD_DYNAMIC_FLAGS] & ~(UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
 
-                    if (!target->isAllowedToLoot(creature))
-                        dynamicFlags &= ~UNIT_DYNFLAG_LOOTABLE;
+            if (creature)
+            {
+                if (creature->hasLootRecipient())
+                {
+                    dynamicFlags |= UNIT_DYNFLAG_TAPPED;
+                    if (creature->isTappedBy(target))
+                        dynamicFlags |= UNIT_DYNFLAG_TAPPED_BY_PLAYER;
                 }
 
-                // unit UNIT_DYNFLAG_TRACK_UNIT should only be sent to caster of SPELL_AURA_MOD_STALKED auras
-                if (dynamicFlags & UNIT_DYNFLAG_TRACK_UNIT)
-                    if (!HasAuraTypeWithCaster(SPELL_AURA_MOD_STALKED, target->GetGUID()))
-                        dynamicFlags &= ~UNIT_DYNFLAG_TRACK_UNIT;
-
-                fieldBuffer << dynamicFlags;
+                if (!target->isAllowedToLoot(creature))
+                    dynamicFlags &= ~UNIT_DYNFLAG_LOOTABLE;
             }
-            // FG: pretend that OTHER players in own group are friendly ("blue")
-            else if (index == UNIT_FIELD_BYTES_2 || index == UNIT_FIELD_FACTIONTEMPLATE)
+
+            // unit UNIT_DYNFLAG_TRACK_UNIT should only be sent to caster of SPELL_AURA_MOD_STALKED auras
+            if (dynamicFlags & UNIT_DYNFLAG_TRACK_UNIT)
+                if (!HasAuraTypeWithCaster(SPELL_AURA_MOD_STALKED, target->GetGUID()))
+                    dynamicFlags &= ~UNIT_DYNFLAG_TRACK_UNIT;
+
+            return dynamicFlags;
+        }
+        // FG: pretend that OTHER players in own group are friendly ("blue")
+        case UNIT_FIELD_BYTES_2:
+        case UNIT_FIELD_FACTIONTEMPLATE:
+        {
+            if (IsControlledByPlayer() && target != this && sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_GROUP) && IsInRaidWith(target))
             {
-                if (IsControlledByPlayer() && target != this && sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_GROUP) && IsInRaidWith(target))
+                FactionTemplateEntry const* ft1 = getFactionTemplateEntry();
+                FactionTemplateEntry const* ft2 = target->getFactionTemplateEntry();
+                if (ft1 && ft2 && !ft1->IsFriendlyTo(*ft2))
                 {
-                    FactionTemplateEntry const* ft1 = getFactionTemplateEntry();
-                    FactionTemplateEntry const* ft2 = target->getFactionTemplateEntry();
-                    if (ft1 && ft2 && !ft1->IsFriendlyTo(*ft2))
-                    {
-                        if (index == UNIT_FIELD_BYTES_2)
-                            // Allow targetting opposite faction in party when enabled in config
-                            fieldBuffer << (m_uint32Values[UNIT_FIELD_BYTES_2] & ((UNIT_BYTE2_FLAG_SANCTUARY /*| UNIT_BYTE2_FLAG_AURAS | UNIT_BYTE2_FLAG_UNK5*/) << 8)); // this flag is at uint8 offset 1 !!
-                        else
-                            // pretend that all other HOSTILE players have own faction, to allow follow, heal, rezz (trade wont work)
-                            fieldBuffer << uint32(target->getFaction());
-                    }
+                    if (index == UNIT_FIELD_BYTES_2)
+                        // Allow targetting opposite faction in party when enabled in config
+                        return m_uint32Values[UNIT_FIELD_BYTES_2] & ((UNIT_BYTE2_FLAG_SANCTUARY /*| UNIT_BYTE2_FLAG_AURAS | UNIT_BYTE2_FLAG_UNK5*/) << 8); // this flag is at uint8 offset 1 !!
                     else
-                        fieldBuffer << m_uint32Values[index];
+                        // pretend that all other HOSTILE players have own faction, to allow follow, heal, rezz (trade wont work)
+                        return target->getFaction();
                 }
-                else
-                    fieldBuffer << m_uint32Values[index];
-            }
-            else
-            {
-                // send in current format (float as float, uint32 as uint32)
-                fieldBuffer << m_uint32Values[index];
             }
+
+            return m_uint32Values[index];
         }
+        default:
+            return m_uint32Values[index];
     }
-
-    *data << uint8(updateMask.GetBlockCount());
-    updateMask.AppendToPacket(data);
-    data->append(fieldBuffer);
 }
 
 void Unit::SendEclipse()
@@ -269,6 +269,14 @@ enum UnitRename
     UNIT_CAN_BE_ABANDONED   = 0x02,
 };
 
+// notifies queued in the map relocation queue, processed in batches by Map::ProcessRelocationNotifies
+enum RelocationNotifyFlags
+{
+    RELOCATION_NOTIFY_NONE          = 0x00,
+    RELOCATION_NOTIFY_VISIBILITY    = 0x01,                 // visibility of and for the unit
+    RELOCATION_NOTIFY_AI            = 0x02,                 // MoveInLineOfSight of nearby creatures
+};
+
 #define CREATURE_MAX_SPELLS     8
 #define MAX_SPELL_CHARM         4
 #define MAX_SPELL_VEHICLE       6
@@ -1206,6 +1214,37 @@ enum Stagger
 #define ATTACK_DISPLAY_DELAY 200
 #define MAX_PLAYER_STEALTH_DETECT_RANGE 30.0f               // max distance for detection targets by player
 
+// Aggregates of GetAuraEffectsByType() memoized by Unit, see Unit::InvalidateAuraModifierCache
+enum AuraModifierQuery
+{
+    AURA_MODIFIER_TOTAL = 0,
+    AURA_MODIFIER_MULTIPLIER,
+    AURA_MODIFIER_MAX_POSITIVE,
+    AURA_MODIFIER_MAX_NEGATIVE,
+    AURA_MODIFIER_TOTAL_BY_MISC_MASK,
+    AURA_MODIFIER_MULTIPLIER_BY_MISC_MASK,
+    AURA_MODIFIER_MAX_POSITIVE_BY_MISC_MASK,
+    AURA_MODIFIER_MAX_NEGATIVE_BY_MISC_MASK,
+    AURA_MODIFIER_TOTAL_BY_MISC_VALUE,
+    AURA_MODIFIER_MULTIPLIER_BY_MISC_VALUE,
+    AURA_MODIFIER_MAX_POSITIVE_BY_MISC_VALUE,
+    AURA_MODIFIER_MAX_NEGATIVE_BY_MISC_VALUE
+};
+
+#define MAX_AURA_MODIFIER_CACHE_ENTRIES 64                  // the whole cache is dropped when full
+
+struct AuraModifierCacheEntry
+{
+    uint64 Key;                                             // aura type << 40 | query << 32 | misc mask / value
+    union
+    {
+        int32 Modifier;
+        float Multiplier;
+    };
+
+    bool operator<(AuraModifierCacheEntry const& right) const { return Key < right.Key; }
+};
+
 struct SpellProcEventEntry;                                 // used only privately
 
 class Unit : public WorldObject
@@ -1907,6 +1946,12 @@ class Unit : public WorldObject
         int32 GetMaxPositiveAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
         int32 GetMaxNegativeAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
 
+        // must be called whenever an effect of this type is registered, unregistered or changes amount
+        void InvalidateAuraModifierCache(AuraType auratype);
+        uint32 GetAuraModifierCacheSize() const { return uint32(m_auraModifierCache.size()); }
+        uint32 GetAuraModifierCacheHits() const { return m_auraModifierCacheHits; }
+        uint32 GetAuraModifierCacheMisses() const { return m_auraModifierCacheMisses; }
+
         float GetResistanceBuffMods(SpellSchools school, bool positive) const { return GetFloatValue(positive ? UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE+school : UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE+school); }
         void SetResistanceBuffMods(SpellSchools school, bool positive, float val) { SetFloatValue(positive ? UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE+school : UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE+school, val); }
         void ApplyResistanceBuffModsMod(SpellSchools school, bool positive, float val, bool apply) { ApplyModSignedFloatValue(positive ? UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE+school : UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE+school, val, apply); }
@@ -2021,6 +2066,17 @@ class Unit : public WorldObject
         void SetPhaseMask(uint32 newPhaseMask, bool update);// overwrite WorldObject::SetPhaseMask
         void UpdateObjectVisibility(bool forced = true);
 
+        // relocation notifies, queued by OnRelocated / UpdateObjectVisibility(false) and run by the map
+        uint8 GetRelocationNotifyFlags() const { return m_relocationNotifyFlags; }
+        void SetRelocationNotifyFlags(uint8 flags) { m_relocationNotifyFlags = flags; }
+        // last position in the map relocation queue / batch, only valid if the entry there is still this unit
+        uint32 GetRelocationQueueIndex() const { return m_relocationQueueIndex; }
+        void SetRelocationQueueIndex(uint32 index) { m_relocationQueueIndex = index; }
+        uint32 GetRelocationBatchIndex() const { return m_relocationBatchIndex; }
+        void SetRelocationBatchIndex(uint32 index) { m_relocationBatchIndex = index; }
+        void ProcessRelocationVisibility();
+        void ProcessRelocationAINotify();
+
         SpellImmuneList m_spellImmune[MAX_SPELL_IMMUNITY];
         uint32 m_lastSanctuaryTime;
 
@@ -2340,7 +2396,8 @@ class Unit : public WorldObject
     protected:
         explicit Unit (bool isWorldObject);
         
-        void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const;
+        void BuildValuesUpdateFields(uint8 updatetype, ByteBuffer* data, uint32 visibleFlag, uint32 const* flags, Player* target, std::vector<ValuesUpdatePatch>* patches) const;
+        uint32 GetValuesUpdateFieldForTarget(uint16 index, Player* target) const;
 
         UnitAI* i_AI, *i_disabledAI;
 
@@ -2382,6 +2439,16 @@ class Unit : public WorldObject
         uint32 m_removedAurasCount;
 
         AuraEffectList m_modAuras[TOTAL_AURAS];
+
+        typedef std::vector<AuraModifierCacheEntry> AuraModifierCache;
+        AuraModifierCacheEntry const* FindAuraModifier(AuraType auratype, AuraModifierQuery query, uint32 misc) const;
+        void StoreAuraModifier(AuraType auratype, AuraModifierQuery query, uint32 misc, int32 modifier) const;
+        void StoreAuraMultiplier(AuraType auratype, AuraModifierQuery query, uint32 misc, float multiplier) const;
+        void StoreAuraModifierEntry(AuraModifierCacheEntry const& entry) const;
+
+        mutable AuraModifierCache m_auraModifierCache;      // sorted by Key
+        mutable uint32 m_auraModifierCacheHits;
+        mutable uint32 m_auraModifierCacheMisses;
         AuraList m_scAuras;                        // casted singlecast auras
         AuraApplicationList m_interruptableAuras;             // auras which have interrupt mask applied on unit
         AuraStateAurasMap m_auraStateAuras;        // Used for improve performance of aura state checks on aura apply/remove
@@ -2468,10 +2535,12 @@ class Unit : public WorldObject
         void SetRooted(bool apply);
 
     private:
-        class AINotifyTask;
-        class VisibilityUpdateTask;
+        void ScheduleRelocationNotify(uint8 notifyFlags);
+
         Position m_lastVisibilityUpdPos;
-        bool m_VisibilityUpdScheduled;
+        uint8 m_relocationNotifyFlags;
+        uint32 m_relocationQueueIndex;
+        uint32 m_relocationBatchIndex;
         uint32 m_rootTimes;
 
         uint32 m_state;                                     // Even derived shouldn't modify
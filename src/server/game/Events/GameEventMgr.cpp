@@ -1173,16 +1173,10 @@ void GameEventMgr::GameEventSpawn(int16 event_id)
         {
             sObjectMgr->AddCreatureToGrid(*itr, data);
 
-            // Spawn if necessary (loaded grids only)
-            Map* map = sMapMgr->CreateBaseMap(data->mapid);
-            // We use spawn coords to spawn
-            if (!map->Instanceable() && map->IsGridLoaded(data->posX, data->posY))
-            {
-                Creature* creature = new Creature;
-                //sLog->outDebug(LOG_FILTER_GENERAL, "Spawning creature %u", *itr);
-                if (!creature->LoadCreatureFromDB(*itr, map))
-                    delete creature;
-            }
+            // Spawn if necessary (loaded grids only), done by the map update. A map not created yet
+            // has no loaded grid, it loads the creature with its grid
+            if (Map* map = sMapMgr->FindBaseNonInstanceMap(data->mapid))
+                map->QueueEventSpawn(TYPEID_UNIT, *itr, true);
         }
     }
 
@@ -1199,23 +1193,10 @@ void GameEventMgr::GameEventSpawn(int16 event_id)
         if (GameObjectData const* data = sObjectMgr->GetGOData(*itr))
         {
             sObjectMgr->AddGameobjectToGrid(*itr, data);
-            // Spawn if necessary (loaded grids only)
-            // this base map checked as non-instanced and then only existed
-            Map* map = sMapMgr->CreateBaseMap(data->mapid);
-            // We use current coords to unspawn, not spawn coords since creature can have changed grid
-            if (!map->Instanceable() && map->IsGridLoaded(data->posX, data->posY))
-            {
-                GameObject* pGameobject = new GameObject;
-                //sLog->outDebug(LOG_FILTER_GENERAL, "Spawning gameobject %u", *itr);
-                //TODO: find out when it is add to map
-                if (!pGameobject->LoadGameObjectFromDB(*itr, map, false))
-                    delete pGameobject;
-                else
-                {
-                    if (pGameobject->isSpawnedByDefault())
-                        map->AddToMap(pGameobject);
-                }
-            }
+
+            // Spawn if necessary (loaded grids only), done by the map update
+            if (Map* map = sMapMgr->FindBaseNonInstanceMap(data->mapid))
+                map->QueueEventSpawn(TYPEID_GAMEOBJECT, *itr, true);
         }
     }
 
@@ -1251,7 +1232,10 @@ void GameEventMgr::GameEventUnspawn(int16 event_id)
         {
             sObjectMgr->RemoveCreatureFromGrid(*itr, data);
 
-            if (Creature* creature = ObjectAccessor::GetObjectInWorld(MAKE_NEW_GUID(*itr, data->id, HIGHGUID_UNIT), (Creature*)NULL))
+            // queued after a spawn that may still be pending on the same map
+            if (Map* map = sMapMgr->FindBaseNonInstanceMap(data->mapid))
+                map->QueueEventSpawn(TYPEID_UNIT, *itr, false);
+            else if (Creature* creature = ObjectAccessor::GetObjectInWorld(MAKE_NEW_GUID(*itr, data->id, HIGHGUID_UNIT), (Creature*)NULL))
                 creature->AddObjectToRemoveList();
         }
     }
@@ -1273,7 +1257,9 @@ void GameEventMgr::GameEventUnspawn(int16 event_id)
         {
             sObjectMgr->RemoveGameobjectFromGrid(*itr, data);
 
-            if (GameObject* pGameobject = ObjectAccessor::GetObjectInWorld(MAKE_NEW_GUID(*itr, data->id, HIGHGUID_GAMEOBJECT), (GameObject*)NULL))
+            if (Map* map = sMapMgr->FindBaseNonInstanceMap(data->mapid))
+                map->QueueEventSpawn(TYPEID_GAMEOBJECT, *itr, false);
+            else if (GameObject* pGameobject = ObjectAccessor::GetObjectInWorld(MAKE_NEW_GUID(*itr, data->id, HIGHGUID_GAMEOBJECT), (GameObject*)NULL))
                 pGameobject->AddObjectToRemoveList();
         }
     }
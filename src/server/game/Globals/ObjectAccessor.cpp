@@ -114,27 +114,33 @@ Corpse* ObjectAccessor::GetCorpse(WorldObject const& u, uint64 guid)
 
 GameObject* ObjectAccessor::GetGameObject(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (GameObject*)NULL);
+    return u.GetMap()->GetGameObject(guid);
 }
 
 DynamicObject* ObjectAccessor::GetDynamicObject(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (DynamicObject*)NULL);
+    return u.GetMap()->GetDynamicObject(guid);
 }
 
 AreaTrigger* ObjectAccessor::GetAreaTrigger(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (AreaTrigger*)NULL);
+    return u.GetMap()->GetAreaTrigger(guid);
 }
 
 Unit* ObjectAccessor::GetUnit(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (Unit*)NULL);
+    if (IS_PLAYER_GUID(guid))
+        return GetPlayer(u, guid);
+
+    if (IS_PET_GUID(guid))
+        return GetPet(u, guid);
+
+    return GetCreature(u, guid);
 }
 
 Creature* ObjectAccessor::GetCreature(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (Creature*)NULL);
+    return u.GetMap()->GetCreature(guid);
 }
 
 Pet* ObjectAccessor::GetPet(WorldObject const& u, uint64 guid)
@@ -177,7 +177,8 @@ class ObjectAccessor
                 return NULL;
         }
 
-        // these functions return objects only if in map of specified object
+        // these functions return objects only if in map of specified object, creatures, gameobjects,
+        // dynamic objects and areatriggers are found in the object index of the map without locking
         static WorldObject* GetWorldObject(WorldObject const&, uint64);
         static Object* GetObjectByTypeMask(WorldObject const&, uint64, uint32 typemask);
         static Corpse* GetCorpse(WorldObject const& u, uint64 guid);
@@ -252,6 +253,9 @@ class ObjectAccessor
 
         //Thread unsafe
         void Update(uint32 diff);
+
+        // values update blocks of the object WorldObject::BuildUpdate is working on, world thread only
+        ValuesUpdateCache& GetValuesUpdateCache() { return i_valuesUpdateCache; }
         void RemoveOldCorpses();
         void UnloadAll();
 
@@ -264,6 +268,7 @@ class ObjectAccessor
         typedef UNORDERED_MAP<Player*, UpdateData>::value_type UpdateDataValueType;
 
         std::set<Object*> i_objects;
+        ValuesUpdateCache i_valuesUpdateCache;
         Player2CorpsesMapType i_player2corpse;
 
         ACE_Thread_Mutex i_objectLock;
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CellPositionIndex.h"
+#include "GridDefines.h"
+#include "Object.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define CELL_INDEX_SSE2
+#endif
+
+namespace
+{
+    uint8 GetGridMapTypeMask(WorldObject const* obj)
+    {
+        switch (obj->GetTypeId())
+        {
+            case TYPEID_UNIT:
+                return GRID_MAP_TYPE_MASK_CREATURE;
+            case TYPEID_PLAYER:
+                return GRID_MAP_TYPE_MASK_PLAYER;
+            case TYPEID_GAMEOBJECT:
+                return GRID_MAP_TYPE_MASK_GAMEOBJECT;
+            case TYPEID_DYNAMICOBJECT:
+                return GRID_MAP_TYPE_MASK_DYNAMICOBJECT;
+            case TYPEID_CORPSE:
+                return GRID_MAP_TYPE_MASK_CORPSE;
+            case TYPEID_AREATRIGGER:
+                return GRID_MAP_TYPE_MASK_AREATRIGGER;
+            default:
+                return 0;
+        }
+    }
+}
+
+CellPositionIndex::~CellPositionIndex()
+{
+    // objects still linked at this point outlive their cell, make them forget it
+    for (size_t i = 0; i < _objects.size(); ++i)
+        _objects[i]->GetCellIndexEntry().Index = NULL;
+}
+
+void CellPositionIndex::Insert(WorldObject* obj, uint8 container)
+{
+    CellIndexEntry& entry = obj->GetCellIndexEntry();
+    ASSERT(!entry.Index);
+
+    entry.Index = this;
+    entry.Slot = uint32(_objects.size());
+
+    _x.push_back(obj->GetPositionX());
+    _y.push_back(obj->GetPositionY());
+    _size.push_back(obj->GetObjectSize());
+    _phaseMask.push_back(obj->GetPhaseMask());
+    _mask.push_back(GetGridMapTypeMask(obj) | container);
+    _objects.push_back(obj);
+}
+
+void CellPositionIndex::Remove(CellIndexEntry& entry)
+{
+    ASSERT(entry.Index == this && entry.Slot < _objects.size());
+
+    // swap with the last slot, the order of the objects in a cell does not matter
+    uint32 slot = entry.Slot;
+    uint32 last = uint32(_objects.size() - 1);
+    if (slot != last)
+    {
+        _x[slot] = _x[last];
+        _y[slot] = _y[last];
+        _size[slot] = _size[last];
+        _phaseMask[slot] = _phaseMask[last];
+        _mask[slot] = _mask[last];
+        _objects[slot] = _objects[last];
+        _objects[slot]->GetCellIndexEntry().Slot = slot;
+    }
+
+    _x.pop_back();
+    _y.pop_back();
+    _size.pop_back();
+    _phaseMask.pop_back();
+    _mask.pop_back();
+    _objects.pop_back();
+
+    entry.Index = NULL;
+    entry.Slot = 0;
+}
+
+void CellPositionIndex::Update(WorldObject const* obj, uint32 slot)
+{
+    ASSERT(slot < _objects.size() && _objects[slot] == obj);
+
+    _x[slot] = obj->GetPositionX();
+    _y[slot] = obj->GetPositionY();
+    _size[slot] = obj->GetObjectSize();
+    _phaseMask[slot] = obj->GetPhaseMask();
+}
+
+void CellPositionIndex::Query(float x, float y, float radius, uint8 mask, uint32 phaseMask, std::vector<WorldObject*>& result) const
+{
+    uint32 count = uint32(_objects.size());
+    uint32 i = 0;
+
+#ifdef CELL_INDEX_SSE2
+    __m128 const centerX = _mm_set1_ps(x);
+    __m128 const centerY = _mm_set1_ps(y);
+    __m128 const range = _mm_set1_ps(radius);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&_x[i]), centerX);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&_y[i]), centerY);
+        __m128 reach = _mm_add_ps(range, _mm_loadu_ps(&_size[i]));
+        __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+        int inRange = _mm_movemask_ps(_mm_cmple_ps(distSq, _mm_mul_ps(reach, reach)));
+        if (!inRange)
+            continue;
+
+        for (uint32 j = 0; j < 4; ++j)
+            if (inRange & (1 << j))
+                Accept(i + j, mask, phaseMask, result);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        float dx = _x[i] - x;
+        float dy = _y[i] - y;
+        float reach = radius + _size[i];
+        if (dx * dx + dy * dy <= reach * reach)
+            Accept(i, mask, phaseMask, result);
+    }
+}
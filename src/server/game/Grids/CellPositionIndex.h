@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_CELLPOSITIONINDEX_H
+#define TRINITY_CELLPOSITIONINDEX_H
+
+#include "Define.h"
+#include <vector>
+
+class WorldObject;
+class CellPositionIndex;
+
+// which container of the cell holds the object, combined with the GRID_MAP_TYPE_MASK_* bits
+enum CellIndexContainerMask
+{
+    CELL_INDEX_TYPE_BITS        = 0x3F,                     // GRID_MAP_TYPE_MASK_ALL
+    CELL_INDEX_GRID_CONTAINER   = 0x40,
+    CELL_INDEX_WORLD_CONTAINER  = 0x80,
+    CELL_INDEX_ALL_CONTAINERS   = CELL_INDEX_GRID_CONTAINER | CELL_INDEX_WORLD_CONTAINER
+};
+
+// slot of a WorldObject in the position index of its cell
+struct CellIndexEntry
+{
+    CellIndexEntry() : Index(NULL), Slot(0) { }
+
+    CellPositionIndex* Index;
+    uint32 Slot;
+};
+
+/*
+ * Structure of arrays copy of the 2d position, object size, phase mask and
+ * type of every object linked in one grid cell. Range queries scan the packed
+ * arrays and only hand out the objects which can pass a distance check, so the
+ * searchers do not have to walk the GridRefManager lists object by object.
+ *
+ * The index is filled by Grid and ObjectGridLoader, emptied by
+ * GridObject::RemoveFromGrid and kept up to date by WorldObject::UpdateCellIndex
+ * (every WorldObject::Relocate, phase and combat reach changes).
+ */
+class CellPositionIndex
+{
+    public:
+        CellPositionIndex() { }
+        ~CellPositionIndex();
+
+        void Insert(WorldObject* obj, uint8 container);
+        void Remove(CellIndexEntry& entry);
+        void Update(WorldObject const* obj, uint32 slot);
+
+        // appends the objects matching mask (GRID_MAP_TYPE_MASK_* | CELL_INDEX_*_CONTAINER) whose
+        // 2d distance to x, y minus their object size is at most radius, phaseMask 0 matches every phase
+        void Query(float x, float y, float radius, uint8 mask, uint32 phaseMask, std::vector<WorldObject*>& result) const;
+
+        uint32 Size() const { return uint32(_objects.size()); }
+
+    private:
+        CellPositionIndex(CellPositionIndex const&);
+        CellPositionIndex& operator=(CellPositionIndex const&);
+
+        void Accept(uint32 slot, uint8 mask, uint32 phaseMask, std::vector<WorldObject*>& result) const
+        {
+            if ((_mask[slot] & mask & CELL_INDEX_TYPE_BITS) && (_mask[slot] & mask & CELL_INDEX_ALL_CONTAINERS)
+                && (!phaseMask || (_phaseMask[slot] & phaseMask)))
+                result.push_back(_objects[slot]);
+        }
+
+        std::vector<float> _x;
+        std::vector<float> _y;
+        std::vector<float> _size;
+        std::vector<uint32> _phaseMask;
+        std::vector<uint8> _mask;
+        std::vector<WorldObject*> _objects;
+};
+
+#endif
@@ -109,8 +109,12 @@ struct Cell
 
     template<class T, class CONTAINER> void Visit(CellCoord const&, TypeContainerVisitor<T, CONTAINER>& visitor, Map &, WorldObject const&, float) const;
     template<class T, class CONTAINER> void Visit(CellCoord const&, TypeContainerVisitor<T, CONTAINER>& visitor, Map &, float, float, float) const;
+    // same cells as Visit(), but the visitor only gets the objects passing CellPositionIndex::Query
+    template<class T> void VisitIndexed(CellCoord const&, T& visitor, Map &, float radius, float x_off, float y_off, uint8 mask, uint32 phaseMask = 0) const;
 
     static CellArea CalculateCellArea(float x, float y, float radius);
+    // whether Visit() with this radius from x, y goes through cell
+    static bool IsInVisitArea(CellCoord const& cell, float x, float y, float radius);
 
 private:
     template<class T, class CONTAINER> void VisitCircle(TypeContainerVisitor<T, CONTAINER> &, Map &, CellCoord const&, CellCoord const&) const;
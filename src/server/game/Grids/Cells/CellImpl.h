@@ -60,6 +60,38 @@ inline CellArea Cell::CalculateCellArea(float x, float y, float radius)
     return CellArea(centerX, centerY);
 }
 
+inline bool Cell::IsInVisitArea(CellCoord const& cell, float x, float y, float radius)
+{
+    CellCoord standing_cell = MoPCore::ComputeCellCoord(x, y);
+    if (cell == standing_cell)
+        return true;
+
+    if (radius <= 0.0f)
+        return false;
+
+    if (radius > SIZE_OF_GRIDS)
+        radius = SIZE_OF_GRIDS;
+
+    CellArea area = Cell::CalculateCellArea(x, y, radius);
+    if (!area)
+        return false;
+
+    if (cell.x_coord < area.low_bound.x_coord || cell.x_coord > area.high_bound.x_coord ||
+        cell.y_coord < area.low_bound.y_coord || cell.y_coord > area.high_bound.y_coord)
+        return false;
+
+    if (!((area.high_bound.x_coord > (area.low_bound.x_coord + 4)) && (area.high_bound.y_coord > (area.low_bound.y_coord + 4))))
+        return true;
+
+    // the octagon of VisitCircle: a central strip of full height, each column further out is 2 cells shorter
+    uint32 x_shift = (uint32)ceilf((area.high_bound.x_coord - area.low_bound.x_coord) * 0.3f - 0.5f);
+    uint32 x_start = area.low_bound.x_coord + x_shift;
+    uint32 x_end = area.high_bound.x_coord - x_shift;
+    uint32 step = cell.x_coord < x_start ? x_start - cell.x_coord : (cell.x_coord > x_end ? cell.x_coord - x_end : 0);
+
+    return cell.y_coord >= area.low_bound.y_coord + step && cell.y_coord + step <= area.high_bound.y_coord;
+}
+
 template<class T, class CONTAINER>
 inline void Cell::Visit(CellCoord const& standing_cell, TypeContainerVisitor<T, CONTAINER>& visitor, Map& map, float radius, float x_off, float y_off) const
 {
@@ -118,6 +150,41 @@ inline void Cell::Visit(CellCoord const& standing_cell, TypeContainerVisitor<T,
     }
 }
 
+template<class T>
+inline void Cell::VisitIndexed(CellCoord const& standing_cell, T& visitor, Map& map, float radius, float x_off, float y_off, uint8 mask, uint32 phaseMask) const
+{
+    if (!standing_cell.IsCoordValid())
+        return;
+
+    ScratchVector<WorldObject*> buffer(map.GetObjectScratch());
+    std::vector<WorldObject*>& candidates = buffer.Get();
+
+    // the standing cell first, like Visit()
+    map.QueryCellIndex(*this, x_off, y_off, radius, mask, phaseMask, candidates);
+
+    // the cell area is limited like in Visit(), the query itself keeps the full radius
+    CellArea area = Cell::CalculateCellArea(x_off, y_off, radius > SIZE_OF_GRIDS ? SIZE_OF_GRIDS : radius);
+    if (area.low_bound != area.high_bound)
+    {
+        for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+        {
+            for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+            {
+                CellCoord cellCoord(x, y);
+                if (cellCoord != standing_cell)
+                {
+                    Cell r_zone(cellCoord);
+                    r_zone.data.Part.nocreate = this->data.Part.nocreate;
+                    map.QueryCellIndex(r_zone, x_off, y_off, radius, mask, phaseMask, candidates);
+                }
+            }
+        }
+    }
+
+    if (!candidates.empty())
+        visitor.Visit(candidates);
+}
+
 template<class T, class CONTAINER>
 inline void Cell::Visit(CellCoord const& standing_cell, TypeContainerVisitor<T, CONTAINER>& visitor, Map& map, WorldObject const& obj, float radius) const
 {
@@ -33,6 +33,7 @@
 #include "Define.h"
 #include "TypeContainer.h"
 #include "TypeContainerVisitor.h"
+#include "CellPositionIndex.h"
 
 // forward declaration
 template<class A, class T, class O> class GridLoader;
@@ -60,6 +61,7 @@ class Grid
         {
             i_objects.template insert<SPECIFIC_OBJECT>(obj);
             ASSERT(obj->IsInGrid());
+            i_positions.Insert(obj, CELL_INDEX_WORLD_CONTAINER);
         }
 
         /** an object of interested exits the grid
@@ -98,6 +100,11 @@ class Grid
             visitor.Visit(i_objects);
         }
 
+        /** Positions of the world and grid objects, for the range queries of Cell::VisitIndexed
+         */
+        CellPositionIndex& GetPositionIndex() { return i_positions; }
+        CellPositionIndex const& GetPositionIndex() const { return i_positions; }
+
         /** Returns the number of object within the grid.
          */
         //unsigned int ActiveObjectsInGrid(void) const { return i_objects.template Count<ACTIVE_OBJECT>(); }
@@ -113,6 +120,7 @@ class Grid
         {
             i_container.template insert<SPECIFIC_OBJECT>(obj);
             ASSERT(obj->IsInGrid());
+            i_positions.Insert(obj, CELL_INDEX_GRID_CONTAINER);
         }
 
         /** Removes a containter type object from the grid
@@ -137,6 +145,7 @@ class Grid
 
         TypeMapContainer<GRID_OBJECT_TYPES> i_container;
         TypeMapContainer<WORLD_OBJECT_TYPES> i_objects;
+        CellPositionIndex i_positions;
         //typedef std::set<void*> ActiveGridObjects;
         //ActiveGridObjects m_activeGridObjects;
 };
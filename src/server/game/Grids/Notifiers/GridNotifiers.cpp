@@ -30,34 +30,66 @@
 
 using namespace MoPCore;
 
+namespace
+{
+    // Walks the sorted client guids together with the sorted guids found in range,
+    // everything the grid visit didn't reach is removed and reported as out of range
+    struct OutOfRangeGUIDRemover
+    {
+        OutOfRangeGUIDRemover(Player& player, UpdateData& data, std::vector<uint64> const& visibleGUIDs) :
+            _player(player), _data(data), _visible(visibleGUIDs.begin()), _visibleEnd(visibleGUIDs.end()) { }
+
+        bool operator()(uint64 guid)
+        {
+            while (_visible != _visibleEnd && *_visible < guid)
+                ++_visible;
+
+            if (_visible != _visibleEnd && *_visible == guid)
+                return false;
+
+            _data.AddOutOfRangeGUID(guid);
+
+            if (IS_PLAYER_GUID(guid))
+            {
+                Player* player = ObjectAccessor::FindPlayer(guid);
+                if (player && player->IsInWorld())
+                    player->UpdateVisibilityOf(&_player);
+            }
+
+            return true;
+        }
+
+        Player& _player;
+        UpdateData& _data;
+        std::vector<uint64>::const_iterator _visible;
+        std::vector<uint64>::const_iterator _visibleEnd;
+    };
+}
+
 void VisibleNotifier::SendToSelf()
 {
-    // at this moment i_clientGUIDs have guids that not iterate at grid level checks
+    std::sort(i_visibleGUIDs.begin(), i_visibleGUIDs.end());
+
+    // at this moment client guids not found in i_visibleGUIDs were not iterated at grid level checks
     // but exist one case when this possible and object not out of range: transports
     if (Transport* transport = i_player.GetTransport())
         for (Transport::PlayerSet::const_iterator itr = transport->GetPassengers().begin();itr != transport->GetPassengers().end();++itr)
         {
-            if (vis_guids.find((*itr)->GetGUID()) != vis_guids.end())
-            {
-                vis_guids.erase((*itr)->GetGUID());
+            uint64 guid = (*itr)->GetGUID();
+            if (i_player.m_clientGUIDs.find(guid) == i_player.m_clientGUIDs.end())
+                continue;
 
-                i_player.UpdateVisibilityOf((*itr), i_data, i_visibleNow);
-                (*itr)->UpdateVisibilityOf(&i_player);
-            }
-        }
+            std::vector<uint64>::iterator pos = std::lower_bound(i_visibleGUIDs.begin(), i_visibleGUIDs.end(), guid);
+            if (pos != i_visibleGUIDs.end() && *pos == guid)
+                continue;
 
-    for (Player::ClientGUIDs::const_iterator it = vis_guids.begin();it != vis_guids.end(); ++it)
-    {
-        i_player.m_clientGUIDs.erase(*it);
-        i_data.AddOutOfRangeGUID(*it);
+            i_visibleGUIDs.insert(pos, guid);
 
-        if (IS_PLAYER_GUID(*it))
-        {
-            Player* player = ObjectAccessor::FindPlayer(*it);
-            if (player && player->IsInWorld())
-                player->UpdateVisibilityOf(&i_player);
+            i_player.UpdateVisibilityOf((*itr), i_data, i_visibleNow);
+            (*itr)->UpdateVisibilityOf(&i_player);
         }
-    }
+
+    i_player.m_clientGUIDs.erase_if(OutOfRangeGUIDRemover(i_player, i_data, i_visibleGUIDs));
 
     if (!i_data.HasData())
         return;
@@ -73,37 +105,50 @@ void VisibleNotifier::SendToSelf()
 void VisibleChangesNotifier::Visit(PlayerMapType &m)
 {
     for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        if (iter->getSource() == &i_object)
-            continue;
-
-        iter->getSource()->UpdateVisibilityOf(&i_object);
-
-        if (!iter->getSource()->GetSharedVisionList().empty())
-            for (SharedVisionList::const_iterator i = iter->getSource()->GetSharedVisionList().begin();
-                i != iter->getSource()->GetSharedVisionList().end(); ++i)
-                if ((*i)->m_seer == iter->getSource())
-                    (*i)->UpdateVisibilityOf(&i_object);
-    }
+        VisitObject(iter->getSource());
 }
 
 void VisibleChangesNotifier::Visit(CreatureMapType &m)
 {
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-        if (!iter->getSource()->GetSharedVisionList().empty())
-            for (SharedVisionList::const_iterator i = iter->getSource()->GetSharedVisionList().begin();
-                i != iter->getSource()->GetSharedVisionList().end(); ++i)
-                if ((*i)->m_seer == iter->getSource())
-                    (*i)->UpdateVisibilityOf(&i_object);
+        VisitObject(iter->getSource());
 }
 
 void VisibleChangesNotifier::Visit(DynamicObjectMapType &m)
 {
     for (DynamicObjectMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-        if (IS_PLAYER_GUID(iter->getSource()->GetCasterGUID()))
-            if (Player* caster = (Player*)iter->getSource()->GetCaster())
-                if (caster->m_seer == iter->getSource())
-                    caster->UpdateVisibilityOf(&i_object);
+        VisitObject(iter->getSource());
+}
+
+void VisibleChangesNotifier::VisitObject(Player* player)
+{
+    if (player == &i_object)
+        return;
+
+    player->UpdateVisibilityOf(&i_object);
+
+    if (!player->GetSharedVisionList().empty())
+        for (SharedVisionList::const_iterator i = player->GetSharedVisionList().begin();
+            i != player->GetSharedVisionList().end(); ++i)
+            if ((*i)->m_seer == player)
+                (*i)->UpdateVisibilityOf(&i_object);
+}
+
+void VisibleChangesNotifier::VisitObject(Creature* creature)
+{
+    if (!creature->GetSharedVisionList().empty())
+        for (SharedVisionList::const_iterator i = creature->GetSharedVisionList().begin();
+            i != creature->GetSharedVisionList().end(); ++i)
+            if ((*i)->m_seer == creature)
+                (*i)->UpdateVisibilityOf(&i_object);
+}
+
+void VisibleChangesNotifier::VisitObject(DynamicObject* dynObj)
+{
+    if (IS_PLAYER_GUID(dynObj->GetCasterGUID()))
+        if (Player* caster = (Player*)dynObj->GetCaster())
+            if (caster->m_seer == dynObj)
+                caster->UpdateVisibilityOf(&i_object);
 }
 
 inline void CreatureUnitRelocationWorker(Creature* c, Unit* u)
@@ -120,12 +165,14 @@ inline void CreatureUnitRelocationWorker(Creature* c, Unit* u)
 void AIRelocationNotifier::Visit(CreatureMapType &m)
 {
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Creature* c = iter->getSource();
-        CreatureUnitRelocationWorker(c, &i_unit);
-        if (isCreature)
-            CreatureUnitRelocationWorker((Creature*)&i_unit, c);
-    }
+        VisitObject(iter->getSource());
+}
+
+void AIRelocationNotifier::VisitObject(Creature* c)
+{
+    CreatureUnitRelocationWorker(c, &i_unit);
+    if (isCreature)
+        CreatureUnitRelocationWorker((Creature*)&i_unit, c);
 }
 
 void MessageDistDeliverer::Visit(PlayerMapType &m)
@@ -43,10 +43,11 @@ namespace MoPCore
         Player &i_player;
         UpdateData i_data;
         std::set<Unit*> i_visibleNow;
-        Player::ClientGUIDs vis_guids;
+        std::vector<uint64>& i_visibleGUIDs;                // objects found in range, client guids missing here went out of range
 
-        VisibleNotifier(Player &player) : i_player(player), i_data(player.GetMapId()), vis_guids(player.m_clientGUIDs) {}
+        VisibleNotifier(Player &player) : i_player(player), i_data(player.GetMapId()), i_visibleGUIDs(player.m_visibleGUIDsBuffer) { i_visibleGUIDs.clear(); }
         template<class T> void Visit(GridRefManager<T> &m);
+        template<class T> void VisitObject(T* obj);
         void SendToSelf(void);
     };
 
@@ -59,6 +60,9 @@ namespace MoPCore
         void Visit(PlayerMapType &);
         void Visit(CreatureMapType &);
         void Visit(DynamicObjectMapType &);
+        void VisitObject(Player* player);
+        void VisitObject(Creature* creature);
+        void VisitObject(DynamicObject* dynObj);
     };
 
     struct PlayerRelocationNotifier : public VisibleNotifier
@@ -99,6 +103,32 @@ namespace MoPCore
         explicit AIRelocationNotifier(Unit &unit) : i_unit(unit), isCreature(unit.GetTypeId() == TYPEID_UNIT)  {}
         template<class T> void Visit(GridRefManager<T> &) {}
         void Visit(CreatureMapType &);
+        void VisitObject(Creature* creature);
+    };
+
+    // Gathers every object of the visited cells, used to replay one grid visit
+    // for several notifiers (see Map::ProcessSharedRelocationNotifies)
+    struct RelocationObjectCollector
+    {
+        std::vector<Player*> i_players;
+        std::vector<Creature*> i_creatures;
+        std::vector<GameObject*> i_gameObjects;
+        std::vector<DynamicObject*> i_dynamicObjects;
+        std::vector<Corpse*> i_corpses;
+        std::vector<AreaTrigger*> i_areaTriggers;
+
+        void Visit(PlayerMapType &m) { Collect(m, i_players); }
+        void Visit(CreatureMapType &m) { Collect(m, i_creatures); }
+        void Visit(GameObjectMapType &m) { Collect(m, i_gameObjects); }
+        void Visit(DynamicObjectMapType &m) { Collect(m, i_dynamicObjects); }
+        void Visit(CorpseMapType &m) { Collect(m, i_corpses); }
+        void Visit(AreaTriggerMapType &m) { Collect(m, i_areaTriggers); }
+
+        template<class T> void Collect(GridRefManager<T> &m, std::vector<T*> &objects)
+        {
+            for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+                objects.push_back(iter->getSource());
+        }
     };
 
     struct GridUpdater
@@ -222,6 +252,7 @@ namespace MoPCore
         void Visit(CorpseMapType &m);
         void Visit(DynamicObjectMapType &m);
         void Visit(AreaTriggerMapType &m);
+        void Visit(std::vector<WorldObject*> const& candidates); // Cell::VisitIndexed
 
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
     };
@@ -243,6 +274,7 @@ namespace MoPCore
         void Visit(CorpseMapType &m);
         void Visit(DynamicObjectMapType &m);
         void Visit(AreaTriggerMapType &m);
+        void Visit(std::vector<WorldObject*> const& candidates); // Cell::VisitIndexed
 
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
     };
@@ -264,6 +296,22 @@ namespace MoPCore
         void Visit(GameObjectMapType &m);
         void Visit(DynamicObjectMapType &m);
         void Visit(AreaTriggerMapType &m);
+        void Visit(std::vector<WorldObject*> const& candidates); // Cell::VisitIndexed
+
+        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
+    };
+
+    // WorldObjectListSearcher for the indexed cell visits, fills a vector (usually a map ScratchVector)
+    template<class Check>
+    struct WorldObjectVectorSearcher
+    {
+        std::vector<WorldObject*> &i_objects;
+        Check& i_check;
+
+        WorldObjectVectorSearcher(std::vector<WorldObject*> &objects, Check & check)
+            : i_objects(objects), i_check(check) {}
+
+        void Visit(std::vector<WorldObject*> const& candidates); // Cell::VisitIndexed
 
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
     };
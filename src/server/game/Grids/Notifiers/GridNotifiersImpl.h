@@ -31,10 +31,14 @@ template<class T>
 inline void MoPCore::VisibleNotifier::Visit(GridRefManager<T> &m)
 {
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        vis_guids.erase(iter->getSource()->GetGUID());
-        i_player.UpdateVisibilityOf(iter->getSource(), i_data, i_visibleNow);
-    }
+        VisitObject(iter->getSource());
+}
+
+template<class T>
+inline void MoPCore::VisibleNotifier::VisitObject(T* obj)
+{
+    i_visibleGUIDs.push_back(obj->GetGUID());
+    i_player.UpdateVisibilityOf(obj, i_data, i_visibleNow);
 }
 
 inline void MoPCore::ObjectUpdater::Visit(CreatureMapType &m)
@@ -186,6 +190,26 @@ void MoPCore::WorldObjectSearcher<Check>::Visit(AreaTriggerMapType &m)
     }
 }
 
+template<class Check>
+void MoPCore::WorldObjectSearcher<Check>::Visit(std::vector<WorldObject*> const& candidates)
+{
+    // already found
+    if (i_object)
+        return;
+
+    for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+    {
+        if (!(*itr)->InSamePhase(i_phaseMask))
+            continue;
+
+        if (i_check(*itr))
+        {
+            i_object = *itr;
+            return;
+        }
+    }
+}
+
 template<class Check>
 void MoPCore::WorldObjectLastSearcher<Check>::Visit(GameObjectMapType &m)
 {
@@ -282,6 +306,19 @@ void MoPCore::WorldObjectLastSearcher<Check>::Visit(AreaTriggerMapType  &m)
     }
 }
 
+template<class Check>
+void MoPCore::WorldObjectLastSearcher<Check>::Visit(std::vector<WorldObject*> const& candidates)
+{
+    for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+    {
+        if (!(*itr)->InSamePhase(i_phaseMask))
+            continue;
+
+        if (i_check(*itr))
+            i_object = *itr;
+    }
+}
+
 template<class Check>
 void MoPCore::WorldObjectListSearcher<Check>::Visit(PlayerMapType &m)
 {
@@ -348,6 +385,22 @@ void MoPCore::WorldObjectListSearcher<Check>::Visit(AreaTriggerMapType &m)
             i_objects.push_back(itr->getSource());
 }
 
+template<class Check>
+void MoPCore::WorldObjectListSearcher<Check>::Visit(std::vector<WorldObject*> const& candidates)
+{
+    for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+        if (i_check(*itr))
+            i_objects.push_back(*itr);
+}
+
+template<class Check>
+void MoPCore::WorldObjectVectorSearcher<Check>::Visit(std::vector<WorldObject*> const& candidates)
+{
+    for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+        if (i_check(*itr))
+            i_objects.push_back(*itr);
+}
+
 // Gameobject searchers
 
 template<class Check>
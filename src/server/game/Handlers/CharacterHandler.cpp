@@ -316,7 +316,7 @@ void WorldSession::HandleCharEnumOpcode(WorldPacket& /*recvData*/)
     stmt->setUInt8(0, PET_SLOT_ACTUAL_PET_SLOT);
     stmt->setUInt32(1, GetAccountId());
 
-    _charEnumCallback = CharacterDatabase.AsyncQuery(stmt);
+    _charEnumCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetAccountId())));
 }
 
 void WorldSession::HandleCharCreateOpcode(WorldPacket& recvData)
@@ -445,7 +445,7 @@ void WorldSession::HandleCharCreateOpcode(WorldPacket& recvData)
     _charCreateCallback.SetParam(new CharacterCreateInfo(name, race_, class_, gender, skin, face, hairStyle, hairColor, facialHair, outfitId, recvData));
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHECK_NAME);
     stmt->setString(0, name);
-    _charCreateCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt));
+    _charCreateCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetAccountId())));
 }
 
 void WorldSession::HandleCharCreateCallback(PreparedQueryResult result, CharacterCreateInfo* createInfo)
@@ -507,7 +507,7 @@ void WorldSession::HandleCharCreateCallback(PreparedQueryResult result, Characte
             stmt->setUInt32(0, GetAccountId());
 
             _charCreateCallback.FreeResult();
-            _charCreateCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt));
+            _charCreateCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetAccountId())));
             _charCreateCallback.NextStage();
         }
         break;
@@ -539,7 +539,7 @@ void WorldSession::HandleCharCreateCallback(PreparedQueryResult result, Characte
                 PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHAR_CREATE_INFO);
                 stmt->setUInt32(0, GetAccountId());
                 stmt->setUInt32(1, (skipCinematics == 1 || createInfo->Class == CLASS_DEATH_KNIGHT) ? 10 : 1);
-                _charCreateCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt));
+                _charCreateCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetAccountId())));
                 _charCreateCallback.NextStage();
                 return;
             }
@@ -883,10 +883,10 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket& recvData)
         return;
     }
 
-    _charLoginCallback = CharacterDatabase.DelayQueryHolder((SQLQueryHolder*)holder);
+    _charLoginCallback.SetFutureResult(CharacterDatabase.DelayQueryHolder((SQLQueryHolder*)holder, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetAccountId())));
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_CHARACTER_SPELL);
     stmt->setUInt32(0, GetAccountId());
-    _accountSpellCallback = LoginDatabase.AsyncQuery(stmt);
+    _accountSpellCallback.SetFutureResult(LoginDatabase.AsyncQuery(stmt, MakeDatabaseRoutingKey(DB_ROUTING_ACCOUNT, GetAccountId())));
 
 }
 
@@ -59,6 +59,9 @@ class LootTemplate::LootGroup                               // A set of loot def
         bool HasQuestDropForPlayer(Player const* player) const;
                                                             // The same for active quests of the player
         void Process(Loot& loot, uint16 lootMode) const;    // Rolls an item from the group (if any) and adds the item to the loot
+        void ProcessUncompiled(Loot& loot, uint16 lootMode) const;
+                                                            // The same with the linear roll over every entry
+        void Compile();                                     // Builds the alias table of the group
         float RawTotalChance() const;                       // Overall chance for the group (without equal chanced items)
         float TotalChance() const;                          // Overall chance for the group
 
@@ -72,7 +75,19 @@ class LootTemplate::LootGroup                               // A set of loot def
         LootStoreItemList ExplicitlyChanced;                // Entries with chances defined in DB
         LootStoreItemList EqualChanced;                     // Zero chances - every entry takes the same chance
 
+        // Walker alias table over the explicitly chanced entries, the equal chanced entries and the empty drop
+        // (in this order, the empty drop only exists without equal chanced entries), one roll picks an outcome
+        // with the same probability as the linear roll
+        std::vector<float> AliasChance;
+        std::vector<uint32> Alias;
+
         LootStoreItem const* Roll() const;                 // Rolls an item from the group, returns NULL if all miss their chances
+        uint32 RollAlias() const;                          // Rolls an outcome index from the alias table
+
+        typedef std::vector<LootStoreItem const*> PossibleDrops;
+        // Rolls the remaining entries until one is added to the loot or the attempts run out
+        static void ProcessAttempts(Loot& loot, uint16 lootMode, PossibleDrops& explicitDrops, PossibleDrops& equalDrops, uint8 attempts, uint8 maxAttempts);
+        static bool IsDuplicate(Loot const& loot, LootStoreItem const& item);
 };
 
 //Remove all data and free all memory
@@ -161,10 +176,18 @@ uint32 LootStore::LoadLootTable()
     while (result->NextRow());
 
     Verify();                                           // Checks validity of the loot store
+    Compile();
 
     return count;
 }
 
+// Compiles every template of the loot store
+void LootStore::Compile()
+{
+    for (LootTemplateMap::const_iterator i = m_LootTemplates.begin(); i != m_LootTemplates.end(); ++i)
+        i->second->Compile();
+}
+
 bool LootStore::HaveQuestLootFor(uint32 loot_id) const
 {
     LootTemplateMap::const_iterator itr = m_LootTemplates.find(loot_id);
@@ -246,9 +269,48 @@ void LootStore::ReportNotExistedId(uint32 id) const
 // --------- LootStoreItem ---------
 //
 
+// Pre-multiplies the drop rates into the chance and resolves the item template and the reference
+void LootStoreItem::Compile()
+{
+    ItemTemplate const* proto = sObjectMgr->GetItemTemplate(itemid);
+
+    dropLimit = proto ? (proto->InventoryType == 0 ? 3 : 1) : 0;
+    referenceLoops = 0;
+    reference = NULL;
+
+    if (mincountOrRef < 0)
+    {
+        reference = LootTemplates_Reference.GetLootFor(-mincountOrRef);
+        referenceLoops = uint32(float(maxcount) * sWorld->getRate(RATE_DROP_ITEM_REFERENCED_AMOUNT));
+    }
+
+    for (uint8 rate = 0; rate < 2; ++rate)
+    {
+        float modifier = 1.0f;
+        if (rate && mincountOrRef < 0)
+            modifier = sWorld->getRate(RATE_DROP_ITEM_REFERENCED);
+        else if (rate && type == LOOT_ITEM_TYPE_ITEM && proto)
+            modifier = sWorld->getRate(qualityToRate[proto->Quality]);
+
+        if (chance >= 100.0f)
+            rolledChance[rate] = 100.0f;
+        else if (mincountOrRef > 0 && type != LOOT_ITEM_TYPE_ITEM && type != LOOT_ITEM_TYPE_CURRENCY)
+            rolledChance[rate] = 0.0f;
+        else
+            rolledChance[rate] = chance * modifier;
+    }
+}
+
+// Checks if the entry takes it's chance with the compiled chance
+bool LootStoreItem::Roll(bool rate) const
+{
+    float rolled = rolledChance[rate ? 1 : 0];
+    return rolled >= 100.0f || roll_chance_f(rolled);
+}
+
 // Checks if the entry (quest, non-quest, reference) takes it's chance (at loot generation)
 // RATE_DROP_ITEMS is no longer used for all types of entries
-bool LootStoreItem::Roll(bool rate) const
+bool LootStoreItem::RollUncompiled(bool rate) const
 {
     if (chance >= 100.0f)
         return true;
@@ -1372,25 +1434,166 @@ void LootTemplate::LootGroup::CopyConditions(ConditionList /*conditions*/)
     }
 }
 
+// Builds the alias table, the outcome probabilities are the parts of [0, 100) the linear roll gives to each entry
+void LootTemplate::LootGroup::Compile()
+{
+    for (LootStoreItemList::iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+        i->Compile();
+    for (LootStoreItemList::iterator i = EqualChanced.begin(); i != EqualChanced.end(); ++i)
+        i->Compile();
+
+    AliasChance.clear();
+    Alias.clear();
+
+    std::vector<double> weights;
+    weights.reserve(ExplicitlyChanced.size() + EqualChanced.size() + 1);
+
+    double start = 0.0;
+    bool covered = false;                                   // the rest of the roll range is taken by an entry
+    for (LootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+    {
+        if (covered)
+            weights.push_back(0.0);
+        else if (i->chance >= 100.0f || start + i->chance >= 100.0)
+        {
+            weights.push_back(100.0 - start);
+            covered = true;
+        }
+        else
+        {
+            weights.push_back(i->chance);
+            start += i->chance;
+        }
+    }
+
+    double missed = covered ? 0.0 : 100.0 - start;
+    if (!EqualChanced.empty())
+        weights.resize(weights.size() + EqualChanced.size(), missed / EqualChanced.size());
+    else if (missed > 0.0)
+        weights.push_back(missed);                          // empty drop
+
+    if (weights.empty())
+        return;
+
+    uint32 count = uint32(weights.size());
+    AliasChance.resize(count, 1.0f);
+    Alias.resize(count);
+
+    std::vector<uint32> small, large;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        weights[i] = weights[i] * count / 100.0;
+        Alias[i] = i;
+        if (weights[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32 less = small.back();
+        uint32 more = large.back();
+        small.pop_back();
+
+        AliasChance[less] = float(weights[less]);
+        Alias[less] = more;
+
+        weights[more] -= 1.0 - weights[less];
+        if (weights[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // what is left over is 1 up to rounding errors and keeps AliasChance 1
+}
+
+uint32 LootTemplate::LootGroup::RollAlias() const
+{
+    uint32 column = urand(0, Alias.size() - 1);
+    return rand_norm() < AliasChance[column] ? column : Alias[column];
+}
+
+// Equippable items drop once per loot, other items up to 3 times
+bool LootTemplate::LootGroup::IsDuplicate(Loot const& loot, LootStoreItem const& item)
+{
+    if (!item.dropLimit)
+        return false;
+
+    uint8 counter = 0;
+    for (LootItemList::const_iterator i = loot.items.begin(); i != loot.items.end(); ++i)
+        if (i->itemid == item.itemid && ++counter == item.dropLimit)
+            return true;
+
+    return false;
+}
+
 // Rolls an item from the group (if any takes its chance) and adds the item to the loot
 void LootTemplate::LootGroup::Process(Loot& loot, uint16 lootMode) const
+{
+    uint8 const maxAttempts = ExplicitlyChanced.size() + EqualChanced.size();
+    if (!maxAttempts || Alias.empty())
+        return;
+
+    uint32 explicitCount = ExplicitlyChanced.size();
+    uint32 outcome = RollAlias();
+    if (outcome >= explicitCount + EqualChanced.size())
+        return;                                             // empty drop
+
+    LootStoreItem const* item = outcome < explicitCount ? &ExplicitlyChanced[outcome] : &EqualChanced[outcome - explicitCount];
+
+    bool duplicate = false;
+    if (item->lootmode & lootMode)
+    {
+        if (!IsDuplicate(loot, *item))
+        {
+            loot.AddItem(*item);
+            return;
+        }
+
+        duplicate = true;
+    }
+
+    // the first roll failed, continue with what the linear roll would have left: the explicitly chanced
+    // entries in front of the rolled one are gone, and the rolled entry itself if it is a duplicate
+    PossibleDrops explicitDrops;
+    PossibleDrops equalDrops;
+    if (outcome < explicitCount)
+        for (uint32 i = outcome + (duplicate ? 1 : 0); i < explicitCount; ++i)
+            explicitDrops.push_back(&ExplicitlyChanced[i]);
+
+    for (uint32 i = 0; i < EqualChanced.size(); ++i)
+        if (!duplicate || explicitCount + i != outcome)
+            equalDrops.push_back(&EqualChanced[i]);
+
+    ProcessAttempts(loot, lootMode, explicitDrops, equalDrops, 1, maxAttempts);
+}
+
+void LootTemplate::LootGroup::ProcessUncompiled(Loot& loot, uint16 lootMode) const
 {
     // build up list of possible drops
-    LootStoreItemList EqualPossibleDrops = EqualChanced;
-    LootStoreItemList ExplicitPossibleDrops = ExplicitlyChanced;
+    PossibleDrops explicitDrops;
+    PossibleDrops equalDrops;
+    for (LootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+        explicitDrops.push_back(&*i);
+    for (LootStoreItemList::const_iterator i = EqualChanced.begin(); i != EqualChanced.end(); ++i)
+        equalDrops.push_back(&*i);
 
-    uint8 uiAttemptCount = 0;
-    const uint8 uiMaxAttempts = ExplicitlyChanced.size() + EqualChanced.size();
+    ProcessAttempts(loot, lootMode, explicitDrops, equalDrops, 0, ExplicitlyChanced.size() + EqualChanced.size());
+}
 
+void LootTemplate::LootGroup::ProcessAttempts(Loot& loot, uint16 lootMode, PossibleDrops& ExplicitPossibleDrops, PossibleDrops& EqualPossibleDrops, uint8 uiAttemptCount, uint8 uiMaxAttempts)
+{
     while (!ExplicitPossibleDrops.empty() || !EqualPossibleDrops.empty())
     {
         if (uiAttemptCount == uiMaxAttempts)             // already tried rolling too many times, just abort
             return;
 
-        LootStoreItem* item = NULL;
+        LootStoreItem const* item = NULL;
 
         // begin rolling (normally called via Roll())
-        LootStoreItemList::iterator itr;
+        PossibleDrops::iterator itr;
         uint8 itemSource = 0;
         if (!ExplicitPossibleDrops.empty())              // First explicitly chanced entries are checked
         {
@@ -1399,16 +1602,16 @@ void LootTemplate::LootGroup::Process(Loot& loot, uint16 lootMode) const
             // check each explicitly chanced entry in the template and modify its chance based on quality
             for (itr = ExplicitPossibleDrops.begin(); itr != ExplicitPossibleDrops.end(); itr = ExplicitPossibleDrops.erase(itr))
             {
-                if (itr->chance >= 100.0f)
+                if ((*itr)->chance >= 100.0f)
                 {
-                    item = &*itr;
+                    item = *itr;
                     break;
                 }
 
-                Roll -= itr->chance;
+                Roll -= (*itr)->chance;
                 if (Roll < 0)
                 {
-                    item = &*itr;
+                    item = *itr;
                     break;
                 }
             }
@@ -1418,7 +1621,7 @@ void LootTemplate::LootGroup::Process(Loot& loot, uint16 lootMode) const
             itemSource = 2;
             itr = EqualPossibleDrops.begin();
             std::advance(itr, irand(0, EqualPossibleDrops.size()-1));
-            item = &*itr;
+            item = *itr;
         }
         // finish rolling
 
@@ -1426,21 +1629,7 @@ void LootTemplate::LootGroup::Process(Loot& loot, uint16 lootMode) const
 
         if (item != NULL && item->lootmode & lootMode)   // only add this item if roll succeeds and the mode matches
         {
-            bool duplicate = false;
-            if (ItemTemplate const* _proto = sObjectMgr->GetItemTemplate(item->itemid))
-            {
-                uint8 _item_counter = 0;
-                for (LootItemList::const_iterator _item = loot.items.begin(); _item != loot.items.end(); ++_item)
-                    if (_item->itemid == item->itemid)                             // search through the items that have already dropped
-                    {
-                        ++_item_counter;
-                        if (_proto->InventoryType == 0 && _item_counter == 3)      // Non-equippable items are limited to 3 drops
-                            duplicate = true;
-                        else if (_proto->InventoryType != 0 && _item_counter == 1) // Equippable item are limited to 1 drop
-                            duplicate = true;
-                    }
-            }
-            if (duplicate) // if item->itemid is a duplicate, remove it
+            if (IsDuplicate(loot, *item))                // if item->itemid is a duplicate, remove it
                 switch (itemSource)
                 {
                     case 1: // item came from ExplicitPossibleDrops
@@ -1559,7 +1748,8 @@ void LootTemplate::Process(Loot& loot, bool rate, uint16 lootMode, uint8 groupId
         return;
     }
 
-    // Rolling non-grouped items
+    // Rolling non-grouped items, the drop count limit of the uncompiled processing never skips
+    // an entry so it is not checked here
     for (LootStoreItemList::const_iterator i = Entries.begin(); i != Entries.end(); ++i)
     {
         if (i->lootmode &~ lootMode)                          // Do not add if mode mismatch
@@ -1568,6 +1758,43 @@ void LootTemplate::Process(Loot& loot, bool rate, uint16 lootMode, uint8 groupId
         if (!i->Roll(rate))
             continue;                                         // Bad luck for the entry
 
+        if (i->mincountOrRef < 0 && i->type == LOOT_ITEM_TYPE_ITEM)                             // References processing
+        {
+            if (!i->reference)
+                continue;                                     // Error message already printed at loading stage
+
+            for (uint32 loop = 0; loop < i->referenceLoops; ++loop)    // Ref multiplicator
+                i->reference->Process(loot, rate, lootMode, i->group);
+        }
+        else                                                  // Plain entries (not a reference, not grouped)
+            loot.AddItem(*i);                                 // Chance is already checked, just add
+    }
+
+    // Now processing groups
+    for (LootGroups::const_iterator i = Groups.begin(); i != Groups.end(); ++i)
+        i->Process(loot, lootMode);
+}
+
+void LootTemplate::ProcessUncompiled(Loot& loot, bool rate, uint16 lootMode, uint8 groupId) const
+{
+    if (groupId)                                            // Group reference uses own processing of the group
+    {
+        if (groupId > Groups.size())
+            return;                                         // Error message already printed at loading stage
+
+        Groups[groupId-1].ProcessUncompiled(loot, lootMode);
+        return;
+    }
+
+    // Rolling non-grouped items
+    for (LootStoreItemList::const_iterator i = Entries.begin(); i != Entries.end(); ++i)
+    {
+        if (i->lootmode &~ lootMode)                          // Do not add if mode mismatch
+            continue;
+
+        if (!i->RollUncompiled(rate))
+            continue;                                         // Bad luck for the entry
+
         if (i->type == LOOT_ITEM_TYPE_ITEM)
         {
             if (ItemTemplate const* _proto = sObjectMgr->GetItemTemplate(i->itemid))
@@ -1597,7 +1824,7 @@ void LootTemplate::Process(Loot& loot, bool rate, uint16 lootMode, uint8 groupId
 
             uint32 maxcount = uint32(float(i->maxcount) * sWorld->getRate(RATE_DROP_ITEM_REFERENCED_AMOUNT));
             for (uint32 loop = 0; loop < maxcount; ++loop)    // Ref multiplicator
-                Referenced->Process(loot, rate, lootMode, i->group);
+                Referenced->ProcessUncompiled(loot, rate, lootMode, i->group);
         }
         else                                                  // Plain entries (not a reference, not grouped)
             loot.AddItem(*i);                                 // Chance is already checked, just add
@@ -1605,7 +1832,16 @@ void LootTemplate::Process(Loot& loot, bool rate, uint16 lootMode, uint8 groupId
 
     // Now processing groups
     for (LootGroups::const_iterator i = Groups.begin(); i != Groups.end(); ++i)
-        i->Process(loot, lootMode);
+        i->ProcessUncompiled(loot, lootMode);
+}
+
+void LootTemplate::Compile()
+{
+    for (LootStoreItemList::iterator i = Entries.begin(); i != Entries.end(); ++i)
+        i->Compile();
+
+    for (LootGroups::iterator i = Groups.begin(); i != Groups.end(); ++i)
+        i->Compile();
 }
 
 // True if template includes at least 1 quest drop entry
@@ -2121,5 +2357,24 @@ void LoadLootTemplates_Reference()
     // output error for any still listed ids (not referenced from any loot table)
     LootTemplates_Reference.ReportUnusedIds(lootIdSet);
 
+    // the other stores point into the reference store
+    CompileLootTables();
+
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, ">> Loaded refence loot templates in %u ms", GetMSTimeDiffToNow(oldMSTime));
 }
+
+void CompileLootTables()
+{
+    LootTemplates_Creature.Compile();
+    LootTemplates_Fishing.Compile();
+    LootTemplates_Gameobject.Compile();
+    LootTemplates_Item.Compile();
+    LootTemplates_Mail.Compile();
+    LootTemplates_Milling.Compile();
+    LootTemplates_Pickpocketing.Compile();
+    LootTemplates_Skinning.Compile();
+    LootTemplates_Disenchant.Compile();
+    LootTemplates_Prospecting.Compile();
+    LootTemplates_Spell.Compile();
+    LootTemplates_Reference.Compile();
+}
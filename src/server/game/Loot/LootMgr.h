@@ -106,6 +106,7 @@ enum LootSlotType
 
 class Player;
 class LootStore;
+class LootTemplate;
 class ConditionMgr;
 
 struct LootStoreItem
@@ -120,14 +121,24 @@ struct LootStoreItem
     uint8   maxcount    :8;                                 // max drop count for the item (mincountOrRef positive) or Ref multiplicator (mincountOrRef negative)
     std::list<Condition*>  conditions;                               // additional loot condition
 
+    // filled by Compile() from the item template, the drop rates and the reference store
+    float   rolledChance[2];                                // chance with rates disabled / enabled, 100 for sure drops
+    uint8   dropLimit;                                      // drops of the same item allowed by a group roll, 0 means no limit
+    uint32  referenceLoops;                                 // Ref multiplicator with RATE_DROP_ITEM_REFERENCED_AMOUNT applied
+    LootTemplate const* reference;                          // referenced template, NULL if missing
+
     // Constructor, converting ChanceOrQuestChance -> (chance, needs_quest)
     // displayid is filled in IsValid() which must be called after
     LootStoreItem(uint32 _itemid, uint8 _type, float _chanceOrQuestChance, uint16 _lootmode, uint8 _group, int32 _mincountOrRef, uint8 _maxcount)
         : itemid(_itemid), type(_type), chance(fabs(_chanceOrQuestChance)), mincountOrRef(_mincountOrRef), lootmode(_lootmode),
-        group(_group), needs_quest(_chanceOrQuestChance < 0), maxcount(_maxcount)
-         {}
+        group(_group), needs_quest(_chanceOrQuestChance < 0), maxcount(_maxcount), dropLimit(0), referenceLoops(0), reference(NULL)
+    {
+        rolledChance[0] = rolledChance[1] = chance;
+    }
 
+    void Compile();                                         // Fills the compiled fields (at loading stage and after rate or item template reloads)
     bool Roll(bool rate) const;                             // Checks if the entry takes it's chance (at loot generation)
+    bool RollUncompiled(bool rate) const;                   // The same roll with the rates and the item template looked up every time
     bool IsValid(LootStore const& store, uint32 entry) const;
                                                             // Checks correctness of values
 };
@@ -216,6 +227,8 @@ class LootStore
         char const* GetName() const { return m_name; }
         char const* GetEntryName() const { return m_entryName; }
         bool IsRatesAllowed() const { return m_ratesAllowed; }
+
+        void Compile();
     protected:
         uint32 LoadLootTable();
         void Clear();
@@ -236,6 +249,10 @@ class LootTemplate
         void AddEntry(LootStoreItem& item);
         // Rolls for every item in the template and adds the rolled items the the loot
         void Process(Loot& loot, bool rate, uint16 lootMode, uint8 groupId = 0) const;
+        // The same rolls without the compiled tables, kept to check them against (.debug lootsim)
+        void ProcessUncompiled(Loot& loot, bool rate, uint16 lootMode, uint8 groupId = 0) const;
+        // Builds the compiled chances, references and group alias tables
+        void Compile();
         void CopyConditions(std::list<Condition*>  conditions);
 
         // True if template includes at least 1 quest drop entry
@@ -457,6 +474,9 @@ void LoadLootTemplates_Prospecting();
 void LoadLootTemplates_Spell();
 void LoadLootTemplates_Reference();
 
+// Recompiles every loot store, needed when the reference store, the drop rates or the item templates change
+void CompileLootTables();
+
 inline void LoadLootTables()
 {
     LoadLootTemplates_Creature();
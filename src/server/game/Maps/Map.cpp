@@ -33,6 +33,7 @@
 #include "LFGMgr.h"
 #include "DynamicTree.h"
 #include "Vehicle.h"
+#include "TickProfiler.h"
 
 union u_map_magic
 {
@@ -206,7 +207,7 @@ _creatureToMoveLock(false), i_mapEntry (sMapStore.LookupEntry(id)), i_spawnMode(
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
 m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
 m_activeNonPlayersIter(m_activeNonPlayers.end()), i_gridExpiry(expiry),
-i_scriptLock(false)
+i_scriptLock(false), _relocationBatchInProgress(false), _updateWorker(-1)
 {
     m_parentMap = (_parent ? _parent : this);
     for (unsigned int idx=0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
@@ -255,6 +256,15 @@ void Map::AddToGrid(Creature* obj, Cell const& cell)
     obj->SetCurrentCell(cell);
 }
 
+void Map::QueryCellIndex(Cell const& cell, float x, float y, float radius, uint8 mask, uint32 phaseMask, std::vector<WorldObject*>& result)
+{
+    if (!cell.NoCreate() || IsGridLoaded(GridCoord(cell.GridX(), cell.GridY())))
+    {
+        EnsureGridLoaded(cell);
+        getNGrid(cell.GridX(), cell.GridY())->GetGridType(cell.CellX(), cell.CellY()).GetPositionIndex().Query(x, y, radius, mask, phaseMask, result);
+    }
+}
+
 void Map::SwitchGridContainers(Creature* obj, bool on)
 {
     ASSERT(!obj->IsPermanentWorldObject());
@@ -499,6 +509,13 @@ void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<MoPCore::Obj
 
 void Map::Update(const uint32 t_diff)
 {
+    TickProfileScope profileScope(TICK_PROFILE_MAP, (uint64(GetId()) << 32) | GetInstanceId(), GetMapName());
+
+    _lastRelocationStats = _relocationStats;
+    _relocationStats = RelocationNotifyStats();
+    _lastCreatureTierStats = _creatureTierStats;
+    _creatureTierStats = CreatureUpdateTierStats();
+
     _dynamicTree.update(t_diff);
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
@@ -556,8 +573,12 @@ void Map::Update(const uint32 t_diff)
         i_scriptLock = false;
     }
 
+    ProcessEventSpawnQueue();
+
     MoveAllCreaturesInMoveList();
 
+    ProcessRelocationNotifies(t_diff);
+
     sScriptMgr->OnMapUpdate(this, t_diff);
 }
 
@@ -754,6 +775,250 @@ void Map::MoveAllCreaturesInMoveList()
     _creatureToMoveLock = false;
 }
 
+void Map::AddUnitToRelocationQueue(Unit* unit, uint8 notifyFlags)
+{
+    if (unit->GetRelocationNotifyFlags() == RELOCATION_NOTIFY_NONE)
+    {
+        unit->SetRelocationQueueIndex(_relocationQueue.size());
+        _relocationQueue.push_back(unit);
+        ++_relocationStats.QueuedUnits;
+    }
+    else
+        ++_relocationStats.CoalescedNotifies;
+
+    unit->SetRelocationNotifyFlags(unit->GetRelocationNotifyFlags() | notifyFlags);
+}
+
+void Map::RemoveUnitFromRelocationQueue(Unit* unit)
+{
+    if (unit->GetRelocationNotifyFlags() != RELOCATION_NOTIFY_NONE)
+    {
+        uint32 index = unit->GetRelocationQueueIndex();
+        if (index < _relocationQueue.size() && _relocationQueue[index] == unit)
+            _relocationQueue[index] = NULL;
+
+        unit->SetRelocationNotifyFlags(RELOCATION_NOTIFY_NONE);
+    }
+
+    // unit can be removed from world by a notify of the batch being processed
+    if (_relocationBatchInProgress)
+    {
+        uint32 index = unit->GetRelocationBatchIndex();
+        if (index < _relocationBatch.size() && _relocationBatch[index].NotifyUnit == unit)
+            _relocationBatch[index].NotifyUnit = NULL;
+    }
+}
+
+namespace
+{
+    struct RelocationEntryCellOrder
+    {
+        template<class T>
+        bool operator()(T const& left, T const& right) const { return left.CellId < right.CellId; }
+    };
+
+    template<class T, class NOTIFIER>
+    void VisitCollectedObjects(std::vector<T*> const& objects, NOTIFIER& notifier)
+    {
+        for (typename std::vector<T*>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr)
+            if ((*itr)->IsInWorld())
+                notifier.VisitObject(*itr);
+    }
+}
+
+void Map::ProcessRelocationNotifies(uint32 diff)
+{
+    // set by World::LoadConfigSettings, read on every pass so a config reload reaches the existing maps
+    _relocationNotifyTimer.SetInterval(World::Visibility_RelocationNotifyInterval);
+    _aiNotifyTimer.SetInterval(World::Visibility_AINotifyDelay);
+
+    _relocationNotifyTimer.Update(diff);
+    _aiNotifyTimer.Update(diff);
+
+    uint8 processMask = RELOCATION_NOTIFY_NONE;
+    if (_relocationNotifyTimer.Passed())
+    {
+        _relocationNotifyTimer.Reset();
+        processMask |= RELOCATION_NOTIFY_VISIBILITY;
+    }
+
+    if (_aiNotifyTimer.Passed())
+    {
+        _aiNotifyTimer.Reset();
+        processMask |= RELOCATION_NOTIFY_AI;
+    }
+
+    if (processMask == RELOCATION_NOTIFY_NONE || _relocationQueue.empty())
+        return;
+
+    // move the due notifies to the batch, units keep their other pending flags queued
+    std::vector<Unit*> queue;
+    queue.swap(_relocationQueue);
+    _relocationQueue.reserve(queue.size());
+    _relocationBatch.clear();
+    _relocationBatch.reserve(queue.size());
+
+    for (std::vector<Unit*>::const_iterator itr = queue.begin(); itr != queue.end(); ++itr)
+    {
+        Unit* unit = *itr;
+        if (!unit)
+            continue;
+
+        uint8 flags = unit->GetRelocationNotifyFlags();
+        unit->SetRelocationNotifyFlags(flags & ~processMask);
+        if (flags & ~processMask)
+        {
+            unit->SetRelocationQueueIndex(_relocationQueue.size());
+            _relocationQueue.push_back(unit);
+        }
+
+        if (!(flags & processMask))
+            continue;
+
+        RelocationNotifyEntry entry;
+        entry.NotifyUnit = unit;
+        entry.NotifyFlags = flags & processMask;
+        entry.CellId = MoPCore::ComputeCellCoord(unit->GetPositionX(), unit->GetPositionY()).GetId();
+        _relocationBatch.push_back(entry);
+    }
+
+    // units of the same cell are next to each other, nearby ones can share a grid visit
+    std::sort(_relocationBatch.begin(), _relocationBatch.end(), RelocationEntryCellOrder());
+    for (size_t i = 0; i < _relocationBatch.size(); ++i)
+        _relocationBatch[i].NotifyUnit->SetRelocationBatchIndex(i);
+
+    float const shareDistSq = World::Visibility_RelocationShareDistance * World::Visibility_RelocationShareDistance;
+    _relocationBatchInProgress = true;
+
+    for (size_t runStart = 0; runStart < _relocationBatch.size();)
+    {
+        size_t runEnd = runStart + 1;
+        while (runEnd < _relocationBatch.size() && _relocationBatch[runEnd].CellId == _relocationBatch[runStart].CellId)
+            ++runEnd;
+
+        for (size_t leader = runStart; leader < runEnd;)
+        {
+            size_t clusterEnd = leader + 1;
+
+            // players looking through another object (far sight, possess) see from another place
+            Unit* leaderUnit = _relocationBatch[leader].NotifyUnit;
+            if (shareDistSq > 0.0f && leaderUnit && (leaderUnit->GetTypeId() != TYPEID_PLAYER || leaderUnit->ToPlayer()->m_seer == leaderUnit))
+            {
+                for (size_t i = clusterEnd; i < runEnd; ++i)
+                {
+                    Unit* member = _relocationBatch[i].NotifyUnit;
+                    if (!member || (member->GetTypeId() == TYPEID_PLAYER && member->ToPlayer()->m_seer != member))
+                        continue;
+
+                    if (leaderUnit->GetExactDist2dSq(member) > shareDistSq)
+                        continue;
+
+                    std::swap(_relocationBatch[i], _relocationBatch[clusterEnd]);
+                    if (_relocationBatch[i].NotifyUnit)
+                        _relocationBatch[i].NotifyUnit->SetRelocationBatchIndex(i);
+                    member->SetRelocationBatchIndex(clusterEnd);
+                    ++clusterEnd;
+                }
+            }
+
+            if (clusterEnd - leader > 1)
+                ProcessSharedRelocationNotifies(leader, clusterEnd);
+            else if (leaderUnit)
+            {
+                if (_relocationBatch[leader].NotifyFlags & RELOCATION_NOTIFY_VISIBILITY)
+                    leaderUnit->ProcessRelocationVisibility();
+
+                // visibility update may have removed the unit from world
+                if (_relocationBatch[leader].NotifyUnit && (_relocationBatch[leader].NotifyFlags & RELOCATION_NOTIFY_AI))
+                    leaderUnit->ProcessRelocationAINotify();
+
+                ++_relocationStats.ProcessedUnits;
+            }
+
+            leader = clusterEnd;
+        }
+
+        runStart = runEnd;
+    }
+
+    _relocationBatchInProgress = false;
+    _relocationBatch.clear();
+}
+
+void Map::ProcessSharedRelocationNotifies(size_t first, size_t last)
+{
+    Unit* leader = _relocationBatch[first].NotifyUnit;
+
+    // one visit covering the notify range of every member, each notifier still checks its own range
+    float radius = 0.0f;
+    bool loadGrids = false;
+    for (size_t i = first; i < last; ++i)
+    {
+        Unit* unit = _relocationBatch[i].NotifyUnit;
+        radius = std::max(radius, unit->GetVisibilityRange());
+        if (Player* player = unit->ToPlayer())
+        {
+            radius = std::max(radius, player->GetSightRange());
+            loadGrids = true;
+        }
+    }
+
+    MoPCore::RelocationObjectCollector objects;
+    VisitAll(leader->GetPositionX(), leader->GetPositionY(), radius + World::Visibility_RelocationShareDistance, objects, loadGrids);
+
+    ++_relocationStats.SharedVisits;
+
+    for (size_t i = first; i < last; ++i)
+    {
+        Unit* unit = _relocationBatch[i].NotifyUnit;
+        if (!unit)
+            continue;
+
+        uint8 flags = _relocationBatch[i].NotifyFlags;
+        if (flags & RELOCATION_NOTIFY_VISIBILITY)
+        {
+            SharedVisionList const& sharedVision = unit->GetSharedVisionList();
+            for (SharedVisionList::const_iterator itr = sharedVision.begin(); itr != sharedVision.end();)
+            {
+                Player* viewer = *itr;
+                ++itr;
+                viewer->UpdateVisibilityForPlayer();
+            }
+
+            if (Player* player = unit->ToPlayer())
+            {
+                MoPCore::VisibleNotifier notifier(*player);
+                VisitCollectedObjects(objects.i_players, notifier);
+                VisitCollectedObjects(objects.i_creatures, notifier);
+                VisitCollectedObjects(objects.i_gameObjects, notifier);
+                VisitCollectedObjects(objects.i_dynamicObjects, notifier);
+                VisitCollectedObjects(objects.i_corpses, notifier);
+                VisitCollectedObjects(objects.i_areaTriggers, notifier);
+                notifier.SendToSelf();
+            }
+
+            MoPCore::VisibleChangesNotifier notifier(*unit);
+            VisitCollectedObjects(objects.i_players, notifier);
+            VisitCollectedObjects(objects.i_creatures, notifier);
+            VisitCollectedObjects(objects.i_dynamicObjects, notifier);
+        }
+
+        // the creatures of the cells the own visit of the unit goes through (Unit::ProcessRelocationAINotify),
+        // the shared visit covers more of them
+        if (_relocationBatch[i].NotifyUnit && (flags & RELOCATION_NOTIFY_AI))
+        {
+            MoPCore::AIRelocationNotifier notifier(*unit);
+            float aiRadius = unit->GetVisibilityRange();
+            for (std::vector<Creature*>::const_iterator itr = objects.i_creatures.begin(); itr != objects.i_creatures.end(); ++itr)
+                if ((*itr)->IsInWorld() && Cell::IsInVisitArea((*itr)->GetCurrentCell().GetCellCoord(), unit->GetPositionX(), unit->GetPositionY(), aiRadius))
+                    notifier.VisitObject(*itr);
+        }
+
+        ++_relocationStats.ProcessedUnits;
+        ++_relocationStats.SharedUnits;
+    }
+}
+
 bool Map::CreatureCellRelocation(Creature* c, Cell new_cell)
 {
     Cell const& old_cell = c->GetCurrentCell();
@@ -2451,6 +2716,8 @@ bool InstanceMap::AddPlayerToMap(Player* player)
 
 void InstanceMap::Update(const uint32 t_diff)
 {
+    TickProfileScope profileScope(TICK_PROFILE_MAP, (uint64(GetId()) << 32) | GetInstanceId(), GetMapName());
+
     Map::Update(t_diff);
 
     if (i_data)
@@ -2763,19 +3030,123 @@ void BattlegroundMap::RemoveAllPlayers()
                     player->TeleportTo(player->GetBattlegroundEntryPoint());
 }
 
+void Map::QueueEventSpawn(uint8 typeId, uint32 guid, bool spawn)
+{
+    EventSpawnRequest request;
+    request.Guid = guid;
+    request.TypeId = typeId;
+    request.Spawn = spawn;
+
+    TRINITY_GUARD(ACE_Thread_Mutex, _eventSpawnLock);
+    _eventSpawnQueue.push_back(request);
+}
+
+void Map::ProcessEventSpawnQueue()
+{
+    // at least one request per update so the queue always drains. The lock is only held to pop, spawning
+    // may run scripts that start or stop game events and queue again
+    uint32 budget = sWorld->getIntConfig(CONFIG_GAME_EVENT_SPAWN_BUDGET);
+    uint32 startTime = getMSTime();
+    do
+    {
+        EventSpawnRequest request;
+        {
+            TRINITY_GUARD(ACE_Thread_Mutex, _eventSpawnLock);
+            if (_eventSpawnQueue.empty())
+                return;
+
+            request = _eventSpawnQueue.front();
+            _eventSpawnQueue.pop_front();
+        }
+
+        ProcessEventSpawn(request);
+    }
+    while (GetMSTimeDiffToNow(startTime) < budget);
+}
+
+void Map::ProcessEventSpawn(EventSpawnRequest const& request)
+{
+    // spawns only matter for loaded grids, the grids loaded later get the object from the cell guids of
+    // ObjectMgr, which may also have happened since the request was queued
+    if (request.TypeId == TYPEID_UNIT)
+    {
+        CreatureData const* data = sObjectMgr->GetCreatureData(request.Guid);
+        if (!data)
+            return;
+
+        Creature* creature = GetCreature(MAKE_NEW_GUID(request.Guid, data->id, HIGHGUID_UNIT));
+        if (!request.Spawn)
+        {
+            if (creature)
+                creature->AddObjectToRemoveList();
+            return;
+        }
+
+        // We use spawn coords to spawn
+        if (creature || !IsGridLoaded(data->posX, data->posY))
+            return;
+
+        creature = new Creature;
+        if (!creature->LoadCreatureFromDB(request.Guid, this))
+            delete creature;
+    }
+    else if (request.TypeId == TYPEID_GAMEOBJECT)
+    {
+        GameObjectData const* data = sObjectMgr->GetGOData(request.Guid);
+        if (!data)
+            return;
+
+        GameObject* gameObject = GetGameObject(MAKE_NEW_GUID(request.Guid, data->id, HIGHGUID_GAMEOBJECT));
+        if (!request.Spawn)
+        {
+            if (gameObject)
+                gameObject->AddObjectToRemoveList();
+            return;
+        }
+
+        if (gameObject || !IsGridLoaded(data->posX, data->posY))
+            return;
+
+        gameObject = new GameObject;
+        if (!gameObject->LoadGameObjectFromDB(request.Guid, this, false))
+            delete gameObject;
+        else if (gameObject->isSpawnedByDefault())
+            AddToMap(gameObject);
+    }
+}
+
+void Map::AddToObjectIndex(WorldObject* obj)
+{
+    _objectIndex.Insert(obj->GetGUID(), obj);
+}
+
+void Map::RemoveFromObjectIndex(WorldObject* obj)
+{
+    _objectIndex.Remove(obj->GetGUID(), obj);
+}
+
 Creature* Map::GetCreature(uint64 guid)
 {
-    return ObjectAccessor::GetObjectInMap(guid, this, (Creature*)NULL);
+    WorldObject* obj = _objectIndex.Find(guid);
+    return obj ? obj->ToCreature() : NULL;
 }
 
 GameObject* Map::GetGameObject(uint64 guid)
 {
-    return ObjectAccessor::GetObjectInMap(guid, this, (GameObject*)NULL);
+    WorldObject* obj = _objectIndex.Find(guid);
+    return obj ? obj->ToGameObject() : NULL;
 }
 
 DynamicObject* Map::GetDynamicObject(uint64 guid)
 {
-    return ObjectAccessor::GetObjectInMap(guid, this, (DynamicObject*)NULL);
+    WorldObject* obj = _objectIndex.Find(guid);
+    return obj ? obj->ToDynObject() : NULL;
+}
+
+AreaTrigger* Map::GetAreaTrigger(uint64 guid)
+{
+    WorldObject* obj = _objectIndex.Find(guid);
+    return obj ? obj->ToAreaTrigger() : NULL;
 }
 
 void Map::UpdateIteratorBack(Player* player)
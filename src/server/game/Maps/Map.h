@@ -32,8 +32,11 @@
 #include "MapRefManager.h"
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
+#include "ScratchVector.h"
+#include "MapObjectIndex.h"
 
 #include <bitset>
+#include <deque>
 #include <list>
 
 class Unit;
@@ -43,6 +46,8 @@ class Group;
 class InstanceSave;
 class Object;
 class WorldObject;
+class GameObject;
+class AreaTrigger;
 class TempSummon;
 class Player;
 class CreatureGroup;
@@ -231,6 +236,43 @@ struct InstanceTemplate
 
 typedef std::map<uint32/*leaderDBGUID*/, CreatureGroup*>        CreatureGroupHolderType;
 
+// per tick counters of the relocation notify system
+struct RelocationNotifyStats
+{
+    RelocationNotifyStats() : QueuedUnits(0), CoalescedNotifies(0), ProcessedUnits(0),
+        VisibilityVisits(0), AIVisits(0), SharedVisits(0), SharedUnits(0) { }
+
+    uint32 QueuedUnits;                                     // units added to the relocation queue
+    uint32 CoalescedNotifies;                               // notifies merged into an already queued entry
+    uint32 ProcessedUnits;                                  // units handled by the batch pass
+    uint32 VisibilityVisits;                                // VisibleNotifier / VisibleChangesNotifier cell visits
+    uint32 AIVisits;                                        // AIRelocationNotifier cell visits
+    uint32 SharedVisits;                                    // cell visits shared by a group of nearby movers
+    uint32 SharedUnits;                                     // units served by shared visits
+};
+
+// how often Creature::Update runs for a creature, see Creature::UpdateLevelOfDetail
+enum CreatureUpdateTier
+{
+    CREATURE_UPDATE_TIER_ACTIVE,                            // every map update: engaged, controlled or a player close by
+    CREATURE_UPDATE_TIER_NEAR,                              // a player within CreatureUpdate.LOD.FarDistance
+    CREATURE_UPDATE_TIER_FAR,                               // only kept updated by the cells of a farther player
+    MAX_CREATURE_UPDATE_TIERS
+};
+
+// per tick counters of the creature update tiers
+struct CreatureUpdateTierStats
+{
+    CreatureUpdateTierStats() : Updated(0)
+    {
+        for (uint8 i = 0; i < MAX_CREATURE_UPDATE_TIERS; ++i)
+            Creatures[i] = 0;
+    }
+
+    uint32 Creatures[MAX_CREATURE_UPDATE_TIERS];            // creatures visited by the map update, per tier
+    uint32 Updated;                                         // creatures whose update ran
+};
+
 class Map : public GridRefManager<NGridType>
 {
     friend class MapReference;
@@ -276,7 +318,31 @@ class Map : public GridRefManager<NGridType>
         void PlayerRelocation(Player*, float x, float y, float z, float orientation);
         void CreatureRelocation(Creature* creature, float x, float y, float z, float ang, bool respawnRelocationOnFail = true);
 
+        // relocation notifies are queued per unit and processed in batches every Visibility.RelocationNotifyInterval
+        void AddUnitToRelocationQueue(Unit* unit, uint8 notifyFlags);
+        void RemoveUnitFromRelocationQueue(Unit* unit);
+        RelocationNotifyStats& GetRelocationNotifyCounters() { return _relocationStats; }
+        RelocationNotifyStats const& GetLastTickRelocationNotifyStats() const { return _lastRelocationStats; }
+        CreatureUpdateTierStats& GetCreatureUpdateTierCounters() { return _creatureTierStats; }
+        CreatureUpdateTierStats const& GetLastTickCreatureUpdateTierStats() const { return _lastCreatureTierStats; }
+
         template<class T, class CONTAINER> void Visit(const Cell& cell, TypeContainerVisitor<T, CONTAINER> &visitor);
+        void QueryCellIndex(Cell const& cell, float x, float y, float radius, uint8 mask, uint32 phaseMask, std::vector<WorldObject*>& result);
+
+        // reusable vectors for the searches and target selections done on the map thread, see ScratchVector
+        ScratchVectorStack<WorldObject*>& GetObjectScratch() { return _objectScratch; }
+        ScratchVectorStack<Unit*>& GetUnitScratch() { return _unitScratch; }
+        ScratchVectorStack<GameObject*>& GetGameObjectScratch() { return _gameObjectScratch; }
+
+        // MapUpdater worker the map is updated on with MapUpdate.Affinity, -1 until its first scheduled update
+        int32 GetUpdateWorker() const { return _updateWorker; }
+        void SetUpdateWorker(int32 worker) { _updateWorker = worker; }
+
+        // game event spawns and despawns, queued by GameEventMgr and done in queue order by the map update,
+        // GameEvent.SpawnBudget ms per update. Scripts start and stop events from their own map update, so the
+        // queue can be filled from any map thread while this map updates; it is guarded by _eventSpawnLock.
+        // typeId is TYPEID_UNIT or TYPEID_GAMEOBJECT, guid the db guid
+        void QueueEventSpawn(uint8 typeId, uint32 guid, bool spawn);
 
         bool IsRemovalGrid(float x, float y) const
         {
@@ -443,6 +509,12 @@ class Map : public GridRefManager<NGridType>
         Creature* GetCreature(uint64 guid);
         GameObject* GetGameObject(uint64 guid);
         DynamicObject* GetDynamicObject(uint64 guid);
+        AreaTrigger* GetAreaTrigger(uint64 guid);
+
+        // must called with AddToWorld / RemoveFromWorld of creatures (not pets), gameobjects, dynamic objects and areatriggers
+        void AddToObjectIndex(WorldObject* obj);
+        void RemoveFromObjectIndex(WorldObject* obj);
+        uint32 GetObjectIndexSize() const { return _objectIndex.Size(); }
 
         MapInstanced* ToMapInstanced(){ if (Instanceable())  return reinterpret_cast<MapInstanced*>(this); else return NULL;  }
         const MapInstanced* ToMapInstanced() const { if (Instanceable())  return (const MapInstanced*)((MapInstanced*)this); else return NULL;  }
@@ -512,6 +584,47 @@ class Map : public GridRefManager<NGridType>
         bool _creatureToMoveLock;
         std::vector<Creature*> _creaturesToMove;
 
+        struct RelocationNotifyEntry
+        {
+            Unit* NotifyUnit;
+            uint8 NotifyFlags;
+            uint32 CellId;
+        };
+
+        void ProcessRelocationNotifies(uint32 diff);
+        void ProcessSharedRelocationNotifies(size_t first, size_t last);
+
+        std::vector<Unit*> _relocationQueue;
+        std::vector<RelocationNotifyEntry> _relocationBatch;
+        bool _relocationBatchInProgress;
+        IntervalTimer _relocationNotifyTimer;
+        IntervalTimer _aiNotifyTimer;
+        RelocationNotifyStats _relocationStats;
+        RelocationNotifyStats _lastRelocationStats;
+        CreatureUpdateTierStats _creatureTierStats;
+        CreatureUpdateTierStats _lastCreatureTierStats;
+
+        ScratchVectorStack<WorldObject*> _objectScratch;
+        ScratchVectorStack<Unit*> _unitScratch;
+        ScratchVectorStack<GameObject*> _gameObjectScratch;
+
+        MapObjectIndex _objectIndex;
+
+        int32 _updateWorker;
+
+        struct EventSpawnRequest
+        {
+            uint32 Guid;                                    // db guid of the creature or gameobject
+            uint8 TypeId;
+            bool Spawn;
+        };
+
+        void ProcessEventSpawnQueue();
+        void ProcessEventSpawn(EventSpawnRequest const& request);
+
+        std::deque<EventSpawnRequest> _eventSpawnQueue;
+        ACE_Thread_Mutex _eventSpawnLock;                   // not held while a request is processed
+
         bool IsGridLoaded(const GridCoord &) const;
         void EnsureGridCreated(const GridCoord &);
         bool EnsureGridLoaded(Cell const&);
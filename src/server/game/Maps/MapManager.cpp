@@ -60,7 +60,8 @@ void MapManager::Initialize()
     }
     int num_threads(sWorld->getIntConfig(CONFIG_NUMTHREADS));
     // Start mtmaps if needed.
-    if (num_threads > 0 && m_updater.activate(num_threads) == -1)
+    if (num_threads > 0 && m_updater.activate(num_threads, sWorld->getBoolConfig(CONFIG_MAP_UPDATE_AFFINITY),
+        sWorld->getIntConfig(CONFIG_MAP_UPDATE_AFFINITY_SKEW)) == -1)
         abort();
 }
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapObjectIndex.h"
+#include "Errors.h"
+#include <cstring>
+
+#define MAP_OBJECT_INDEX_MIN_CAPACITY 256
+
+void MapObjectIndex::Insert(uint64 guid, WorldObject* obj)
+{
+    ASSERT(guid && obj);
+
+    // at most 3/4 full so the probe sequences stay short
+    if ((_size + 1) * 4 > _capacity * 3)
+        Grow();
+
+    uint32 i = Home(guid);
+    for (; _slots[i].Guid; i = (i + 1) & (_capacity - 1))
+    {
+        if (_slots[i].Guid == guid)
+        {
+            _slots[i].Object = obj;
+            return;
+        }
+    }
+
+    _slots[i].Guid = guid;
+    _slots[i].Object = obj;
+    ++_size;
+}
+
+void MapObjectIndex::Remove(uint64 guid, WorldObject const* obj)
+{
+    if (!_size)
+        return;
+
+    uint32 mask = _capacity - 1;
+    uint32 hole = Home(guid);
+    for (; _slots[hole].Guid != guid; hole = (hole + 1) & mask)
+        if (!_slots[hole].Guid)
+            return;
+
+    if (_slots[hole].Object != obj)
+        return;
+
+    // move back every following entry of the cluster that may not be found past the hole any more
+    for (uint32 next = (hole + 1) & mask; _slots[next].Guid; next = (next + 1) & mask)
+    {
+        uint32 home = Home(_slots[next].Guid);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            _slots[hole] = _slots[next];
+            hole = next;
+        }
+    }
+
+    _slots[hole].Guid = 0;
+    _slots[hole].Object = NULL;
+    --_size;
+}
+
+void MapObjectIndex::Grow()
+{
+    Slot* oldSlots = _slots;
+    uint32 oldCapacity = _capacity;
+
+    _capacity = _capacity ? _capacity * 2 : MAP_OBJECT_INDEX_MIN_CAPACITY;
+    _slots = new Slot[_capacity];
+    memset(_slots, 0, _capacity * sizeof(Slot));
+
+    for (uint32 i = 0; i < oldCapacity; ++i)
+    {
+        if (!oldSlots[i].Guid)
+            continue;
+
+        uint32 j = Home(oldSlots[i].Guid);
+        while (_slots[j].Guid)
+            j = (j + 1) & (_capacity - 1);
+
+        _slots[j] = oldSlots[i];
+    }
+
+    delete[] oldSlots;
+}
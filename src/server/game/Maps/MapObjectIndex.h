@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_MAPOBJECTINDEX_H
+#define TRINITY_MAPOBJECTINDEX_H
+
+#include "Define.h"
+
+class WorldObject;
+
+/*
+ * GUID to object index of the creatures, gameobjects, dynamic objects and
+ * areatriggers in world on one map, so the map aware ObjectAccessor lookups
+ * do not go through the global HashMapHolder and its lock.
+ *
+ * Open addressing with linear probing, the capacity is a power of two and
+ * removal shifts the following entries back so no tombstones are needed.
+ * Filled from the AddToWorld / RemoveFromWorld of the indexed types, which
+ * covers AddToMap / RemoveFromMap as well as grid loading and unloading. Like
+ * the grids it is only used by the thread updating the map, or by the world
+ * thread while no map is updated.
+ */
+class MapObjectIndex
+{
+    public:
+        MapObjectIndex() : _slots(NULL), _capacity(0), _size(0) { }
+        ~MapObjectIndex() { delete[] _slots; }
+
+        // replaces the object indexed with the same guid, if any
+        void Insert(uint64 guid, WorldObject* obj);
+        // only removes the entry if it still points to obj
+        void Remove(uint64 guid, WorldObject const* obj);
+
+        WorldObject* Find(uint64 guid) const
+        {
+            if (!_size)
+                return NULL;
+
+            for (uint32 i = Home(guid); _slots[i].Guid; i = (i + 1) & (_capacity - 1))
+                if (_slots[i].Guid == guid)
+                    return _slots[i].Object;
+
+            return NULL;
+        }
+
+        uint32 Size() const { return _size; }
+
+    private:
+        MapObjectIndex(MapObjectIndex const&);
+        MapObjectIndex& operator=(MapObjectIndex const&);
+
+        struct Slot
+        {
+            uint64 Guid;                                    // 0 for a free slot, no object has guid 0
+            WorldObject* Object;
+        };
+
+        uint32 Home(uint64 guid) const
+        {
+            // the low guids are sequential, mix the bits before masking
+            guid ^= guid >> 33;
+            guid *= UI64LIT(0xff51afd7ed558ccd);
+            guid ^= guid >> 33;
+            return uint32(guid) & (_capacity - 1);
+        }
+
+        void Grow();
+
+        Slot* _slots;
+        uint32 _capacity;
+        uint32 _size;
+};
+
+#endif
@@ -2,9 +2,20 @@
 #include "DelayExecutor.h"
 #include "Map.h"
 #include "DatabaseEnv.h"
+#include "TickProfiler.h"
+#include "MemoryPool.h"
 
 #include <ace/Guard_T.h>
 #include <ace/Method_Request.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include <cstdio>
+
+#if PLATFORM == PLATFORM_UNIX && defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#  define MAP_UPDATER_NUMA
+#endif
 
 class WDBThreadStartReq1 : public ACE_Method_Request
 {
@@ -34,6 +45,36 @@ class WDBThreadEndReq1 : public ACE_Method_Request
         }
 };
 
+// pins the worker thread to the cpus of its NUMA node, pages the thread touches first
+// (grids, objects, its pool caches) are then allocated from that node by the kernel
+class MapWorkerStartReq : public ACE_Method_Request
+{
+    private:
+
+        std::vector<uint32> m_cpus;
+
+    public:
+
+        MapWorkerStartReq(std::vector<uint32> const& cpus) : m_cpus(cpus)
+        {
+        }
+
+        virtual int call()
+        {
+#ifdef MAP_UPDATER_NUMA
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (size_t i = 0; i < m_cpus.size(); ++i)
+                if (m_cpus[i] < CPU_SETSIZE)
+                    CPU_SET(m_cpus[i], &set);
+
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                sLog->outError(LOG_FILTER_MAPS, "MapUpdater: failed to pin map update thread to its NUMA node");
+#endif
+            return 0;
+        }
+};
+
 class MapUpdateRequest : public ACE_Method_Request
 {
     private:
@@ -41,42 +82,145 @@ class MapUpdateRequest : public ACE_Method_Request
         Map& m_map;
         MapUpdater& m_updater;
         ACE_UINT32 m_diff;
+        uint32 m_worker;
 
     public:
 
-        MapUpdateRequest(Map& m, MapUpdater& u, ACE_UINT32 d)
-            : m_map(m), m_updater(u), m_diff(d)
+        MapUpdateRequest(Map& m, MapUpdater& u, ACE_UINT32 d, uint32 w = 0)
+            : m_map(m), m_updater(u), m_diff(d), m_worker(w)
         {
         }
 
         virtual int call()
         {
+            sTickProfiler->RegisterThread();
+
+            if (!m_updater.has_affinity())
+            {
+                m_map.Update (m_diff);
+                SizeClassPool::FlushAllThreadStats();
+                m_updater.update_finished(m_map, 0, 0);
+                return 0;
+            }
+
+            ACE_Time_Value start = ACE_OS::gettimeofday();
             m_map.Update (m_diff);
-            m_updater.update_finished();
+            ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+            SizeClassPool::FlushAllThreadStats();
+            m_updater.update_finished(m_map, m_worker, uint64(elapsed.sec()) * 1000000 + elapsed.usec());
             return 0;
         }
 };
 
+namespace
+{
+    // cpus of every NUMA node from sysfs, empty when the host has no NUMA information
+    void LoadNumaNodes(std::vector<std::vector<uint32> >& nodes)
+    {
+#ifdef MAP_UPDATER_NUMA
+        for (uint32 node = 0; ; ++node)
+        {
+            char path[64];
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+
+            FILE* file = fopen(path, "r");
+            if (!file)
+                break;
+
+            // format: "0-7,16-23"
+            std::vector<uint32> cpus;
+            unsigned int first, last;
+            while (fscanf(file, "%u", &first) == 1)
+            {
+                last = first;
+                int c = fgetc(file);
+                if (c == '-')
+                {
+                    if (fscanf(file, "%u", &last) != 1)
+                        break;
+                    c = fgetc(file);
+                }
+
+                for (uint32 cpu = first; cpu <= last; ++cpu)
+                    cpus.push_back(cpu);
+
+                if (c != ',')
+                    break;
+            }
+            fclose(file);
+
+            if (!cpus.empty())
+                nodes.push_back(cpus);
+        }
+#else
+        (void)nodes;
+#endif
+    }
+}
+
 MapUpdater::MapUpdater():
-m_executor(), m_mutex(), m_condition(m_mutex), pending_requests(0)
+m_executor(), m_mutex(), m_condition(m_mutex), pending_requests(0), m_rebalanceSkew(0), m_rebalanceCount(0)
 {
 }
 
 MapUpdater::~MapUpdater()
 {
     deactivate();
+
+    for (size_t i = 0; i < m_workers.size(); ++i)
+        delete m_workers[i].Executor;
 }
 
-int MapUpdater::activate(size_t num_threads)
+int MapUpdater::activate(size_t num_threads, bool affinity, uint32 rebalanceSkew)
 {
-    return m_executor.activate((int)num_threads, new WDBThreadStartReq1, new WDBThreadEndReq1);
+    if (!affinity)
+        return m_executor.activate((int)num_threads, new WDBThreadStartReq1, new WDBThreadEndReq1);
+
+    if (activated() || num_threads < 1)
+        return -1;
+
+    std::vector<std::vector<uint32> > nodes;
+    LoadNumaNodes(nodes);
+
+    // pinning only pays off when there is more than one node to keep the memory local to
+    bool pin = nodes.size() > 1;
+
+    m_rebalanceSkew = rebalanceSkew;
+    m_workers.resize(num_threads);
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        Worker& worker = m_workers[i];
+        worker.Executor = new DelayExecutor();
+
+        ACE_Method_Request* startReq;
+        if (pin)
+        {
+            worker.Node = int32(i % nodes.size());
+            startReq = new MapWorkerStartReq(nodes[worker.Node]);
+        }
+        else
+            startReq = new WDBThreadStartReq1;
+
+        if (worker.Executor->activate(1, startReq, new WDBThreadEndReq1) == -1)
+            return -1;
+    }
+
+    sLog->outInfo(LOG_FILTER_MAPS, "MapUpdater: %u map update threads with map affinity, %s", uint32(num_threads),
+        pin ? "pinned to NUMA nodes" : "not pinned (single NUMA node)");
+    return 0;
 }
 
 int MapUpdater::deactivate()
 {
     wait();
 
-    return m_executor.deactivate();
+    if (m_workers.empty())
+        return m_executor.deactivate();
+
+    for (size_t i = 0; i < m_workers.size(); ++i)
+        m_workers[i].Executor->deactivate();
+
+    return 0;
 }
 
 int MapUpdater::wait()
@@ -86,6 +230,9 @@ int MapUpdater::wait()
     while (pending_requests > 0)
         m_condition.wait();
 
+    if (!m_workers.empty())
+        rebalance();
+
     return 0;
 }
 
@@ -95,7 +242,16 @@ int MapUpdater::schedule_update(Map& map, ACE_UINT32 diff)
 
     ++pending_requests;
 
-    if (m_executor.execute(new MapUpdateRequest(map, *this, diff)) == -1)
+    int result;
+    if (m_workers.empty())
+        result = m_executor.execute(new MapUpdateRequest(map, *this, diff));
+    else
+    {
+        uint32 worker = select_worker(map);
+        result = m_workers[worker].Executor->execute(new MapUpdateRequest(map, *this, diff, worker));
+    }
+
+    if (result == -1)
     {
         ACE_DEBUG((LM_ERROR, ACE_TEXT("(%t) \n"), ACE_TEXT("Failed to schedule Map Update")));
 
@@ -108,10 +264,13 @@ int MapUpdater::schedule_update(Map& map, ACE_UINT32 diff)
 
 bool MapUpdater::activated()
 {
+    if (!m_workers.empty())
+        return m_workers[0].Executor->activated();
+
     return m_executor.activated();
 }
 
-void MapUpdater::update_finished()
+void MapUpdater::update_finished(Map& map, uint32 worker, uint64 elapsed)
 {
     TRINITY_GUARD(ACE_Thread_Mutex, m_mutex);
 
@@ -121,7 +280,113 @@ void MapUpdater::update_finished()
         return;
     }
 
+    if (!m_workers.empty())
+    {
+        Worker& w = m_workers[worker];
+        w.Updated.push_back(std::make_pair(&map, elapsed));
+        w.UpdateTime += elapsed;
+    }
+
     --pending_requests;
 
     m_condition.broadcast();
 }
+
+// called with m_mutex held
+uint32 MapUpdater::select_worker(Map& map)
+{
+    int32 worker = map.GetUpdateWorker();
+    if (worker >= 0 && uint32(worker) < m_workers.size())
+        return uint32(worker);
+
+    // new map, give it to the worker with the least work last tick, ties go to the one with less maps
+    uint32 best = 0;
+    for (uint32 i = 1; i < m_workers.size(); ++i)
+    {
+        Worker const& w = m_workers[i];
+        Worker const& b = m_workers[best];
+        if (w.LastUpdateTime < b.LastUpdateTime || (w.LastUpdateTime == b.LastUpdateTime && w.LastMaps < b.LastMaps))
+            best = i;
+    }
+
+    // counted right away so the other maps created in the same tick spread over the workers
+    ++m_workers[best].LastMaps;
+    map.SetUpdateWorker(int32(best));
+    return best;
+}
+
+// called with m_mutex held once all the maps of the tick are updated
+void MapUpdater::rebalance()
+{
+    uint64 total = 0;
+    uint32 busiest = 0, idlest = 0;
+    for (uint32 i = 0; i < m_workers.size(); ++i)
+    {
+        total += m_workers[i].UpdateTime;
+        if (m_workers[i].UpdateTime > m_workers[busiest].UpdateTime)
+            busiest = i;
+        if (m_workers[i].UpdateTime < m_workers[idlest].UpdateTime)
+            idlest = i;
+    }
+
+    uint64 average = total / m_workers.size();
+    Worker& from = m_workers[busiest];
+    uint64 gap = from.UpdateTime - m_workers[idlest].UpdateTime;
+
+    // one map per tick at most, and only when the skew is worth more than a millisecond, a moved
+    // map leaves its memory on the old node so moving back and forth on noise would only cost
+    if (busiest != idlest && from.Updated.size() > 1 && gap > 1000
+        && from.UpdateTime * 100 > average * (100 + m_rebalanceSkew))
+    {
+        // the map whose cost is closest to half the gap evens both workers out best
+        std::pair<Map*, uint64>* move = NULL;
+        uint64 bestDelta = 0;
+        for (size_t i = 0; i < from.Updated.size(); ++i)
+        {
+            std::pair<Map*, uint64>& entry = from.Updated[i];
+            if (entry.second >= gap)
+                continue;
+
+            uint64 delta = entry.second > gap / 2 ? entry.second - gap / 2 : gap / 2 - entry.second;
+            if (!move || delta < bestDelta)
+            {
+                move = &entry;
+                bestDelta = delta;
+            }
+        }
+
+        if (move)
+        {
+            move->first->SetUpdateWorker(int32(idlest));
+            ++m_rebalanceCount;
+        }
+    }
+
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        Worker& w = m_workers[i];
+        w.LastUpdateTime = w.UpdateTime;
+        w.LastMaps = uint32(w.Updated.size());
+        w.UpdateTime = 0;
+        w.Updated.clear();
+    }
+}
+
+void MapUpdater::get_worker_stats(std::vector<MapUpdateWorkerStats>& stats)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_mutex);
+
+    stats.resize(m_workers.size());
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        stats[i].Node = m_workers[i].Node;
+        stats[i].Maps = m_workers[i].LastMaps;
+        stats[i].UpdateTime = m_workers[i].LastUpdateTime;
+    }
+}
+
+uint32 MapUpdater::get_rebalance_count()
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_mutex);
+    return m_rebalanceCount;
+}
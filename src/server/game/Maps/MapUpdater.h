@@ -5,9 +5,20 @@
 #include <ace/Condition_Thread_Mutex.h>
 
 #include "DelayExecutor.h"
+#include "Define.h"
+
+#include <vector>
 
 class Map;
 
+// last tick of one map update worker, affinity mode only
+struct MapUpdateWorkerStats
+{
+    int32 Node;                                             // NUMA node the worker is pinned to, -1 when not pinned
+    uint32 Maps;                                            // maps updated by the worker
+    uint64 UpdateTime;                                      // microseconds spent in Map::Update
+};
+
 class MapUpdater
 {
     public:
@@ -21,20 +32,46 @@ class MapUpdater
 
         int wait();
 
-        int activate(size_t num_threads);
+        // affinity: every map keeps its worker thread from tick to tick, workers are pinned to the cpus
+        // of a NUMA node and a map only moves when the busiest worker is rebalanceSkew percent above average
+        int activate(size_t num_threads, bool affinity = false, uint32 rebalanceSkew = 0);
 
         int deactivate();
 
         bool activated();
 
+        bool has_affinity() const { return !m_workers.empty(); }
+
+        void get_worker_stats(std::vector<MapUpdateWorkerStats>& stats);
+        uint32 get_rebalance_count();
+
     private:
 
+        struct Worker
+        {
+            Worker() : Executor(NULL), Node(-1), UpdateTime(0), LastUpdateTime(0), LastMaps(0) { }
+
+            DelayExecutor* Executor;
+            int32 Node;
+            std::vector<std::pair<Map*, uint64> > Updated;  // maps updated this tick and their cost
+            uint64 UpdateTime;
+            uint64 LastUpdateTime;
+            uint32 LastMaps;
+        };
+
         DelayExecutor m_executor;
         ACE_Thread_Mutex m_mutex;
         ACE_Condition_Thread_Mutex m_condition;
         size_t pending_requests;
 
-        void update_finished();
+        std::vector<Worker> m_workers;
+        uint32 m_rebalanceSkew;
+        uint32 m_rebalanceCount;
+
+        void update_finished(Map& map, uint32 worker, uint64 elapsed);
+
+        uint32 select_worker(Map& map);
+        void rebalance();
 };
 
 #endif //_MAP_UPDATER_H_INCLUDED
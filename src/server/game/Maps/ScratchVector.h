@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_SCRATCHVECTOR_H
+#define TRINITY_SCRATCHVECTOR_H
+
+#include "Define.h"
+#include "Errors.h"
+#include <deque>
+#include <vector>
+
+/*
+ * Vectors kept by a Map for the searches running on its update thread
+ * (spell target selection, indexed cell visits), so they keep their capacity
+ * between calls instead of going through the allocator every time.
+ *
+ * The vectors form a stack: a search started while another one is still
+ * using its vector (spell scripts, conditions, nested casts) takes the next
+ * one. A deque is used so taking a new vector never moves the ones in use.
+ */
+template<class T>
+class ScratchVectorStack
+{
+    public:
+        ScratchVectorStack() : _depth(0) { }
+
+        std::vector<T>& Acquire()
+        {
+            if (_depth == _vectors.size())
+                _vectors.push_back(std::vector<T>());
+
+            std::vector<T>& vec = _vectors[_depth++];
+            vec.clear();
+            return vec;
+        }
+
+        void Release(std::vector<T>& vec)
+        {
+            ASSERT(_depth && &_vectors[_depth - 1] == &vec);
+            vec.clear();
+            --_depth;
+        }
+
+    private:
+        ScratchVectorStack(ScratchVectorStack const&);
+        ScratchVectorStack& operator=(ScratchVectorStack const&);
+
+        std::deque<std::vector<T> > _vectors;
+        size_t _depth;
+};
+
+// takes a vector from the stack for the lifetime of the object
+template<class T>
+class ScratchVector
+{
+    public:
+        explicit ScratchVector(ScratchVectorStack<T>& stack) : _stack(stack), _vector(stack.Acquire()) { }
+        ~ScratchVector() { _stack.Release(_vector); }
+
+        std::vector<T>& Get() { return _vector; }
+
+    private:
+        ScratchVector(ScratchVector const&);
+        ScratchVector& operator=(ScratchVector const&);
+
+        ScratchVectorStack<T>& _stack;
+        std::vector<T>& _vector;
+};
+
+#endif
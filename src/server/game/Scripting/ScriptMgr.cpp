@@ -26,6 +26,7 @@
 #include "ScriptSystem.h"
 #include "Transport.h"
 #include "Vehicle.h"
+#include "TickProfiler.h"
 #include "SpellInfo.h"
 #include "SpellScript.h"
 #include "GossipDef.h"
@@ -138,6 +139,24 @@ class ScriptRegistry
         static uint32 _scriptIdCounter;
 };
 
+// Times a hook of the script until it goes out of scope, the name is only read with the profiler enabled
+template<class TScript>
+class ScriptProfileScope
+{
+    public:
+        explicit ScriptProfileScope(TScript* script) : _script(script)
+        {
+            if (TickProfiler::IsEnabled())
+                _scope.Start(TICK_PROFILE_SCRIPT, uint64(script), script->GetName().c_str());
+        }
+
+        TScript* operator->() const { return _script; }
+
+    private:
+        TScript* _script;
+        TickProfileScope _scope;
+};
+
 // Utility macros to refer to the script registry.
 #define SCR_REG_MAP(T) ScriptRegistry<T>::ScriptMap
 #define SCR_REG_ITR(T) ScriptRegistry<T>::ScriptMapIterator
@@ -154,23 +173,27 @@ class ScriptRegistry
         return R; \
     for (SCR_REG_ITR(T) C = SCR_REG_LST(T).begin(); \
         C != SCR_REG_LST(T).end(); ++C)
+// the temporary scope lives until the end of the hook call made through it
 #define FOREACH_SCRIPT(T) \
     FOR_SCRIPTS(T, itr, end) \
-    itr->second
+    ScriptProfileScope<T>(itr->second)
 
 // Utility macros for finding specific scripts.
 #define GET_SCRIPT_NO_RET(T, I, V) \
     T* V = ScriptRegistry<T>::GetScriptById(I);
 
+// the found script is profiled until the end of the hook
 #define GET_SCRIPT(T, I, V) \
     T* V = ScriptRegistry<T>::GetScriptById(I); \
     if (!V) \
-        return;
+        return; \
+    ScriptProfileScope<T> profileScope(V);
 
 #define GET_SCRIPT_RET(T, I, V, R) \
     T* V = ScriptRegistry<T>::GetScriptById(I); \
     if (!V) \
-        return R;
+        return R; \
+    ScriptProfileScope<T> profileScope(V);
 
 void DoScriptText(int32 iTextEntry, WorldObject* pSource, Unit* target)
 {
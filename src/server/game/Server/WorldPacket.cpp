@@ -33,7 +33,7 @@ void WorldPacket::Compress(z_stream* compressionStream)
     uint32 size = wpos();
     uint32 destsize = compressBound(size);
 
-    std::vector<uint8> storage(destsize);
+    StorageType storage(destsize);
 
     _compressionStream = compressionStream;
     Compress(static_cast<void*>(&storage[0]), &destsize, static_cast<const void*>(contents()), size);
@@ -42,6 +42,7 @@
 #include "SocialMgr.h"
 #include "zlib.h"
 #include "ScriptMgr.h"
+#include "TickProfiler.h"
 #include "Transport.h"
 #include "WardenWin.h"
 #include "WardenMac.h"
@@ -336,6 +337,7 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
     {
         const OpcodeHandler* opHandle = opcodeTable[WOW_CLIENT][packet->GetOpcode()];
         uint32 pktTime = getMSTime();
+        TickProfileScope profileScope(TICK_PROFILE_OPCODE, packet->GetOpcode(), opHandle->name);
 
         try
         {
@@ -1184,21 +1186,38 @@ void WorldSession::InitializeQueryCallbackParameters()
     // Callback parameters that have pointers in them should be properly
     // initialized to NULL here.
     _charCreateCallback.SetParam(NULL);
+
+    _charEnumCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_CHAR_ENUM);
+    _charCreateCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_CHAR_CREATE);
+    _charLoginCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_CHAR_LOGIN);
+    _accountSpellCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_ACCOUNT_SPELLS);
+    _addFriendCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_ADD_FRIEND);
+    _charRenameCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_CHAR_RENAME);
+    _addIgnoreCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_ADD_IGNORE);
+    _sendStabledPetCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_STABLED_PETS);
+    _setPetSlotCallback.SetCompletionQueue(&_queryCompletions, QUERY_CALLBACK_SET_PET_SLOT);
 }
 
 void WorldSession::ProcessQueryCallbacks()
 {
+    // the callbacks report to _queryCompletions when the database sets their result,
+    // a slot may still show up after its future was replaced so IsReady is checked anyway
+    if (!_queryCompletions.HasCompletions())
+        return;
+
+    uint32 completed = _queryCompletions.PopAll();
+
     PreparedQueryResult result;
 
     //! HandleCharEnumOpcode
-    if (_charEnumCallback.ready())
+    if ((completed & (1 << QUERY_CALLBACK_CHAR_ENUM)) && _charEnumCallback.IsReady())
     {
-        _charEnumCallback.get(result);
+        _charEnumCallback.GetResult(result);
         HandleCharEnum(result);
-        _charEnumCallback.cancel();
+        _charEnumCallback.FreeResult();
     }
 
-    if (_charCreateCallback.IsReady())
+    if ((completed & (1 << QUERY_CALLBACK_CHAR_CREATE)) && _charCreateCallback.IsReady())
     {
         _charCreateCallback.GetResult(result);
         HandleCharCreateCallback(result, _charCreateCallback.GetParam());
@@ -1206,18 +1225,19 @@ void WorldSession::ProcessQueryCallbacks()
     }
 
     //! HandlePlayerLoginOpcode
-    if (_charLoginCallback.ready() && _accountSpellCallback.ready())
+    if ((completed & ((1 << QUERY_CALLBACK_CHAR_LOGIN) | (1 << QUERY_CALLBACK_ACCOUNT_SPELLS))) &&
+        _charLoginCallback.IsReady() && _accountSpellCallback.IsReady())
     {
         SQLQueryHolder* param;
-        _charLoginCallback.get(param);
-        _accountSpellCallback.get(result);
+        _charLoginCallback.GetResult(param);
+        _accountSpellCallback.GetResult(result);
         HandlePlayerLogin((LoginQueryHolder*)param, result);
-        _charLoginCallback.cancel();
-        _accountSpellCallback.cancel();
+        _charLoginCallback.FreeResult();
+        _accountSpellCallback.FreeResult();
     }
 
     //! HandleAddFriendOpcode
-    if (_addFriendCallback.IsReady())
+    if ((completed & (1 << QUERY_CALLBACK_ADD_FRIEND)) && _addFriendCallback.IsReady())
     {
         std::string param = _addFriendCallback.GetParam();
         _addFriendCallback.GetResult(result);
@@ -1226,7 +1246,7 @@ void WorldSession::ProcessQueryCallbacks()
     }
 
     //- HandleCharRenameOpcode
-    if (_charRenameCallback.IsReady())
+    if ((completed & (1 << QUERY_CALLBACK_CHAR_RENAME)) && _charRenameCallback.IsReady())
     {
         std::string param = _charRenameCallback.GetParam();
         _charRenameCallback.GetResult(result);
@@ -1235,15 +1255,15 @@ void WorldSession::ProcessQueryCallbacks()
     }
 
     //- HandleCharAddIgnoreOpcode
-    if (_addIgnoreCallback.ready())
+    if ((completed & (1 << QUERY_CALLBACK_ADD_IGNORE)) && _addIgnoreCallback.IsReady())
     {
-        _addIgnoreCallback.get(result);
+        _addIgnoreCallback.GetResult(result);
         HandleAddIgnoreOpcodeCallBack(result);
-        _addIgnoreCallback.cancel();
+        _addIgnoreCallback.FreeResult();
     }
 
     //- SendStabledPet
-    if (_sendStabledPetCallback.IsReady())
+    if ((completed & (1 << QUERY_CALLBACK_STABLED_PETS)) && _sendStabledPetCallback.IsReady())
     {
         uint64 param = _sendStabledPetCallback.GetParam();
         _sendStabledPetCallback.GetResult(result);
@@ -1252,7 +1272,7 @@ void WorldSession::ProcessQueryCallbacks()
     }
 
     //- HandleStableSwapPet
-    if (_setPetSlotCallback.IsReady())
+    if ((completed & (1 << QUERY_CALLBACK_SET_PET_SLOT)) && _setPetSlotCallback.IsReady())
     {
         uint32 param = _setPetSlotCallback.GetParam();
         _setPetSlotCallback.GetResult(result);
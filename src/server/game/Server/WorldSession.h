@@ -1091,16 +1091,32 @@ class WorldSession
         void InitializeQueryCallbackParameters();
         void ProcessQueryCallbacks();
 
-        PreparedQueryResultFuture _charEnumCallback;
-        PreparedQueryResultFuture _addIgnoreCallback;
-        PreparedQueryResultFuture _accountSpellCallback;
+        enum QueryCallbackSlot
+        {
+            QUERY_CALLBACK_CHAR_ENUM,
+            QUERY_CALLBACK_CHAR_CREATE,
+            QUERY_CALLBACK_CHAR_LOGIN,
+            QUERY_CALLBACK_ACCOUNT_SPELLS,
+            QUERY_CALLBACK_ADD_FRIEND,
+            QUERY_CALLBACK_CHAR_RENAME,
+            QUERY_CALLBACK_ADD_IGNORE,
+            QUERY_CALLBACK_STABLED_PETS,
+            QUERY_CALLBACK_SET_PET_SLOT
+        };
+
+        // declared before the callbacks, they report to it until they are destroyed
+        QueryCompletionQueue _queryCompletions;
+
+        QueryCallback<PreparedQueryResult> _charEnumCallback;
+        QueryCallback<PreparedQueryResult> _addIgnoreCallback;
+        QueryCallback<PreparedQueryResult> _accountSpellCallback;
 
         QueryCallback<PreparedQueryResult, std::string> _charRenameCallback;
         QueryCallback<PreparedQueryResult, std::string> _addFriendCallback;
         QueryCallback<PreparedQueryResult, uint32> _setPetSlotCallback;
         QueryCallback<PreparedQueryResult, uint64> _sendStabledPetCallback;
         QueryCallback<PreparedQueryResult, CharacterCreateInfo*, true> _charCreateCallback;
-        QueryResultHolderFuture _charLoginCallback;
+        QueryCallback<SQLQueryHolder*> _charLoginCallback;
 
     private:
         // private trade methods
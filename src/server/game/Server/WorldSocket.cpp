@@ -831,9 +831,9 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     if (closing_)
         return -1;
 
-    // Dump received packet.
-    //if (sPacketLog->CanLogPacket())
-    //    sPacketLog->LogPacket(*new_pct, CLIENT_TO_SERVER);
+    // Dump received packet, tools/loadgen replays the client side of these captures
+    if (sPacketLog->CanLogPacket())
+        sPacketLog->LogPacket(*new_pct, CLIENT_TO_SERVER);
 
     std::string opcodeName = GetOpcodeNameForLogging(opcode, WOW_CLIENT);
     if (opcode != CMSG_PLAYER_MOVE)
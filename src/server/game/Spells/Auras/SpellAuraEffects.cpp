@@ -531,6 +531,18 @@ void AuraEffect::GetApplicationList(std::list<AuraApplication*> & applicationLis
     }
 }
 
+void AuraEffect::InvalidateTargetsAuraModifierCache() const
+{
+    AuraPtr base = GetBase();
+    if (!base)
+        return;
+
+    Aura::ApplicationMap const & targetMap = base->GetApplicationMap();
+    for (Aura::ApplicationMap::const_iterator appIter = targetMap.begin(); appIter != targetMap.end(); ++appIter)
+        if (appIter->second->HasEffect(GetEffIndex()))
+            appIter->second->GetTarget()->InvalidateAuraModifierCache(GetAuraType());
+}
+
 int32 AuraEffect::CalculateAmount(Unit* caster)
 {
     int32 amount;
@@ -1717,7 +1729,10 @@ void AuraEffect::ChangeAmount(int32 newAmount, bool mark, bool onStackOrReapply)
     if (handleMask & AURA_EFFECT_HANDLE_CHANGE_AMOUNT)
     {
         if (!mark)
+        {
             m_amount = newAmount;
+            InvalidateTargetsAuraModifierCache();
+        }
         else
             SetAmount(newAmount);
     }
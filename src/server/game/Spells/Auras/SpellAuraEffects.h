@@ -33,6 +33,7 @@ class AuraEffect : public std::enable_shared_from_this<AuraEffect>
     friend void Aura::_InitEffects(uint32 effMask, Unit* caster, int32 *baseAmount);
     friend AuraPtr Unit::_TryStackingOrRefreshingExistingAura(SpellInfo const* newAura, uint32 effMask, Unit* caster, int32* baseAmount, Item* castItem, uint64 casterGUID);
     friend Aura::~Aura();
+    friend class PooledAuraEffect;
     private:
         explicit AuraEffect(AuraPtr base, uint8 effIndex, int32 *baseAmount, Unit* caster);
     public:
@@ -48,6 +49,7 @@ class AuraEffect : public std::enable_shared_from_this<AuraEffect>
 
         void GetTargetList(std::list<Unit*> & targetList) const;
         void GetApplicationList(std::list<AuraApplication*> & applicationList) const;
+        void InvalidateTargetsAuraModifierCache() const;     // after m_amount changed, see Unit::InvalidateAuraModifierCache
         SpellModifier* GetSpellModifier() const { return m_spellmod; }
 
         SpellInfo const* GetSpellInfo() const { return m_spellInfo; }
@@ -67,6 +69,7 @@ class AuraEffect : public std::enable_shared_from_this<AuraEffect>
             {
                 m_amount = amount;
                 GetBase()->SetNeedClientUpdateForTargets();
+                InvalidateTargetsAuraModifierCache();
             }
             m_canBeRecalculated = false;
         }
@@ -36,6 +36,53 @@
 #include "ScriptMgr.h"
 #include "SpellScript.h"
 #include "Vehicle.h"
+#include "MemoryPool.h"
+
+// Aura and AuraEffect objects are allocated together with their shared_ptr control block
+// (allocate_shared) from these pools, AuraApplication through its class operator new
+static SizeClassPool& GetAuraPool()
+{
+    static SizeClassPool pool("Aura", 9, 11, 256);
+    return pool;
+}
+
+static SizeClassPool& GetAuraEffectPool()
+{
+    static SizeClassPool pool("AuraEffect", 7, 9, 512);
+    return pool;
+}
+
+static SizeClassPool& GetAuraApplicationPool()
+{
+    static SizeClassPool pool("AuraApplication", 5, 7, 512);
+    return pool;
+}
+
+// UnitAura and DynObjAura constructors are protected, allocate_shared constructs this public wrapper
+template<class AURA>
+class PooledAura : public AURA
+{
+    public:
+        PooledAura(SpellInfo const* spellproto, uint32 effMask, WorldObject* owner, Unit* caster, SpellPowerEntry const* spellPowerData, int32 *baseAmount, Item* castItem, uint64 casterGUID)
+            : AURA(spellproto, effMask, owner, caster, spellPowerData, baseAmount, castItem, casterGUID) { }
+};
+
+// same for the private AuraEffect constructor, this class is a friend of AuraEffect
+class PooledAuraEffect : public AuraEffect
+{
+    public:
+        PooledAuraEffect(AuraPtr base, uint8 effIndex, int32 *baseAmount, Unit* caster) : AuraEffect(base, effIndex, baseAmount, caster) { }
+};
+
+void* AuraApplication::operator new(size_t size)
+{
+    return GetAuraApplicationPool().Allocate(size);
+}
+
+void AuraApplication::operator delete(void* ptr, size_t size)
+{
+    GetAuraApplicationPool().Deallocate(ptr, size);
+}
 
 AuraApplication::AuraApplication(Unit* target, Unit* caster, AuraPtr aura, uint32 effMask):
 _target(target), _base(aura), _removeMode(AURA_REMOVE_NONE), _slot(MAX_AURAS),
@@ -505,14 +552,16 @@ AuraPtr Aura::Create(SpellInfo const* spellproto, uint32 effMask, WorldObject* o
     {
         case TYPEID_UNIT:
         case TYPEID_PLAYER:
-            aura = AuraPtr(new UnitAura(spellproto, effMask, owner, caster, spellPowerData, baseAmount, castItem, casterGUID));
+            aura = std::allocate_shared<PooledAura<UnitAura> >(PoolAllocator<PooledAura<UnitAura>, GetAuraPool>(),
+                spellproto, effMask, owner, caster, spellPowerData, baseAmount, castItem, casterGUID);
             aura->GetUnitOwner()->_AddAura(TO_UNITAURA(aura), caster);
             aura->LoadScripts();
             aura->_InitEffects(effMask, caster, baseAmount);
             break;
         case TYPEID_DYNAMICOBJECT:
             {
-                aura = AuraPtr(new DynObjAura(spellproto, effMask, owner, caster, spellPowerData, baseAmount, castItem, casterGUID));
+                aura = std::allocate_shared<PooledAura<DynObjAura> >(PoolAllocator<PooledAura<DynObjAura>, GetAuraPool>(),
+                    spellproto, effMask, owner, caster, spellPowerData, baseAmount, castItem, casterGUID);
 
                 auto dynowner_temp = aura->GetDynobjOwner();
 
@@ -562,7 +611,8 @@ void Aura::_InitEffects(uint32 effMask, Unit* caster, int32 *baseAmount)
     {
         if (effMask & (uint8(1) << i))
         {
-            m_effects[i] = AuraEffectPtr(new AuraEffect(shared_from_this(), i, baseAmount ? baseAmount + i : NULL, caster));
+            m_effects[i] = std::allocate_shared<PooledAuraEffect>(PoolAllocator<PooledAuraEffect, GetAuraEffectPool>(),
+                shared_from_this(), i, baseAmount ? baseAmount + i : NULL, caster);
 
             m_effects[i]->CalculatePeriodic(caster, true, false);
             m_effects[i]->SetAmount(m_effects[i]->CalculateAmount(caster));
@@ -62,6 +62,9 @@ class AuraApplication
         void _InitFlags(Unit* caster, uint32 effMask);
         void _HandleEffect(uint8 effIndex, bool apply);
     public:
+        // AuraApplication objects come from the "AuraApplication" SizeClassPool
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
 
         Unit* GetTarget() const { return _target; }
         AuraPtr GetBase() const { return std::const_pointer_cast<Aura>(_base); }
@@ -57,6 +57,7 @@
 #include "Battlefield.h"
 #include "BattlefieldMgr.h"
 #include "GuildMgr.h"
+#include "MemoryPool.h"
 
 extern pEffect SpellEffects[TOTAL_SPELL_EFFECTS];
 
@@ -602,6 +603,23 @@ m_caster((info->AttributesEx6 & SPELL_ATTR6_CAST_BY_CHARMER && caster->GetCharme
     }
 }
 
+// every cast allocates one, keep a few per thread (Spell is a bit over 2 KB)
+static SizeClassPool& GetSpellPool()
+{
+    static SizeClassPool pool("Spell", 11, 13, 64);
+    return pool;
+}
+
+void* Spell::operator new(size_t size)
+{
+    return GetSpellPool().Allocate(size);
+}
+
+void Spell::operator delete(void* ptr, size_t size)
+{
+    GetSpellPool().Deallocate(ptr, size);
+}
+
 Spell::~Spell()
 {
     // unload scripts
@@ -1124,7 +1142,9 @@ void Spell::SelectImplicitConeTargets(SpellEffIndex effIndex, SpellImplicitTarge
         ASSERT(false && "Spell::SelectImplicitConeTargets: received not implemented target reference type");
         return;
     }
-    std::list<WorldObject*> targets;
+    Map* map = m_caster->GetMap();
+    ScratchVector<WorldObject*> targetBuffer(map->GetObjectScratch());
+    std::vector<WorldObject*>& targets = targetBuffer.Get();
     SpellTargetObjectTypes objectType = targetType.GetObjectType();
     SpellTargetCheckTypes selectionType = targetType.GetCheckType();
     ConditionList* condList = m_spellInfo->Effects[effIndex].ImplicitTargetConditions;
@@ -1152,8 +1172,8 @@ void Spell::SelectImplicitConeTargets(SpellEffIndex effIndex, SpellImplicitTarge
     if (uint32 containerTypeMask = GetSearcherTypeMask(objectType, condList))
     {
         MoPCore::WorldObjectSpellConeTargetCheck check(coneAngle, radius, m_caster, m_spellInfo, selectionType, condList);
-        MoPCore::WorldObjectListSearcher<MoPCore::WorldObjectSpellConeTargetCheck> searcher(m_caster, targets, check, containerTypeMask);
-        SearchTargets<MoPCore::WorldObjectListSearcher<MoPCore::WorldObjectSpellConeTargetCheck> >(searcher, containerTypeMask, m_caster, m_caster, radius);
+        MoPCore::WorldObjectVectorSearcher<MoPCore::WorldObjectSpellConeTargetCheck> searcher(targets, check);
+        SearchTargets<MoPCore::WorldObjectVectorSearcher<MoPCore::WorldObjectSpellConeTargetCheck> >(searcher, containerTypeMask, m_caster, m_caster, radius);
 
         CallScriptObjectAreaTargetSelectHandlers(targets, effIndex);
 
@@ -1165,10 +1185,12 @@ void Spell::SelectImplicitConeTargets(SpellEffIndex effIndex, SpellImplicitTarge
 
             // for compability with older code - add only unit and go targets
             // TODO: remove this
-            std::list<Unit*> unitTargets;
-            std::list<GameObject*> gObjTargets;
+            ScratchVector<Unit*> unitBuffer(map->GetUnitScratch());
+            ScratchVector<GameObject*> gObjBuffer(map->GetGameObjectScratch());
+            std::vector<Unit*>& unitTargets = unitBuffer.Get();
+            std::vector<GameObject*>& gObjTargets = gObjBuffer.Get();
 
-            for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
+            for (std::vector<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
             {
                 if (Unit* unitTarget = (*itr)->ToUnit())
                     unitTargets.push_back(unitTarget);
@@ -1182,16 +1204,13 @@ void Spell::SelectImplicitConeTargets(SpellEffIndex effIndex, SpellImplicitTarge
                 uint8 maxSize = m_caster->HasAura(54940) ? 4 : 6; // Glyph of Light of Dawn
                 unitTargets.push_back(m_caster);
                 if (unitTargets.size() > maxSize)
-                {
-                    unitTargets.sort(MoPCore::HealthPctOrderPred());
-                    unitTargets.resize(maxSize);
-                }
+                    MoPCore::Containers::SortedResize(unitTargets, maxSize, MoPCore::HealthPctOrderPred());
             }
 
-            for (std::list<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end(); ++itr)
+            for (std::vector<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end(); ++itr)
                 AddUnitTarget(*itr, effMask, false);
 
-            for (std::list<GameObject*>::iterator itr = gObjTargets.begin(); itr != gObjTargets.end(); ++itr)
+            for (std::vector<GameObject*>::iterator itr = gObjTargets.begin(); itr != gObjTargets.end(); ++itr)
                 AddGOTarget(*itr, effMask);
         }
     }
@@ -1248,7 +1267,9 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
              ASSERT(false && "Spell::SelectImplicitAreaTargets: received not implemented target reference type");
              return;
     }
-    std::list<WorldObject*> targets;
+    Map* map = m_caster->GetMap();
+    ScratchVector<WorldObject*> targetBuffer(map->GetObjectScratch());
+    std::vector<WorldObject*>& targets = targetBuffer.Get();
     float radius = m_spellInfo->Effects[effIndex].CalcRadius(m_caster) * m_spellValue->RadiusMod;
     SearchAreaTargets(targets, radius, center, referer, targetType.GetObjectType(), targetType.GetCheckType(), m_spellInfo->Effects[effIndex].ImplicitTargetConditions);
 
@@ -1262,7 +1283,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
             CleanupTargetList();
 
             if (!targets.empty())
-                for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
+                for (std::vector<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
                     if ((*itr) && (*itr)->ToUnit())
                         if ((*itr)->GetEntry() == 60512)
                             AddUnitTarget((*itr)->ToUnit(), 1 << effIndex, false);
@@ -1275,7 +1296,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
             CleanupTargetList();
 
             if (!targets.empty())
-                for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
+                for (std::vector<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
                     if ((*itr) && (*itr)->ToUnit())
                         if ((*itr)->GetEntry() == 60583 || (*itr)->GetEntry() == 60585 || (*itr)->GetEntry() == 60586)
                             AddUnitTarget((*itr)->ToUnit(), 1 << effIndex, false);
@@ -1288,7 +1309,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
             CleanupTargetList();
 
             if (!targets.empty())
-                for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
+                for (std::vector<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
                     if ((*itr) && (*itr)->ToUnit())
                         if ((*itr)->GetEntry() == 61334 || (*itr)->GetEntry() == 61989)
                             AddUnitTarget((*itr)->ToUnit(), 1 << effIndex, false);
@@ -1301,13 +1322,15 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
 
     CallScriptObjectAreaTargetSelectHandlers(targets, effIndex);
 
-    std::list<Unit*> unitTargets;
-    std::list<GameObject*> gObjTargets;
+    ScratchVector<Unit*> unitBuffer(map->GetUnitScratch());
+    ScratchVector<GameObject*> gObjBuffer(map->GetGameObjectScratch());
+    std::vector<Unit*>& unitTargets = unitBuffer.Get();
+    std::vector<GameObject*>& gObjTargets = gObjBuffer.Get();
     // for compability with older code - add only unit and go targets
     // TODO: remove this
     if (!targets.empty())
     {
-        for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
+        for (std::vector<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
         {
             if ((*itr))
             {
@@ -1364,7 +1387,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
                 // Fire and brimstone
                 if (m_spellInfo->Id == 114654 || m_spellInfo->Id == 108685)
                 {
-                    for (std::list<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();++itr)
+                    for (std::vector<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();++itr)
                     {
                         if (IsCritForTarget((*itr)))
                             m_caster->SetPower(POWER_BURNING_EMBERS, m_caster->GetPower(POWER_BURNING_EMBERS) + 2);
@@ -1397,7 +1420,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
                     break;
 
                 // Remove targets outside caster's raid
-                for (std::list<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();)
+                for (std::vector<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();)
                 {
                     if (!(*itr)->IsInRaidWith(m_caster))
                         itr = unitTargets.erase(itr);
@@ -1418,7 +1441,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
                         // Normal case
                         if (effIndex == 1 && !m_caster->HasAura(115738))
                         {
-                            for (std::list<Unit*>::iterator itr = unitTargets.begin() ; itr != unitTargets.end();)
+                            for (std::vector<Unit*>::iterator itr = unitTargets.begin() ; itr != unitTargets.end();)
                             {
                                 bool found = false;
                                 uint8 types_i = 0;
@@ -1476,8 +1499,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
                             }
                             else
                             {
-                                unitTargets.sort(MoPCore::UnitDistanceCompareOrderPred(m_caster));
-                                Unit* victim = (*unitTargets.begin())->ToUnit();
+                                Unit* victim = *std::min_element(unitTargets.begin(), unitTargets.end(), MoPCore::UnitDistanceCompareOrderPred(m_caster));
 
                                 if (victim)
                                 {
@@ -1544,7 +1566,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
                     break;
 
                 // Remove targets outside caster's raid
-                for (std::list<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();)
+                for (std::vector<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();)
                     if (!(*itr)->IsInRaidWith(m_caster))
                         itr = unitTargets.erase(itr);
                     else
@@ -1559,31 +1581,25 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
             if (Powers(power) == POWER_HEALTH)
             {
                 if (unitTargets.size() > maxSize)
-                {
-                    unitTargets.sort(MoPCore::HealthPctOrderPred());
-                    unitTargets.resize(maxSize);
-                }
+                    MoPCore::Containers::SortedResize(unitTargets, maxSize, MoPCore::HealthPctOrderPred());
             }
             else
             {
-                for (std::list<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();)
+                for (std::vector<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end();)
                     if ((*itr)->getPowerType() != (Powers)power)
                         itr = unitTargets.erase(itr);
                     else
                         ++itr;
 
                 if (unitTargets.size() > maxSize)
-                {
-                    unitTargets.sort(MoPCore::PowerPctOrderPred((Powers)power));
-                    unitTargets.resize(maxSize);
-                }
+                    MoPCore::Containers::SortedResize(unitTargets, maxSize, MoPCore::PowerPctOrderPred((Powers)power));
             }
         }
 
         // todo: move to scripts, but we must call it before resize list by MaxAffectedTargets
         // Intimidating Shout
         if (m_spellInfo->Id == 5246 && effIndex != EFFECT_0)
-            unitTargets.remove(m_targets.GetUnitTarget());
+            unitTargets.erase(std::remove(unitTargets.begin(), unitTargets.end(), m_targets.GetUnitTarget()), unitTargets.end());
 
         // Custom MoP Script
         // 107270 / 117640 / 116847 - Spinning Crane Kick / Rushing Jade Wind : Give 1 Chi if the spell hits at least 3 targets
@@ -1610,7 +1626,9 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
         if (uint32 maxTargets = m_spellValue->MaxAffectedTargets)
             MoPCore::Containers::RandomResizeList(unitTargets, maxTargets);
 
-        for (std::list<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end(); ++itr)
+        PrefetchLineOfSight(unitTargets);
+
+        for (std::vector<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end(); ++itr)
             AddUnitTarget(*itr, effMask, false);
     }
 
@@ -1619,7 +1637,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
         if (uint32 maxTargets = m_spellValue->MaxAffectedTargets)
             MoPCore::Containers::RandomResizeList(gObjTargets, maxTargets);
 
-        for (std::list<GameObject*>::iterator itr = gObjTargets.begin(); itr != gObjTargets.end(); ++itr)
+        for (std::vector<GameObject*>::iterator itr = gObjTargets.begin(); itr != gObjTargets.end(); ++itr)
             AddGOTarget(*itr, effMask);
     }
 }
@@ -1875,14 +1893,15 @@ void Spell::SelectImplicitTrajTargets()
 
     float srcToDestDelta = m_targets.GetDstPos()->m_positionZ - m_targets.GetSrcPos()->m_positionZ;
 
-    std::list<WorldObject*> targets;
+    ScratchVector<WorldObject*> targetBuffer(m_caster->GetMap()->GetObjectScratch());
+    std::vector<WorldObject*>& targets = targetBuffer.Get();
     MoPCore::WorldObjectSpellTrajTargetCheck check(dist2d, m_targets.GetSrcPos(), m_caster, m_spellInfo);
-    MoPCore::WorldObjectListSearcher<MoPCore::WorldObjectSpellTrajTargetCheck> searcher(m_caster, targets, check, GRID_MAP_TYPE_MASK_ALL);
-    SearchTargets<MoPCore::WorldObjectListSearcher<MoPCore::WorldObjectSpellTrajTargetCheck> > (searcher, GRID_MAP_TYPE_MASK_ALL, m_caster, m_targets.GetSrcPos(), dist2d);
+    MoPCore::WorldObjectVectorSearcher<MoPCore::WorldObjectSpellTrajTargetCheck> searcher(targets, check);
+    SearchTargets<MoPCore::WorldObjectVectorSearcher<MoPCore::WorldObjectSpellTrajTargetCheck> > (searcher, GRID_MAP_TYPE_MASK_ALL, m_caster, m_targets.GetSrcPos(), dist2d);
     if (targets.empty())
         return;
 
-    targets.sort(MoPCore::ObjectDistanceOrderPred(m_caster));
+    std::stable_sort(targets.begin(), targets.end(), MoPCore::ObjectDistanceOrderPred(m_caster));
 
     float b = tangent(m_targets.GetElevation());
     float a = (srcToDestDelta - dist2d * b) / (dist2d * dist2d);
@@ -1890,7 +1909,7 @@ void Spell::SelectImplicitTrajTargets()
         a = 0;
     float bestDist = m_spellInfo->GetMaxRange(false);
 
-    std::list<WorldObject*>::const_iterator itr = targets.begin();
+    std::vector<WorldObject*>::const_iterator itr = targets.begin();
     for (; itr != targets.end(); ++itr)
     {
         if (Unit* unitTarget = (*itr)->ToUnit())
@@ -2129,16 +2148,14 @@ void Spell::SearchTargets(SEARCHER& searcher, uint32 containerMask, Unit* refere
 
         Map& map = *(referer->GetMap());
 
+        // one pass over the cell position indexes instead of walking the world and grid lists of every cell
+        uint8 mask = uint8(containerMask & CELL_INDEX_TYPE_BITS);
         if (searchInWorld)
-        {
-            TypeContainerVisitor<SEARCHER, WorldTypeMapContainer> world_object_notifier(searcher);
-            cell.Visit(p, world_object_notifier, map, radius, x, y);
-        }
+            mask |= CELL_INDEX_WORLD_CONTAINER;
         if (searchInGrid)
-        {
-            TypeContainerVisitor<SEARCHER, GridTypeMapContainer >  grid_object_notifier(searcher);
-            cell.Visit(p, grid_object_notifier, map, radius, x , y);
-        }
+            mask |= CELL_INDEX_GRID_CONTAINER;
+
+        cell.VisitIndexed(p, searcher, map, radius, x, y, mask);
     }
 }
 
@@ -2164,6 +2181,64 @@ void Spell::SearchAreaTargets(std::list<WorldObject*>& targets, float range, Pos
     SearchTargets<MoPCore::WorldObjectListSearcher<MoPCore::WorldObjectSpellAreaTargetCheck> > (searcher, containerTypeMask, m_caster, position, range);
 }
 
+void Spell::SearchAreaTargets(std::vector<WorldObject*>& targets, float range, Position const* position, Unit* referer, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectionType, ConditionList* condList)
+{
+    uint32 containerTypeMask = GetSearcherTypeMask(objectType, condList);
+    if (!containerTypeMask)
+        return;
+    MoPCore::WorldObjectSpellAreaTargetCheck check(range, position, m_caster, referer, m_spellInfo, selectionType, condList);
+    MoPCore::WorldObjectVectorSearcher<MoPCore::WorldObjectSpellAreaTargetCheck> searcher(targets, check);
+    SearchTargets<MoPCore::WorldObjectVectorSearcher<MoPCore::WorldObjectSpellAreaTargetCheck> > (searcher, containerTypeMask, m_caster, position, range);
+}
+
+// Traces the line of sight checks CheckEffectTarget is about to run on the area targets in one batch,
+// the results land in the vmap ray cache where the single checks pick them up
+void Spell::PrefetchLineOfSight(std::vector<Unit*> const& targets) const
+{
+    if (targets.size() < 2)
+        return;
+
+    if (!m_spellInfo->IsNeedAdditionalLosChecks() && (IsTriggered() || m_spellInfo->AttributesEx2 & SPELL_ATTR2_CAN_TARGET_NOT_IN_LOS))
+        return;
+
+    VMAP::IVMapManager* vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
+    if (!vMapManager->isLineOfSightCalcEnabled() || !vMapManager->getRayCacheSize())
+        return;
+
+    // same end point as CheckEffectTarget
+    float x, y, z;
+    if (m_targets.HasDst())
+        m_targets.GetDstPos()->GetPosition(x, y, z);
+    else
+    {
+        WorldObject* caster = NULL;
+        if (IS_GAMEOBJECT_GUID(m_originalCasterGUID))
+            caster = m_caster->GetMap()->GetGameObject(m_originalCasterGUID);
+        if (!caster)
+            caster = m_caster;
+        caster->GetPosition(x, y, z);
+    }
+
+    std::vector<VMAP::LineOfSightQuery> queries;
+    queries.reserve(targets.size());
+    for (std::vector<Unit*>::const_iterator itr = targets.begin(); itr != targets.end(); ++itr)
+    {
+        if (*itr == m_caster || !(*itr)->IsInWorld())
+            continue;
+
+        VMAP::LineOfSightQuery query;
+        (*itr)->GetPosition(query.From[0], query.From[1], query.From[2]);
+        query.From[2] += 2.0f;
+        query.To[0] = x;
+        query.To[1] = y;
+        query.To[2] = z + 2.0f;
+        queries.push_back(query);
+    }
+
+    if (queries.size() > 1)
+        vMapManager->isInLineOfSight(m_caster->GetMapId(), &queries[0], uint32(queries.size()));
+}
+
 void Spell::SearchChainTargets(std::list<WorldObject*>& targets, uint32 chainTargets, WorldObject* target, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectType, ConditionList* condList, bool isChainHeal)
 {
     // max dist for jump target selection
@@ -9382,6 +9457,31 @@ void Spell::CallScriptObjectAreaTargetSelectHandlers(std::list<WorldObject*>& ta
         sLog->OutSpecialLog("SpellScript [%u] take more than 15 ms to execute (%u ms)", m_spellInfo->Id, scriptExecuteTime);
 }
 
+void Spell::CallScriptObjectAreaTargetSelectHandlers(std::vector<WorldObject*>& targets, SpellEffIndex effIndex)
+{
+    // the hooks take a std::list, only build one when a script of the spell hooks this effect
+    bool hooked = false;
+    for (std::list<SpellScript*>::iterator scritr = m_loadedScripts.begin(); scritr != m_loadedScripts.end() && !hooked; ++scritr)
+    {
+        std::list<SpellScript::ObjectAreaTargetSelectHandler>::iterator hookItrEnd = (*scritr)->OnObjectAreaTargetSelect.end(), hookItr = (*scritr)->OnObjectAreaTargetSelect.begin();
+        for (; hookItr != hookItrEnd; ++hookItr)
+        {
+            if ((*hookItr).IsEffectAffected(m_spellInfo, effIndex))
+            {
+                hooked = true;
+                break;
+            }
+        }
+    }
+
+    if (!hooked)
+        return;
+
+    std::list<WorldObject*> targetList(targets.begin(), targets.end());
+    CallScriptObjectAreaTargetSelectHandlers(targetList, effIndex);
+    targets.assign(targetList.begin(), targetList.end());
+}
+
 void Spell::CallScriptObjectTargetSelectHandlers(WorldObject*& target, SpellEffIndex effIndex)
 {
     uint32 scriptExecuteTime = getMSTime();
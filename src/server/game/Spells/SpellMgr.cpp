@@ -1506,8 +1506,8 @@ void SpellMgr::LoadSpellRanks()
     {
         for (int difficulty = 0; difficulty < MAX_DIFFICULTY; difficulty++)
         {
-            if (mSpellInfoMap[difficulty][itr->first])
-                mSpellInfoMap[difficulty][itr->first]->ChainEntry = NULL;
+            if (SpellInfo* spellInfo = _GetSpellInfo(itr->first, difficulty))
+                spellInfo->ChainEntry = NULL;
         }
     }
     mSpellChains.clear();
@@ -1599,8 +1599,8 @@ void SpellMgr::LoadSpellRanks()
             mSpellChains[addedSpell].rank = itr->second;
             mSpellChains[addedSpell].prev = GetSpellInfo(prevRank);
             for (int difficulty = 0; difficulty < MAX_DIFFICULTY; difficulty++)
-                if (mSpellInfoMap[difficulty][addedSpell])
-                    mSpellInfoMap[difficulty][addedSpell]->ChainEntry = &mSpellChains[addedSpell];
+                if (SpellInfo* spellInfo = _GetSpellInfo(addedSpell, difficulty))
+                    spellInfo->ChainEntry = &mSpellChains[addedSpell];
             prevRank = addedSpell;
             ++itr;
             if (itr == rankChain.end())
@@ -3141,17 +3141,14 @@ void SpellMgr::LoadSpellInfoStore()
 
 
     UnloadSpellInfoStore();
-    for (int difficulty = 0; difficulty < MAX_DIFFICULTY; difficulty++)
-        mSpellInfoMap[difficulty].resize(sSpellStore.GetNumRows(), NULL);
+    mSpellInfoMap.resize(sSpellStore.GetNumRows(), NULL);
+    mSpellDifficultyMask.resize(sSpellStore.GetNumRows(), 0);
 
-    for (uint32 i = 0; i < sSpellStore.GetNumRows(); ++i)
+    for (std::map<uint32, std::set<uint32> >::const_iterator itr = spellDifficultyList.begin(); itr != spellDifficultyList.end(); ++itr)
     {
-        if (SpellEntry const* spellEntry = sSpellStore.LookupEntry(i))
-        {
-            std::set<uint32> difficultyInfo = spellDifficultyList[i];
-            for (std::set<uint32>::iterator itr = difficultyInfo.begin(); itr != difficultyInfo.end(); itr++)
-                mSpellInfoMap[(*itr)][i] = new SpellInfo(spellEntry, (*itr));
-        }
+        if (SpellEntry const* spellEntry = sSpellStore.LookupEntry(itr->first))
+            for (std::set<uint32>::const_iterator diff = itr->second.begin(); diff != itr->second.end(); ++diff)
+                _SetSpellInfo(itr->first, *diff, new SpellInfo(spellEntry, *diff));
     }
 
     std::set<uint32> alreadySet;
@@ -3166,7 +3163,7 @@ void SpellMgr::LoadSpellInfoStore()
 
         for (int difficulty = 0; difficulty < MAX_DIFFICULTY; difficulty++)
         {
-            SpellInfo* spell = mSpellInfoMap[difficulty][spellPower->SpellId];
+            SpellInfo* spell = _GetSpellInfo(spellPower->SpellId, difficulty);
             if (!spell)
                 continue;
 
@@ -3190,7 +3187,7 @@ void SpellMgr::LoadSpellInfoStore()
         if (!talentInfo)
             continue;
 
-        SpellInfo * spellEntry = mSpellInfoMap[REGULAR_DIFFICULTY][talentInfo->spellId];
+        SpellInfo * spellEntry = _GetSpellInfo(talentInfo->spellId, REGULAR_DIFFICULTY);
         if (spellEntry)
             spellEntry->talentId = talentInfo->Id;
     }
@@ -3200,27 +3197,25 @@ void SpellMgr::LoadSpellInfoStore()
 
 void SpellMgr::UnloadSpellInfoStore()
 {
-    for (int difficulty = 0; difficulty < MAX_DIFFICULTY; difficulty++)
-    {
-        for (uint32 i = 0; i < mSpellInfoMap[difficulty].size(); ++i)
-        {
-            if (mSpellInfoMap[difficulty][i])
-                delete mSpellInfoMap[difficulty][i];
-        }
-        mSpellInfoMap[difficulty].clear();
-    }
+    for (uint32 i = 0; i < mSpellInfoMap.size(); ++i)
+        delete mSpellInfoMap[i];
+
+    for (SpellDifficultyInfoMap::iterator itr = mSpellDifficultyInfoMap.begin(); itr != mSpellDifficultyInfoMap.end(); ++itr)
+        delete itr->second;
+
+    mSpellInfoMap.clear();
+    mSpellDifficultyInfoMap.clear();
+    mSpellDifficultyMask.clear();
 }
 
 void SpellMgr::UnloadSpellInfoImplicitTargetConditionLists()
 {
-    for (int difficulty = 0; difficulty < MAX_DIFFICULTY; difficulty++)
-    {
-        for (uint32 i = 0; i < mSpellInfoMap[difficulty].size(); ++i)
-        {
-            if (mSpellInfoMap[difficulty][i])
-                mSpellInfoMap[difficulty][i]->_UnloadImplicitTargetConditionLists();
-        }
-    }
+    for (uint32 i = 0; i < mSpellInfoMap.size(); ++i)
+        if (mSpellInfoMap[i])
+            mSpellInfoMap[i]->_UnloadImplicitTargetConditionLists();
+
+    for (SpellDifficultyInfoMap::iterator itr = mSpellDifficultyInfoMap.begin(); itr != mSpellDifficultyInfoMap.end(); ++itr)
+        itr->second->_UnloadImplicitTargetConditionLists();
 }
 
 void SpellMgr::LoadSpellCustomAttr()
@@ -3232,7 +3227,7 @@ void SpellMgr::LoadSpellCustomAttr()
     {
         for (int difficulty = 0; difficulty < MAX_DIFFICULTY; difficulty++)
         {
-            spellInfo = mSpellInfoMap[difficulty][i];
+            spellInfo = _GetSpellInfo(i, difficulty);
             if (!spellInfo)
                 continue;
 
@@ -5392,9 +5387,15 @@ void SpellMgr::LoadSpellCustomAttr()
                 case 88869: // Illustrious Grand Master Fishing
                 case 110412:// Zen Master Fishing
                 {
-                    SpellInfo* fishingDummy = new SpellInfo(sSpellStore.LookupEntry(131474), difficulty);
-                    fishingDummy->Id = spellInfo->Effects[0].TriggerSpell;
-                    mSpellInfoMap[difficulty][spellInfo->Effects[0].TriggerSpell] = fishingDummy;
+                    // only build the dummy once it can be stored
+                    uint32 triggerSpell = spellInfo->Effects[0].TriggerSpell;
+                    SpellEntry const* dummyEntry = sSpellStore.LookupEntry(131474);
+                    if (!dummyEntry || !triggerSpell || triggerSpell >= GetSpellInfoStoreSize())
+                        break;
+
+                    SpellInfo* fishingDummy = new SpellInfo(dummyEntry, difficulty);
+                    fishingDummy->Id = triggerSpell;
+                    _SetSpellInfo(triggerSpell, difficulty, fishingDummy);
                     break;
                 }
                 // Mogu'shan Vault
@@ -9048,15 +9049,56 @@ void SpellMgr::LoadTalentSpellInfo()
 
 const SpellInfo* SpellMgr::GetSpellInfo(uint32 spellId, Difficulty difficulty) const
 {
-    if (spellId < GetSpellInfoStoreSize())
+    if (spellId >= GetSpellInfoStoreSize())
+        return NULL;
+
+    // the mask keeps the common case, a spell without difficulty specific effects, off the hash map
+    if (difficulty != REGULAR_DIFFICULTY && (mSpellDifficultyMask[spellId] & (1 << difficulty)))
+        return mSpellDifficultyInfoMap.find(MAKE_PAIR64(spellId, difficulty))->second;
+
+    return mSpellInfoMap[spellId];
+}
+
+SpellInfo* SpellMgr::_GetSpellInfo(uint32 spellId, uint32 difficulty) const
+{
+    if (spellId >= GetSpellInfoStoreSize())
+        return NULL;
+
+    if (difficulty == REGULAR_DIFFICULTY)
+        return mSpellInfoMap[spellId];
+
+    if (!(mSpellDifficultyMask[spellId] & (1 << difficulty)))
+        return NULL;
+
+    return mSpellDifficultyInfoMap.find(MAKE_PAIR64(spellId, difficulty))->second;
+}
+
+void SpellMgr::_SetSpellInfo(uint32 spellId, uint32 difficulty, SpellInfo* spellInfo)
+{
+    // the store owns spellInfo from here on, a rejected one would leak
+    if (spellId >= GetSpellInfoStoreSize() || difficulty >= MAX_DIFFICULTY)
     {
-        if (mSpellInfoMap[difficulty][spellId])
-            return mSpellInfoMap[difficulty][spellId];
+        delete spellInfo;
+        return;
+    }
 
-        return mSpellInfoMap[REGULAR_DIFFICULTY][spellId];
+    if (difficulty == REGULAR_DIFFICULTY)
+    {
+        mSpellInfoMap[spellId] = spellInfo;
+        return;
     }
 
-    return NULL;
+    mSpellDifficultyInfoMap[MAKE_PAIR64(spellId, difficulty)] = spellInfo;
+    mSpellDifficultyMask[spellId] |= 1 << difficulty;
+}
+
+std::list<uint32> const& SpellMgr::GetSpellPowerList(uint32 spellId) const
+{
+    static std::list<uint32> const emptyList;
+    if (spellId >= mSpellPowerInfo.size())
+        return emptyList;
+
+    return mSpellPowerInfo[spellId];
 }
 
 void SpellMgr::LoadSpellPowerInfo()
@@ -9074,7 +9116,7 @@ void SpellMgr::LoadSpellPowerInfo()
 
 SpellPowerEntry const* SpellMgr::GetSpellPowerEntryByIdAndPower(uint32 id, Powers power) const
 {
-    for (auto itr : GetSpellPowerList(id))
+    for (auto const& itr : GetSpellPowerList(id))
     {
         SpellPowerEntry const* spellPower = sSpellPowerStore.LookupEntry(itr);
         if (!spellPower)
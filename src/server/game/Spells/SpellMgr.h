@@ -574,6 +574,8 @@ typedef std::vector<uint32> SpellCustomAttribute;
 typedef std::vector<bool> EnchantCustomAttribute;
 
 typedef std::vector<SpellInfo*> SpellInfoMap;
+// SpellInfos of the spells having difficulty specific effects, keyed by MAKE_PAIR64(spellId, difficulty)
+typedef UNORDERED_MAP<uint64, SpellInfo*> SpellDifficultyInfoMap;
 
 typedef std::map<int32, std::vector<int32> > SpellLinkedMap;
 
@@ -697,9 +699,9 @@ class SpellMgr
 
         // SpellInfo object management
         SpellInfo const* GetSpellInfo(uint32 spellId, Difficulty difficulty = REGULAR_DIFFICULTY) const;
-        uint32 GetSpellInfoStoreSize() const { return mSpellInfoMap[REGULAR_DIFFICULTY].size(); }
-        std::set<uint32> GetSpellClassList(uint8 ClassID) const { return mSpellClassInfo[ClassID]; }
-        std::list<uint32> GetSpellPowerList(uint32 spellId) const { return mSpellPowerInfo[spellId]; }
+        uint32 GetSpellInfoStoreSize() const { return mSpellInfoMap.size(); }
+        std::set<uint32> const& GetSpellClassList(uint8 ClassID) const { return mSpellClassInfo[ClassID]; }
+        std::list<uint32> const& GetSpellPowerList(uint32 spellId) const;
         std::list<uint32> const* GetSpellOverrideInfo(uint32 spellId) { return mSpellOverrideInfo.find(spellId) == mSpellOverrideInfo.end() ? NULL : &mSpellOverrideInfo[spellId]; }
 
         bool IsTalent(uint32 spellId) { return mTalentSpellInfo.find(spellId) != mTalentSpellInfo.end() ?  true :  false; }
@@ -743,6 +745,10 @@ class SpellMgr
         std::vector<uint32>        mSpellCreateItemList;
 
     private:
+        // exact entry of the difficulty, no fallback to REGULAR_DIFFICULTY
+        SpellInfo* _GetSpellInfo(uint32 spellId, uint32 difficulty) const;
+        void _SetSpellInfo(uint32 spellId, uint32 difficulty, SpellInfo* spellInfo);
+
         SpellDifficultySearcherMap mSpellDifficultySearcherMap;
         SpellChainMap              mSpellChains;
         SpellsRequiringSpellMap    mSpellsReqSpell;
@@ -770,7 +776,9 @@ class SpellMgr
         SkillLineAbilityMap        mSkillLineAbilityMap;
         PetLevelupSpellMap         mPetLevelupSpellMap;
         PetDefaultSpellsMap        mPetDefaultSpellsMap;           // only spells not listed in related mPetLevelupSpellMap entry
-        SpellInfoMap               mSpellInfoMap[MAX_DIFFICULTY];
+        SpellInfoMap               mSpellInfoMap;                  // REGULAR_DIFFICULTY, indexed by spell id
+        SpellDifficultyInfoMap     mSpellDifficultyInfoMap;        // only spells with difficulty specific effects
+        std::vector<uint16>        mSpellDifficultyMask;           // per spell id, bit set for every difficulty in mSpellDifficultyInfoMap
         SpellClassList             mSpellClassInfo;
         SpellOverrideInfo          mSpellOverrideInfo;
         TalentSpellSet             mTalentSpellInfo;
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TickProfiler.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Util.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+bool TickProfiler::_enabled = false;
+ACE_TSS<TickProfilerThreadBuffer> TickProfiler::_buffers;
+
+uint32 TickProfileHistogram::GetBucket(uint64 ns)
+{
+    if (ns < 4)
+        return uint32(ns);
+
+    uint32 exponent = 63;
+    while (!(ns >> exponent))
+        --exponent;
+
+    if (exponent >= 40)
+        return TICK_PROFILE_BUCKETS - 1;
+
+    return (exponent - 1) * 4 + uint32((ns >> (exponent - 2)) & 3);
+}
+
+uint64 TickProfileHistogram::GetBucketUpperBound(uint32 bucket)
+{
+    if (bucket < 4)
+        return bucket + 1;
+
+    uint32 exponent = bucket / 4 + 1;
+    return uint64(5 + bucket % 4) << (exponent - 2);
+}
+
+void TickProfileHistogram::Merge(TickProfileHistogram const& other)
+{
+    for (uint32 i = 0; i < TICK_PROFILE_BUCKETS; ++i)
+        _buckets[i] += other._buckets[i];
+
+    _count += other._count;
+    _total += other._total;
+    if (other._max > _max)
+        _max = other._max;
+}
+
+void TickProfileHistogram::Reset()
+{
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _total = 0;
+    _max = 0;
+}
+
+uint64 TickProfileHistogram::GetPercentile(float pct) const
+{
+    if (!_count)
+        return 0;
+
+    uint64 rank = uint64(double(_count) * pct / 100.0 + 0.5);
+    if (!rank)
+        rank = 1;
+
+    uint64 seen = 0;
+    for (uint32 i = 0; i < TICK_PROFILE_BUCKETS; ++i)
+    {
+        seen += _buckets[i];
+        if (seen >= rank)
+            return std::min(GetBucketUpperBound(i), _max);
+    }
+
+    return _max;
+}
+
+TickProfilerThreadBuffer::~TickProfilerThreadBuffer()
+{
+    if (Registered)
+        sTickProfiler->UnregisterThread(this);
+}
+
+TickProfiler::TickProfiler() : _windowStart(time(NULL)), _dumpInterval(0), _dumpTimer(0), _mergeTimer(0)
+{
+}
+
+std::string TickProfiler::GetEntryName(uint64 key, char const* name)
+{
+    uint64 id = key & UI64LIT(0x00FFFFFFFFFFFFFF);
+    char buf[256];
+
+    switch (GetCategory(key))
+    {
+        case TICK_PROFILE_MAP:
+            snprintf(buf, sizeof(buf), "%s (map %u, instance %u)", name ? name : "", uint32(id >> 32), uint32(id));
+            break;
+        case TICK_PROFILE_OPCODE:
+            snprintf(buf, sizeof(buf), "%s (0x%04X)", name ? name : "", uint32(id));
+            break;
+        case TICK_PROFILE_SMARTAI:
+            snprintf(buf, sizeof(buf), "entry %u, source_type %u", uint32(id), uint32(id >> 32));
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "%s", name ? name : "");
+            break;
+    }
+
+    return buf;
+}
+
+void TickProfiler::RegisterThread()
+{
+    TickProfilerThreadBuffer* buffer = _buffers.ts_object();
+    if (buffer && buffer->Registered)
+        return;
+
+    if (!buffer)
+    {
+        buffer = new TickProfilerThreadBuffer();
+        _buffers.ts_object(buffer);
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, _lock);
+    buffer->Registered = true;
+    _threads.push_back(buffer);
+}
+
+void TickProfiler::UnregisterThread(TickProfilerThreadBuffer* buffer)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, _lock);
+    _threads.erase(std::remove(_threads.begin(), _threads.end(), buffer), _threads.end());
+    buffer->Registered = false;
+}
+
+void TickProfiler::Merge()
+{
+    for (std::vector<TickProfilerThreadBuffer*>::const_iterator itr = _threads.begin(); itr != _threads.end(); ++itr)
+    {
+        std::vector<std::pair<uint64, TickProfileEntry*> >& dirty = (*itr)->Dirty;
+        for (size_t i = 0; i < dirty.size(); ++i)
+        {
+            TickProfileEntry& entry = *dirty[i].second;
+            TickProfileEntry& total = _totals[dirty[i].first];
+            total.Name = entry.Name;
+            total.Histogram.Merge(entry.Histogram);
+
+            entry.Histogram.Reset();
+            entry.Dirty = false;
+        }
+
+        dirty.clear();
+    }
+}
+
+void TickProfiler::Update(uint32 diff)
+{
+    bool dump = false;
+    if (_dumpInterval)
+    {
+        _dumpTimer += diff;
+        dump = _dumpTimer >= _dumpInterval;
+    }
+
+    // a merge costs a histogram per entry sampled since the last one, the thread buffers keep adding up in between
+    _mergeTimer += diff;
+    if (_mergeTimer >= TICK_PROFILE_MERGE_INTERVAL || dump)
+    {
+        _mergeTimer = 0;
+        ACE_GUARD(ACE_Thread_Mutex, guard, _lock);
+        Merge();
+    }
+
+    if (!dump)
+        return;
+
+    _dumpTimer = 0;
+    if (Dump())
+        Reset();
+}
+
+namespace
+{
+    bool CompareTotalTime(TickProfiler::Total const& left, TickProfiler::Total const& right)
+    {
+        return left.Histogram.GetTotal() > right.Histogram.GetTotal();
+    }
+}
+
+uint32 TickProfiler::GetTotals(TickProfileCategory category, uint32 count, std::vector<Total>& totals)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, _lock, 0);
+
+    for (TickProfileEntryMap::const_iterator itr = _totals.begin(); itr != _totals.end(); ++itr)
+    {
+        if (GetCategory(itr->first) != category)
+            continue;
+
+        Total total;
+        total.Key = itr->first;
+        total.Name = itr->second.Name;
+        total.Histogram = itr->second.Histogram;
+        totals.push_back(total);
+    }
+
+    std::sort(totals.begin(), totals.end(), CompareTotalTime);
+    if (totals.size() > count)
+        totals.resize(count);
+
+    return uint32(time(NULL) - _windowStart);
+}
+
+void TickProfiler::Reset()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, _lock);
+    _totals.clear();
+    _windowStart = time(NULL);
+}
+
+bool TickProfiler::Dump()
+{
+    if (_dumpFile.empty())
+        return false;
+
+    FILE* file = fopen(_dumpFile.c_str(), "a");
+    if (!file)
+    {
+        sLog->outError(LOG_FILTER_GENERAL, "TickProfiler: can't open %s for writing", _dumpFile.c_str());
+        return false;
+    }
+
+    static char const* categoryNames[MAX_TICK_PROFILE_CATEGORY] = { "map", "opcode", "script", "smartai" };
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, _lock, false);
+
+    time_t now = time(NULL);
+    fprintf(file, "# %s, %u seconds\n", TimeToTimestampStr(now).c_str(), uint32(now - _windowStart));
+    fprintf(file, "# category;name;calls;total us;avg us;p50 us;p95 us;p99 us;max us\n");
+
+    for (TickProfileEntryMap::const_iterator itr = _totals.begin(); itr != _totals.end(); ++itr)
+    {
+        TickProfileHistogram const& histogram = itr->second.Histogram;
+        if (!histogram.GetCount())
+            continue;
+
+        fprintf(file, "%s;%s;" UI64FMTD ";" UI64FMTD ";" UI64FMTD ";" UI64FMTD ";" UI64FMTD ";" UI64FMTD ";" UI64FMTD "\n",
+            categoryNames[GetCategory(itr->first)], GetEntryName(itr->first, itr->second.Name).c_str(), histogram.GetCount(),
+            histogram.GetTotal() / 1000, histogram.GetTotal() / histogram.GetCount() / 1000,
+            histogram.GetPercentile(50.0f) / 1000, histogram.GetPercentile(95.0f) / 1000, histogram.GetPercentile(99.0f) / 1000,
+            histogram.GetMax() / 1000);
+    }
+
+    fclose(file);
+    return true;
+}
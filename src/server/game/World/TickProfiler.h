@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_TICKPROFILER_H
+#define TRINITY_TICKPROFILER_H
+
+#include "Define.h"
+#include "UnorderedMap.h"
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/TSS_T.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+enum TickProfileCategory
+{
+    TICK_PROFILE_MAP            = 0,                        // Map::Update, id is map id << 32 | instance id
+    TICK_PROFILE_OPCODE         = 1,                        // WorldSession::Update packet handlers, id is the opcode
+    TICK_PROFILE_SCRIPT         = 2,                        // ScriptMgr hooks, id is the script object
+    TICK_PROFILE_SMARTAI        = 3,                        // SmartScript updates and events, id is source type << 32 | owner entry
+    MAX_TICK_PROFILE_CATEGORY
+};
+
+// script hooks and SmartAI scripts run per object and tick, only about one call in TICK_PROFILE_SAMPLE_RATE is timed
+#define TICK_PROFILE_SAMPLE_RATE 64
+
+// time in ms between merging the thread buffers into the totals
+#define TICK_PROFILE_MERGE_INTERVAL 1000
+
+// 4 buckets per power of two of nanoseconds, the last one ends at 2^40 ns (about 18 minutes)
+#define TICK_PROFILE_BUCKETS 156
+
+// Log scale histogram of nanosecond durations, percentiles are exact up to a quarter of their power of two
+class TickProfileHistogram
+{
+    public:
+        TickProfileHistogram() { Reset(); }
+
+        // weight: number of calls the sample stands for
+        void Add(uint64 ns, uint32 weight)
+        {
+            _buckets[GetBucket(ns)] += weight;
+            _count += weight;
+            _total += ns * weight;
+            if (ns > _max)
+                _max = ns;
+        }
+
+        void Merge(TickProfileHistogram const& other);
+        void Reset();
+
+        uint64 GetCount() const { return _count; }
+        uint64 GetTotal() const { return _total; }
+        uint64 GetMax() const { return _max; }
+
+        // upper bound in ns of the bucket holding the pct percentile, pct in [0, 100]
+        uint64 GetPercentile(float pct) const;
+
+    private:
+        static uint32 GetBucket(uint64 ns);
+        static uint64 GetBucketUpperBound(uint32 bucket);
+
+        uint32 _buckets[TICK_PROFILE_BUCKETS];
+        uint64 _count;
+        uint64 _total;
+        uint64 _max;
+};
+
+struct TickProfileEntry
+{
+    TickProfileEntry() : Name(NULL), Dirty(false) { }
+
+    char const* Name;                                       // map, opcode or script name, lives as long as the process
+    bool Dirty;                                             // sampled since the last merge
+    TickProfileHistogram Histogram;
+};
+
+typedef UNORDERED_MAP<uint64, TickProfileEntry> TickProfileEntryMap;
+
+// samples of one thread, only written by that thread and only read while it runs no profiled code
+struct TickProfilerThreadBuffer
+{
+    TickProfilerThreadBuffer() : Registered(false), CurrentKey(0), SampleCountdown(1), SampleInterval(1), SampleSeed(2463534242u) { }
+    ~TickProfilerThreadBuffer();
+
+    void Record(uint64 key, char const* name, uint64 ns, uint32 weight)
+    {
+        TickProfileEntry& entry = Entries[key];
+        if (!entry.Dirty)
+        {
+            entry.Dirty = true;
+            entry.Name = name;
+            Dirty.push_back(std::make_pair(key, &entry));
+        }
+
+        entry.Histogram.Add(ns, weight);
+    }
+
+    // the calls since the previous sample, which the new one stands for. The next interval is random (xorshift) so
+    // a map with a multiple of the rate of scripted objects does not always time the same ones
+    uint32 NextSample()
+    {
+        uint32 weight = SampleInterval;
+        SampleSeed ^= SampleSeed << 13;
+        SampleSeed ^= SampleSeed >> 17;
+        SampleSeed ^= SampleSeed << 5;
+        SampleInterval = TICK_PROFILE_SAMPLE_RATE / 2 + SampleSeed % TICK_PROFILE_SAMPLE_RATE;
+        SampleCountdown = SampleInterval;
+        return weight;
+    }
+
+    bool Registered;
+    uint64 CurrentKey;                                      // innermost running scope, 0 for none
+    uint32 SampleCountdown;                                 // script and SmartAI calls until the next timed one
+    uint32 SampleInterval;
+    uint32 SampleSeed;
+    TickProfileEntryMap Entries;
+    std::vector<std::pair<uint64, TickProfileEntry*> > Dirty;
+};
+
+/*
+ * Always on scoped timers for the world tick. TickProfileScope objects in
+ * Map::Update, the WorldSession packet handlers, the ScriptMgr hooks and
+ * SmartScript add their duration to a histogram in a buffer of the running
+ * thread, without any locking. Only the world thread and the map update
+ * threads register a buffer, scopes on other threads are not sampled.
+ *
+ * Every second, after the map update threads finished, the world thread merges
+ * the samples of every buffer into the totals shown by .debug profile, and every
+ * Profiler.DumpInterval the totals are appended to Profiler.DumpFile and reset.
+ * Timings are inclusive: a script hook called from a packet handler counts for both.
+ * Map updates and packet handlers are all timed, script hooks and SmartAI scripts
+ * are sampled (TICK_PROFILE_SAMPLE_RATE), their call counts and totals are estimates.
+ */
+class TickProfiler
+{
+    friend class ACE_Singleton<TickProfiler, ACE_Null_Mutex>;
+    TickProfiler();
+
+    public:
+        struct Total
+        {
+            uint64 Key;
+            char const* Name;
+            TickProfileHistogram Histogram;
+        };
+
+        static bool IsEnabled() { return _enabled; }
+        static uint64 MakeKey(TickProfileCategory category, uint64 id) { return (uint64(category + 1) << 56) | (id & UI64LIT(0x00FFFFFFFFFFFFFF)); }
+        static TickProfileCategory GetCategory(uint64 key) { return TickProfileCategory((key >> 56) - 1); }
+        static std::string GetEntryName(uint64 key, char const* name);
+
+        // NULL if the thread is not sampled
+        static TickProfilerThreadBuffer* GetThreadBuffer()
+        {
+            TickProfilerThreadBuffer* buffer = _buffers.ts_object();
+            return buffer && buffer->Registered ? buffer : NULL;
+        }
+
+        void SetEnabled(bool enabled) { _enabled = enabled; }
+        void SetDumpInterval(uint32 interval) { _dumpInterval = interval; }
+        void SetDumpFile(std::string const& file) { _dumpFile = file; }
+
+        // samples the calling thread from now on, safe to call again
+        void RegisterThread();
+        void UnregisterThread(TickProfilerThreadBuffer* buffer);
+
+        // world thread, while no map is updated
+        void Update(uint32 diff);
+
+        // entries of the category ordered by total time, at most count, and the length of the window in seconds
+        uint32 GetTotals(TickProfileCategory category, uint32 count, std::vector<Total>& totals);
+        void Reset();
+        bool Dump();
+
+    private:
+        void Merge();
+
+        static bool _enabled;
+        static ACE_TSS<TickProfilerThreadBuffer> _buffers;
+
+        ACE_Thread_Mutex _lock;                             // thread list and totals, never taken by a scope
+        std::vector<TickProfilerThreadBuffer*> _threads;
+        TickProfileEntryMap _totals;
+        time_t _windowStart;
+        uint32 _dumpInterval;
+        uint32 _dumpTimer;
+        uint32 _mergeTimer;
+        std::string _dumpFile;
+};
+
+#define sTickProfiler ACE_Singleton<TickProfiler, ACE_Null_Mutex>::instance()
+
+// Times the rest of the enclosing block into the thread buffer, a scope with the
+// same key as the innermost running one (recursion) is left to that one
+class TickProfileScope
+{
+    public:
+        TickProfileScope(TickProfileCategory category, uint64 id, char const* name) : _buffer(NULL)
+        {
+            if (TickProfiler::IsEnabled())
+                Start(category, id, name);
+        }
+
+        // not timing until Start(), for callers that only compute the key when the profiler is enabled
+        TickProfileScope() : _buffer(NULL) { }
+
+        ~TickProfileScope()
+        {
+            if (!_buffer)
+                return;
+
+            uint64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+            _buffer->Record(_key, _name, ns, _weight);
+            _buffer->CurrentKey = _parentKey;
+        }
+
+        void Start(TickProfileCategory category, uint64 id, char const* name)
+        {
+            TickProfilerThreadBuffer* buffer = TickProfiler::GetThreadBuffer();
+            if (!buffer)
+                return;
+
+            uint64 key = TickProfiler::MakeKey(category, id);
+            if (buffer->CurrentKey == key)
+                return;
+
+            uint32 weight = 1;
+            if (category >= TICK_PROFILE_SCRIPT)
+            {
+                if (--buffer->SampleCountdown)
+                    return;
+
+                weight = buffer->NextSample();
+            }
+
+            _buffer = buffer;
+            _weight = weight;
+            _key = key;
+            _name = name;
+            _parentKey = buffer->CurrentKey;
+            buffer->CurrentKey = key;
+            _start = std::chrono::steady_clock::now();
+        }
+
+    private:
+        TickProfileScope(TickProfileScope const&);
+        TickProfileScope& operator=(TickProfileScope const&);
+
+        TickProfilerThreadBuffer* _buffer;
+        uint64 _key;
+        uint64 _parentKey;
+        char const* _name;
+        uint32 _weight;
+        std::chrono::steady_clock::time_point _start;
+};
+
+#endif
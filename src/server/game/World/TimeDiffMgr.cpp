@@ -12,6 +12,9 @@ void TimeDiffMgr::Initialize()
         m_prevLog[i].Average = 0;
         m_prevLog[i].Max = 0;
         m_prevLog[i].Players = 0;
+        m_prevLog[i].P50 = 0;
+        m_prevLog[i].P95 = 0;
+        m_prevLog[i].P99 = 0;
     }
 }
 
@@ -20,49 +23,40 @@ void TimeDiffMgr::InitTimer(UpdateTimeLogInterval interval)
     if (interval >= INTERVAL_MAX)
         return;
 
-    m_worldSum[interval] = 0;
-    m_worldCount[interval] = 0;
-    m_worldMax[interval] = 0;
+    m_worldDiffs[interval].Reset();
     m_worldUpdate[interval] = getMSTime();
 }
 
+void TimeDiffMgr::CloseInterval(UpdateTimeLogInterval interval)
+{
+    LatencyHistogram const& diffs = m_worldDiffs[interval];
+    m_prevLog[interval].Average = diffs.GetAverage();
+    m_prevLog[interval].Max = diffs.GetMax();
+    m_prevLog[interval].Players = sWorld->GetActiveSessionCount();
+    m_prevLog[interval].P50 = diffs.GetPercentile(50.0f);
+    m_prevLog[interval].P95 = diffs.GetPercentile(95.0f);
+    m_prevLog[interval].P99 = diffs.GetPercentile(99.0f);
+    InitTimer(interval);
+}
+
 void TimeDiffMgr::Update(uint32 diff)
 {
     for (uint32 i = 0; i < INTERVAL_MAX; ++i)
-    {
-        if (diff > m_worldMax[i])
-            m_worldMax[i] = diff;
-
-        ++m_worldCount[i];
-        m_worldSum[i] += diff;
-    }
+        m_worldDiffs[i].Add(diff);
 
     if (GetMSTimeDiffToNow(m_worldUpdate[INTERVAL_1_MINUTE]) >= MINUTE * IN_MILLISECONDS)
     {
-        m_prevLog[INTERVAL_1_MINUTE].Average = m_worldSum[INTERVAL_1_MINUTE] / m_worldCount[INTERVAL_1_MINUTE];
-        m_prevLog[INTERVAL_1_MINUTE].Max = m_worldMax[INTERVAL_1_MINUTE];
-        m_prevLog[INTERVAL_1_MINUTE].Players = sWorld->GetActiveSessionCount();
-        InitTimer(INTERVAL_1_MINUTE);
+        CloseInterval(INTERVAL_1_MINUTE);
 
+        PerfLog const& log = m_prevLog[INTERVAL_1_MINUTE];
         CharacterDatabase.PExecute(
-            "INSERT INTO time_diff_log (time, average, max, players) VALUES (UNIX_TIMESTAMP(), %u, %u, %u)",
-            m_prevLog[INTERVAL_1_MINUTE].Average, m_prevLog[INTERVAL_1_MINUTE].Max,
-            m_prevLog[INTERVAL_1_MINUTE].Players);
+            "INSERT INTO time_diff_log (time, average, max, players, p50, p95, p99) VALUES (UNIX_TIMESTAMP(), %u, %u, %u, %u, %u, %u)",
+            log.Average, log.Max, log.Players, log.P50, log.P95, log.P99);
     }
 
     if (GetMSTimeDiffToNow(m_worldUpdate[INTERVAL_5_MINUTE]) >= 5 * MINUTE * IN_MILLISECONDS)
-    {
-        m_prevLog[INTERVAL_5_MINUTE].Average = m_worldSum[INTERVAL_5_MINUTE] / m_worldCount[INTERVAL_5_MINUTE];
-        m_prevLog[INTERVAL_5_MINUTE].Max = m_worldMax[INTERVAL_5_MINUTE];
-        m_prevLog[INTERVAL_5_MINUTE].Players = sWorld->GetActiveSessionCount();
-        InitTimer(INTERVAL_5_MINUTE);
-    }
+        CloseInterval(INTERVAL_5_MINUTE);
 
     if (GetMSTimeDiffToNow(m_worldUpdate[INTERVAL_15_MINUTE]) >= 15 * MINUTE * IN_MILLISECONDS)
-    {
-        m_prevLog[INTERVAL_15_MINUTE].Average = m_worldSum[INTERVAL_15_MINUTE] / m_worldCount[INTERVAL_15_MINUTE];
-        m_prevLog[INTERVAL_15_MINUTE].Max = m_worldMax[INTERVAL_15_MINUTE];
-        m_prevLog[INTERVAL_15_MINUTE].Players = sWorld->GetActiveSessionCount();
-        InitTimer(INTERVAL_15_MINUTE);
-    }
+        CloseInterval(INTERVAL_15_MINUTE);
 }
@@ -3,6 +3,7 @@
 
 #include <ace/Singleton.h>
 #include "Common.h"
+#include "LatencyHistogram.h"
 
 enum UpdateTimeLogInterval
 {
@@ -18,6 +19,9 @@ struct PerfLog
     uint32 Average;
     uint32 Max;
     uint32 Players;
+    uint32 P50;                                             // tick time percentiles, ms
+    uint32 P95;
+    uint32 P99;
 };
 
 class TimeDiffMgr
@@ -30,10 +34,9 @@ public:
 
 private:
     void InitTimer(UpdateTimeLogInterval interval);
-    uint32 m_worldCount[INTERVAL_MAX];
-    uint32 m_worldSum[INTERVAL_MAX];
+    void CloseInterval(UpdateTimeLogInterval interval);
     uint32 m_worldUpdate[INTERVAL_MAX];
-    uint32 m_worldMax[INTERVAL_MAX];
+    LatencyHistogram m_worldDiffs[INTERVAL_MAX];
     PerfLog m_prevLog[INTERVAL_MAX];
 };
 
@@ -21,6 +21,8 @@
 */
 
 #include "AnticheatMgr.h"
+#include "TickProfiler.h"
+#include "MemoryPool.h"
 #include "Common.h"
 #include "DatabaseEnv.h"
 #include "Config.h"
@@ -96,6 +98,8 @@ int32 World::m_visibility_notify_periodInBGArenas   = DEFAULT_VISIBILITY_NOTIFY_
 
 float World::Visibility_RelocationLowerLimit = 20.0f;
 uint32 World::Visibility_AINotifyDelay = 1000;
+uint32 World::Visibility_RelocationNotifyInterval = 100;
+float World::Visibility_RelocationShareDistance = 10.0f;
 
 /// World constructor
 World::World()
@@ -1022,6 +1026,7 @@ void World::LoadConfigSettings(bool reload)
     m_int_configs[CONFIG_CHATFLOOD_PRIVATE_MESSAGE_DELAY] = ConfigMgr::GetIntDefault("ChatFlood.PrivateMessageMessageDelay", 1);
 
     m_int_configs[CONFIG_EVENT_ANNOUNCE] = ConfigMgr::GetIntDefault("Event.Announce", 0);
+    m_int_configs[CONFIG_GAME_EVENT_SPAWN_BUDGET] = ConfigMgr::GetIntDefault("GameEvent.SpawnBudget", 5);
 
     m_float_configs[CONFIG_CREATURE_FAMILY_FLEE_ASSISTANCE_RADIUS] = ConfigMgr::GetFloatDefault("CreatureFamilyFleeAssistanceRadius", 30.0f);
     m_float_configs[CONFIG_CREATURE_FAMILY_ASSISTANCE_RADIUS] = ConfigMgr::GetFloatDefault("CreatureFamilyAssistanceRadius", 10.0f);
@@ -1074,6 +1079,18 @@ void World::LoadConfigSettings(bool reload)
 
     m_float_configs[CONFIG_THREAT_RADIUS] = ConfigMgr::GetFloatDefault("ThreatRadius", 60.0f);
 
+    m_bool_configs[CONFIG_CREATURE_UPDATE_LOD] = ConfigMgr::GetBoolDefault("CreatureUpdate.LOD.Enable", true);
+    m_float_configs[CONFIG_CREATURE_UPDATE_LOD_NEAR_DISTANCE] = ConfigMgr::GetFloatDefault("CreatureUpdate.LOD.NearDistance", 40.0f);
+    m_float_configs[CONFIG_CREATURE_UPDATE_LOD_FAR_DISTANCE] = ConfigMgr::GetFloatDefault("CreatureUpdate.LOD.FarDistance", DEFAULT_VISIBILITY_DISTANCE);
+    if (m_float_configs[CONFIG_CREATURE_UPDATE_LOD_FAR_DISTANCE] < m_float_configs[CONFIG_CREATURE_UPDATE_LOD_NEAR_DISTANCE])
+    {
+        sLog->outError(LOG_FILTER_SERVER_LOADING, "CreatureUpdate.LOD.FarDistance (%f) must be >= CreatureUpdate.LOD.NearDistance (%f), set to %f.",
+            m_float_configs[CONFIG_CREATURE_UPDATE_LOD_FAR_DISTANCE], m_float_configs[CONFIG_CREATURE_UPDATE_LOD_NEAR_DISTANCE], m_float_configs[CONFIG_CREATURE_UPDATE_LOD_NEAR_DISTANCE]);
+        m_float_configs[CONFIG_CREATURE_UPDATE_LOD_FAR_DISTANCE] = m_float_configs[CONFIG_CREATURE_UPDATE_LOD_NEAR_DISTANCE];
+    }
+    m_int_configs[CONFIG_CREATURE_UPDATE_LOD_NEAR_INTERVAL] = ConfigMgr::GetIntDefault("CreatureUpdate.LOD.NearInterval", 300);
+    m_int_configs[CONFIG_CREATURE_UPDATE_LOD_FAR_INTERVAL] = ConfigMgr::GetIntDefault("CreatureUpdate.LOD.FarInterval", 1000);
+
     // always use declined names in the russian client
     m_bool_configs[CONFIG_DECLINED_NAMES_USED] =
         (m_int_configs[CONFIG_REALM_ZONE] == REALM_ZONE_RUSSIAN) ? true : ConfigMgr::GetBoolDefault("DeclinedNames", false);
@@ -1141,6 +1158,10 @@ void World::LoadConfigSettings(bool reload)
 
     Visibility_RelocationLowerLimit = ConfigMgr::GetFloatDefault("Visibility.RelocationLowerLimit", 20.f);
     Visibility_AINotifyDelay = ConfigMgr::GetFloatDefault("Visibility.AINotifyDelay", 1000);
+    Visibility_RelocationNotifyInterval = ConfigMgr::GetIntDefault("Visibility.RelocationNotifyInterval", 100);
+    Visibility_RelocationShareDistance = ConfigMgr::GetFloatDefault("Visibility.RelocationShareDistance", 10.0f);
+    if (Visibility_RelocationShareDistance < 0.0f)
+        Visibility_RelocationShareDistance = 0.0f;
 
     //visibility in instances
     m_MaxVisibleDistanceInInstances = ConfigMgr::GetFloatDefault("Visibility.Distance.Instances", DEFAULT_VISIBILITY_INSTANCE);
@@ -1210,6 +1231,7 @@ void World::LoadConfigSettings(bool reload)
     bool enableLOS = ConfigMgr::GetBoolDefault("vmap.enableLOS", true);
     bool enableHeight = ConfigMgr::GetBoolDefault("vmap.enableHeight", true);
     bool enablePetLOS = ConfigMgr::GetBoolDefault("vmap.petLOS", true);
+    int32 rayCacheSize = ConfigMgr::GetIntDefault("vmap.rayCacheSize", 1024);
     std::string ignoreSpellIds = ConfigMgr::GetStringDefault("vmap.ignoreSpellIds", "");
 
     if (!enableHeight)
@@ -1217,6 +1239,7 @@ void World::LoadConfigSettings(bool reload)
 
     VMAP::VMapFactory::createOrGetVMapManager()->setEnableLineOfSightCalc(enableLOS);
     VMAP::VMapFactory::createOrGetVMapManager()->setEnableHeightCalc(enableHeight);
+    VMAP::VMapFactory::createOrGetVMapManager()->setRayCacheSize(rayCacheSize > 0 ? uint32(rayCacheSize) : 0);
     //VMAP::VMapFactory::preventSpellsFromBeingTestedForLoS(ignoreSpellIds.c_str());
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, "VMap support included. LineOfSight:%i, getHeight:%i, indoorCheck:%i PetLOS:%i", enableLOS, enableHeight, enableIndoor, enablePetLOS);
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, "VMap data directory is: %svmaps", m_dataPath.c_str());
@@ -1243,6 +1266,24 @@ void World::LoadConfigSettings(bool reload)
     m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = ConfigMgr::GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_int_configs[CONFIG_MIN_LOG_UPDATE] = ConfigMgr::GetIntDefault("MinRecordUpdateTimeDiff", 100);
     m_int_configs[CONFIG_NUMTHREADS] = ConfigMgr::GetIntDefault("MapUpdate.Threads", 1);
+    m_bool_configs[CONFIG_MAP_UPDATE_AFFINITY] = ConfigMgr::GetBoolDefault("MapUpdate.Affinity", false);
+    m_int_configs[CONFIG_MAP_UPDATE_AFFINITY_SKEW] = ConfigMgr::GetIntDefault("MapUpdate.Affinity.RebalanceSkew", 50);
+
+    m_bool_configs[CONFIG_TICK_PROFILER] = ConfigMgr::GetBoolDefault("Profiler.Enable", true);
+    m_int_configs[CONFIG_TICK_PROFILER_DUMP_INTERVAL] = ConfigMgr::GetIntDefault("Profiler.DumpInterval", 300) * IN_MILLISECONDS;
+    sTickProfiler->SetEnabled(m_bool_configs[CONFIG_TICK_PROFILER]);
+    sTickProfiler->SetDumpInterval(m_int_configs[CONFIG_TICK_PROFILER_DUMP_INTERVAL]);
+
+    std::string profileFile = ConfigMgr::GetStringDefault("Profiler.DumpFile", "TickProfile.log");
+    if (!profileFile.empty())
+    {
+        std::string logsDir = ConfigMgr::GetStringDefault("LogsDir", "");
+        if (!logsDir.empty() && logsDir[logsDir.length() - 1] != '/' && logsDir[logsDir.length() - 1] != '\\')
+            logsDir.push_back('/');
+        profileFile = logsDir + profileFile;
+    }
+    sTickProfiler->SetDumpFile(profileFile);
+
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = ConfigMgr::GetIntDefault("Command.LookupMaxResults", 0);
 
     // chat logging
@@ -1368,7 +1409,10 @@ void World::LoadConfigSettings(bool reload)
     m_int_configs[CONFIG_ANTISPAM_MAIL_COUNT] = ConfigMgr::GetIntDefault("Antispam.Mail.Count", 10);
 
     if (reload)
+    {
+        CompileLootTables();                                // drop rates are compiled into the loot tables
         sScriptMgr->OnConfigLoad(reload);
+    }
 }
 
 extern void LoadGameObjectModelList();
@@ -2520,6 +2564,8 @@ void World::Update(uint32 diff)
     ProcessCliCommands();
 
     sTimeDiffMgr->Update(diff);
+    sTickProfiler->Update(diff);                            // no map is updated here
+    SizeClassPool::FlushAllThreadStats();
 
     sScriptMgr->OnWorldUpdate(diff);
 }
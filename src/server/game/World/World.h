@@ -206,6 +206,9 @@ enum WorldBoolConfigs
     CONFIG_VIP_EXCHANGE_FROST_COMMAND,
     CONFIG_ANTISPAM_ENABLED,
     CONFIG_DISABLE_RESTART,
+    CONFIG_CREATURE_UPDATE_LOD,
+    CONFIG_MAP_UPDATE_AFFINITY,
+    CONFIG_TICK_PROFILER,
     BOOL_CONFIG_VALUE_COUNT
 };
 
@@ -226,6 +229,8 @@ enum WorldFloatConfigs
     CONFIG_STATS_LIMITS_PARRY,
     CONFIG_STATS_LIMITS_BLOCK,
     CONFIG_STATS_LIMITS_CRIT,
+    CONFIG_CREATURE_UPDATE_LOD_NEAR_DISTANCE,
+    CONFIG_CREATURE_UPDATE_LOD_FAR_DISTANCE,
     FLOAT_CONFIG_VALUE_COUNT
 };
 
@@ -393,6 +398,11 @@ enum WorldIntConfigs
     CONFIG_ANTISPAM_MAIL_TIMER,
     CONFIG_ANTISPAM_MAIL_COUNT,
     CONFIG_AUTO_SERVER_RESTART_HOUR,
+    CONFIG_CREATURE_UPDATE_LOD_NEAR_INTERVAL,
+    CONFIG_CREATURE_UPDATE_LOD_FAR_INTERVAL,
+    CONFIG_MAP_UPDATE_AFFINITY_SKEW,
+    CONFIG_GAME_EVENT_SPAWN_BUDGET,
+    CONFIG_TICK_PROFILER_DUMP_INTERVAL,
     INT_CONFIG_VALUE_COUNT
 };
 
@@ -833,6 +843,8 @@ class World
 
         static float Visibility_RelocationLowerLimit;
         static uint32 Visibility_AINotifyDelay;
+        static uint32 Visibility_RelocationNotifyInterval;
+        static float Visibility_RelocationShareDistance;
 
         void ProcessCliCommands();
         void QueueCliCommand(CliCommandHolder* commandHolder) { cliCmdQueue.add(commandHolder); }
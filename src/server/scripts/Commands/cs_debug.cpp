@@ -32,9 +32,110 @@ EndScriptData */
 #include "GridNotifiersImpl.h"
 #include "GossipDef.h"
 #include "MapManager.h"
+#include "MemoryPool.h"
+#include "EventProcessor.h"
+#include "Threading.h"
+#include "VMapFactory.h"
+#include "VMapManager2.h"
+#include "BoundingIntervalHierarchy.h"
+#include "Spell.h"
+#include "SpellMgr.h"
+#include "LootMgr.h"
+#include "TickProfiler.h"
 
 #include <fstream>
 
+// runs the line of sight checks of .debug vmaplos on one thread
+class VMapLosBenchWorker : public ACE_Based::Runnable
+{
+    public:
+        VMapLosBenchWorker(uint32 mapId, std::vector<float> const& points, uint32 queries, uint32 offset)
+            : _mapId(mapId), _points(points), _queries(queries), _offset(offset), InLineOfSight(0) { }
+
+        void run()
+        {
+            VMAP::IVMapManager* vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
+            uint32 pairs = uint32(_points.size() / 6);
+            for (uint32 i = 0; i < _queries; ++i)
+            {
+                float const* p = &_points[((i + _offset) % pairs) * 6];
+                if (vMapManager->isInLineOfSight(_mapId, p[0], p[1], p[2], p[3], p[4], p[5]))
+                    ++InLineOfSight;
+            }
+        }
+
+    private:
+        uint32 _mapId;
+        std::vector<float> const& _points;
+        uint32 _queries;
+        uint32 _offset;
+
+    public:
+        uint32 InLineOfSight;
+};
+
+// synthetic scene of .debug bihpacket, boxes stand in for the model instances of a map
+struct BihBenchBounds
+{
+    void operator()(G3D::AABox const& box, G3D::AABox& out) const { out = box; }
+};
+
+struct BihBenchCallback
+{
+    BihBenchCallback(std::vector<G3D::AABox> const& boxes, std::vector<bool>& hits) : Boxes(boxes), Hits(hits), RayIndex(0) { }
+
+    // slab test against the box, instead of ModelInstance::intersectRay
+    bool operator()(G3D::Ray const& ray, uint32 rayIndex, uint32 entry, float& maxDist, bool /*stopAtFirst*/)
+    {
+        G3D::AABox const& box = Boxes[entry];
+        float tMin = 0.0f;
+        float tMax = maxDist;
+        for (int i = 0; i < 3; ++i)
+        {
+            float invDir = 1.0f / ray.direction()[i];
+            float t1 = (box.low()[i] - ray.origin()[i]) * invDir;
+            float t2 = (box.high()[i] - ray.origin()[i]) * invDir;
+            if (t1 > t2)
+                std::swap(t1, t2);
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+        }
+
+        if (tMin > tMax)
+            return false;
+
+        maxDist = tMin;
+        Hits[rayIndex] = true;
+        return true;
+    }
+
+    bool operator()(G3D::Ray const& ray, uint32 entry, float& maxDist, bool stopAtFirst)
+    {
+        return (*this)(ray, RayIndex, entry, maxDist, stopAtFirst);
+    }
+
+    std::vector<G3D::AABox> const& Boxes;
+    std::vector<bool>& Hits;
+    uint32 RayIndex;
+};
+
+// records the order and time in which the events of .debug events are executed
+class EventOrderCheck : public BasicEvent
+{
+    public:
+        EventOrderCheck(uint32 id, std::vector<std::pair<uint32, uint64> >& executed) : _id(id), _executed(executed) { }
+
+        bool Execute(uint64 e_time, uint32 /*p_time*/)
+        {
+            _executed.push_back(std::make_pair(_id, e_time));
+            return true;
+        }
+
+    private:
+        uint32 _id;
+        std::vector<std::pair<uint32, uint64> >& _executed;
+};
+
 class debug_commandscript : public CommandScript
 {
     public:
@@ -100,6 +201,20 @@ class debug_commandscript : public CommandScript
                 { "packet",         SEC_ADMINISTRATOR,  false, &HandleDebugPacketCommand,          "", NULL },
                 { "guildevent",     SEC_ADMINISTRATOR,  false, &HandleDebugGuildEventCommand,      "", NULL },
                 { "log",            SEC_ADMINISTRATOR,  false, &HandleDebugLogCommand,             "", NULL },
+                { "relocation",     SEC_ADMINISTRATOR,  false, &HandleDebugRelocationCommand,      "", NULL },
+                { "pools",          SEC_ADMINISTRATOR,  true,  &HandleDebugPoolsCommand,           "", NULL },
+                { "auramods",       SEC_ADMINISTRATOR,  false, &HandleDebugAuraModsCommand,        "", NULL },
+                { "cellindex",      SEC_ADMINISTRATOR,  false, &HandleDebugCellIndexCommand,       "", NULL },
+                { "vmaplos",        SEC_ADMINISTRATOR,  false, &HandleDebugVMapLosCommand,         "", NULL },
+                { "bihpacket",      SEC_ADMINISTRATOR,  false, &HandleDebugBihPacketCommand,       "", NULL },
+                { "updatetiers",    SEC_ADMINISTRATOR,  false, &HandleDebugUpdateTiersCommand,     "", NULL },
+                { "spelltargets",   SEC_ADMINISTRATOR,  false, &HandleDebugSpellTargetsCommand,    "", NULL },
+                { "mapthreads",     SEC_ADMINISTRATOR,  true,  &HandleDebugMapThreadsCommand,      "", NULL },
+                { "valuesupdate",   SEC_ADMINISTRATOR,  false, &HandleDebugValuesUpdateCommand,    "", NULL },
+                { "dbqueues",       SEC_ADMINISTRATOR,  true,  &HandleDebugDbQueuesCommand,        "", NULL },
+                { "lootsim",        SEC_ADMINISTRATOR,  true,  &HandleDebugLootSimCommand,         "", NULL },
+                { "profile",        SEC_ADMINISTRATOR,  true,  &HandleDebugProfileCommand,         "", NULL },
+                { "events",         SEC_ADMINISTRATOR,  true,  &HandleDebugEventsCommand,          "", NULL },
                 { NULL,             SEC_PLAYER,         false, NULL,                               "", NULL }
             };
             static ChatCommand commandTable[] =
@@ -761,6 +876,743 @@ class debug_commandscript : public CommandScript
             return true;
         }
 
+        static bool HandleDebugRelocationCommand(ChatHandler* handler, char const* /*args*/)
+        {
+            Map* map = handler->GetSession()->GetPlayer()->GetMap();
+            RelocationNotifyStats const& stats = map->GetLastTickRelocationNotifyStats();
+
+            handler->PSendSysMessage("Relocation notifies of map %u (instance %u), last tick:", map->GetId(), map->GetInstanceId());
+            handler->PSendSysMessage("queued units: %u, coalesced notifies: %u, processed units: %u",
+                stats.QueuedUnits, stats.CoalescedNotifies, stats.ProcessedUnits);
+            handler->PSendSysMessage("visibility visits: %u, ai visits: %u, shared visits: %u (%u units)",
+                stats.VisibilityVisits, stats.AIVisits, stats.SharedVisits, stats.SharedUnits);
+            return true;
+        }
+
+        // .debug updatetiers: creature update tiers of the current map, and of the selected creature
+        static bool HandleDebugUpdateTiersCommand(ChatHandler* handler, char const* /*args*/)
+        {
+            Map* map = handler->GetSession()->GetPlayer()->GetMap();
+            CreatureUpdateTierStats const& stats = map->GetLastTickCreatureUpdateTierStats();
+
+            handler->PSendSysMessage("Creature update tiers of map %u (instance %u), last tick:", map->GetId(), map->GetInstanceId());
+            handler->PSendSysMessage("active: %u, near: %u, far: %u, updated: %u",
+                stats.Creatures[CREATURE_UPDATE_TIER_ACTIVE], stats.Creatures[CREATURE_UPDATE_TIER_NEAR],
+                stats.Creatures[CREATURE_UPDATE_TIER_FAR], stats.Updated);
+
+            if (Creature* target = handler->getSelectedCreature())
+                handler->PSendSysMessage("Selected creature %u is in tier %u", target->GetEntry(), target->GetUpdateTier());
+            return true;
+        }
+
+        // .debug pools [check]: counters of every size class pool, check first runs an alloc/free
+        // cycle through a scratch pool and the packet storage pool and fails unless the second
+        // allocation of each was a cache hit
+        static bool HandleDebugPoolsCommand(ChatHandler* handler, char const* args)
+        {
+            if (*args && strcmp(args, "check") == 0)
+            {
+                MemoryPoolStats stats;
+                {
+                    SizeClassPool pool("PoolCheck", 4, 6, 8);
+                    pool.Deallocate(pool.Allocate(24), 24);
+                    pool.Deallocate(pool.Allocate(24), 24);
+                    pool.Deallocate(pool.Allocate(256), 256);
+                    pool.FlushThreadStats();
+                    stats = pool.GetStats();
+                }
+
+                handler->PSendSysMessage("Pool check: hits " UI64FMTD ", misses " UI64FMTD ", oversized " UI64FMTD ", frees " UI64FMTD,
+                    stats.Hits, stats.Misses, stats.Oversized, stats.Frees);
+
+                if (stats.Hits != 1 || stats.Misses != 1 || stats.Oversized != 1 || stats.Frees != 3)
+                {
+                    handler->SendSysMessage("Pool check failed, blocks are not served from the thread caches");
+                    handler->SetSentErrorMessage(true);
+                    return false;
+                }
+
+                SizeClassPool& packetPool = ByteBuffer::GetStoragePool();
+                packetPool.FlushThreadStats();
+                uint64 packetHits = packetPool.GetStats().Hits;
+                {
+                    ByteBuffer first;
+                }
+                {
+                    ByteBuffer second;
+                }
+                packetPool.FlushThreadStats();
+                packetHits = packetPool.GetStats().Hits - packetHits;
+
+                handler->PSendSysMessage("Packet storage check: " UI64FMTD " hits", packetHits);
+                if (!packetHits)
+                {
+                    handler->SendSysMessage("Pool check failed, packet storage is not served from the thread caches");
+                    handler->SetSentErrorMessage(true);
+                    return false;
+                }
+            }
+
+            std::vector<SizeClassPool const*> pools;
+            SizeClassPool::GetPools(pools);
+
+            for (std::vector<SizeClassPool const*>::const_iterator itr = pools.begin(); itr != pools.end(); ++itr)
+            {
+                MemoryPoolStats stats = (*itr)->GetStats();
+                uint64 requests = stats.Hits + stats.Misses;
+                handler->PSendSysMessage("%s: hits " UI64FMTD ", misses " UI64FMTD " (%.1f%% hit), oversized " UI64FMTD ", released " UI64FMTD ", in use " SI64FMTD,
+                    (*itr)->GetName(), stats.Hits, stats.Misses, requests ? float(stats.Hits) * 100.0f / float(requests) : 0.0f,
+                    stats.Oversized, stats.Released, stats.InUse());
+            }
+
+            return true;
+        }
+
+        // .debug events: runs events due on the same tick through a scratch event processor and fails
+        // unless they execute on that tick in the order they were added, the first two are added
+        // far ahead and cascade down the timer wheel, the last one only shortly before it is due
+        static bool HandleDebugEventsCommand(ChatHandler* handler, char const* /*args*/)
+        {
+            uint64 const dueTime = 40000;
+
+            std::vector<std::pair<uint32, uint64> > executed;
+            {
+                EventProcessor events;
+                events.AddEvent(new EventOrderCheck(1, executed), dueTime);
+                events.AddEvent(new EventOrderCheck(2, executed), dueTime);
+
+                for (uint64 time = 0; time < dueTime - 100; time += 100)
+                    events.Update(100);
+
+                events.AddEvent(new EventOrderCheck(3, executed), dueTime);
+                events.Update(99);
+                events.Update(1);
+                events.Update(100);
+            }
+
+            bool ordered = executed.size() == 3;
+            for (size_t i = 0; i < executed.size(); ++i)
+            {
+                handler->PSendSysMessage("Event %u executed at " UI64FMTD " ms", executed[i].first, executed[i].second);
+                if (executed[i].first != i + 1 || executed[i].second != dueTime)
+                    ordered = false;
+            }
+
+            if (!ordered)
+            {
+                handler->SendSysMessage("Event check failed, events due on the same tick are not executed in the order they were added");
+                handler->SetSentErrorMessage(true);
+                return false;
+            }
+
+            handler->SendSysMessage("Event check passed");
+            return true;
+        }
+
+        // .debug mapthreads: map update workers of MapUpdate.Affinity with their NUMA node and last tick,
+        // compare the .server info tick percentiles with affinity on and off under the same load
+        static bool HandleDebugMapThreadsCommand(ChatHandler* handler, char const* /*args*/)
+        {
+            MapUpdater* updater = sMapMgr->GetMapUpdater();
+            if (!updater->has_affinity())
+            {
+                handler->PSendSysMessage("Map update affinity is disabled (MapUpdate.Affinity = 0)");
+                return true;
+            }
+
+            std::vector<MapUpdateWorkerStats> stats;
+            updater->get_worker_stats(stats);
+
+            uint64 total = 0;
+            for (size_t i = 0; i < stats.size(); ++i)
+            {
+                handler->PSendSysMessage("Worker %u: node %d, %u maps, " UI64FMTD " us last tick",
+                    uint32(i), stats[i].Node, stats[i].Maps, stats[i].UpdateTime);
+                total += stats[i].UpdateTime;
+            }
+
+            handler->PSendSysMessage("Total " UI64FMTD " us, average " UI64FMTD " us per worker, %u rebalances",
+                total, stats.empty() ? 0 : total / stats.size(), updater->get_rebalance_count());
+
+            if (WorldSession* session = handler->GetSession())
+                if (Player* player = session->GetPlayer())
+                    handler->PSendSysMessage("Map %u instance %u is updated by worker %d",
+                        player->GetMapId(), player->GetInstanceId(), player->GetMap()->GetUpdateWorker());
+
+            return true;
+        }
+
+        template<class T>
+        static void SendDbQueueStats(ChatHandler* handler, char const* name, DatabaseWorkerPool<T>& pool, bool reset)
+        {
+            std::vector<DatabaseWorkerStats> stats;
+            pool.GetShardStats(stats, reset);
+
+            for (size_t i = 0; i < stats.size(); ++i)
+                handler->PSendSysMessage("%s shard %u: %u queued, " UI64FMTD " ops, avg " UI64FMTD " ms, max %u ms",
+                    name, uint32(i), stats[i].QueueDepth, stats[i].Operations,
+                    stats[i].Operations ? stats[i].TotalLatency / stats[i].Operations : 0, stats[i].MaxLatency);
+
+            handler->PSendSysMessage("%s unkeyed: %u queued", name, pool.GetUnkeyedQueueDepth());
+        }
+
+        // .debug dbqueues [reset]: queue depth and enqueue to completion latency of every async
+        // database connection (shard), and the unkeyed operations waiting for a free one
+        static bool HandleDebugDbQueuesCommand(ChatHandler* handler, char const* args)
+        {
+            bool reset = args && strcmp(args, "reset") == 0;
+
+            SendDbQueueStats(handler, "Character", CharacterDatabase, reset);
+            SendDbQueueStats(handler, "Login", LoginDatabase, reset);
+            SendDbQueueStats(handler, "World", WorldDatabase, reset);
+            return true;
+        }
+
+        // .debug profile [map|opcode|script|smartai] [count]: the entries of the tick profiler with the most total
+        // time since the last dump, .debug profile reset|dump starts a new window (after writing Profiler.DumpFile)
+        static bool HandleDebugProfileCommand(ChatHandler* handler, char const* args)
+        {
+            char* categoryStr = strtok((char*)args, " ");
+            char* countStr = strtok(NULL, " ");
+
+            if (!TickProfiler::IsEnabled())
+                handler->SendSysMessage("Tick profiler is disabled (Profiler.Enable), no new samples are taken");
+
+            if (categoryStr && strcmp(categoryStr, "reset") == 0)
+            {
+                sTickProfiler->Reset();
+                handler->SendSysMessage("Tick profiler reset");
+                return true;
+            }
+
+            if (categoryStr && strcmp(categoryStr, "dump") == 0)
+            {
+                if (!sTickProfiler->Dump())
+                {
+                    handler->SendSysMessage("Tick profiler dump failed, check Profiler.DumpFile");
+                    handler->SetSentErrorMessage(true);
+                    return false;
+                }
+
+                sTickProfiler->Reset();
+                handler->SendSysMessage("Tick profiler dumped and reset");
+                return true;
+            }
+
+            static char const* categoryNames[MAX_TICK_PROFILE_CATEGORY] = { "map", "opcode", "script", "smartai" };
+            uint32 category = TICK_PROFILE_MAP;
+            if (categoryStr)
+            {
+                for (category = 0; category < MAX_TICK_PROFILE_CATEGORY; ++category)
+                    if (strcmp(categoryStr, categoryNames[category]) == 0)
+                        break;
+
+                if (category == MAX_TICK_PROFILE_CATEGORY)
+                    return false;
+            }
+
+            uint32 count = countStr ? uint32(atoi(countStr)) : 10;
+            if (!count)
+                return false;
+
+            std::vector<TickProfiler::Total> totals;
+            uint32 window = sTickProfiler->GetTotals(TickProfileCategory(category), count, totals);
+
+            handler->PSendSysMessage("Tick profile, %s, last %u s, top %u:", categoryNames[category], window, uint32(totals.size()));
+            for (std::vector<TickProfiler::Total>::const_iterator itr = totals.begin(); itr != totals.end(); ++itr)
+            {
+                TickProfileHistogram const& histogram = itr->Histogram;
+                handler->PSendSysMessage("%s: " UI64FMTD " calls, " UI64FMTD " ms total, avg " UI64FMTD " us, p95 " UI64FMTD " us, max " UI64FMTD " us",
+                    TickProfiler::GetEntryName(itr->Key, itr->Name).c_str(), histogram.GetCount(), histogram.GetTotal() / 1000000,
+                    histogram.GetTotal() / histogram.GetCount() / 1000, histogram.GetPercentile(95.0f) / 1000, histogram.GetMax() / 1000);
+            }
+            return true;
+        }
+
+        // .debug lootsim <creature loot id> [iterations]: fills the creature loot with the compiled tables and with
+        // the linear rolls, compares the drop rate of every item and the loot generation time of both
+        static bool HandleDebugLootSimCommand(ChatHandler* handler, char const* args)
+        {
+            char* lootIdStr = strtok((char*)args, " ");
+            char* iterationsStr = strtok(NULL, " ");
+            if (!lootIdStr)
+                return false;
+
+            uint32 lootId = uint32(atoi(lootIdStr));
+            uint32 iterations = iterationsStr ? uint32(atoi(iterationsStr)) : 100000;
+            if (!iterations)
+                return false;
+
+            LootTemplate const* tab = LootTemplates_Creature.GetLootFor(lootId);
+            if (!tab)
+            {
+                handler->PSendSysMessage("No creature loot template %u", lootId);
+                handler->SetSentErrorMessage(true);
+                return false;
+            }
+
+            bool rate = LootTemplates_Creature.IsRatesAllowed();
+            std::map<uint32, std::pair<uint32, uint32> > drops;    // item, drops with the compiled tables / the linear rolls
+            uint64 elapsed[2];
+            Loot loot;
+
+            for (uint8 compiled = 0; compiled < 2; ++compiled)
+            {
+                ACE_Time_Value start = ACE_OS::gettimeofday();
+                for (uint32 i = 0; i < iterations; ++i)
+                {
+                    loot.clear();
+                    if (compiled)
+                        tab->Process(loot, rate, LOOT_MODE_DEFAULT);
+                    else
+                        tab->ProcessUncompiled(loot, rate, LOOT_MODE_DEFAULT);
+
+                    for (LootItemList::const_iterator itr = loot.items.begin(); itr != loot.items.end(); ++itr)
+                        ++(compiled ? drops[itr->itemid].first : drops[itr->itemid].second);
+                    for (LootItemList::const_iterator itr = loot.quest_items.begin(); itr != loot.quest_items.end(); ++itr)
+                        ++(compiled ? drops[itr->itemid].first : drops[itr->itemid].second);
+                }
+                ACE_Time_Value diff = ACE_OS::gettimeofday() - start;
+                elapsed[compiled] = uint64(diff.sec()) * 1000000 + diff.usec();
+            }
+            loot.clear();
+
+            // two proportion z test per item, with this many items a few above 3 are expected by chance
+            double worst = 0.0;
+            uint32 worstItem = 0;
+            uint32 above = 0;
+            for (std::map<uint32, std::pair<uint32, uint32> >::const_iterator itr = drops.begin(); itr != drops.end(); ++itr)
+            {
+                double compiledRate = double(itr->second.first) / iterations;
+                double linearRate = double(itr->second.second) / iterations;
+                double pooled = (compiledRate + linearRate) / 2.0;
+                double error = sqrt(2.0 * pooled * (1.0 - pooled) / iterations);
+                double z = error > 0.0 ? fabs(compiledRate - linearRate) / error : 0.0;
+                if (z > 3.0)
+                    ++above;
+                if (z > worst)
+                {
+                    worst = z;
+                    worstItem = itr->first;
+                }
+            }
+
+            handler->PSendSysMessage("Creature loot %u, %u iterations, %u distinct items, %u items with |z| > 3, worst |z| %.2f (item %u)",
+                lootId, iterations, uint32(drops.size()), above, worst, worstItem);
+            handler->PSendSysMessage("Linear rolls: " UI64FMTD " us (%.0f loots/s), compiled tables: " UI64FMTD " us (%.0f loots/s)",
+                elapsed[0], elapsed[0] ? iterations * 1000000.0 / elapsed[0] : 0.0,
+                elapsed[1], elapsed[1] ? iterations * 1000000.0 / elapsed[1] : 0.0);
+            return true;
+        }
+
+        // .debug valuesupdate [recipients] [iterations]: marks a few fields of the selected unit changed and
+        // builds its values update for the players around (repeated up to recipients), per player and cached per visibility class
+        static bool HandleDebugValuesUpdateCommand(ChatHandler* handler, char const* args)
+        {
+            Player* player = handler->GetSession()->GetPlayer();
+            Unit* unit = handler->getSelectedUnit();
+            if (!unit)
+                unit = player;
+
+            char* recipientsStr = strtok((char*)args, " ");
+            char* iterationsStr = strtok(NULL, " ");
+            uint32 recipients = recipientsStr ? uint32(atoi(recipientsStr)) : 200;
+            uint32 iterations = iterationsStr ? uint32(atoi(iterationsStr)) : 100;
+            if (!recipients || !iterations)
+                return false;
+
+            std::list<Player*> around;
+            unit->GetPlayerListInGrid(around, unit->GetVisibilityRange());
+            if (around.empty())
+                around.push_back(player);
+
+            std::vector<Player*> targets;
+            targets.reserve(recipients);
+            for (std::list<Player*>::const_iterator itr = around.begin(); targets.size() < recipients; ++itr)
+            {
+                if (itr == around.end())
+                    itr = around.begin();
+                targets.push_back(*itr);
+            }
+
+            // resent to the players around on the next update, with their current values
+            unit->ForceValuesUpdateAtIndex(UNIT_FIELD_HEALTH);
+            unit->ForceValuesUpdateAtIndex(UNIT_FIELD_FLAGS);
+            unit->ForceValuesUpdateAtIndex(UNIT_FIELD_AURASTATE);
+            unit->ForceValuesUpdateAtIndex(OBJECT_FIELD_DYNAMIC_FLAGS);
+
+            // both paths must produce the same packets
+            std::set<Player*> distinct(targets.begin(), targets.end());
+            ValuesUpdateCache checkCache;
+            uint32 mismatches = 0;
+            for (std::set<Player*>::const_iterator itr = distinct.begin(); itr != distinct.end(); ++itr)
+            {
+                UpdateDataMapType perPlayer, cached;
+                unit->BuildFieldsUpdate(*itr, perPlayer, NULL);
+                unit->BuildFieldsUpdate(*itr, cached, &checkCache);
+
+                WorldPacket perPlayerPacket, cachedPacket;
+                perPlayer.begin()->second.BuildPacket(&perPlayerPacket);
+                cached.begin()->second.BuildPacket(&cachedPacket);
+                if (perPlayerPacket.size() != cachedPacket.size() || memcmp(perPlayerPacket.contents(), cachedPacket.contents(), perPlayerPacket.size()))
+                    ++mismatches;
+            }
+
+            ValuesUpdateCache cache;
+            uint64 elapsed[2];
+            ACE_Time_Value start = ACE_OS::gettimeofday();
+            for (uint32 i = 0; i < iterations; ++i)
+            {
+                UpdateDataMapType dataMap;
+                for (std::vector<Player*>::const_iterator itr = targets.begin(); itr != targets.end(); ++itr)
+                    unit->BuildFieldsUpdate(*itr, dataMap, NULL);
+            }
+            ACE_Time_Value diff = ACE_OS::gettimeofday() - start;
+            elapsed[0] = uint64(diff.sec()) * 1000000 + diff.usec();
+
+            start = ACE_OS::gettimeofday();
+            for (uint32 i = 0; i < iterations; ++i)
+            {
+                UpdateDataMapType dataMap;
+                for (std::vector<Player*>::const_iterator itr = targets.begin(); itr != targets.end(); ++itr)
+                    unit->BuildFieldsUpdate(*itr, dataMap, &cache);
+                cache.Reset();
+            }
+            diff = ACE_OS::gettimeofday() - start;
+            elapsed[1] = uint64(diff.sec()) * 1000000 + diff.usec();
+
+            handler->PSendSysMessage("Values update of %s for %u recipients (%u distinct players), %u iterations, %u mismatches",
+                unit->GetName(), recipients, uint32(distinct.size()), iterations, mismatches);
+            handler->PSendSysMessage("Per player: " UI64FMTD " us, per visibility class: " UI64FMTD " us (" UI64FMTD " class builds, " UI64FMTD " reuses)",
+                elapsed[0], elapsed[1], cache.GetMisses(), cache.GetHits());
+            return true;
+        }
+
+        // .debug auramods [iterations]: aura modifier cache counters of the selected unit, with an
+        // iteration count also times the aggregates read by a melee hit, cached and recomputed
+        static bool HandleDebugAuraModsCommand(ChatHandler* handler, char const* args)
+        {
+            Unit* unit = handler->getSelectedUnit();
+            if (!unit)
+                unit = handler->GetSession()->GetPlayer();
+
+            handler->PSendSysMessage("Aura modifier cache of %s: %u entries, %u hits, %u misses",
+                unit->GetName(), unit->GetAuraModifierCacheSize(), unit->GetAuraModifierCacheHits(), unit->GetAuraModifierCacheMisses());
+
+            uint32 iterations = *args ? uint32(atoi(args)) : 0;
+            if (!iterations)
+                return true;
+
+            static AuraType const hitAuraTypes[] =
+            {
+                SPELL_AURA_MOD_DAMAGE_PERCENT_DONE, SPELL_AURA_MOD_DAMAGE_PERCENT_TAKEN, SPELL_AURA_MOD_DAMAGE_DONE,
+                SPELL_AURA_MOD_DAMAGE_TAKEN, SPELL_AURA_MOD_CRIT_DAMAGE_BONUS, SPELL_AURA_MOD_CRIT_PCT,
+                SPELL_AURA_MOD_WEAPON_CRIT_PERCENT, SPELL_AURA_MOD_EXPERTISE, SPELL_AURA_MOD_TARGET_RESISTANCE
+            };
+            uint32 const hitAuraTypeCount = sizeof(hitAuraTypes) / sizeof(hitAuraTypes[0]);
+
+            uint64 elapsed[2];
+            for (uint8 cached = 0; cached < 2; ++cached)
+            {
+                ACE_Time_Value start = ACE_OS::gettimeofday();
+                for (uint32 i = 0; i < iterations; ++i)
+                {
+                    if (!cached)
+                        for (uint32 j = 0; j < hitAuraTypeCount; ++j)
+                            unit->InvalidateAuraModifierCache(hitAuraTypes[j]);
+
+                    unit->GetTotalAuraMultiplierByMiscMask(SPELL_AURA_MOD_DAMAGE_PERCENT_DONE, SPELL_SCHOOL_MASK_NORMAL);
+                    unit->GetTotalAuraMultiplierByMiscMask(SPELL_AURA_MOD_DAMAGE_PERCENT_TAKEN, SPELL_SCHOOL_MASK_NORMAL);
+                    unit->GetTotalAuraModifierByMiscMask(SPELL_AURA_MOD_DAMAGE_DONE, SPELL_SCHOOL_MASK_NORMAL);
+                    unit->GetTotalAuraModifierByMiscMask(SPELL_AURA_MOD_DAMAGE_TAKEN, SPELL_SCHOOL_MASK_NORMAL);
+                    unit->GetTotalAuraMultiplierByMiscMask(SPELL_AURA_MOD_CRIT_DAMAGE_BONUS, SPELL_SCHOOL_MASK_NORMAL);
+                    unit->GetTotalAuraModifier(SPELL_AURA_MOD_CRIT_PCT);
+                    unit->GetTotalAuraModifier(SPELL_AURA_MOD_WEAPON_CRIT_PERCENT);
+                    unit->GetTotalAuraModifier(SPELL_AURA_MOD_EXPERTISE);
+                    unit->GetTotalAuraModifierByMiscMask(SPELL_AURA_MOD_TARGET_RESISTANCE, SPELL_SCHOOL_MASK_NORMAL);
+                }
+                ACE_Time_Value diff = ACE_OS::gettimeofday() - start;
+                elapsed[cached] = uint64(diff.sec()) * 1000000 + diff.usec();
+            }
+
+            handler->PSendSysMessage("%u melee hit aggregate sets: recomputed " UI64FMTD " us, cached " UI64FMTD " us",
+                iterations, elapsed[0], elapsed[1]);
+            return true;
+        }
+
+        // .debug cellindex [radius] [iterations]: finds the objects around the player by walking the
+        // grid lists and through the cell position indexes, both results must match
+        static bool HandleDebugCellIndexCommand(ChatHandler* handler, char const* args)
+        {
+            Player* player = handler->GetSession()->GetPlayer();
+
+            char* radiusStr = strtok((char*)args, " ");
+            char* iterationsStr = strtok(NULL, " ");
+            float radius = radiusStr ? float(atof(radiusStr)) : 30.0f;
+            uint32 iterations = iterationsStr ? uint32(atoi(iterationsStr)) : 1000;
+            if (radius <= 0.0f || !iterations)
+                return false;
+
+            CellCoord p(MoPCore::ComputeCellCoord(player->GetPositionX(), player->GetPositionY()));
+            Cell cell(p);
+            cell.SetNoCreate();
+            Map& map = *player->GetMap();
+
+            std::vector<WorldObject*> standing;
+            map.QueryCellIndex(cell, player->GetPositionX(), player->GetPositionY(), SIZE_OF_GRIDS, GRID_MAP_TYPE_MASK_ALL | CELL_INDEX_ALL_CONTAINERS, 0, standing);
+
+            MoPCore::AllWorldObjectsInRange check(player, radius);
+            std::list<WorldObject*> found[2];
+            uint64 elapsed[2];
+            for (uint8 indexed = 0; indexed < 2; ++indexed)
+            {
+                ACE_Time_Value start = ACE_OS::gettimeofday();
+                for (uint32 i = 0; i < iterations; ++i)
+                {
+                    found[indexed].clear();
+                    MoPCore::WorldObjectListSearcher<MoPCore::AllWorldObjectsInRange> searcher(player, found[indexed], check);
+                    if (indexed)
+                        // the check adds the size of the player to the radius
+                        cell.VisitIndexed(p, searcher, map, radius + player->GetObjectSize(), player->GetPositionX(), player->GetPositionY(),
+                            GRID_MAP_TYPE_MASK_ALL | CELL_INDEX_ALL_CONTAINERS, player->GetPhaseMask());
+                    else
+                    {
+                        TypeContainerVisitor<MoPCore::WorldObjectListSearcher<MoPCore::AllWorldObjectsInRange>, WorldTypeMapContainer> worldVisitor(searcher);
+                        TypeContainerVisitor<MoPCore::WorldObjectListSearcher<MoPCore::AllWorldObjectsInRange>, GridTypeMapContainer> gridVisitor(searcher);
+                        cell.Visit(p, worldVisitor, map, radius, player->GetPositionX(), player->GetPositionY());
+                        cell.Visit(p, gridVisitor, map, radius, player->GetPositionX(), player->GetPositionY());
+                    }
+                }
+                ACE_Time_Value diff = ACE_OS::gettimeofday() - start;
+                elapsed[indexed] = uint64(diff.sec()) * 1000000 + diff.usec();
+            }
+
+            handler->PSendSysMessage("Standing cell holds %u objects. %u searches within %.1f yards: grid lists %u objects in " UI64FMTD " us, cell index %u objects in " UI64FMTD " us",
+                uint32(standing.size()), iterations, radius, uint32(found[0].size()), elapsed[0], uint32(found[1].size()), elapsed[1]);
+            return true;
+        }
+
+        // .debug vmaplos [threads] [queries]: line of sight checks between random points around the player,
+        // first on one thread then spread over [threads] threads, with the ray cache counters
+        static bool HandleDebugVMapLosCommand(ChatHandler* handler, char const* args)
+        {
+            Player* player = handler->GetSession()->GetPlayer();
+
+            char* threadsStr = strtok((char*)args, " ");
+            char* queriesStr = strtok(NULL, " ");
+            uint32 threads = threadsStr ? uint32(atoi(threadsStr)) : 4;
+            uint32 queries = queriesStr ? uint32(atoi(queriesStr)) : 100000;
+            if (!threads || threads > 32 || !queries)
+                return false;
+
+            // 256 endpoint pairs within 40 yards, so repeated pairs also exercise the ray cache
+            std::vector<float> points;
+            for (uint32 i = 0; i < 256; ++i)
+            {
+                for (uint8 j = 0; j < 2; ++j)
+                {
+                    points.push_back(player->GetPositionX() + frand(-40.0f, 40.0f));
+                    points.push_back(player->GetPositionY() + frand(-40.0f, 40.0f));
+                    points.push_back(player->GetPositionZ() + frand(0.0f, 5.0f));
+                }
+            }
+
+            VMAP::IVMapManager* vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
+            uint64 hits[2], misses[2];
+            vMapManager->getRayCacheStats(hits[0], misses[0]);
+
+            uint64 elapsed[2];
+            uint32 inLos[2] = { 0, 0 };
+            for (uint8 run = 0; run < 2; ++run)
+            {
+                uint32 threadCount = run ? threads : 1;
+                std::vector<VMapLosBenchWorker*> workers;
+                std::vector<ACE_Based::Thread*> workerThreads;
+
+                ACE_Time_Value start = ACE_OS::gettimeofday();
+                for (uint32 i = 0; i < threadCount; ++i)
+                {
+                    VMapLosBenchWorker* worker = new VMapLosBenchWorker(player->GetMapId(), points, queries / threadCount, i * 37);
+                    worker->incReference();                 // keep it alive after the thread released it
+                    workers.push_back(worker);
+                    workerThreads.push_back(new ACE_Based::Thread(worker));
+                }
+                for (uint32 i = 0; i < threadCount; ++i)
+                {
+                    workerThreads[i]->wait();
+                    delete workerThreads[i];
+                    inLos[run] += workers[i]->InLineOfSight;
+                    workers[i]->decReference();
+                }
+                ACE_Time_Value diff = ACE_OS::gettimeofday() - start;
+                elapsed[run] = std::max<uint64>(uint64(diff.sec()) * 1000000 + diff.usec(), 1);
+            }
+
+            vMapManager->getRayCacheStats(hits[1], misses[1]);
+
+            handler->PSendSysMessage("%u LoS checks: 1 thread " UI64FMTD " checks/s (%u in LoS), %u threads " UI64FMTD " checks/s (%u in LoS)",
+                queries, uint64(queries) * 1000000 / elapsed[0], inLos[0], threads, uint64(queries / threads * threads) * 1000000 / elapsed[1], inLos[1]);
+            handler->PSendSysMessage("Ray cache: " UI64FMTD " hits, " UI64FMTD " misses", hits[1] - hits[0], misses[1] - misses[0]);
+            return true;
+        }
+
+        // .debug bihpacket [boxes] [targets]: line of sight from [targets] points around the player to the player
+        // through a BIH of [boxes] random boxes, traced one ray at a time and in packets, both results must match
+        static bool HandleDebugBihPacketCommand(ChatHandler* handler, char const* args)
+        {
+            Player* player = handler->GetSession()->GetPlayer();
+
+            char* boxesStr = strtok((char*)args, " ");
+            char* targetsStr = strtok(NULL, " ");
+            uint32 boxCount = boxesStr ? uint32(atoi(boxesStr)) : 20000;
+            uint32 targets = targetsStr ? uint32(atoi(targetsStr)) : 40;
+            if (!boxCount || !targets)
+                return false;
+
+            G3D::Vector3 center(player->GetPositionX(), player->GetPositionY(), player->GetPositionZ() + 2.0f);
+
+            std::vector<G3D::AABox> boxes;
+            boxes.reserve(boxCount);
+            for (uint32 i = 0; i < boxCount; ++i)
+            {
+                G3D::Vector3 boxCenter = center + G3D::Vector3(frand(-100.0f, 100.0f), frand(-100.0f, 100.0f), frand(-10.0f, 10.0f));
+                G3D::Vector3 halfSize(frand(0.2f, 3.0f), frand(0.2f, 3.0f), frand(0.2f, 3.0f));
+                boxes.push_back(G3D::AABox(boxCenter - halfSize, boxCenter + halfSize));
+            }
+
+            BIH tree;
+            BihBenchBounds bounds;
+            tree.build(boxes, bounds);
+
+            // targets spread around the player like an area spell, ordered by heading as StaticMapTree does
+            std::vector<G3D::Ray> rays;
+            std::vector<float> distances;
+            for (uint32 i = 0; i < targets; ++i)
+            {
+                float angle = 2 * float(M_PI) * i / targets;
+                float dist = frand(5.0f, 30.0f);
+                G3D::Vector3 from = center + G3D::Vector3(dist * std::cos(angle), dist * std::sin(angle), frand(-1.0f, 1.0f));
+                distances.push_back((center - from).magnitude());
+                rays.push_back(G3D::Ray::fromOriginAndDirection(from, (center - from) / distances.back()));
+            }
+
+            uint32 const iterations = 2000;
+            std::vector<bool> hits[2] = { std::vector<bool>(targets, false), std::vector<bool>(targets, false) };
+            uint64 elapsed[2];
+            for (uint8 packet = 0; packet < 2; ++packet)
+            {
+                BihBenchCallback callback(boxes, hits[packet]);
+                ACE_Time_Value start = ACE_OS::gettimeofday();
+                for (uint32 i = 0; i < iterations; ++i)
+                {
+                    std::vector<float> maxDist = distances;
+                    if (packet)
+                        tree.intersectRays(&rays[0], targets, callback, &maxDist[0], true);
+                    else
+                    {
+                        for (callback.RayIndex = 0; callback.RayIndex < targets; ++callback.RayIndex)
+                            tree.intersectRay(rays[callback.RayIndex], callback, maxDist[callback.RayIndex], true);
+                    }
+                }
+                ACE_Time_Value diff = ACE_OS::gettimeofday() - start;
+                elapsed[packet] = uint64(diff.sec()) * 1000000 + diff.usec();
+            }
+
+            uint32 blocked = uint32(std::count(hits[0].begin(), hits[0].end(), true));
+            handler->PSendSysMessage("%u x %u rays through %u boxes (%u blocked): single rays " UI64FMTD " us, packets " UI64FMTD " us, results %s",
+                iterations, targets, boxCount, blocked, elapsed[0], elapsed[1], hits[0] == hits[1] ? "match" : "DIFFER");
+            return true;
+        }
+
+        // runs the area target selection of a spell around the player, once with std::list as Spell
+        // used to and once with the map scratch vectors and nth_element it uses now
+        static bool HandleDebugSpellTargetsCommand(ChatHandler* handler, char const* args)
+        {
+            Player* player = handler->GetSession()->GetPlayer();
+
+            char* spellStr = strtok((char*)args, " ");
+            char* iterationsStr = strtok(NULL, " ");
+            char* maxTargetsStr = strtok(NULL, " ");
+            uint32 spellId = spellStr ? uint32(atoi(spellStr)) : 0;
+            uint32 iterations = iterationsStr ? uint32(atoi(iterationsStr)) : 10000;
+            uint32 maxTargets = maxTargetsStr ? uint32(atoi(maxTargetsStr)) : 5;
+
+            SpellInfo const* spellInfo = sSpellMgr->GetSpellInfo(spellId);
+            if (!spellInfo)
+            {
+                handler->PSendSysMessage(LANG_COMMAND_NOSPELLFOUND);
+                handler->SetSentErrorMessage(true);
+                return false;
+            }
+
+            if (!iterations || !maxTargets)
+                return false;
+
+            float radius = spellInfo->Effects[EFFECT_0].CalcRadius(player);
+            if (radius <= 0.0f)
+                radius = 30.0f;
+
+            Map* map = player->GetMap();
+            float x = player->GetPositionX();
+            float y = player->GetPositionY();
+            CellCoord p(MoPCore::ComputeCellCoord(x, y));
+            Cell cell(p);
+            cell.SetNoCreate();
+            uint8 mask = GRID_MAP_TYPE_MASK_CREATURE | GRID_MAP_TYPE_MASK_PLAYER | CELL_INDEX_ALL_CONTAINERS;
+
+            MoPCore::WorldObjectSpellAreaTargetCheck check(radius, player, player, player, spellInfo, TARGET_CHECK_DEFAULT, NULL);
+
+            uint64 elapsed[2];
+            uint32 found[2] = { 0, 0 };
+
+            ACE_Time_Value start = ACE_OS::gettimeofday();
+            for (uint32 i = 0; i < iterations; ++i)
+            {
+                std::list<WorldObject*> targets;
+                MoPCore::WorldObjectListSearcher<MoPCore::WorldObjectSpellAreaTargetCheck> searcher(player, targets, check, GRID_MAP_TYPE_MASK_ALL);
+                cell.VisitIndexed(p, searcher, *map, radius, x, y, mask);
+
+                std::list<Unit*> unitTargets;
+                for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
+                    if (Unit* unit = (*itr)->ToUnit())
+                        unitTargets.push_back(unit);
+
+                if (unitTargets.size() > maxTargets)
+                {
+                    unitTargets.sort(MoPCore::HealthPctOrderPred());
+                    unitTargets.resize(maxTargets);
+                }
+                found[0] += unitTargets.size();
+            }
+            ACE_Time_Value diff = ACE_OS::gettimeofday() - start;
+            elapsed[0] = uint64(diff.sec()) * 1000000 + diff.usec();
+
+            start = ACE_OS::gettimeofday();
+            for (uint32 i = 0; i < iterations; ++i)
+            {
+                ScratchVector<WorldObject*> targetBuffer(map->GetObjectScratch());
+                std::vector<WorldObject*>& targets = targetBuffer.Get();
+                MoPCore::WorldObjectVectorSearcher<MoPCore::WorldObjectSpellAreaTargetCheck> searcher(targets, check);
+                cell.VisitIndexed(p, searcher, *map, radius, x, y, mask);
+
+                ScratchVector<Unit*> unitBuffer(map->GetUnitScratch());
+                std::vector<Unit*>& unitTargets = unitBuffer.Get();
+                for (std::vector<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
+                    if (Unit* unit = (*itr)->ToUnit())
+                        unitTargets.push_back(unit);
+
+                if (unitTargets.size() > maxTargets)
+                    MoPCore::Containers::SortedResize(unitTargets, maxTargets, MoPCore::HealthPctOrderPred());
+                found[1] += unitTargets.size();
+            }
+            diff = ACE_OS::gettimeofday() - start;
+            elapsed[1] = uint64(diff.sec()) * 1000000 + diff.usec();
+
+            handler->PSendSysMessage("%u target selections of spell %u (%.1f yards, max %u targets, %u kept per selection): lists " UI64FMTD " us, scratch vectors " UI64FMTD " us, results %s",
+                iterations, spellId, radius, maxTargets, found[0] / iterations, elapsed[0], elapsed[1], found[0] == found[1] ? "match" : "DIFFER");
+            return true;
+        }
+
         static bool HandleDebugAreaTriggersCommand(ChatHandler* handler, char const* /*args*/)
         {
             Player* player = handler->GetSession()->GetPlayer();
@@ -1122,8 +1974,8 @@ class debug_commandscript : public CommandScript
             if (!target || target->isTotem() || target->isPet())
                 return false;
 
-            std::list<HostileReference*>& threatList = target->getThreatManager().getThreatList();
-            std::list<HostileReference*>::iterator itr;
+            ThreatContainer::StorageType& threatList = target->getThreatManager().getThreatList();
+            ThreatContainer::StorageType::iterator itr;
             uint32 count = 0;
             handler->PSendSysMessage("Threat list of %s (guid %u)", target->GetName(), target->GetGUIDLow());
             for (itr = threatList.begin(); itr != threatList.end(); ++itr)
@@ -573,6 +573,7 @@ public:
     {
         sLog->outInfo(LOG_FILTER_GENERAL, "Loading Item templates... (`item_template`)");
         sObjectMgr->LoadItemTemplates();
+        CompileLootTables();                                // item qualities and drop limits are compiled into the loot tables
         handler->SendGlobalGMSysMessage("DB table `item_template` (item templates) reloaded.");
         return true;
     }
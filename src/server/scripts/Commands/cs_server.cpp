@@ -139,6 +139,14 @@ public:
             handler->PSendSysMessage("Outdoor PVP diff : %u ms", sWorld->GetRecordDiff(RECORD_DIFF_OUTDOORPVP));
             handler->PSendSysMessage("LFG Mgr diff : %u ms", sWorld->GetRecordDiff(RECORD_DIFF_LFG));
             handler->PSendSysMessage("Callback diff : %u ms", sWorld->GetRecordDiff(RECORD_DIFF_CALLBACK));
+
+            static char const* intervalNames[INTERVAL_MAX] = { "1 min", "5 min", "15 min" };
+            for (uint8 i = 0; i < INTERVAL_MAX; ++i)
+            {
+                PerfLog const perf = sTimeDiffMgr->GetPerfLog(UpdateTimeLogInterval(i));
+                handler->PSendSysMessage("World tick (%s) : avg %u ms, p50 %u ms, p95 %u ms, p99 %u ms, max %u ms",
+                    intervalNames[i], perf.Average, perf.P50, perf.P95, perf.P99, perf.Max);
+            }
         }
 
         // Can't use sWorld->ShutdownMsg here in case of console command
@@ -467,13 +467,13 @@ class boss_sinestra : public CreatureScript
 
                             std::list<Unit*> targetList;
 
-                            const std::list<HostileReference*> &threatlist = me->getThreatManager().getThreatList();
+                            const ThreatContainer::StorageType &threatlist = me->getThreatManager().getThreatList();
 
                             if (threatlist.empty())
                                 return;
 
                             DefaultTargetSelector targetSelector(me, 0.0f, true, 0);
-                            for (std::list<HostileReference*>::const_iterator itr = threatlist.begin(); itr != threatlist.end(); ++itr)
+                            for (ThreatContainer::StorageType::const_iterator itr = threatlist.begin(); itr != threatlist.end(); ++itr)
                                 if (targetSelector((*itr)->getTarget()) && me->getVictim() != (*itr)->getTarget())
                                     targetList.push_back((*itr)->getTarget());
 
@@ -246,35 +246,34 @@ public:
             //Affliction_Timer
             if (Affliction_Timer <= diff)
             {
-                std::list<HostileReference*> threatlist = me->getThreatManager().getThreatList();
-                for (std::list<HostileReference*>::const_iterator i = threatlist.begin(); i != threatlist.end(); ++i)
+                // the afflictions can kill their target, walk a copy of the targets
+                std::vector<uint64> targetGuids;
+                me->getThreatManager().getThreatListGuids(targetGuids);
+                for (std::vector<uint64>::const_iterator i = targetGuids.begin(); i != targetGuids.end(); ++i)
                 {
-                    if ((*i) && (*i)->getSource())
+                    if (Unit* unit = Unit::GetUnit(*me, *i))
                     {
-                        if (Unit* unit = Unit::GetUnit(*me, (*i)->getUnitGuid()))
+                        //Cast affliction
+                        DoCast(unit, RAND(SPELL_BROODAF_BLUE, SPELL_BROODAF_BLACK,
+                                           SPELL_BROODAF_RED, SPELL_BROODAF_BRONZE, SPELL_BROODAF_GREEN), true);
+
+                        //Chromatic mutation if target is effected by all afflictions
+                        if (unit->HasAura(SPELL_BROODAF_BLUE)
+                            && unit->HasAura(SPELL_BROODAF_BLACK)
+                            && unit->HasAura(SPELL_BROODAF_RED)
+                            && unit->HasAura(SPELL_BROODAF_BRONZE)
+                            && unit->HasAura(SPELL_BROODAF_GREEN))
                         {
-                            //Cast affliction
-                            DoCast(unit, RAND(SPELL_BROODAF_BLUE, SPELL_BROODAF_BLACK,
-                                               SPELL_BROODAF_RED, SPELL_BROODAF_BRONZE, SPELL_BROODAF_GREEN), true);
-
-                            //Chromatic mutation if target is effected by all afflictions
-                            if (unit->HasAura(SPELL_BROODAF_BLUE)
-                                && unit->HasAura(SPELL_BROODAF_BLACK)
-                                && unit->HasAura(SPELL_BROODAF_RED)
-                                && unit->HasAura(SPELL_BROODAF_BRONZE)
-                                && unit->HasAura(SPELL_BROODAF_GREEN))
-                            {
-                                //target->RemoveAllAuras();
-                                //DoCast(target, SPELL_CHROMATIC_MUT_1);
-
-                                //Chromatic mutation is causing issues
-                                //Assuming it is caused by a lack of core support for Charm
-                                //So instead we instant kill our target
-
-                                //WORKAROUND
-                                if (unit->GetTypeId() == TYPEID_PLAYER)
-                                    unit->CastSpell(unit, 5, false);
-                            }
+                            //target->RemoveAllAuras();
+                            //DoCast(target, SPELL_CHROMATIC_MUT_1);
+
+                            //Chromatic mutation is causing issues
+                            //Assuming it is caused by a lack of core support for Charm
+                            //So instead we instant kill our target
+
+                            //WORKAROUND
+                            if (unit->GetTypeId() == TYPEID_PLAYER)
+                                unit->CastSpell(unit, 5, false);
                         }
                     }
                 }
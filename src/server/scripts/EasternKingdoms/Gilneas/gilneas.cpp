@@ -4628,8 +4628,8 @@ class npc_dark_ranger_thyala  : public CreatureScript
             {
                 if (me->GetHealth() < damage)
                 {
-                    std::list<HostileReference*> threatList = me->getThreatManager().getThreatList();
-                    for (std::list<HostileReference*>::const_iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
+                    ThreatContainer::StorageType threatList = me->getThreatManager().getThreatList();
+                    for (ThreatContainer::StorageType::const_iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
                         if (Player* player = ObjectAccessor::GetPlayer((*me), (*itr)->getUnitGuid()))
                             player->KilledMonsterCredit(me->GetEntry(), me->GetGUID());
                 }
@@ -607,8 +607,8 @@ public:
                         case EVENT_DETONATE:
                         {
                             std::vector<Unit*> unitList;
-                            std::list<HostileReference*> *threatList = &me->getThreatManager().getThreatList();
-                            for (std::list<HostileReference*>::const_iterator itr = threatList->begin(); itr != threatList->end(); ++itr)
+                            ThreatContainer::StorageType *threatList = &me->getThreatManager().getThreatList();
+                            for (ThreatContainer::StorageType::const_iterator itr = threatList->begin(); itr != threatList->end(); ++itr)
                             {
                                 if ((*itr)->getTarget()->GetTypeId() == TYPEID_PLAYER
                                     && (*itr)->getTarget()->getPowerType() == POWER_MANA
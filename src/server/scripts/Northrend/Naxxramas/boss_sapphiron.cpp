@@ -304,7 +304,7 @@ public:
                         case EVENT_ICEBOLT:
                         {
                             std::vector<Unit*> targets;
-                            std::list<HostileReference*>::const_iterator i = me->getThreatManager().getThreatList().begin();
+                            ThreatContainer::StorageType::const_iterator i = me->getThreatManager().getThreatList().begin();
                             for (; i != me->getThreatManager().getThreatList().end(); ++i)
                                 if ((*i)->getTarget()->GetTypeId() == TYPEID_PLAYER && !(*i)->getTarget()->HasAura(SPELL_ICEBOLT))
                                     targets.push_back((*i)->getTarget());
@@ -360,7 +360,7 @@ public:
         {
             DoZoneInCombat(); // make sure everyone is in threatlist
             std::vector<Unit*> targets;
-            std::list<HostileReference*>::const_iterator i = me->getThreatManager().getThreatList().begin();
+            ThreatContainer::StorageType::const_iterator i = me->getThreatManager().getThreatList().begin();
             for (; i != me->getThreatManager().getThreatList().end(); ++i)
             {
                 Unit* target = (*i)->getTarget();
@@ -1891,10 +1891,12 @@ public:
 		{
 			if (Creature* caster = GetCaster()->ToCreature())
 			{
-				const std::list<HostileReference*>& m_threatlist = caster->getThreatManager().getThreatList();
-				for (std::list<HostileReference*>::const_iterator itr = m_threatlist.begin(); itr != m_threatlist.end(); ++itr)
+				// the vortex spell can remove its target from the list, keep the guids only
+				std::vector<uint64> targetGuids;
+				caster->getThreatManager().getThreatListGuids(targetGuids);
+				for (std::vector<uint64>::const_iterator itr = targetGuids.begin(); itr != targetGuids.end(); ++itr)
 				{
-					if (Unit* target = (*itr)->getTarget())
+					if (Unit* target = Unit::GetUnit(*caster, *itr))
 					{
 						Player* targetPlayer = target->ToPlayer();
 						if (!targetPlayer || targetPlayer->isGameMaster())
@@ -188,18 +188,20 @@ public:
         {
             if (Creature* malygos = instance->GetCreature(malygosGUID))
             {
-                std::list<HostileReference*> m_threatlist = malygos->getThreatManager().getThreatList();
+                // the vortex spell can remove its target from the list, keep the guids only
+                std::vector<uint64> targetGuids;
+                malygos->getThreatManager().getThreatListGuids(targetGuids);
                 for (std::list<uint64>::const_iterator itr_vortex = vortexTriggers.begin(); itr_vortex != vortexTriggers.end(); ++itr_vortex)
                 {
-                    if (m_threatlist.empty())
+                    if (targetGuids.empty())
                         return;
 
                     uint8 counter = 0;
                     if (Creature* trigger = instance->GetCreature(*itr_vortex))
                     {
-                        for (std::list<HostileReference*>::const_iterator itr = m_threatlist.begin(); itr!= m_threatlist.end(); ++itr)
+                        for (std::vector<uint64>::const_iterator itr = targetGuids.begin(); itr != targetGuids.end(); ++itr)
                         {
-                            if (Unit* target = (*itr)->getTarget())
+                            if (Unit* target = Unit::GetUnit(*malygos, *itr))
                             {
                                 Player* player = target->ToPlayer();
 
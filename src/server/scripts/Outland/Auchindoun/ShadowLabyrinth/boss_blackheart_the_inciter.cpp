@@ -136,10 +136,11 @@ public:
             {
                 DoCast(me, SPELL_INCITE_CHAOS);
 
-                std::list<HostileReference*> t_list = me->getThreatManager().getThreatList();
-                for (std::list<HostileReference*>::const_iterator itr = t_list.begin(); itr!= t_list.end(); ++itr)
+                std::vector<uint64> targetGuids;
+                me->getThreatManager().getThreatListGuids(targetGuids);
+                for (std::vector<uint64>::const_iterator itr = targetGuids.begin(); itr != targetGuids.end(); ++itr)
                 {
-                    Unit* target = Unit::GetUnit(*me, (*itr)->getUnitGuid());
+                    Unit* target = Unit::GetUnit(*me, *itr);
                     if (target && target->GetTypeId() == TYPEID_PLAYER)
                         me->CastSpell(target, SPELL_INCITE_CHAOS_B, true);
                 }
@@ -271,7 +271,7 @@ class boss_niuzao : public CreatureScript
                     return;
 
                 // Get the Threat List
-                std::list<HostileReference*> threatlist = me->getThreatManager().getThreatList();
+                ThreatContainer::StorageType threatlist = me->getThreatManager().getThreatList();
                 if (threatlist.empty()) // He doesn't have anyone in his threatlist, useless to continue
                     return;
 
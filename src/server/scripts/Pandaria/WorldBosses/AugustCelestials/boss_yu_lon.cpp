@@ -231,7 +231,7 @@ class boss_yu_lon : public CreatureScript
                     return;
 
                 // Get the Threat List
-                std::list<HostileReference*> threatlist = me->getThreatManager().getThreatList();
+                ThreatContainer::StorageType threatlist = me->getThreatManager().getThreatList();
                 if (threatlist.empty()) // He doesn't have anyone in his threatlist, useless to continue
                     return;
 
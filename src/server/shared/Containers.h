@@ -18,7 +18,9 @@
 #ifndef CONTAINERS_H
 #define CONTAINERS_H
 
+#include <algorithm>
 #include <list>
+#include <vector>
 
 //! Because circular includes are bad
 extern uint32 urand(uint32 min, uint32 max);
@@ -70,6 +72,33 @@ namespace MoPCore
             list = listCopy;
         }
 
+        // Same result as the std::list version (a random subset in the original order), in one pass
+        template<class T>
+        void RandomResizeList(std::vector<T> &vec, uint32 size)
+        {
+            size_t vec_size = vec.size();
+            if (vec_size <= size)
+                return;
+
+            // selection sampling: keep each element with probability needed / left
+            size_t kept = 0;
+            for (size_t i = 0; i < vec_size && kept < size; ++i)
+                if (urand(0, vec_size - i - 1) < size - kept)
+                    vec[kept++] = vec[i];
+
+            vec.resize(size);
+        }
+
+        // Keeps the size first elements of the order given by pred, sorted. Stable like the std::list sort
+        // it replaces: of the targets pred considers equal, the first ones found are kept, in that order
+        template<class T, class Predicate>
+        void SortedResize(std::vector<T> &vec, uint32 size, Predicate pred)
+        {
+            std::stable_sort(vec.begin(), vec.end(), pred);
+            if (vec.size() > size)
+                vec.resize(size);
+        }
+
         /* Select a random element from a container. Note: make sure you explicitly empty check the container */
         template <class C> typename C::value_type const& SelectRandomContainerElement(C const& container)
         {
@@ -20,10 +20,12 @@
 #include "SQLOperation.h"
 #include "MySQLConnection.h"
 #include "MySQLThreading.h"
+#include "Timer.h"
 
 DatabaseWorker::DatabaseWorker(ACE_Activation_Queue* new_queue, MySQLConnection* con) :
 m_queue(new_queue),
-m_conn(con)
+m_conn(con),
+m_busy(0)
 {
     /// Assign thread to task
     activate();
@@ -42,10 +44,29 @@ int DatabaseWorker::svc()
             break;
 
         request->SetConnection(m_conn);
+        m_busy = 1;
         request->call();
+        m_busy = 0;
+
+        uint32 latency = GetMSTimeDiffToNow(request->m_enqueueTime);
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_statsLock, -1);
+            ++m_stats.Operations;
+            m_stats.TotalLatency += latency;
+            m_stats.MaxLatency = std::max(m_stats.MaxLatency, latency);
+        }
 
         delete request;
     }
 
     return 0;
 }
+
+void DatabaseWorker::GetStats(DatabaseWorkerStats& stats, bool reset)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_statsLock);
+    stats = m_stats;
+    stats.QueueDepth = uint32(m_queue->method_count());
+    if (reset)
+        m_stats = DatabaseWorkerStats();
+}
@@ -20,9 +20,24 @@
 
 #include <ace/Task.h>
 #include <ace/Activation_Queue.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
+
+#include "Define.h"
 
 class MySQLConnection;
 
+///- Operations executed by the worker of one async connection (one shard of the pool)
+struct DatabaseWorkerStats
+{
+    DatabaseWorkerStats() : QueueDepth(0), Operations(0), TotalLatency(0), MaxLatency(0) { }
+
+    uint32 QueueDepth;                                      // operations waiting in the queue of the shard
+    uint64 Operations;                                      // executed since the last reset
+    uint64 TotalLatency;                                    // ms from enqueue to the end of the execution
+    uint32 MaxLatency;
+};
+
 class DatabaseWorker : protected ACE_Task_Base
 {
     public:
@@ -32,10 +47,18 @@ class DatabaseWorker : protected ACE_Task_Base
         int svc();
         int wait() { return ACE_Task_Base::wait(); }
 
+        void GetStats(DatabaseWorkerStats& stats, bool reset);
+        //! Executing an operation, a worker with an empty queue may still be stuck on a slow one
+        bool IsBusy() const { return m_busy.value() != 0; }
+
     private:
         DatabaseWorker() : ACE_Task_Base() {}
         ACE_Activation_Queue* m_queue;
         MySQLConnection* m_conn;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_busy;
+
+        ACE_Thread_Mutex m_statsLock;
+        DatabaseWorkerStats m_stats;
 };
 
 #endif
@@ -30,6 +30,7 @@
 #include "QueryResult.h"
 #include "QueryHolder.h"
 #include "AdhocStatement.h"
+#include "Timer.h"
 
 class PingOperation : public SQLOperation
 {
@@ -41,13 +42,46 @@ class PingOperation : public SQLOperation
     }
 };
 
+//! Wakes the worker of a shard for the unkeyed operations, which wait in a queue shared by every async
+//! connection. The worker runs the oldest ones until keyed work reaches its own queue, so the unkeyed
+//! operations whose ticket sits behind a slow operation on another shard are run by this one. A ticket
+//! finding the shared queue empty does nothing.
+class UnkeyedOperationTicket : public SQLOperation
+{
+    public:
+        UnkeyedOperationTicket(ACE_Activation_Queue* unkeyedQueue, ACE_Activation_Queue* shardQueue)
+            : m_unkeyedQueue(unkeyedQueue), m_shardQueue(shardQueue) { }
+
+        bool Execute()
+        {
+            do
+            {
+                //! does not wait, the dequeue timeout is an absolute time
+                ACE_Time_Value now = ACE_OS::gettimeofday();
+                SQLOperation* op = (SQLOperation*)m_unkeyedQueue->dequeue(&now);
+                if (!op)
+                    break;
+
+                op->SetConnection(m_conn);
+                op->call();
+                delete op;
+            }
+            while (!m_shardQueue->method_count());
+
+            return true;
+        }
+
+    private:
+        ACE_Activation_Queue* m_unkeyedQueue;
+        ACE_Activation_Queue* m_shardQueue;
+};
+
 template <class T>
 class DatabaseWorkerPool
 {
     public:
         /* Activity state */
-        DatabaseWorkerPool() :
-        _queue(new ACE_Activation_Queue())
+        DatabaseWorkerPool() : _unkeyedQueue(NULL), _queryHolderFanOut(1)
         {
             memset(_connectionCount, 0, sizeof(_connectionCount));
 
@@ -64,11 +98,14 @@ class DatabaseWorkerPool
             sLog->outInfo(LOG_FILTER_SQL_DRIVER, "Opening DatabasePool '%s'. Asynchronous connections: %u, synchronous connections: %u.",
                 GetDatabaseName(), async_threads, synch_threads);
 
-            //! Open asynchronous connections (delayed operations)
+            //! Open asynchronous connections (delayed operations), each one with its own queue (shard)
             _connections[IDX_ASYNC].resize(async_threads);
+            _unkeyedQueue = new ACE_Activation_Queue();
+            _queues.resize(async_threads);
             for (uint8 i = 0; i < async_threads; ++i)
             {
-                T* t = new T(_queue, _connectionInfo);
+                _queues[i] = new ACE_Activation_Queue();
+                T* t = new T(_queues[i], _connectionInfo);
                 res &= t->Open();
                 _connections[IDX_ASYNC][i] = t;
                 ++_connectionCount[IDX_ASYNC];
@@ -100,7 +137,9 @@ class DatabaseWorkerPool
             //! Shuts down delaythreads for this connection pool by underlying deactivate().
             //! The next dequeue attempt in the worker thread tasks will result in an error,
             //! ultimately ending the worker thread task.
-            _queue->queue()->close();
+            for (size_t i = 0; i < _queues.size(); ++i)
+                _queues[i]->queue()->close();
+            _unkeyedQueue->queue()->close();
 
             for (uint8 i = 0; i < _connectionCount[IDX_ASYNC]; ++i)
             {
@@ -122,7 +161,11 @@ class DatabaseWorkerPool
                 _connections[IDX_SYNCH][i]->Close();
 
             //! Deletes the ACE_Activation_Queue object and its underlying ACE_Message_Queue
-            delete _queue;
+            for (size_t i = 0; i < _queues.size(); ++i)
+                delete _queues[i];
+            _queues.clear();
+            delete _unkeyedQueue;
+            _unkeyedQueue = NULL;
 
             sLog->outInfo(LOG_FILTER_SQL_DRIVER, "All connections on DatabasePool '%s' closed.", GetDatabaseName());
         }
@@ -160,10 +203,11 @@ class DatabaseWorkerPool
 
         //! Enqueues a one-way SQL operation in prepared statement format that will be executed asynchronously.
         //! Statement must be prepared with CONNECTION_ASYNC flag.
-        void Execute(PreparedStatement* stmt)
+        //! Operations with the same routingKey (see MakeDatabaseRoutingKey) are executed in order.
+        void Execute(PreparedStatement* stmt, uint64 routingKey = DB_ROUTING_ANY)
         {
             PreparedStatementTask* task = new PreparedStatementTask(stmt);
-            Enqueue(task);
+            Enqueue(task, routingKey);
         }
 
         /**
@@ -285,6 +329,35 @@ class DatabaseWorkerPool
             return PreparedQueryResult(ret);
         }
 
+        //! Directly executes a prepared query and reads its rows one by one while they are iterated, without
+        //! materializing them (see PreparedResultStream). Meant for large loads. Positioned on the first row
+        //! like Query(), empty results return NULL. The synchronous connection stays locked until the stream
+        //! is released, so no other synchronous query of this pool may be issued meanwhile when it only has
+        //! one synchronous connection.
+        PreparedQueryStream StreamQuery(PreparedStatement* stmt)
+        {
+            T* t = GetFreeConnection();
+            PreparedResultStream* ret = t->StreamQuery(stmt);
+
+            //! Delete proxy-class. Not needed anymore
+            delete stmt;
+
+            if (!ret)
+            {
+                t->Unlock();
+                return PreparedQueryStream(NULL);
+            }
+
+            //! The stream unlocks the connection when deleted
+            if (!ret->NextRow())
+            {
+                delete ret;
+                return PreparedQueryStream(NULL);
+            }
+
+            return PreparedQueryStream(ret);
+        }
+
         /**
             Asynchronous query (with resultset) methods.
         */
@@ -315,11 +388,12 @@ class DatabaseWorkerPool
         //! Enqueues a query in prepared format that will set the value of the PreparedQueryResultFuture return object as soon as the query is executed.
         //! The return value is then processed in ProcessQueryCallback methods.
         //! Statement must be prepared with CONNECTION_ASYNC flag.
-        PreparedQueryResultFuture AsyncQuery(PreparedStatement* stmt)
+        //! Operations with the same routingKey (see MakeDatabaseRoutingKey) are executed in order.
+        PreparedQueryResultFuture AsyncQuery(PreparedStatement* stmt, uint64 routingKey = DB_ROUTING_ANY)
         {
             PreparedQueryResultFuture res;
             PreparedStatementTask* task = new PreparedStatementTask(stmt, res);
-            Enqueue(task);
+            Enqueue(task, routingKey);
             return res;
         }
 
@@ -327,14 +401,39 @@ class DatabaseWorkerPool
         //! return object as soon as the query is executed.
         //! The return value is then processed in ProcessQueryCallback methods.
         //! Any prepared statements added to this holder need to be prepared with the CONNECTION_ASYNC flag.
-        QueryResultHolderFuture DelayQueryHolder(SQLQueryHolder* holder)
+        //! Holders with enough queries are split into interleaved slices executed by several async connections
+        //! in parallel (see SetQueryHolderFanOut), the future is set once the last slice is done.
+        //! The holder runs after the operations queued before it with the same routingKey.
+        QueryResultHolderFuture DelayQueryHolder(SQLQueryHolder* holder, uint64 routingKey = DB_ROUTING_ANY)
         {
             QueryResultHolderFuture res;
+
+            uint32 slices = std::min<uint32>(_queryHolderFanOut, _connectionCount[IDX_ASYNC]);
+            slices = std::min<uint32>(slices, holder->GetSize() / MIN_QUERY_HOLDER_SLICE_SIZE);
+            if (slices > 1)
+            {
+                //! The first slice goes to the shard of the key and queues the other ones on the next shards
+                uint32 shard = GetShard(routingKey);
+                SQLQueryHolderFanOut* fanOut = new SQLQueryHolderFanOut(holder, res, slices);
+                for (uint32 i = 1; i < slices; ++i)
+                    fanOut->Defer(_queues[(shard + i) % _queues.size()], new SQLQueryHolderSliceTask(fanOut, holder, i, slices));
+
+                Enqueue(new SQLQueryHolderSliceTask(fanOut, holder, 0, slices), routingKey);
+                return res;
+            }
+
             SQLQueryHolderTask* task = new SQLQueryHolderTask(holder, res);
-            Enqueue(task);
+            Enqueue(task, routingKey);
             return res;     //! Fool compiler, has no use yet
         }
 
+        //! Maximum number of async connections a single query holder is spread over, 1 executes holders
+        //! on one connection.
+        void SetQueryHolderFanOut(uint32 slices)
+        {
+            _queryHolderFanOut = std::max<uint32>(slices, 1);
+        }
+
         /**
             Transaction context methods.
         */
@@ -347,7 +446,8 @@ class DatabaseWorkerPool
 
         //! Enqueues a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
         //! were appended to the transaction will be respected during execution.
-        void CommitTransaction(SQLTransaction transaction)
+        //! Operations with the same routingKey (see MakeDatabaseRoutingKey) are executed in order.
+        void CommitTransaction(SQLTransaction transaction, uint64 routingKey = DB_ROUTING_ANY)
         {
             #ifdef TRINITY_DEBUG
             //! Only analyze transaction weaknesses in Debug mode.
@@ -366,7 +466,7 @@ class DatabaseWorkerPool
             }
             #endif // TRINITY_DEBUG
 
-            Enqueue(new TransactionTask(transaction));
+            Enqueue(new TransactionTask(transaction), routingKey);
         }
 
         //! Directly executes a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
@@ -456,11 +556,27 @@ class DatabaseWorkerPool
                 }
             }
 
-            //! Assuming all worker threads are free, every worker thread will receive 1 ping operation request
-            //! If one or more worker threads are busy, the ping operations will not be split evenly, but this doesn't matter
-            //! as the sole purpose is to prevent connections from idling.
-            for (size_t i = 0; i < _connections[IDX_ASYNC].size(); ++i)
-                Enqueue(new PingOperation);
+            //! Every async connection has its own queue, each one receives 1 ping operation request
+            for (size_t i = 0; i < _queues.size(); ++i)
+            {
+                PingOperation* op = new PingOperation;
+                op->m_enqueueTime = getMSTime();
+                _queues[i]->enqueue(op);
+            }
+        }
+
+        //! Queue depth and latency of every async connection (shard), the latencies are reset when reset is set.
+        void GetShardStats(std::vector<DatabaseWorkerStats>& stats, bool reset)
+        {
+            stats.resize(_connectionCount[IDX_ASYNC]);
+            for (uint32 i = 0; i < _connectionCount[IDX_ASYNC]; ++i)
+                _connections[IDX_ASYNC][i]->m_worker->GetStats(stats[i], reset);
+        }
+
+        //! Unkeyed operations no worker picked up yet.
+        uint32 GetUnkeyedQueueDepth() const
+        {
+            return _unkeyedQueue ? uint32(_unkeyedQueue->method_count()) : 0;
         }
 
     private:
@@ -472,9 +588,59 @@ class DatabaseWorkerPool
             return mysql_real_escape_string(_connections[IDX_SYNCH][0]->GetHandle(), to, from, length);
         }
 
-        void Enqueue(SQLOperation* op)
+        //! Keyed operations go to the queue of the shard of their key and run in order. Unkeyed ones have no
+        //! ordering, they go to the queue every async connection drains, with a ticket on the idlest shard
+        //! to wake its worker.
+        void Enqueue(SQLOperation* op, uint64 routingKey = DB_ROUTING_ANY)
+        {
+            op->m_enqueueTime = getMSTime();
+            if (routingKey != DB_ROUTING_ANY || _queues.size() < 2)
+            {
+                _queues[GetShard(routingKey)]->enqueue(op);
+                return;
+            }
+
+            _unkeyedQueue->enqueue(op);
+
+            ACE_Activation_Queue* shardQueue = _queues[GetIdlestShard()];
+            UnkeyedOperationTicket* ticket = new UnkeyedOperationTicket(_unkeyedQueue, shardQueue);
+            ticket->m_enqueueTime = op->m_enqueueTime;
+            shardQueue->enqueue(ticket);
+        }
+
+        //! Shard of a keyed operation, the idlest one for an unkeyed operation.
+        uint32 GetShard(uint64 routingKey) const
         {
-            _queue->enqueue(op);
+            if (_queues.size() < 2)
+                return 0;
+
+            if (routingKey == DB_ROUTING_ANY)
+                return GetIdlestShard();
+
+            //! multiplicative hash, consecutive ids land on different shards
+            uint64 hash = routingKey * UI64LIT(0x9E3779B97F4A7C15);
+            return uint32((hash >> 32) % _queues.size());
+        }
+
+        //! Shard with the fewest queued operations, counting the one its worker runs. The depths change
+        //! while they are read, a ticket can still land behind a slow operation, see UnkeyedOperationTicket.
+        uint32 GetIdlestShard() const
+        {
+            uint32 idlest = 0;
+            size_t idlestDepth = ~size_t(0);
+            for (uint32 i = 0; i < _queues.size(); ++i)
+            {
+                size_t depth = _queues[i]->method_count() + (_connections[IDX_ASYNC][i]->m_worker->IsBusy() ? 1 : 0);
+                if (depth < idlestDepth)
+                {
+                    idlest = i;
+                    idlestDepth = depth;
+                    if (!depth)
+                        break;
+                }
+            }
+
+            return idlest;
         }
 
         //! Gets a free connection in the synchronous connection pool.
@@ -509,10 +675,15 @@ class DatabaseWorkerPool
             IDX_SIZE,
         };
 
-        ACE_Activation_Queue*           _queue;             //! Queue shared by async worker threads.
+        //! Holders with fewer queries per slice are not worth the extra round trips through the queue.
+        static uint32 const MIN_QUERY_HOLDER_SLICE_SIZE = 4;
+
+        std::vector<ACE_Activation_Queue*> _queues;         //! One queue per async connection, executed in order.
+        ACE_Activation_Queue*           _unkeyedQueue;      //! Unkeyed operations, drained by every async connection.
         std::vector<T*>                 _connections[IDX_SIZE];
         uint32                          _connectionCount[IDX_SIZE];       //! Counter of MySQL connections;
         MySQLConnectionInfo             _connectionInfo;
+        uint32                          _queryHolderFanOut; //! Async connections one query holder may be split over.
 };
 
 #endif
@@ -23,6 +23,7 @@ Field::Field()
     data.type = MYSQL_TYPE_NULL;
     data.length = 0;
     data.raw = false;
+    data.owned = false;
 }
 
 Field::~Field()
@@ -41,6 +42,7 @@ void Field::SetByteValue(const void* newValue, const size_t newSize, enum_field_
         data.value = new char[newSize];
         memcpy(data.value, newValue, newSize);
         data.length = length;
+        data.owned = true;
     }
     data.type = newType;
     data.raw = true;
@@ -58,8 +60,31 @@ void Field::SetStructuredValue(char* newValue, enum_field_types newType)
         data.value = new char [size+1];
         strcpy((char*)data.value, newValue);
         data.length = size;
+        data.owned = true;
     }
 
     data.type = newType;
     data.raw = false;
 }
+
+void Field::SetByteReference(void const* newValue, enum_field_types newType, uint32 length)
+{
+    if (data.value)
+        CleanUp();
+
+    data.value = const_cast<void*>(newValue);
+    data.length = newValue ? length : 0;
+    data.type = newType;
+    data.raw = true;
+}
+
+void Field::SetStructuredReference(char const* newValue, enum_field_types newType, uint32 length)
+{
+    if (data.value)
+        CleanUp();
+
+    data.value = const_cast<char*>(newValue);
+    data.length = newValue ? length : 0;
+    data.type = newType;
+    data.raw = false;
+}
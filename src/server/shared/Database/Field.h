@@ -23,10 +23,24 @@
 
 #include <mysql.h>
 
+//! Non owning view of the bytes of a string or blob column, only valid while the row it was read from is.
+struct FieldBytes
+{
+    FieldBytes() : Data(""), Length(0) { }
+    FieldBytes(char const* data, uint32 length) : Data(data), Length(length) { }
+
+    bool Empty() const { return !Length; }
+    std::string ToString() const { return std::string(Data, Length); }
+
+    char const* Data;
+    uint32 Length;
+};
+
 class Field
 {
     friend class ResultSet;
     friend class PreparedResultSet;
+    friend class PreparedResultStream;
 
     public:
 
@@ -243,7 +257,24 @@ class Field
                     string = "";
                 return std::string(string, data.length);
             }
-            return std::string((char*)data.value);
+            return std::string((char*)data.value, data.length);
+        }
+
+        //! Same as GetString() without the copy, see FieldBytes.
+        FieldBytes GetBytes() const
+        {
+            if (!data.value)
+                return FieldBytes();
+
+            #ifdef TRINITY_DEBUG
+            if (IsNumeric())
+            {
+                sLog->outWarn(LOG_FILTER_SQL, "Error: GetBytes() on numeric field. Using type: %s.", FieldTypeToString(data.type));
+                return FieldBytes();
+            }
+            #endif
+
+            return FieldBytes(static_cast<char const*>(data.value), data.length);
         }
 
         uint32 GetStringLength() const
@@ -266,6 +297,7 @@ class Field
             void* value;            // Actual data in memory
             enum_field_types type;  // Field type
             bool raw;               // Raw bytes? (Prepared statement or ad hoc)
+            bool owned;             // Value allocated by the field, else it points into the result set buffers
          } data;
         #if defined(__GNUC__)
         #pragma pack()
@@ -276,10 +308,16 @@ class Field
         void SetByteValue(void const* newValue, size_t const newSize, enum_field_types newType, uint32 length);
         void SetStructuredValue(char* newValue, enum_field_types newType);
 
+        //! No copy, value must stay valid as long as the field is read
+        void SetByteReference(void const* newValue, enum_field_types newType, uint32 length);
+        void SetStructuredReference(char const* newValue, enum_field_types newType, uint32 length);
+
         void CleanUp()
         {
-            delete[] ((char*)data.value);
+            if (data.owned)
+                delete[] ((char*)data.value);
             data.value = NULL;
+            data.owned = false;
         }
 
         static size_t SizeForType(MYSQL_FIELD* field)
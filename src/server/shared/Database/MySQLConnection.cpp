@@ -482,6 +482,18 @@ PreparedResultSet* MySQLConnection::Query(PreparedStatement* stmt)
     return new PreparedResultSet(stmt->m_stmt->GetSTMT(), result, rowCount, fieldCount);
 }
 
+PreparedResultStream* MySQLConnection::StreamQuery(PreparedStatement* stmt)
+{
+    MYSQL_RES *result = NULL;
+    uint64 rowCount = 0;
+    uint32 fieldCount = 0;
+
+    if (!_Query(stmt, &result, &rowCount, &fieldCount))
+        return NULL;
+
+    return new PreparedResultStream(this, stmt->m_stmt->GetSTMT(), result, fieldCount);
+}
+
 bool MySQLConnection::_HandleMySQLErrno(uint32 errNo)
 {
     switch (errNo)
@@ -19,6 +19,7 @@
 #include "QueryHolder.h"
 #include "PreparedStatement.h"
 #include "Log.h"
+#include "Timer.h"
 
 bool SQLQueryHolder::SetQuery(size_t index, const char *sql)
 {
@@ -171,19 +172,12 @@ SQLQueryHolderTask::~SQLQueryHolderTask()
         delete m_holder;
 }
 
-bool SQLQueryHolderTask::Execute()
+void SQLQueryHolder::Execute(MySQLConnection* conn, size_t first, size_t stride)
 {
-    m_executed = true;
-    if (!m_holder)
-        return false;
-
-    /// we can do this, we are friends
-    std::vector<SQLQueryHolder::SQLResultPair> &queries = m_holder->m_queries;
-
-    for (size_t i = 0; i < queries.size(); i++)
+    for (size_t i = first; i < m_queries.size(); i += stride)
     {
-        /// execute all queries in the holder and pass the results
-        if (SQLElementData* data = &queries[i].first)
+        /// execute the queries of the slice and pass the results, every slice only touches its own indexes
+        if (SQLElementData* data = &m_queries[i].first)
         {
             switch (data->type)
             {
@@ -191,20 +185,93 @@ bool SQLQueryHolderTask::Execute()
                 {
                     char const* sql = data->element.query;
                     if (sql)
-                        m_holder->SetResult(i, m_conn->Query(sql));
+                        SetResult(i, conn->Query(sql));
                     break;
                 }
                 case SQL_ELEMENT_PREPARED:
                 {
                     PreparedStatement* stmt = data->element.stmt;
                     if (stmt)
-                        m_holder->SetPreparedResult(i, m_conn->Query(stmt));
+                        SetPreparedResult(i, conn->Query(stmt));
                     break;
                 }
             }
         }
     }
+}
+
+bool SQLQueryHolderTask::Execute()
+{
+    m_executed = true;
+    if (!m_holder)
+        return false;
+
+    m_holder->Execute(m_conn, 0, 1);
 
     m_result.set(m_holder);
     return true;
 }
+
+void SQLQueryHolderFanOut::LaunchDeferred()
+{
+    for (size_t i = 0; i < m_deferred.size(); ++i)
+    {
+        SQLQueryHolderSliceTask* slice = m_deferred[i].second;
+        slice->m_enqueueTime = getMSTime();
+
+        /// closed queue, the slice is dropped
+        if (m_deferred[i].first->enqueue(slice) == -1)
+            delete slice;
+    }
+
+    m_deferred.clear();
+}
+
+void SQLQueryHolderFanOut::DropDeferred()
+{
+    std::vector<std::pair<ACE_Activation_Queue*, SQLQueryHolderSliceTask*> > deferred;
+    deferred.swap(m_deferred);
+
+    for (size_t i = 0; i < deferred.size(); ++i)
+        delete deferred[i].second;
+}
+
+void SQLQueryHolderFanOut::SliceDone(bool executed)
+{
+    if (!executed)
+        ++m_dropped;
+
+    if (--m_pending != 0)
+        return;
+
+    /// same as an unexecuted SQLQueryHolderTask, the future is never set
+    if (m_dropped.value())
+        delete m_holder;
+    else
+        m_result.set(m_holder);
+
+    delete this;
+}
+
+SQLQueryHolderSliceTask::~SQLQueryHolderSliceTask()
+{
+    if (m_executed)
+        return;
+
+    /// the deferred slices hold the fan out alive until this one is done
+    if (!m_first)
+        m_fanOut->DropDeferred();
+
+    m_fanOut->SliceDone(false);
+}
+
+bool SQLQueryHolderSliceTask::Execute()
+{
+    m_executed = true;
+    if (!m_first)
+        m_fanOut->LaunchDeferred();
+
+    m_holder->Execute(m_conn, m_first, m_stride);
+    m_fanOut->SliceDone(true);
+    return true;
+}
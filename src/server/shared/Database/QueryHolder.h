@@ -19,13 +19,19 @@
 #define _QUERYHOLDER_H
 
 #include <ace/Future.h>
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
 
 class SQLQueryHolder
 {
     friend class SQLQueryHolderTask;
+    friend class SQLQueryHolderSliceTask;
     private:
         typedef std::pair<SQLElementData, SQLResultSetUnion> SQLResultPair;
         std::vector<SQLResultPair> m_queries;
+
+        //! Executes the queries first, first + stride, ... on conn.
+        void Execute(MySQLConnection* conn, size_t first, size_t stride);
     public:
         SQLQueryHolder() {}
         ~SQLQueryHolder();
@@ -33,6 +39,7 @@ class SQLQueryHolder
         bool SetPQuery(size_t index, const char *format, ...) ATTR_PRINTF(3, 4);
         bool SetPreparedQuery(size_t index, PreparedStatement* stmt);
         void SetSize(size_t size);
+        size_t GetSize() const { return m_queries.size(); }
         QueryResult GetResult(size_t index);
         PreparedQueryResult GetPreparedResult(size_t index);
         void SetResult(size_t index, ResultSet* result);
@@ -56,4 +63,47 @@ class SQLQueryHolderTask : public SQLOperation
 
 };
 
+class SQLQueryHolderSliceTask;
+
+//! Shared by the slices of a holder split over several async connections.
+//! The first slice is queued on the shard of the holder routing key and only
+//! queues the other ones once it runs, so the holder still executes after the
+//! operations queued before it with the same key. The slice finishing last
+//! hands the holder to the future, the callers receive all results in one step.
+class SQLQueryHolderFanOut
+{
+    public:
+        SQLQueryHolderFanOut(SQLQueryHolder* holder, QueryResultHolderFuture res, uint32 slices)
+            : m_holder(holder), m_result(res), m_pending(slices), m_dropped(0) {}
+
+        void Defer(ACE_Activation_Queue* queue, SQLQueryHolderSliceTask* slice) { m_deferred.push_back(std::make_pair(queue, slice)); }
+        void LaunchDeferred();
+        void DropDeferred();
+
+        void SliceDone(bool executed);
+
+    private:
+        SQLQueryHolder* m_holder;
+        QueryResultHolderFuture m_result;
+        std::vector<std::pair<ACE_Activation_Queue*, SQLQueryHolderSliceTask*> > m_deferred;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_pending;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_dropped;      //! slices destroyed without being executed (queue closed)
+};
+
+class SQLQueryHolderSliceTask : public SQLOperation
+{
+    private:
+        SQLQueryHolderFanOut* m_fanOut;
+        SQLQueryHolder* m_holder;
+        size_t m_first;
+        size_t m_stride;
+        bool m_executed;
+
+    public:
+        SQLQueryHolderSliceTask(SQLQueryHolderFanOut* fanOut, SQLQueryHolder* holder, size_t first, size_t stride)
+            : m_fanOut(fanOut), m_holder(holder), m_first(first), m_stride(stride), m_executed(false) {};
+        ~SQLQueryHolderSliceTask();
+        bool Execute();
+};
+
 #endif
\ No newline at end of file
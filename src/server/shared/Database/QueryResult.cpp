@@ -19,6 +19,47 @@
 #include "DatabaseEnv.h"
 #include "Log.h"
 
+namespace
+{
+    //! Size of the blocks holding the field values of a PreparedResultSet
+    size_t const PREPARED_RESULT_DATA_BLOCK_SIZE = 64 * 1024;
+    //! Initial bind buffer of the variable length columns of a PreparedResultStream, grown on demand
+    size_t const PREPARED_STREAM_STRING_BUFFER_SIZE = 256;
+
+    bool IsStringType(enum_field_types type)
+    {
+        switch (type)
+        {
+            case MYSQL_TYPE_TINY_BLOB:
+            case MYSQL_TYPE_MEDIUM_BLOB:
+            case MYSQL_TYPE_LONG_BLOB:
+            case MYSQL_TYPE_BLOB:
+            case MYSQL_TYPE_STRING:
+            case MYSQL_TYPE_VAR_STRING:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    //! Columns sent as text, their length is only known from max_length after mysql_stmt_store_result.
+    //! The other types have a fixed size (Field::SizeForType).
+    bool IsVariableLengthType(enum_field_types type)
+    {
+        switch (type)
+        {
+            case MYSQL_TYPE_DECIMAL:
+            case MYSQL_TYPE_NEWDECIMAL:
+            case MYSQL_TYPE_VARCHAR:
+            case MYSQL_TYPE_ENUM:
+            case MYSQL_TYPE_SET:
+                return true;
+            default:
+                return IsStringType(type);
+        }
+    }
+}
+
 ResultSet::ResultSet(MYSQL_RES *result, MYSQL_FIELD *fields, uint64 rowCount, uint32 fieldCount) :
 _rowCount(rowCount),
 _fieldCount(fieldCount),
@@ -30,6 +71,7 @@ _fields(fields)
 }
 
 PreparedResultSet::PreparedResultSet(MYSQL_STMT* stmt, MYSQL_RES *result, uint64 rowCount, uint32 fieldCount) :
+m_rows(NULL),
 m_rowCount(rowCount),
 m_rowPosition(0),
 m_fieldCount(fieldCount),
@@ -37,7 +79,9 @@ m_rBind(NULL),
 m_stmt(stmt),
 m_res(result),
 m_isNull(NULL),
-m_length(NULL)
+m_length(NULL),
+m_dataBlockPos(NULL),
+m_dataBlockFree(0)
 {
     if (!m_res)
         return;
@@ -95,38 +139,13 @@ m_length(NULL)
 
     m_rowCount = mysql_stmt_num_rows(m_stmt);
 
-    m_rows.resize(uint32(m_rowCount));
+    m_rows = new Field[uint32(m_rowCount) * m_fieldCount];
     while (_NextRow())
     {
-        m_rows[uint32(m_rowPosition)] = new Field[m_fieldCount];
-        for (uint64 fIndex = 0; fIndex < m_fieldCount; ++fIndex)
-        {
-            if (!*m_rBind[fIndex].is_null)
-                m_rows[uint32(m_rowPosition)][fIndex].SetByteValue( m_rBind[fIndex].buffer,
-                                                            m_rBind[fIndex].buffer_length,
-                                                            m_rBind[fIndex].buffer_type,
-                                                           *m_rBind[fIndex].length );
-            else
-                switch (m_rBind[fIndex].buffer_type)
-                {
-                    case MYSQL_TYPE_TINY_BLOB:
-                    case MYSQL_TYPE_MEDIUM_BLOB:
-                    case MYSQL_TYPE_LONG_BLOB:
-                    case MYSQL_TYPE_BLOB:
-                    case MYSQL_TYPE_STRING:
-                    case MYSQL_TYPE_VAR_STRING:
-                    m_rows[uint32(m_rowPosition)][fIndex].SetByteValue( "",
-                                                            m_rBind[fIndex].buffer_length,
-                                                            m_rBind[fIndex].buffer_type,
-                                                           *m_rBind[fIndex].length );
-                    break;
-                    default:
-                    m_rows[uint32(m_rowPosition)][fIndex].SetByteValue( 0,
-                                                            m_rBind[fIndex].buffer_length,
-                                                            m_rBind[fIndex].buffer_type,
-                                                           *m_rBind[fIndex].length );
-                }
-        }
+        Field* row = &m_rows[uint32(m_rowPosition) * m_fieldCount];
+        for (uint32 fIndex = 0; fIndex < m_fieldCount; ++fIndex)
+            CopyField(row[fIndex], m_rBind[fIndex]);
+
         m_rowPosition++;
     }
     m_rowPosition = 0;
@@ -142,8 +161,46 @@ ResultSet::~ResultSet()
 
 PreparedResultSet::~PreparedResultSet()
 {
-    for (uint32 i = 0; i < uint32(m_rowCount); ++i)
-        delete[] m_rows[i];
+    delete[] m_rows;
+
+    for (size_t i = 0; i < m_dataBlocks.size(); ++i)
+        delete[] m_dataBlocks[i];
+}
+
+void PreparedResultSet::CopyField(Field& field, MYSQL_BIND const& bind)
+{
+    bool isString = IsStringType(bind.buffer_type);
+    if (*bind.is_null)
+    {
+        field.SetByteReference(isString ? "" : NULL, bind.buffer_type, 0);
+        return;
+    }
+
+    /// strings only take their actual length, not the size of the longest value of the column
+    size_t size = isString ? std::min<size_t>(*bind.length, bind.buffer_length) : bind.buffer_length;
+    char* value = AllocateFieldData(size + 1);
+    memcpy(value, bind.buffer, size);
+    value[size] = '\0';
+
+    field.SetByteReference(value, bind.buffer_type, isString ? uint32(size) : *bind.length);
+}
+
+char* PreparedResultSet::AllocateFieldData(size_t size)
+{
+    /// keep the numeric values aligned
+    size = (size + 7) & ~size_t(7);
+    if (size > m_dataBlockFree)
+    {
+        size_t blockSize = std::max(size, PREPARED_RESULT_DATA_BLOCK_SIZE);
+        m_dataBlocks.push_back(new char[blockSize]);
+        m_dataBlockPos = m_dataBlocks.back();
+        m_dataBlockFree = blockSize;
+    }
+
+    char* data = m_dataBlockPos;
+    m_dataBlockPos += size;
+    m_dataBlockFree -= size;
+    return data;
 }
 
 bool ResultSet::NextRow()
@@ -160,8 +217,10 @@ bool ResultSet::NextRow()
         return false;
     }
 
+    /// the fields point into the row, it stays valid until the result is freed
+    unsigned long* lengths = mysql_fetch_lengths(_result);
     for (uint32 i = 0; i < _fieldCount; i++)
-        _currentRow[i].SetStructuredValue(row[i], _fields[i].type);
+        _currentRow[i].SetStructuredReference(row[i], _fields[i].type, uint32(lengths[i]));
 
     return true;
 }
@@ -226,3 +285,159 @@ void PreparedResultSet::FreeBindBuffer()
     for (uint32 i = 0; i < m_fieldCount; ++i)
         free (m_rBind[i].buffer);
 }
+
+PreparedResultStream::PreparedResultStream(MySQLConnection* conn, MYSQL_STMT* stmt, MYSQL_RES* result, uint32 fieldCount) :
+m_conn(conn),
+m_stmt(stmt),
+m_res(result),
+m_rBind(NULL),
+m_isNull(NULL),
+m_length(NULL),
+m_row(NULL),
+m_fieldCount(fieldCount),
+m_bound(false)
+{
+    if (!m_res)
+        return;
+
+    /// same ownership of the length and is_null arrays as PreparedResultSet
+    if (m_stmt->bind_result_done)
+    {
+        delete[] m_stmt->bind->length;
+        delete[] m_stmt->bind->is_null;
+    }
+
+    m_rBind = new MYSQL_BIND[m_fieldCount];
+    m_isNull = new my_bool[m_fieldCount];
+    m_length = new unsigned long[m_fieldCount];
+    m_row = new Field[m_fieldCount];
+
+    memset(m_isNull, 0, sizeof(my_bool) * m_fieldCount);
+    memset(m_rBind, 0, sizeof(MYSQL_BIND) * m_fieldCount);
+    memset(m_length, 0, sizeof(unsigned long) * m_fieldCount);
+
+    //- No mysql_stmt_store_result, every mysql_stmt_fetch reads the next row from the connection.
+    //- max_length is unknown without it, the buffers of the strings, blobs and decimals start small
+    //- and grow in FetchTruncatedColumns.
+    uint32 i = 0;
+    MYSQL_FIELD* field = mysql_fetch_field(m_res);
+    while (field)
+    {
+        size_t size = IsVariableLengthType(field->type) ? PREPARED_STREAM_STRING_BUFFER_SIZE : Field::SizeForType(field);
+
+        m_rBind[i].buffer_type = field->type;
+        m_rBind[i].buffer = malloc(size);
+        memset(m_rBind[i].buffer, 0, size);
+        m_rBind[i].buffer_length = size;
+        m_rBind[i].length = &m_length[i];
+        m_rBind[i].is_null = &m_isNull[i];
+        m_rBind[i].error = NULL;
+        m_rBind[i].is_unsigned = field->flags & UNSIGNED_FLAG;
+
+        ++i;
+        field = mysql_fetch_field(m_res);
+    }
+
+    if (mysql_stmt_bind_result(m_stmt, m_rBind))
+    {
+        sLog->outWarn(LOG_FILTER_SQL, "%s:mysql_stmt_bind_result, cannot bind result from MySQL server. Error: %s", __FUNCTION__, mysql_stmt_error(m_stmt));
+        return;
+    }
+
+    m_bound = true;
+}
+
+PreparedResultStream::~PreparedResultStream()
+{
+    if (m_res)
+    {
+        mysql_free_result(m_res);
+
+        /// also discards the rows that were not read
+        mysql_stmt_free_result(m_stmt);
+
+        for (uint32 i = 0; i < m_fieldCount; ++i)
+            free(m_rBind[i].buffer);
+
+        delete[] m_rBind;
+        delete[] m_row;
+
+        /// bound arrays are deleted by the next result of the statement
+        if (!m_bound)
+        {
+            delete[] m_isNull;
+            delete[] m_length;
+        }
+    }
+
+    m_conn->Unlock();
+}
+
+bool PreparedResultStream::NextRow()
+{
+    if (!m_bound)
+        return false;
+
+    int retval = mysql_stmt_fetch(m_stmt);
+    if (retval == MYSQL_NO_DATA)
+        return false;
+
+    if (retval && retval != MYSQL_DATA_TRUNCATED)
+    {
+        sLog->outWarn(LOG_FILTER_SQL, "%s:mysql_stmt_fetch, cannot fetch row from MySQL server. Error: %s", __FUNCTION__, mysql_stmt_error(m_stmt));
+        return false;
+    }
+
+    if (!FetchTruncatedColumns())
+        return false;
+
+    for (uint32 i = 0; i < m_fieldCount; ++i)
+    {
+        MYSQL_BIND& bind = m_rBind[i];
+        if (m_isNull[i])
+        {
+            m_row[i].SetByteReference(IsStringType(bind.buffer_type) ? "" : NULL, bind.buffer_type, 0);
+            continue;
+        }
+
+        if (IsVariableLengthType(bind.buffer_type))
+            static_cast<char*>(bind.buffer)[m_length[i]] = '\0';
+
+        m_row[i].SetByteReference(bind.buffer, bind.buffer_type, m_length[i]);
+    }
+
+    return true;
+}
+
+bool PreparedResultStream::FetchTruncatedColumns()
+{
+    bool rebind = false;
+    for (uint32 i = 0; i < m_fieldCount; ++i)
+    {
+        MYSQL_BIND& bind = m_rBind[i];
+
+        /// text also needs room for the terminating null character
+        if (m_isNull[i] || !IsVariableLengthType(bind.buffer_type) || m_length[i] < bind.buffer_length)
+            continue;
+
+        size_t size = m_length[i] + 1;
+        bind.buffer = realloc(bind.buffer, size);
+        bind.buffer_length = size;
+        if (mysql_stmt_fetch_column(m_stmt, &bind, i, 0))
+        {
+            sLog->outWarn(LOG_FILTER_SQL, "%s:mysql_stmt_fetch_column, cannot fetch column %u from MySQL server. Error: %s", __FUNCTION__, i, mysql_stmt_error(m_stmt));
+            return false;
+        }
+
+        rebind = true;
+    }
+
+    /// the grown buffers are used for the following rows too
+    if (rebind && mysql_stmt_bind_result(m_stmt, m_rBind))
+    {
+        sLog->outWarn(LOG_FILTER_SQL, "%s:mysql_stmt_bind_result, cannot bind result from MySQL server. Error: %s", __FUNCTION__, mysql_stmt_error(m_stmt));
+        return false;
+    }
+
+    return true;
+}
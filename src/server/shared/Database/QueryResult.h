@@ -21,6 +21,7 @@
 
 #include "AutoPtr.h"
 #include <ace/Thread_Mutex.h>
+#include <ace/Null_Mutex.h>
 
 #include "Field.h"
 #include "Log.h"
@@ -73,18 +74,18 @@ class PreparedResultSet
         Field* Fetch() const
         {
             ASSERT(m_rowPosition < m_rowCount);
-            return m_rows[uint32(m_rowPosition)];
+            return &m_rows[uint32(m_rowPosition) * m_fieldCount];
         }
 
         const Field & operator [] (uint32 index) const
         {
             ASSERT(m_rowPosition < m_rowCount);
             ASSERT(index < m_fieldCount);
-            return m_rows[uint32(m_rowPosition)][index];
+            return m_rows[uint32(m_rowPosition) * m_fieldCount + index];
         }
 
     protected:
-        std::vector<Field*> m_rows;
+        Field* m_rows;                                      // m_rowCount * m_fieldCount fields, row after row
         uint64 m_rowCount;
         uint64 m_rowPosition;
         uint32 m_fieldCount;
@@ -97,13 +98,61 @@ class PreparedResultSet
         my_bool* m_isNull;
         unsigned long* m_length;
 
+        //! The field values point into a few large blocks instead of one allocation per field
+        std::vector<char*> m_dataBlocks;
+        char* m_dataBlockPos;
+        size_t m_dataBlockFree;
+
         void FreeBindBuffer();
         void CleanUp();
         bool _NextRow();
 
+        void CopyField(Field& field, MYSQL_BIND const& bind);
+        char* AllocateFieldData(size_t size);
 };
 
 typedef MoPCore::AutoPtr<PreparedResultSet, ACE_Thread_Mutex> PreparedQueryResult;
 
+class MySQLConnection;
+
+//! Rows of a prepared query read one at a time from the statement bind buffers, nothing is
+//! materialized: the fields of the current row point into the bind buffers and are only valid
+//! until the next NextRow(). The connection stays locked (and the result unbuffered on the
+//! server side) until the stream is destroyed, see DatabaseWorkerPool::StreamQuery.
+class PreparedResultStream
+{
+    public:
+        PreparedResultStream(MySQLConnection* conn, MYSQL_STMT* stmt, MYSQL_RES* result, uint32 fieldCount);
+        ~PreparedResultStream();
+
+        bool NextRow();
+        uint32 GetFieldCount() const { return m_fieldCount; }
+
+        Field* Fetch() const { return m_row; }
+        const Field & operator [] (uint32 index) const
+        {
+            ASSERT(index < m_fieldCount);
+            return m_row[index];
+        }
+
+    private:
+        PreparedResultStream(PreparedResultStream const&);
+        PreparedResultStream& operator=(PreparedResultStream const&);
+
+        bool FetchTruncatedColumns();
+
+        MySQLConnection* m_conn;
+        MYSQL_STMT* m_stmt;
+        MYSQL_RES* m_res;
+        MYSQL_BIND* m_rBind;
+        my_bool* m_isNull;
+        unsigned long* m_length;
+        Field* m_row;
+        uint32 m_fieldCount;
+        bool m_bound;
+};
+
+typedef MoPCore::AutoPtr<PreparedResultStream, ACE_Null_Mutex> PreparedQueryStream;
+
 #endif
 
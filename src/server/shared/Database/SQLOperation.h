@@ -21,6 +21,7 @@
 #include <ace/Method_Request.h>
 #include <ace/Activation_Queue.h>
 
+#include "Define.h"
 #include "QueryResult.h"
 
 //- Forward declare (don't include header to prevent circular includes)
@@ -54,12 +55,25 @@ union SQLResultSetUnion
     ResultSet* qresult;
 };
 
+//- Routing keys of the async operations: operations with the same key are executed
+//- in order by the same async connection of the pool.
+enum DatabaseRoutingDomain
+{
+    DB_ROUTING_ANY      = 0,    // unkeyed, run by the first free async connection without ordering
+    DB_ROUTING_ACCOUNT  = 1,    // everything an account and its characters load and save
+};
+
+inline uint64 MakeDatabaseRoutingKey(DatabaseRoutingDomain domain, uint32 id)
+{
+    return (uint64(domain) << 32) | id;
+}
+
 class MySQLConnection;
 
 class SQLOperation : public ACE_Method_Request
 {
     public:
-        SQLOperation(): m_conn(NULL) {};
+        SQLOperation(): m_conn(NULL), m_enqueueTime(0) {};
         virtual int call()
         {
             Execute();
@@ -69,6 +83,7 @@ class SQLOperation : public ACE_Method_Request
         virtual void SetConnection(MySQLConnection* con) { m_conn = con; }
 
         MySQLConnection* m_conn;
+        uint32 m_enqueueTime;                               //- getMSTime() when queued, for the shard latency
 };
 
 #endif
@@ -0,0 +1,121 @@
+/*
+* Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRINITY_FLAT_SET_H
+#define TRINITY_FLAT_SET_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+// Sorted vector with a std::set like interface. Lookups are binary searches over
+// contiguous memory and inserts/erases don't allocate once capacity is reached.
+// Iterators are invalidated by insert and erase, like std::vector ones.
+template<class T>
+class FlatSet
+{
+    public:
+        typedef T key_type;
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+        typedef typename container_type::const_iterator const_iterator;
+        typedef const_iterator iterator;                    // elements are keys, never modifiable in place
+        typedef typename container_type::size_type size_type;
+
+        const_iterator begin() const { return _elements.begin(); }
+        const_iterator end() const { return _elements.end(); }
+        bool empty() const { return _elements.empty(); }
+        size_type size() const { return _elements.size(); }
+        void clear() { _elements.clear(); }
+        void reserve(size_type count) { _elements.reserve(count); }
+
+        const_iterator find(T const& value) const
+        {
+            const_iterator itr = std::lower_bound(_elements.begin(), _elements.end(), value);
+            if (itr != _elements.end() && !(value < *itr))
+                return itr;
+            return _elements.end();
+        }
+
+        size_type count(T const& value) const { return find(value) != end() ? 1 : 0; }
+
+        std::pair<const_iterator, bool> insert(T const& value)
+        {
+            // appending in order is the common case (rebuilding from sorted data)
+            if (_elements.empty() || _elements.back() < value)
+            {
+                _elements.push_back(value);
+                return std::make_pair(_elements.end() - 1, true);
+            }
+
+            typename container_type::iterator itr = std::lower_bound(_elements.begin(), _elements.end(), value);
+            if (!(value < *itr))
+                return std::make_pair(const_iterator(itr), false);
+
+            itr = _elements.insert(itr, value);
+            return std::make_pair(const_iterator(itr), true);
+        }
+
+        // Inserts [first, last) with one sort and merge pass instead of a shifting insert per element
+        template<class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            size_type oldSize = _elements.size();
+            _elements.insert(_elements.end(), first, last);
+
+            typename container_type::iterator middle = _elements.begin() + oldSize;
+            if (!std::is_sorted(middle, _elements.end()))
+                std::sort(middle, _elements.end());
+
+            std::inplace_merge(_elements.begin(), middle, _elements.end());
+            _elements.erase(std::unique(_elements.begin(), _elements.end()), _elements.end());
+        }
+
+        size_type erase(T const& value)
+        {
+            typename container_type::iterator itr = std::lower_bound(_elements.begin(), _elements.end(), value);
+            if (itr == _elements.end() || value < *itr)
+                return 0;
+
+            _elements.erase(itr);
+            return 1;
+        }
+
+        // Removes every element for which pred returns true in a single pass.
+        // pred is called exactly once per element, in ascending order.
+        template<class Predicate>
+        void erase_if(Predicate pred)
+        {
+            typename container_type::iterator out = _elements.begin();
+            for (typename container_type::iterator itr = _elements.begin(); itr != _elements.end(); ++itr)
+            {
+                if (pred(*itr))
+                    continue;
+
+                if (out != itr)
+                    *out = *itr;
+                ++out;
+            }
+
+            _elements.erase(out, _elements.end());
+        }
+
+    private:
+        container_type _elements;
+};
+
+#endif
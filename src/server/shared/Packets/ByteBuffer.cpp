@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ByteBuffer.h"
+
+// 64 bytes up to 64 KB, bigger packets (initial object updates, addon data) go to malloc
+#define BYTEBUFFER_POOL_MIN_SHIFT   6
+#define BYTEBUFFER_POOL_MAX_SHIFT   16
+#define BYTEBUFFER_POOL_CACHE_LIMIT 64
+
+SizeClassPool& ByteBuffer::GetStoragePool()
+{
+    // function local so packets built during static initialization find it constructed
+    static SizeClassPool pool("ByteBuffer", BYTEBUFFER_POOL_MIN_SHIFT, BYTEBUFFER_POOL_MAX_SHIFT, BYTEBUFFER_POOL_CACHE_LIMIT);
+    return pool;
+}
@@ -23,6 +23,7 @@
 #include "Debugging/Errors.h"
 #include "Log.h"
 #include "Utilities/ByteConverter.h"
+#include "Utilities/MemoryPool.h"
 
 //! Structure to ease conversions from single 64 bit integer guid into individual bytes, for packet sending purposes
 //! Nuke this out when porting ObjectGuid from MaNGOS, but preserve the per-byte storage
@@ -150,6 +151,11 @@ class ByteBuffer
     public:
         const static size_t DEFAULT_SIZE = 0x1000;
 
+        // packet storage comes from a size class pool with per thread caches, buffers
+        // of destroyed packets are reused by the next packets built on the same thread
+        static SizeClassPool& GetStoragePool();
+        typedef std::vector<uint8, PoolAllocator<uint8, &ByteBuffer::GetStoragePool> > StorageType;
+
         // constructor
         ByteBuffer() : _rpos(0), _wpos(0), _bitpos(8), _curbitval(0)
         {
@@ -758,7 +764,7 @@ class ByteBuffer
     protected:
         size_t _rpos, _wpos, _bitpos;
         uint8 _curbitval;
-        std::vector<uint8> _storage;
+        StorageType _storage;
 };
 
 template <typename T>
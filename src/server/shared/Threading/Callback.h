@@ -20,6 +20,9 @@
 
 #include <ace/Future.h>
 #include <ace/Future_Set.h>
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/Thread_Mutex.h>
 #include "QueryResult.h"
 
 typedef ACE_Future<QueryResult> QueryResultFuture;
@@ -31,16 +34,76 @@ typedef ACE_Future<PreparedQueryResult> PreparedQueryResultFuture;
 */
 #define CALLBACK_STAGE_INVALID uint8(-1)
 
-template <typename Result, typename ParamType, bool chain = false>
-class QueryCallback
+/*! Slots of the QueryCallbacks of one owner whose result was set since the owner last looked.
+    The database worker setting the result marks the slot, so the owner only dispatches the
+    callbacks that completed instead of polling every future on every update.
+*/
+class QueryCompletionQueue
 {
     public:
-        QueryCallback() : _param(), _stage(chain ? 0 : CALLBACK_STAGE_INVALID)  {}
+        QueryCompletionQueue() : _completed(0), _count(0) {}
+
+        //! Called from the database worker thread
+        void Push(uint8 slot)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, _lock);
+            _completed |= uint32(1) << slot;
+            ++_count;
+        }
+
+        //! Cheap check for the owner's update, no lock taken when nothing completed
+        bool HasCompletions() const
+        {
+            return _count.value() != 0;
+        }
+
+        //! Returns the mask of completed slots and forgets them
+        uint32 PopAll()
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, _lock, 0);
+            uint32 completed = _completed;
+            _completed = 0;
+            _count = 0;
+            return completed;
+        }
+
+    private:
+        ACE_Thread_Mutex _lock;
+        uint32 _completed;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> _count;
+};
+
+template <typename Result, typename ParamType = void*, bool chain = false>
+class QueryCallback : public ACE_Future_Observer<Result>
+{
+    public:
+        QueryCallback() : _param(), _stage(chain ? 0 : CALLBACK_STAGE_INVALID), _completions(NULL), _slot(0)  {}
+
+        ~QueryCallback()
+        {
+            // the database worker must not notify a destroyed callback
+            if (_completions)
+                _result.detach(this);
+        }
+
+        //! Reports the completion of every future set on this callback to queue as slot
+        void SetCompletionQueue(QueryCompletionQueue* queue, uint8 slot)
+        {
+            _completions = queue;
+            _slot = slot;
+        }
 
         //! The parameter of this function should be a resultset returned from either .AsyncQuery or .AsyncPQuery
         void SetFutureResult(ACE_Future<Result> value)
         {
+            if (_completions)
+                _result.detach(this);
+
             _result = value;
+
+            // notifies right away when the result is already set
+            if (_completions)
+                _result.attach(this);
         }
 
         ACE_Future<Result> GetFutureResult()
@@ -60,6 +123,9 @@ class QueryCallback
 
         void FreeResult()
         {
+            if (_completions)
+                _result.detach(this);
+
             _result.cancel();
         }
 
@@ -105,10 +171,21 @@ class QueryCallback
             ResetStage();
         }
 
+        //! Called by the database worker setting the result
+        void update(ACE_Future<Result> const& /*future*/)
+        {
+            _completions->Push(_slot);
+        }
+
     private:
+        QueryCallback(QueryCallback const&);
+        QueryCallback& operator=(QueryCallback const&);
+
         ACE_Future<Result> _result;
         ParamType _param;
         uint8 _stage;
+        QueryCompletionQueue* _completions;
+        uint8 _slot;
 };
 
 template <typename Result, typename ParamType1, typename ParamType2, bool chain = false>
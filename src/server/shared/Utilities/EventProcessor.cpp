@@ -17,16 +17,69 @@
  */
 
 #include "EventProcessor.h"
+#include "MemoryPool.h"
+#include "Util.h"
+
+#include <string.h>
+
+#define EVENT_WHEEL_SLOT_MASK   (EVENT_WHEEL_SLOTS - 1)
+
+// BasicEvent objects and the wheel slot arrays both come from here
+static SizeClassPool sEventPool("BasicEvent", 5, 10, 512);
+
+// event lists are circular and referenced by their tail, tail->m_next is the head,
+// so events can be appended in O(1) and leave the list in the order they were added
+void EventProcessor::AppendEvent(BasicEvent*& tail, BasicEvent* Event)
+{
+    if (tail)
+    {
+        Event->m_next = tail->m_next;
+        tail->m_next = Event;
+    }
+    else
+        Event->m_next = Event;
+    tail = Event;
+}
+
+// empties the list and returns its events as a NULL terminated chain, oldest first
+BasicEvent* EventProcessor::DetachEvents(BasicEvent*& tail)
+{
+    if (!tail)
+        return NULL;
+
+    BasicEvent* head = tail->m_next;
+    tail->m_next = NULL;
+    tail = NULL;
+    return head;
+}
+
+void* BasicEvent::operator new(size_t size)
+{
+    return sEventPool.Allocate(size);
+}
+
+void BasicEvent::operator delete(void* ptr, size_t size)
+{
+    sEventPool.Deallocate(ptr, size);
+}
 
 EventProcessor::EventProcessor()
 {
     m_time = 0;
     m_aborting = false;
+    m_wheelTime = 0;
+    m_slots = NULL;
+    memset(m_occupied, 0, sizeof(m_occupied));
+    m_overflow = NULL;
+    m_due = NULL;
 }
 
 EventProcessor::~EventProcessor()
 {
     KillAllEvents(true);
+
+    if (m_slots)
+        sEventPool.Deallocate(m_slots, EVENT_WHEEL_LEVELS * EVENT_WHEEL_SLOTS * sizeof(BasicEvent*));
 }
 
 void EventProcessor::Update(uint32 p_time)
@@ -35,27 +88,177 @@ void EventProcessor::Update(uint32 p_time)
     m_time += p_time;
 
     // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    for (;;)
     {
-        // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        // move the wheel forward until some events are due or we reach the current time
+        AdvanceTo(m_time);
+        if (!m_due)
+            break;
 
-        if (!Event->to_Abort)
+        while (m_due)
         {
-            if (Event->Execute(m_time, p_time))
+            // get and remove event from queue
+            BasicEvent* Event = m_due->m_next;
+            if (Event == m_due)
+                m_due = NULL;
+            else
+                m_due->m_next = Event->m_next;
+            Event->m_next = NULL;
+
+            if (!Event->to_Abort)
             {
-                // completely destroy event if it is not re-added
+                if (Event->Execute(m_time, p_time))
+                {
+                    // completely destroy event if it is not re-added
+                    delete Event;
+                }
+            }
+            else
+            {
+                Event->Abort(m_time);
                 delete Event;
             }
         }
+    }
+}
+
+void EventProcessor::AdvanceTo(uint64 limit)
+{
+    while (m_wheelTime < limit && !m_due)
+    {
+        // lowest non empty level holds the earliest events, the first occupied
+        // slot after the current position tells where the wheel has to stop next
+        int32 level = -1;
+        uint32 slot = 0;
+        uint64 next = limit;
+        for (uint8 i = 0; i < EVENT_WHEEL_LEVELS; ++i)
+        {
+            uint32 shift = i * EVENT_WHEEL_LEVEL_BITS;
+            uint32 position = uint32(m_wheelTime >> shift) & EVENT_WHEEL_SLOT_MASK;
+            uint32 pending = m_occupied[i] & ~((2u << position) - 1);
+            if (!pending)
+                continue;
+
+            level = i;
+            slot = CountTrailingZeros(pending);
+            next = ((m_wheelTime >> (shift + EVENT_WHEEL_LEVEL_BITS)) << (shift + EVENT_WHEEL_LEVEL_BITS)) | (uint64(slot) << shift);
+            break;
+        }
+
+        if (level < 0)
+        {
+            if (!m_overflow)
+            {
+                m_wheelTime = limit;
+                return;
+            }
+
+            // overflow events are reconsidered each time the whole wheel turned around
+            uint32 span = EVENT_WHEEL_LEVELS * EVENT_WHEEL_LEVEL_BITS;
+            next = ((m_wheelTime >> span) + 1) << span;
+        }
+
+        if (next > limit)
+        {
+            m_wheelTime = limit;
+            return;
+        }
+
+        m_wheelTime = next;
+
+        BasicEvent* list;
+        if (level < 0)
+            list = DetachEvents(m_overflow);
         else
         {
-            Event->Abort(m_time);
+            list = DetachEvents(m_slots[level * EVENT_WHEEL_SLOTS + slot]);
+            m_occupied[level] &= ~(1u << slot);
+        }
+
+        // level 0 events end up in the due list, others move to a finer level
+        Cascade(list);
+    }
+}
+
+void EventProcessor::Cascade(BasicEvent* list)
+{
+    // the list is in insertion order, appending keeps events due on the same tick FIFO
+    while (list)
+    {
+        BasicEvent* Event = list;
+        list = Event->m_next;
+        Schedule(Event);
+    }
+}
+
+void EventProcessor::Schedule(BasicEvent* Event)
+{
+    uint64 e_time = Event->m_execTime;
+    if (e_time <= m_wheelTime)
+    {
+        AppendEvent(m_due, Event);
+        return;
+    }
+
+    if (!m_slots)
+    {
+        size_t size = EVENT_WHEEL_LEVELS * EVENT_WHEEL_SLOTS * sizeof(BasicEvent*);
+        m_slots = static_cast<BasicEvent**>(sEventPool.Allocate(size));
+        memset(m_slots, 0, size);
+    }
+
+    // the level is given by the highest time digit that differs from the current wheel position
+    uint64 diff = e_time ^ m_wheelTime;
+    for (uint8 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+    {
+        uint32 shift = level * EVENT_WHEEL_LEVEL_BITS;
+        if (diff >> (shift + EVENT_WHEEL_LEVEL_BITS))
+            continue;
+
+        uint32 slot = uint32(e_time >> shift) & EVENT_WHEEL_SLOT_MASK;
+        AppendEvent(m_slots[level * EVENT_WHEEL_SLOTS + slot], Event);
+        m_occupied[level] |= 1u << slot;
+        return;
+    }
+
+    AppendEvent(m_overflow, Event);
+}
+
+void EventProcessor::AbortList(BasicEvent*& list, bool force)
+{
+    // detach the list, Abort() handlers are free to add new events meanwhile
+    BasicEvent* pending = DetachEvents(list);
+
+    BasicEvent* kept = NULL;
+    while (pending)
+    {
+        BasicEvent* Event = pending;
+        pending = Event->m_next;
+
+        Event->to_Abort = true;
+        Event->Abort(m_time);
+        if (force || Event->IsDeletable())
+        {
             delete Event;
+            continue;
         }
+
+        // need per-element cleanup, event stays queued and is deleted on execution
+        AppendEvent(kept, Event);
     }
+
+    if (!kept)
+        return;
+
+    // kept events go in front of the ones added meanwhile
+    if (list)
+    {
+        BasicEvent* head = kept->m_next;
+        kept->m_next = list->m_next;
+        list->m_next = head;
+    }
+    else
+        list = kept;
 }
 
 void EventProcessor::KillAllEvents(bool force)
@@ -64,36 +267,38 @@ void EventProcessor::KillAllEvents(bool force)
     m_aborting = true;
 
     // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
-    {
-        EventList::iterator i_old = i;
-        ++i;
+    AbortList(m_due, force);
 
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
+    if (m_slots)
+    {
+        for (uint8 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
         {
-            delete i_old->second;
+            for (uint32 slot = 0; slot < EVENT_WHEEL_SLOTS; ++slot)
+            {
+                BasicEvent*& list = m_slots[level * EVENT_WHEEL_SLOTS + slot];
+                if (!list)
+                    continue;
 
-            if (!force)                                      // need per-element cleanup
-                m_events.erase (i_old);
+                AbortList(list, force);
+                if (list)
+                    m_occupied[level] |= 1u << slot;
+                else
+                    m_occupied[level] &= ~(1u << slot);
+            }
         }
     }
 
-    // fast clear event list (in force case)
-    if (force)
-        m_events.clear();
+    AbortList(m_overflow, force);
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
 {
     if (set_addtime) Event->m_addTime = m_time;
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Schedule(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset) const
 {
     return(m_time + t_offset);
 }
-
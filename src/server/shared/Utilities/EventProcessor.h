@@ -21,14 +21,16 @@
 
 #include "Define.h"
 
-#include <map>
-
 // Note. All times are in milliseconds here.
 
+class EventProcessor;
+
 class BasicEvent
 {
+    friend class EventProcessor;
+
     public:
-        BasicEvent() { to_Abort = false; }
+        BasicEvent() : m_next(NULL) { to_Abort = false; }
         virtual ~BasicEvent() {}                              // override destructor to perform some actions on event removal
 
 
@@ -47,9 +49,21 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+        // events are allocated very often, keep their storage in a size class pool
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
+    private:
+        BasicEvent* m_next;                                 // intrusive link in the EventProcessor slot lists
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+// Hierarchical timer wheel: EVENT_WHEEL_LEVELS levels of EVENT_WHEEL_SLOTS slots,
+// level 0 has a resolution of 1 ms, every next level is EVENT_WHEEL_SLOTS times coarser.
+// Events further away than the whole wheel span wait in an overflow list.
+#define EVENT_WHEEL_LEVEL_BITS  5
+#define EVENT_WHEEL_SLOTS       (1 << EVENT_WHEEL_LEVEL_BITS)
+#define EVENT_WHEEL_LEVELS      4
 
 class EventProcessor
 {
@@ -63,7 +77,20 @@ class EventProcessor
         uint64 CalculateTime(uint64 t_offset) const;
     protected:
         uint64 m_time;
-        EventList m_events;
         bool m_aborting;
+
+    private:
+        void Schedule(BasicEvent* Event);
+        void Cascade(BasicEvent* list);
+        void AdvanceTo(uint64 limit);
+        void AbortList(BasicEvent*& list, bool force);
+        static void AppendEvent(BasicEvent*& tail, BasicEvent* Event);
+        static BasicEvent* DetachEvents(BasicEvent*& tail);
+
+        uint64 m_wheelTime;                                 // every event planned up to this time is in the due list
+        BasicEvent** m_slots;                               // EVENT_WHEEL_LEVELS * EVENT_WHEEL_SLOTS list tails, allocated on first use
+        uint32 m_occupied[EVENT_WHEEL_LEVELS];              // bitmask of non empty slots per level
+        BasicEvent* m_overflow;                             // all lists are circular and point to their last event
+        BasicEvent* m_due;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LatencyHistogram.h"
+
+#include <string.h>
+
+void LatencyHistogram::Reset()
+{
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _max = 0;
+    _sum = 0;
+}
+
+uint32 LatencyHistogram::GetBucket(uint32 ms)
+{
+    if (ms < 1000)
+        return ms;
+
+    if (ms < 10000)
+        return 1000 + (ms - 1000) / 10;
+
+    if (ms < 100000)
+        return 1900 + (ms - 10000) / 100;
+
+    return LATENCY_HISTOGRAM_BUCKETS - 1;
+}
+
+uint32 LatencyHistogram::GetBucketUpperBound(uint32 bucket)
+{
+    if (bucket < 1000)
+        return bucket;
+
+    if (bucket < 1900)
+        return 1000 + (bucket - 1000) * 10 + 9;
+
+    return 10000 + (bucket - 1900) * 100 + 99;
+}
+
+void LatencyHistogram::Add(uint32 ms)
+{
+    ++_buckets[GetBucket(ms)];
+    ++_count;
+    _sum += ms;
+    if (ms > _max)
+        _max = ms;
+}
+
+void LatencyHistogram::Merge(LatencyHistogram const& other)
+{
+    for (uint32 i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i)
+        _buckets[i] += other._buckets[i];
+
+    _count += other._count;
+    _sum += other._sum;
+    if (other._max > _max)
+        _max = other._max;
+}
+
+uint32 LatencyHistogram::GetPercentile(float pct) const
+{
+    if (!_count)
+        return 0;
+
+    // rank of the wanted sample, 1 based
+    uint32 rank = uint32(pct / 100.0f * _count + 0.5f);
+    if (rank < 1)
+        rank = 1;
+    else if (rank > _count)
+        rank = _count;
+
+    uint32 seen = 0;
+    for (uint32 i = 0; i < LATENCY_HISTOGRAM_BUCKETS - 1; ++i)
+    {
+        seen += _buckets[i];
+        if (seen >= rank)
+        {
+            uint32 bound = GetBucketUpperBound(i);
+            return bound < _max ? bound : _max;
+        }
+    }
+
+    return _max;
+}
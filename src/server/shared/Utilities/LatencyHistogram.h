@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LATENCYHISTOGRAM_H
+#define _LATENCYHISTOGRAM_H
+
+#include "Define.h"
+
+// bucket layout: 1 ms steps below 1 s, 10 ms steps below 10 s, 100 ms steps below 100 s, then one overflow bucket
+#define LATENCY_HISTOGRAM_BUCKETS (1000 + 900 + 900 + 1)
+
+// Fixed size histogram of millisecond durations (tick times, round trips).
+// Adding a sample is O(1) and never allocates, percentiles are exact up to the bucket width.
+class LatencyHistogram
+{
+    public:
+        LatencyHistogram() { Reset(); }
+
+        void Add(uint32 ms);
+        void Merge(LatencyHistogram const& other);
+        void Reset();
+
+        uint32 GetCount() const { return _count; }
+        uint32 GetMax() const { return _max; }
+        uint32 GetAverage() const { return _count ? uint32(_sum / _count) : 0; }
+
+        // smallest duration (bucket upper bound) not exceeded by pct percent of the samples, pct in [0, 100]
+        uint32 GetPercentile(float pct) const;
+
+    private:
+        static uint32 GetBucket(uint32 ms);
+        static uint32 GetBucketUpperBound(uint32 bucket);
+
+        uint32 _buckets[LATENCY_HISTOGRAM_BUCKETS];
+        uint32 _count;
+        uint32 _max;
+        uint64 _sum;
+};
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemoryPool.h"
+#include "Errors.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+// thread counters are pushed to the shared atomics every STATS_FLUSH_INTERVAL operations
+#define STATS_FLUSH_INTERVAL 1024
+
+SizeClassPool::ThreadCache::ThreadCache() : Owner(NULL), Hits(0), Misses(0), Oversized(0), Released(0), Frees(0)
+{
+    memset(FreeList, 0, sizeof(FreeList));
+    memset(Count, 0, sizeof(Count));
+}
+
+SizeClassPool::ThreadCache::~ThreadCache()
+{
+    for (uint8 i = 0; i < POOL_MAX_SIZE_CLASSES; ++i)
+    {
+        while (FreeBlock* block = FreeList[i])
+        {
+            FreeList[i] = block->Next;
+            free(block);
+        }
+    }
+
+    FlushStats();
+}
+
+void SizeClassPool::ThreadCache::FlushStats()
+{
+    if (!Owner)
+        return;
+
+    Owner->_hits += Hits;
+    Owner->_misses += Misses;
+    Owner->_oversized += Oversized;
+    Owner->_released += Released;
+    Owner->_frees += Frees;
+    Hits = Misses = Oversized = Released = Frees = 0;
+}
+
+// constant initialized, safe to use from the constructors of other static pools
+SizeClassPool* SizeClassPool::_firstPool = NULL;
+
+SizeClassPool::SizeClassPool(char const* name, uint8 minShift, uint8 maxShift, uint32 cacheLimit) :
+    _nextPool(NULL), _name(name), _minShift(minShift), _classCount(maxShift - minShift + 1), _cacheLimit(cacheLimit),
+    _hits(0), _misses(0), _oversized(0), _released(0), _frees(0)
+{
+    ASSERT(minShift >= 4 && minShift <= maxShift);
+    ASSERT(_classCount <= POOL_MAX_SIZE_CLASSES);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, GetRegistryLock());
+    _nextPool = _firstPool;
+    _firstPool = this;
+}
+
+SizeClassPool::~SizeClassPool()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, GetRegistryLock());
+    for (SizeClassPool** itr = &_firstPool; *itr; itr = &(*itr)->_nextPool)
+    {
+        if (*itr == this)
+        {
+            *itr = _nextPool;
+            break;
+        }
+    }
+}
+
+ACE_Thread_Mutex& SizeClassPool::GetRegistryLock()
+{
+    static ACE_Thread_Mutex lock;
+    return lock;
+}
+
+void SizeClassPool::GetPools(std::vector<SizeClassPool const*>& pools)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, GetRegistryLock());
+    for (SizeClassPool const* pool = _firstPool; pool; pool = pool->_nextPool)
+        pools.push_back(pool);
+}
+
+uint8 SizeClassPool::GetSizeClass(size_t size) const
+{
+    uint8 sizeClass = 0;
+    size_t classSize = size_t(1) << _minShift;
+    while (classSize < size)
+    {
+        classSize <<= 1;
+        ++sizeClass;
+    }
+
+    return sizeClass;
+}
+
+size_t SizeClassPool::GetBlockSize(size_t size) const
+{
+    uint8 sizeClass = GetSizeClass(size);
+    if (sizeClass >= _classCount)
+        return size;
+
+    return size_t(1) << (_minShift + sizeClass);
+}
+
+SizeClassPool::ThreadCache* SizeClassPool::GetCache()
+{
+    ThreadCache* cache = _caches.ts_object();
+    if (!cache)
+    {
+        // ts_object() only reads the slot of the thread, the cache is created on first use
+        cache = new ThreadCache();
+        cache->Owner = this;
+        _caches.ts_object(cache);
+    }
+
+    if (cache->Hits + cache->Misses + cache->Frees >= STATS_FLUSH_INTERVAL)
+        cache->FlushStats();
+
+    return cache;
+}
+
+void* SizeClassPool::Allocate(size_t size)
+{
+    uint8 sizeClass = GetSizeClass(size);
+    ThreadCache* cache = GetCache();
+
+    if (sizeClass >= _classCount)
+    {
+        if (cache)
+            ++cache->Oversized;
+
+        void* ptr = malloc(size);
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    if (cache)
+    {
+        if (FreeBlock* block = cache->FreeList[sizeClass])
+        {
+            cache->FreeList[sizeClass] = block->Next;
+            --cache->Count[sizeClass];
+            ++cache->Hits;
+            return block;
+        }
+
+        ++cache->Misses;
+    }
+
+    void* ptr = malloc(size_t(1) << (_minShift + sizeClass));
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void SizeClassPool::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    uint8 sizeClass = GetSizeClass(size);
+    ThreadCache* cache = GetCache();
+    if (cache)
+        ++cache->Frees;
+
+    if (sizeClass >= _classCount)
+    {
+        free(ptr);
+        return;
+    }
+
+    if (!cache || cache->Count[sizeClass] >= _cacheLimit)
+    {
+        if (cache)
+            ++cache->Released;
+        free(ptr);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->Next = cache->FreeList[sizeClass];
+    cache->FreeList[sizeClass] = block;
+    ++cache->Count[sizeClass];
+}
+
+void SizeClassPool::FlushThreadStats()
+{
+    if (ThreadCache* cache = _caches.ts_object())
+        cache->FlushStats();
+}
+
+void SizeClassPool::FlushAllThreadStats()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, GetRegistryLock());
+    for (SizeClassPool* pool = _firstPool; pool; pool = pool->_nextPool)
+        pool->FlushThreadStats();
+}
+
+MemoryPoolStats SizeClassPool::GetStats() const
+{
+    MemoryPoolStats stats;
+    stats.Hits = _hits.value();
+    stats.Misses = _misses.value();
+    stats.Oversized = _oversized.value();
+    stats.Released = _released.value();
+    stats.Frees = _frees.value();
+    return stats;
+}
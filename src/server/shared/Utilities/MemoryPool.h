@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MEMORYPOOL_H
+#define _MEMORYPOOL_H
+
+#include "Define.h"
+#include <ace/TSS_T.h>
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Guard_T.h>
+#include <vector>
+#include <new>
+
+#define POOL_MAX_SIZE_CLASSES 24
+
+struct MemoryPoolStats
+{
+    MemoryPoolStats() : Hits(0), Misses(0), Oversized(0), Released(0), Frees(0) { }
+
+    // blocks handed out and not given back yet (thread counters are flushed lazily, so approximate)
+    int64 InUse() const { return int64(Hits + Misses + Oversized) - int64(Frees); }
+
+    uint64 Hits;                                            // allocations served from a thread cache
+    uint64 Misses;                                          // allocations that had to go to the global allocator
+    uint64 Oversized;                                       // requests larger than the biggest size class
+    uint64 Released;                                        // blocks given back to the global allocator (cache full)
+    uint64 Frees;                                           // blocks given back to the pool
+};
+
+// Power-of-two size class allocator with per-thread free lists in front of the
+// global allocator. Blocks may be freed from any thread: they simply end up in
+// the cache of the thread that freed them.
+class SizeClassPool
+{
+        struct FreeBlock
+        {
+            FreeBlock* Next;
+        };
+
+        struct ThreadCache
+        {
+            ThreadCache();
+            ~ThreadCache();
+
+            void FlushStats();
+
+            SizeClassPool* Owner;
+            FreeBlock* FreeList[POOL_MAX_SIZE_CLASSES];
+            uint32 Count[POOL_MAX_SIZE_CLASSES];
+            uint32 Hits;
+            uint32 Misses;
+            uint32 Oversized;
+            uint32 Released;
+            uint32 Frees;
+        };
+
+    public:
+        // minShift/maxShift: smallest and biggest size class as power of two
+        // cacheLimit: max free blocks kept per size class in each thread
+        SizeClassPool(char const* name, uint8 minShift, uint8 maxShift, uint32 cacheLimit);
+        ~SizeClassPool();
+
+        void* Allocate(size_t size);
+        void Deallocate(void* ptr, size_t size);
+
+        // usable size of a block returned by Allocate(size)
+        size_t GetBlockSize(size_t size) const;
+
+        char const* GetName() const { return _name; }
+        MemoryPoolStats GetStats() const;
+        // pushes the counters of the calling thread to GetStats() now instead of every few operations
+        void FlushThreadStats();
+        // same for every pool, the map and world threads call it once per update
+        static void FlushAllThreadStats();
+
+        // every pool created by the process, for diagnostics
+        static void GetPools(std::vector<SizeClassPool const*>& pools);
+
+    private:
+        uint8 GetSizeClass(size_t size) const;
+        ThreadCache* GetCache();
+
+        static ACE_Thread_Mutex& GetRegistryLock();
+        static SizeClassPool* _firstPool;
+        SizeClassPool* _nextPool;
+
+        char const* _name;
+        uint8 _minShift;
+        uint8 _classCount;
+        uint32 _cacheLimit;
+
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint64> _hits;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint64> _misses;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint64> _oversized;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint64> _released;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint64> _frees;
+
+        // after the counters: destroying it flushes the cache of the destroying thread into them
+        ACE_TSS<ThreadCache> _caches;
+};
+
+// std allocator serving its blocks from the SizeClassPool returned by POOL.
+// Stateless: all instances of the same POOL compare equal.
+template<class T, SizeClassPool& (*POOL)()>
+class PoolAllocator
+{
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef T const* const_pointer;
+        typedef T& reference;
+        typedef T const& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U> struct rebind { typedef PoolAllocator<U, POOL> other; };
+
+        PoolAllocator() { }
+        template<class U> PoolAllocator(PoolAllocator<U, POOL> const& /*other*/) { }
+
+        pointer address(reference value) const { return &value; }
+        const_pointer address(const_reference value) const { return &value; }
+
+        pointer allocate(size_type count, void const* /*hint*/ = NULL) { return static_cast<pointer>(POOL().Allocate(count * sizeof(T))); }
+        void deallocate(pointer ptr, size_type count) { POOL().Deallocate(ptr, count * sizeof(T)); }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer ptr, T const& value) { new (ptr) T(value); }
+        void destroy(pointer ptr) { ptr->~T(); }
+};
+
+template<class T, class U, SizeClassPool& (*POOL)()>
+inline bool operator==(PoolAllocator<T, POOL> const& /*left*/, PoolAllocator<U, POOL> const& /*right*/) { return true; }
+
+template<class T, class U, SizeClassPool& (*POOL)()>
+inline bool operator!=(PoolAllocator<T, POOL> const& /*left*/, PoolAllocator<U, POOL> const& /*right*/) { return false; }
+
+#endif
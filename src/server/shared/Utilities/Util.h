@@ -27,6 +27,10 @@
 #include <vector>
 #include <list>
 
+#if COMPILER == COMPILER_MICROSOFT
+#  include <intrin.h>
+#endif
+
 // Searcher for map of structs
 template<typename T, class S> struct Finder
 {
@@ -163,6 +167,26 @@ inline T RoundToInterval(T& num, T floor, T ceil)
     return num = std::min(std::max(num, floor), ceil);
 }
 
+// index of the lowest set bit, value must not be 0
+inline uint8 CountTrailingZeros(uint64 value)
+{
+#if COMPILER == COMPILER_GNU || COMPILER == COMPILER_INTEL
+    return uint8(__builtin_ctzll(value));
+#elif COMPILER == COMPILER_MICROSOFT && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return uint8(index);
+#else
+    uint8 count = 0;
+    while (!(value & 1))
+    {
+        value >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
 // UTF8 handling
 bool Utf8toWStr(const std::string& utf8str, std::wstring& wstr);
 // in wsize==max size of buffer, out wsize==real string size
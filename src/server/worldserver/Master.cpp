@@ -393,6 +393,9 @@ bool Master::_StartDB()
         return false;
     }
 
+    ///- Player login holders are split over this many async connections
+    CharacterDatabase.SetQueryHolderFanOut(ConfigMgr::GetIntDefault("CharacterDatabase.QueryHolderFanOut", 4));
+
     ///- Get login database info from configuration file
     dbstring = ConfigMgr::GetStringDefault("LoginDatabaseInfo", "");
     if (dbstring.empty())
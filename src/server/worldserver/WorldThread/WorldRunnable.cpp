@@ -29,6 +29,7 @@
 #include "BattlegroundMgr.h"
 #include "MapManager.h"
 #include "Timer.h"
+#include "TickProfiler.h"
 #include "WorldRunnable.h"
 #include "OutdoorPvPMgr.h"
 
@@ -49,6 +50,8 @@ void WorldRunnable::run()
 
     sScriptMgr->OnStartup();
 
+    sTickProfiler->RegisterThread();
+
     ///- While we have not World::m_stopEvent, update the world
     while (!World::IsStopped())
     {
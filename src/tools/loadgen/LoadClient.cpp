@@ -0,0 +1,844 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LoadClient.h"
+#include "LoadScript.h"
+#include "Opcodes.h"
+#include "SHA1.h"
+#include "HMACSHA1.h"
+#include "Timer.h"
+#include "Util.h"
+
+#include <ace/SOCK_Connector.h>
+#include <ace/INET_Addr.h>
+#include <ace/os_include/netinet/os_tcp.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#define LOADGEN_CLIENT_BUILD        18019
+#define WORLD_HEADER_SIZE           4
+#define RECV_CHUNK_SIZE             4096
+
+// authserver commands and results, see authserver/Server/AuthSocket.cpp
+enum LoadGenAuthCmd
+{
+    LOADGEN_AUTH_LOGON_CHALLENGE    = 0x00,
+    LOADGEN_AUTH_LOGON_PROOF        = 0x01,
+    LOADGEN_REALM_LIST              = 0x10
+};
+
+void LoadClientStats::Merge(LoadClientStats const& other)
+{
+    LoginsOk += other.LoginsOk;
+    LoginsFailed += other.LoginsFailed;
+    Disconnects += other.Disconnects;
+    PacketsSent += other.PacketsSent;
+    PacketsReceived += other.PacketsReceived;
+    BytesSent += other.BytesSent;
+    BytesReceived += other.BytesReceived;
+    LoginTime.Merge(other.LoginTime);
+    WorldEnterTime.Merge(other.WorldEnterTime);
+    QueryTimeRtt.Merge(other.QueryTimeRtt);
+    PingRtt.Merge(other.PingRtt);
+}
+
+ClientCrypt::ClientCrypt() : _serverDecrypt(SHA_DIGEST_LENGTH), _clientEncrypt(SHA_DIGEST_LENGTH), _initialized(false)
+{
+}
+
+void ClientCrypt::Init(BigNumber* K)
+{
+    // same seeds as AuthCrypt::Init, each side decrypts what the other encrypts
+    uint8 ServerEncryptionKey[SEED_KEY_SIZE] = { 0x08, 0xF1, 0x95, 0x9F, 0x47, 0xE5, 0xD2, 0xDB, 0xA1, 0x3D, 0x77, 0x8F, 0x3F, 0x3E, 0xE7, 0x00 };
+    HmacHash serverEncryptHmac(SEED_KEY_SIZE, (uint8*)ServerEncryptionKey);
+    uint8* decryptHash = serverEncryptHmac.ComputeHash(K);
+
+    uint8 ServerDecryptionKey[SEED_KEY_SIZE] = { 0x40, 0xAA, 0xD3, 0x92, 0x26, 0x71, 0x43, 0x47, 0x3A, 0x31, 0x08, 0xA6, 0xE7, 0xDC, 0x98, 0x2A };
+    HmacHash clientDecryptHmac(SEED_KEY_SIZE, (uint8*)ServerDecryptionKey);
+    uint8* encryptHash = clientDecryptHmac.ComputeHash(K);
+
+    _serverDecrypt.Init(decryptHash);
+    _clientEncrypt.Init(encryptHash);
+
+    // ARC4-drop1024, like the server
+    uint8 syncBuf[1024];
+    memset(syncBuf, 0, 1024);
+    _serverDecrypt.UpdateData(1024, syncBuf);
+
+    memset(syncBuf, 0, 1024);
+    _clientEncrypt.UpdateData(1024, syncBuf);
+
+    _initialized = true;
+}
+
+void ClientCrypt::DecryptRecv(uint8* data, size_t len)
+{
+    if (!_initialized)
+        return;
+
+    _serverDecrypt.UpdateData(len, data);
+}
+
+void ClientCrypt::EncryptSend(uint8* data, size_t len)
+{
+    if (!_initialized)
+        return;
+
+    _clientEncrypt.UpdateData(len, data);
+}
+
+LoadClient::LoadClient(LoadGenConfig const& config, LoadClientAccount const& account, LoadScript const* script,
+    RecordedTraffic const* traffic, LoadClientStats& stats) :
+    _config(config), _account(account), _script(script), _traffic(traffic), _stats(stats), _state(LOAD_CLIENT_OFFLINE),
+    _recvOffset(0), _hasHeader(false), _pendingOpcode(0), _pendingSize(0), _replayStart(0), _replayIndex(0),
+    _pingCounter(0), _pingSentTime(0)
+{
+    // the replay picks a random start packet, an empty capture has nothing to replay
+    if (_traffic && _traffic->GetPackets().empty())
+        _traffic = NULL;
+}
+
+LoadClient::~LoadClient()
+{
+    Disconnect();
+}
+
+bool LoadClient::Login()
+{
+    uint32 startTime = getMSTime();
+
+    std::string worldHost;
+    uint16 worldPort = 0;
+    if (!AuthLogon(worldHost, worldPort) || !WorldLogon(worldHost, worldPort))
+    {
+        Disconnect();
+        ++_stats.LoginsFailed;
+        return false;
+    }
+
+    ++_stats.LoginsOk;
+    _stats.LoginTime.Add(GetMSTimeDiffToNow(startTime));
+
+    // after login everything is polled from Update()
+    _socket.enable(ACE_NONBLOCK);
+    _state = LOAD_CLIENT_IN_WORLD;
+
+    uint32 now = getMSTime();
+    if (_script)
+    {
+        // spread the first run of every action so clients logged in together don't send in lockstep
+        _nextAction.resize(_script->GetActions().size());
+        for (size_t i = 0; i < _nextAction.size(); ++i)
+            _nextAction[i] = now + urand(0, _script->GetActions()[i].Interval);
+    }
+
+    if (_traffic)
+    {
+        // every client replays the capture from its own random position
+        _replayIndex = urand(0, _traffic->GetPackets().size() - 1);
+        _replayStart = now - _traffic->GetPackets()[_replayIndex].Time;
+    }
+
+    return true;
+}
+
+void LoadClient::Logout()
+{
+    if (_state == LOAD_CLIENT_IN_WORLD)
+        SendPacket(CMSG_LOGOUT_REQUEST, NULL, 0);
+
+    Disconnect();
+    _state = LOAD_CLIENT_OFFLINE;
+}
+
+void LoadClient::Update(uint32 now)
+{
+    if (_state != LOAD_CLIENT_IN_WORLD)
+        return;
+
+    if (!ReadIncoming(now))
+    {
+        printf("%s: disconnected by the server\n", _account.Name.c_str());
+        Disconnect();
+        _state = LOAD_CLIENT_DISCONNECTED;
+        ++_stats.Disconnects;
+        return;
+    }
+
+    if (_script)
+        SendScriptedTraffic(now);
+
+    if (_traffic)
+        SendRecordedTraffic(now);
+}
+
+bool LoadClient::AuthLogon(std::string& worldHost, uint16& worldPort)
+{
+    if (!Connect(_config.AuthHost, _config.AuthPort))
+        return false;
+
+    // AUTH_LOGON_CHALLENGE, strings are sent as reversed little endian uint32
+    ByteBuffer challenge;
+    challenge << uint8(LOADGEN_AUTH_LOGON_CHALLENGE);
+    challenge << uint8(8);
+    challenge << uint16(30 + _account.Name.length());
+    challenge.append((uint8 const*)"WoW\0", 4);
+    challenge << uint8(5) << uint8(4) << uint8(7);
+    challenge << uint16(LOADGEN_CLIENT_BUILD);
+    challenge.append((uint8 const*)"68x\0", 4);
+    challenge.append((uint8 const*)"niW\0", 4);
+    challenge.append((uint8 const*)"SUne", 4);
+    challenge << uint32(0);                                 // timezone bias
+    challenge << uint32(0x0100007F);                        // 127.0.0.1
+    challenge << uint8(_account.Name.length());
+    challenge.append((uint8 const*)_account.Name.c_str(), _account.Name.length());
+
+    if (!SendRaw(challenge.contents(), challenge.size()))
+        return false;
+
+    uint8 header[3];
+    if (!RecvRaw(header, sizeof(header)))
+        return false;
+
+    if (header[2] != 0)
+    {
+        printf("%s: logon challenge refused (result %u)\n", _account.Name.c_str(), header[2]);
+        return false;
+    }
+
+    uint8 Bbytes[32], gbytes[1], Nbytes[32], sbytes[32], unk3[16], lengths[3], securityFlags;
+    if (!RecvRaw(Bbytes, 32) || !RecvRaw(&lengths[0], 1) || !RecvRaw(gbytes, 1) || !RecvRaw(&lengths[1], 1) ||
+        !RecvRaw(Nbytes, 32) || !RecvRaw(sbytes, 32) || !RecvRaw(unk3, 16) || !RecvRaw(&securityFlags, 1))
+        return false;
+
+    if (securityFlags)
+    {
+        // PIN, matrix and token input need a human
+        printf("%s: account has security flags 0x%02X, not supported\n", _account.Name.c_str(), securityFlags);
+        return false;
+    }
+
+    BigNumber N, g, s, B;
+    N.SetBinary(Nbytes, 32);
+    g.SetBinary(gbytes, 1);
+    s.SetBinary(sbytes, 32);
+    B.SetBinary(Bbytes, 32);
+
+    // x = H(s, H(USER:PASS)), see AuthSocket::_SetVSFields
+    std::string password = _config.Password;
+    for (size_t i = 0; i < password.length(); ++i)
+        password[i] = toupper(password[i]);
+
+    SHA1Hash sha;
+    sha.UpdateData(_account.Name);
+    sha.UpdateData(":");
+    sha.UpdateData(password);
+    sha.Finalize();
+    uint8 userHash[SHA_DIGEST_LENGTH];
+    memcpy(userHash, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&s, NULL);
+    sha.UpdateData(userHash, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+    BigNumber a, A, k;
+    a.SetRand(19 * 8);
+    A = g.ModExp(a, N);
+    k.SetDword(3);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &B, NULL);
+    sha.Finalize();
+    BigNumber u;
+    u.SetBinary(sha.GetDigest(), 20);
+
+    // S = (B - k * g^x) ^ (a + u * x), kept positive by adding k * N
+    BigNumber gx = g.ModExp(x, N);
+    BigNumber base = ((B + k * N) - k * gx) % N;
+    BigNumber S = base.ModExp(a + u * x, N);
+
+    // session key, interleaved hashes of S, see AuthSocket::_HandleLogonProof
+    uint8 t[32];
+    uint8 t1[16];
+    uint8 vK[40];
+    memcpy(t, S.AsByteArray(32), 32);
+
+    for (int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2];
+
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+
+    for (int i = 0; i < 20; ++i)
+        vK[i * 2] = sha.GetDigest()[i];
+
+    for (int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2 + 1];
+
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+
+    for (int i = 0; i < 20; ++i)
+        vK[i * 2 + 1] = sha.GetDigest()[i];
+
+    _sessionKey.SetBinary(vK, 40);
+
+    // M1 = H(H(N) xor H(g), H(USER), s, A, B, K)
+    uint8 hash[20];
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&N, NULL);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+    sha.Initialize();
+    sha.UpdateBigNumbers(&g, NULL);
+    sha.Finalize();
+
+    for (int i = 0; i < 20; ++i)
+        hash[i] ^= sha.GetDigest()[i];
+
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(_account.Name);
+    sha.Finalize();
+    uint8 t4[SHA_DIGEST_LENGTH];
+    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, NULL);
+    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+    sha.UpdateBigNumbers(&s, &A, &B, &_sessionKey, NULL);
+    sha.Finalize();
+    uint8 M1[SHA_DIGEST_LENGTH];
+    memcpy(M1, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    ByteBuffer proof;
+    proof << uint8(LOADGEN_AUTH_LOGON_PROOF);
+    proof.append(A.AsByteArray(32), 32);
+    proof.append(M1, SHA_DIGEST_LENGTH);
+    for (int i = 0; i < 20; ++i)
+        proof << uint8(0);                                  // crc hash
+    proof << uint8(0);                                      // number of keys
+    proof << uint8(0);                                      // security flags
+
+    if (!SendRaw(proof.contents(), proof.size()))
+        return false;
+
+    uint8 proofResult[2];
+    if (!RecvRaw(proofResult, sizeof(proofResult)))
+        return false;
+
+    if (proofResult[1] != 0)
+    {
+        printf("%s: logon proof refused (result %u), wrong password?\n", _account.Name.c_str(), proofResult[1]);
+        return false;
+    }
+
+    uint8 M2[SHA_DIGEST_LENGTH];
+    uint8 proofTail[10];
+    if (!RecvRaw(M2, SHA_DIGEST_LENGTH) || !RecvRaw(proofTail, sizeof(proofTail)))
+        return false;
+
+    // REALM_LIST
+    uint8 realmListRequest[5] = { LOADGEN_REALM_LIST, 0, 0, 0, 0 };
+    if (!SendRaw(realmListRequest, sizeof(realmListRequest)))
+        return false;
+
+    uint8 realmHeader[3];
+    if (!RecvRaw(realmHeader, sizeof(realmHeader)))
+        return false;
+
+    uint16 realmListSize = uint16(realmHeader[1] | (realmHeader[2] << 8));
+    ByteBuffer realmList;
+    realmList.resize(realmListSize);
+    if (realmListSize && !RecvRaw((uint8*)realmList.contents(), realmListSize))
+        return false;
+
+    Disconnect();
+
+    try
+    {
+        realmList.read_skip<uint32>();
+        uint16 realmCount = realmList.read<uint16>();
+        for (uint16 i = 0; i < realmCount; ++i)
+        {
+            realmList.read_skip<uint8>();                   // icon
+            realmList.read_skip<uint8>();                   // lock
+            uint8 flag = realmList.read<uint8>();
+            std::string name, address;
+            realmList >> name >> address;
+            realmList.read_skip<float>();                   // population
+            realmList.read_skip<uint8>();                   // characters
+            realmList.read_skip<uint8>();                   // timezone
+            realmList.read_skip<uint8>();
+            if (flag & 0x04)                                // REALM_FLAG_SPECIFYBUILD
+                realmList.read_skip(5);
+
+            if (!_config.RealmName.empty() && name != _config.RealmName)
+                continue;
+
+            std::string::size_type colon = address.rfind(':');
+            if (colon == std::string::npos)
+                return false;
+
+            worldHost = address.substr(0, colon);
+            worldPort = uint16(atoi(address.substr(colon + 1).c_str()));
+            return true;
+        }
+    }
+    catch (ByteBufferException const&)
+    {
+        printf("%s: malformed realm list\n", _account.Name.c_str());
+        return false;
+    }
+
+    printf("%s: realm '%s' not in the realm list\n", _account.Name.c_str(), _config.RealmName.c_str());
+    return false;
+}
+
+bool LoadClient::WorldLogon(std::string const& host, uint16 port)
+{
+    if (!Connect(host, port))
+        return false;
+
+    ByteBuffer payload;
+    uint32 opcode;
+    if (!RecvPacket(opcode, payload) || opcode != MSG_VERIFY_CONNECTIVITY)
+        return false;
+
+    // the client greeting has no opcode: its 2 size bytes and the first 4 characters fill the header
+    static char const clientGreeting[] = "WORLD OF WARCRAFT CONNECTION - CLIENT TO SERVER";
+    ByteBuffer greeting;
+    greeting << uint16(sizeof(clientGreeting));
+    greeting.append((uint8 const*)clientGreeting, sizeof(clientGreeting));
+    if (!SendRaw(greeting.contents(), greeting.size()))
+        return false;
+
+    if (!WaitForPacket(SMSG_AUTH_CHALLENGE, payload))
+        return false;
+
+    uint32 serverSeed = payload.read<uint32>();
+    uint32 clientSeed = urand(0, 0xFFFFFFFF);
+
+    // digest is not verified by the worldserver yet, still computed like the client does
+    uint32 t = 0;
+    SHA1Hash sha;
+    sha.UpdateData(_account.Name);
+    sha.UpdateData((uint8*)&t, 4);
+    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&serverSeed, 4);
+    sha.UpdateBigNumbers(&_sessionKey, NULL);
+    sha.Finalize();
+    uint8* digest = sha.GetDigest();
+
+    // field order of WorldSocket::HandleAuthSession
+    ByteBuffer authSession;
+    authSession << uint32(0);                               // Region
+    authSession << uint32(0);                               // GruntServerId
+    authSession << digest[3] << digest[12] << digest[2] << digest[7];
+    authSession << uint32(0);                               // Battlegroup
+    authSession << digest[11] << digest[17] << digest[14] << digest[4];
+    authSession << uint64(0);                               // DosResponse
+    authSession << digest[10];
+    authSession << uint32(0);                               // RealmIndex
+    authSession << digest[6] << digest[18] << digest[15] << digest[13];
+    authSession << uint8(0);                                // LoginServerType
+    authSession << digest[8];
+    authSession << uint16(LOADGEN_CLIENT_BUILD);
+    authSession << digest[0] << digest[19] << digest[16] << digest[9] << digest[5] << digest[1];
+    authSession << uint8(0);
+    authSession << uint32(clientSeed);
+    authSession << uint32(0);                               // addon data size
+    authSession.WriteBits(_account.Name.length(), 11);
+    authSession.WriteBit(0);
+    authSession.FlushBits();
+    authSession.append((uint8 const*)_account.Name.c_str(), _account.Name.length());
+
+    if (!SendPacket(CMSG_AUTH_SESSION, authSession))
+        return false;
+
+    // the server switches to encrypted headers as soon as it handled CMSG_AUTH_SESSION
+    _crypt.Init(&_sessionKey);
+
+    for (;;)
+    {
+        if (!WaitForPacket(SMSG_AUTH_RESPONSE, payload))
+            return false;
+
+        bool hasAccountData = payload.ReadBit();
+        if (hasAccountData)
+            break;
+
+        // no account data: either queued (wait for the next response) or refused
+        if (!payload.ReadBit())
+        {
+            printf("%s: world login refused\n", _account.Name.c_str());
+            return false;
+        }
+    }
+
+    // the worldserver only accepts characters listed by the last SMSG_CHAR_ENUM
+    if (!SendPacket(CMSG_CHAR_ENUM, NULL, 0) || !WaitForPacket(SMSG_CHAR_ENUM, payload))
+        return false;
+
+    // CMSG_PLAYER_LOGIN, see WorldSession::HandlePlayerLoginOpcode
+    uint64 guid = uint64(_account.CharacterGuid) | (uint64(0x018) << 52);   // HIGHGUID_PLAYER
+    uint8 guidBytes[8];
+    for (uint8 i = 0; i < 8; ++i)
+        guidBytes[i] = uint8(guid >> (i * 8));
+
+    static uint8 const bitOrder[8] = { 7, 6, 0, 4, 5, 2, 3, 1 };
+    static uint8 const byteOrder[8] = { 5, 0, 1, 6, 7, 2, 3, 4 };
+
+    ByteBuffer playerLogin;
+    playerLogin << float(1000.0f);                          // far clip
+    for (uint8 i = 0; i < 8; ++i)
+        playerLogin.WriteBit(guidBytes[bitOrder[i]]);
+    playerLogin.FlushBits();
+    for (uint8 i = 0; i < 8; ++i)
+        playerLogin.WriteByteSeq(guidBytes[byteOrder[i]]);
+
+    uint32 enterTime = getMSTime();
+    if (!SendPacket(CMSG_PLAYER_LOGIN, playerLogin) || !WaitForPacket(SMSG_LOGIN_VERIFY_WORLD, payload))
+        return false;
+
+    _stats.WorldEnterTime.Add(GetMSTimeDiffToNow(enterTime));
+    return true;
+}
+
+bool LoadClient::Connect(std::string const& host, uint16 port)
+{
+    Disconnect();
+
+    ACE_INET_Addr address(port, host.c_str());
+    ACE_SOCK_Connector connector;
+    ACE_Time_Value timeout(0, _config.LoginTimeout * 1000);
+    if (connector.connect(_socket, address, &timeout) == -1)
+    {
+        printf("%s: can't connect to %s:%u\n", _account.Name.c_str(), host.c_str(), port);
+        return false;
+    }
+
+    int nodelay = 1;
+    _socket.set_option(ACE_IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    return true;
+}
+
+void LoadClient::Disconnect()
+{
+    if (_socket.get_handle() != ACE_INVALID_HANDLE)
+        _socket.close();
+
+    _crypt.Reset();
+    _recvBuffer.clear();
+    _recvOffset = 0;
+    _hasHeader = false;
+    _pingSentTime = 0;
+    _queryTimeSent.clear();
+}
+
+bool LoadClient::SendRaw(uint8 const* data, size_t len)
+{
+    ACE_Time_Value timeout(0, _config.LoginTimeout * 1000);
+    if (_socket.send_n(data, len, &timeout) != ssize_t(len))
+        return false;
+
+    _stats.BytesSent += len;
+    return true;
+}
+
+bool LoadClient::RecvRaw(uint8* data, size_t len)
+{
+    ACE_Time_Value timeout(0, _config.LoginTimeout * 1000);
+    if (_socket.recv_n(data, len, &timeout) != ssize_t(len))
+    {
+        printf("%s: connection closed or timed out during login\n", _account.Name.c_str());
+        return false;
+    }
+
+    _stats.BytesReceived += len;
+    return true;
+}
+
+bool LoadClient::SendPacket(uint32 opcode, ByteBuffer const& payload)
+{
+    return SendPacket(opcode, payload.contents(), payload.size());
+}
+
+bool LoadClient::SendPacket(uint32 opcode, uint8 const* payload, size_t len)
+{
+    ByteBuffer packet(len + 6);
+    if (_crypt.IsInitialized())
+    {
+        uint32 header = (uint32(len) << 13) | (opcode & 0x1FFF);
+        EndianConvert(header);
+        packet.append((uint8 const*)&header, 4);
+        _crypt.EncryptSend((uint8*)packet.contents(), 4);
+    }
+    else
+    {
+        packet << uint16(len + 4);
+        packet << uint32(opcode);
+    }
+
+    if (len)
+        packet.append(payload, len);
+
+    ++_stats.PacketsSent;
+
+    // in world the socket is non blocking, send_n still waits for the kernel buffer to drain
+    return SendRaw(packet.contents(), packet.size());
+}
+
+bool LoadClient::RecvPacket(uint32& opcode, ByteBuffer& payload)
+{
+    uint8 header[WORLD_HEADER_SIZE];
+    if (!RecvRaw(header, WORLD_HEADER_SIZE))
+        return false;
+
+    uint32 size;
+    if (_crypt.IsInitialized())
+    {
+        _crypt.DecryptRecv(header, WORLD_HEADER_SIZE);
+        uint32 value = header[0] | (header[1] << 8) | (header[2] << 16) | (uint32(header[3]) << 24);
+        opcode = value & 0x1FFF;
+        size = value >> 13;
+    }
+    else
+    {
+        // size includes the 2 opcode bytes
+        size = header[0] | (header[1] << 8);
+        opcode = header[2] | (header[3] << 8);
+        if (size < 2)
+            return false;
+        size -= 2;
+    }
+
+    payload.clear();
+    payload.resize(size);
+    if (size && !RecvRaw((uint8*)payload.contents(), size))
+        return false;
+
+    ++_stats.PacketsReceived;
+    return true;
+}
+
+bool LoadClient::WaitForPacket(uint32 opcode, ByteBuffer& payload)
+{
+    uint32 startTime = getMSTime();
+    uint32 received;
+    while (RecvPacket(received, payload))
+    {
+        if (received == opcode)
+            return true;
+
+        // keep the session alive while waiting (time sync, pings)
+        HandlePacket(received, payload, getMSTime());
+
+        if (GetMSTimeDiffToNow(startTime) > _config.LoginTimeout)
+            break;
+    }
+
+    printf("%s: no 0x%04X from the server\n", _account.Name.c_str(), opcode);
+    return false;
+}
+
+bool LoadClient::ReadIncoming(uint32 now)
+{
+    for (;;)
+    {
+        size_t used = _recvBuffer.size();
+        _recvBuffer.resize(used + RECV_CHUNK_SIZE);
+        ssize_t len = _socket.recv(&_recvBuffer[used], RECV_CHUNK_SIZE);
+        if (len <= 0)
+        {
+            _recvBuffer.resize(used);
+            if (len == 0)
+                return false;                               // closed by the server
+
+            if (errno == EWOULDBLOCK || errno == EAGAIN)
+                break;
+
+            return false;
+        }
+
+        _recvBuffer.resize(used + len);
+        _stats.BytesReceived += len;
+
+        if (size_t(len) < RECV_CHUNK_SIZE)
+            break;
+    }
+
+    for (;;)
+    {
+        size_t available = _recvBuffer.size() - _recvOffset;
+        if (!_hasHeader)
+        {
+            if (available < WORLD_HEADER_SIZE)
+                break;
+
+            // headers are decrypted exactly once, the payload may still be incomplete
+            uint8* header = &_recvBuffer[_recvOffset];
+            _crypt.DecryptRecv(header, WORLD_HEADER_SIZE);
+            uint32 value = header[0] | (header[1] << 8) | (header[2] << 16) | (uint32(header[3]) << 24);
+            _pendingOpcode = value & 0x1FFF;
+            _pendingSize = value >> 13;
+            _recvOffset += WORLD_HEADER_SIZE;
+            _hasHeader = true;
+            continue;
+        }
+
+        if (available < _pendingSize)
+            break;
+
+        ByteBuffer payload(_pendingSize);
+        if (_pendingSize)
+            payload.append(&_recvBuffer[_recvOffset], _pendingSize);
+
+        _recvOffset += _pendingSize;
+        _hasHeader = false;
+        ++_stats.PacketsReceived;
+
+        HandlePacket(_pendingOpcode, payload, now);
+    }
+
+    // keep the unread tail at the front of the buffer
+    if (_recvOffset)
+    {
+        _recvBuffer.erase(_recvBuffer.begin(), _recvBuffer.begin() + _recvOffset);
+        _recvOffset = 0;
+    }
+
+    return true;
+}
+
+void LoadClient::HandlePacket(uint32 opcode, ByteBuffer& payload, uint32 now)
+{
+    try
+    {
+        switch (opcode)
+        {
+            case SMSG_TIME_SYNC_REQUEST:
+            {
+                uint32 counter = payload.read<uint32>();
+                ByteBuffer response(8);
+                response << uint32(counter);
+                response << uint32(now);
+                SendPacket(CMSG_TIME_SYNC_RESP, response);
+                break;
+            }
+            case SMSG_PONG:
+                if (_pingSentTime)
+                {
+                    _stats.PingRtt.Add(getMSTimeDiff(_pingSentTime, now));
+                    _pingSentTime = 0;
+                }
+                break;
+            case SMSG_QUERY_TIME_RESPONSE:
+                // answered in order by the world thread, one tick after the packet was queued
+                if (!_queryTimeSent.empty())
+                {
+                    _stats.QueryTimeRtt.Add(getMSTimeDiff(_queryTimeSent.front(), now));
+                    _queryTimeSent.erase(_queryTimeSent.begin());
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    catch (ByteBufferException const&)
+    {
+        printf("%s: malformed packet 0x%04X\n", _account.Name.c_str(), opcode);
+    }
+}
+
+void LoadClient::SendScriptedTraffic(uint32 now)
+{
+    std::vector<LoadAction> const& actions = _script->GetActions();
+    for (size_t i = 0; i < actions.size(); ++i)
+    {
+        if (int32(now - _nextAction[i]) < 0)
+            continue;
+
+        LoadAction const& action = actions[i];
+        _nextAction[i] = now + action.Interval;
+
+        switch (action.Type)
+        {
+            case LOAD_ACTION_QUERY_TIME:
+                // nothing to measure against if the server stopped answering
+                if (_queryTimeSent.size() < 16)
+                {
+                    _queryTimeSent.push_back(now);
+                    SendPacket(CMSG_QUERY_TIME, NULL, 0);
+                }
+                break;
+            case LOAD_ACTION_PING:
+            {
+                ByteBuffer ping(8);
+                ping << uint32(_stats.PingRtt.GetAverage());    // latency
+                ping << uint32(++_pingCounter);
+                _pingSentTime = now;
+                SendPacket(CMSG_PING, ping);
+                break;
+            }
+            case LOAD_ACTION_SAY:
+            {
+                ByteBuffer say(action.Payload.size() + 5);
+                say << uint32(0);                           // LANG_UNIVERSAL
+                say.WriteBits(action.Payload.size(), 8);
+                say.FlushBits();
+                say.append(&action.Payload[0], action.Payload.size());
+                SendPacket(CMSG_MESSAGECHAT_SAY, say);
+                break;
+            }
+            case LOAD_ACTION_PACKET:
+                SendPacket(action.Opcode, action.Payload.empty() ? NULL : &action.Payload[0], action.Payload.size());
+                break;
+        }
+    }
+}
+
+void LoadClient::SendRecordedTraffic(uint32 now)
+{
+    std::vector<RecordedPacket> const& packets = _traffic->GetPackets();
+    for (;;)
+    {
+        if (_replayIndex >= packets.size())
+        {
+            // loop the capture
+            _replayIndex = 0;
+            _replayStart += _traffic->GetDuration();
+        }
+
+        RecordedPacket const& packet = packets[_replayIndex];
+        if (int32(now - (_replayStart + packet.Time)) < 0)
+            break;
+
+        SendPacket(packet.Opcode, packet.Payload.empty() ? NULL : &packet.Payload[0], packet.Payload.size());
+        ++_replayIndex;
+    }
+}
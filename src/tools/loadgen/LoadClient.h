@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOADCLIENT_H
+#define _LOADCLIENT_H
+
+#include "Define.h"
+#include "ByteBuffer.h"
+#include "BigNumber.h"
+#include "ARC4.h"
+#include "LatencyHistogram.h"
+
+#include <ace/SOCK_Stream.h>
+#include <string>
+#include <vector>
+
+class LoadScript;
+class RecordedTraffic;
+
+struct LoadGenConfig
+{
+    LoadGenConfig() : AuthPort(3724), LoginTimeout(30000) { }
+
+    std::string AuthHost;
+    uint16 AuthPort;
+    std::string RealmName;                                  // empty: first realm of the list
+    std::string Password;
+    uint32 LoginTimeout;                                    // ms, for every blocking step of the login
+};
+
+struct LoadClientAccount
+{
+    LoadClientAccount() : CharacterGuid(0) { }
+
+    std::string Name;                                       // upper case, like the client sends it
+    uint32 CharacterGuid;                                   // low guid of the character to log in
+};
+
+// Counters of the clients of one worker thread, merged by the main thread once the run is over
+struct LoadClientStats
+{
+    LoadClientStats() : LoginsOk(0), LoginsFailed(0), Disconnects(0), PacketsSent(0), PacketsReceived(0), BytesSent(0), BytesReceived(0) { }
+
+    void Merge(LoadClientStats const& other);
+
+    uint32 LoginsOk;
+    uint32 LoginsFailed;
+    uint32 Disconnects;                                     // clients dropped by the server after login
+    uint64 PacketsSent;
+    uint64 PacketsReceived;
+    uint64 BytesSent;
+    uint64 BytesReceived;
+
+    LatencyHistogram LoginTime;                             // connect to authserver -> SMSG_LOGIN_VERIFY_WORLD
+    LatencyHistogram WorldEnterTime;                        // CMSG_PLAYER_LOGIN -> SMSG_LOGIN_VERIFY_WORLD, the character load
+    LatencyHistogram QueryTimeRtt;                          // CMSG_QUERY_TIME round trip, answered by the world thread
+    LatencyHistogram PingRtt;                               // CMSG_PING round trip, answered by the network thread
+};
+
+// Client side of the world header encryption, mirror of AuthCrypt
+class ClientCrypt
+{
+    public:
+        ClientCrypt();
+
+        void Init(BigNumber* K);
+        void DecryptRecv(uint8* data, size_t len);
+        void EncryptSend(uint8* data, size_t len);
+        void Reset() { _initialized = false; }              // back to plain headers, Init() reseeds the streams
+
+        bool IsInitialized() const { return _initialized; }
+
+    private:
+        ARC4 _serverDecrypt;
+        ARC4 _clientEncrypt;
+        bool _initialized;
+};
+
+enum LoadClientState
+{
+    LOAD_CLIENT_OFFLINE,
+    LOAD_CLIENT_IN_WORLD,
+    LOAD_CLIENT_DISCONNECTED
+};
+
+// One simulated 5.4.7 client. Login() runs the whole authserver + worldserver login
+// with blocking socket calls, afterwards Update() is polled by the owning worker and
+// never blocks: it answers the server, sends the scripted / recorded traffic and
+// measures the round trips.
+class LoadClient
+{
+    public:
+        LoadClient(LoadGenConfig const& config, LoadClientAccount const& account, LoadScript const* script,
+            RecordedTraffic const* traffic, LoadClientStats& stats);
+        ~LoadClient();
+
+        bool Login();
+        void Update(uint32 now);
+        void Logout();
+
+        LoadClientState GetState() const { return _state; }
+        std::string const& GetAccountName() const { return _account.Name; }
+
+    private:
+        bool AuthLogon(std::string& worldHost, uint16& worldPort);
+        bool WorldLogon(std::string const& host, uint16 port);
+
+        bool Connect(std::string const& host, uint16 port);
+        void Disconnect();
+
+        bool SendRaw(uint8 const* data, size_t len);
+        bool RecvRaw(uint8* data, size_t len);
+
+        bool SendPacket(uint32 opcode, ByteBuffer const& payload);
+        bool SendPacket(uint32 opcode, uint8 const* payload, size_t len);
+        bool RecvPacket(uint32& opcode, ByteBuffer& payload);
+        bool WaitForPacket(uint32 opcode, ByteBuffer& payload);
+
+        bool ReadIncoming(uint32 now);
+        void HandlePacket(uint32 opcode, ByteBuffer& payload, uint32 now);
+        void SendScriptedTraffic(uint32 now);
+        void SendRecordedTraffic(uint32 now);
+
+        LoadGenConfig const& _config;
+        LoadClientAccount _account;
+        LoadScript const* _script;
+        RecordedTraffic const* _traffic;
+        LoadClientStats& _stats;
+
+        LoadClientState _state;
+        ACE_SOCK_Stream _socket;
+        ClientCrypt _crypt;
+        BigNumber _sessionKey;
+
+        // non blocking receive once in world
+        std::vector<uint8> _recvBuffer;
+        size_t _recvOffset;
+        bool _hasHeader;
+        uint32 _pendingOpcode;
+        uint32 _pendingSize;
+
+        std::vector<uint32> _nextAction;                    // per script line, time of its next run
+        uint32 _replayStart;
+        uint32 _replayIndex;
+
+        uint32 _pingCounter;
+        uint32 _pingSentTime;                               // 0: no ping in flight
+        std::vector<uint32> _queryTimeSent;                 // send times of the CMSG_QUERY_TIME in flight
+};
+
+#endif
@@ -0,0 +1,399 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file loadgen: headless 5.4.7 clients against a local authserver/worldserver.
+/// Every client logs in an existing account (<prefix><index>, all with the same password)
+/// with its first character, then sends scripted and/or recorded traffic. At the end the
+/// client side round trips and the worldserver tick percentiles of time_diff_log are printed.
+/// Logins are blocking, so -t is the number of concurrent logins: a login storm such as
+/// "-n 1000 -t 64 -l 1000 -d 0" measures the time to world percentiles of the character load.
+
+#include "LoadClient.h"
+#include "LoadScript.h"
+#include "DatabaseEnv.h"
+#include "Threading.h"
+#include "Timer.h"
+
+#include <ace/Init_ACE.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+#include <mysql.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+#define WORKER_SLEEP_TIME 10                                // ms between two polls of the clients of a worker
+
+// never opened, the database log appender of the shared library writes to it. The accounts and the tick times
+// are read with plain mysql connections, see ConnectDatabase()
+LoginDatabaseWorkerPool LoginDatabase;
+
+struct LoadGenOptions
+{
+    LoadGenOptions() : AccountPrefix("LOADGEN"), FirstIndex(1), Clients(100), Threads(4), Duration(600), LoginRate(20) { }
+
+    LoadGenConfig Client;
+    std::string AccountPrefix;
+    uint32 FirstIndex;
+    uint32 Clients;
+    uint32 Threads;
+    uint32 Duration;                                        // seconds, measured from the end of the ramp up
+    uint32 LoginRate;                                       // logins per second, per worker
+    std::string ScriptFile;
+    std::string ReplayFile;
+    std::string LoginDatabaseInfo;                          // "host;port;user;password;database", like the .conf files
+    std::string CharacterDatabaseInfo;
+};
+
+class LoadWorker : public ACE_Based::Runnable
+{
+    public:
+        LoadWorker(LoadGenOptions const& options, std::vector<LoadClientAccount> const& accounts, LoadScript const* script,
+            RecordedTraffic const* traffic) : _options(options), _accounts(accounts), _script(script), _traffic(traffic)
+        {
+        }
+
+        void run()
+        {
+            std::vector<LoadClient*> clients;
+            clients.reserve(_accounts.size());
+            for (size_t i = 0; i < _accounts.size(); ++i)
+                clients.push_back(new LoadClient(_options.Client, _accounts[i], _script, _traffic, _stats));
+
+            uint32 startTime = getMSTime();
+            uint32 loginInterval = IN_MILLISECONDS / std::max<uint32>(_options.LoginRate, 1);
+            size_t loggedIn = 0;
+            uint32 endTime = 0;
+
+            for (;;)
+            {
+                uint32 now = getMSTime();
+
+                // ramp up: logins are blocking, at most one per poll so the logged in clients keep being served
+                if (loggedIn < clients.size() && getMSTimeDiff(startTime, now) >= loggedIn * loginInterval)
+                {
+                    clients[loggedIn++]->Login();
+                    if (loggedIn == clients.size())
+                        endTime = getMSTime() + _options.Duration * IN_MILLISECONDS;
+                    continue;
+                }
+
+                if (endTime && int32(now - endTime) >= 0)
+                    break;
+
+                for (size_t i = 0; i < loggedIn; ++i)
+                    clients[i]->Update(now);
+
+                ACE_Based::Thread::Sleep(WORKER_SLEEP_TIME);
+            }
+
+            for (size_t i = 0; i < clients.size(); ++i)
+            {
+                clients[i]->Logout();
+                delete clients[i];
+            }
+        }
+
+        LoadClientStats const& GetStats() const { return _stats; }
+
+    private:
+        LoadGenOptions const& _options;
+        std::vector<LoadClientAccount> _accounts;
+        LoadScript const* _script;
+        RecordedTraffic const* _traffic;
+        LoadClientStats _stats;
+};
+
+void Usage(char const* prg)
+{
+    printf(
+        "Usage: %s [OPTION]...\n"
+        "  -a <host>         authserver address (default 127.0.0.1)\n"
+        "  -p <port>         authserver port (default 3724)\n"
+        "  -r <realm>        realm name (default first realm of the list)\n"
+        "  -u <prefix>       account name prefix (default LOADGEN)\n"
+        "  -i <index>        index of the first account (default 1)\n"
+        "  -w <password>     password of all accounts\n"
+        "  -n <clients>      number of clients (default 100)\n"
+        "  -t <threads>      worker threads (default 4)\n"
+        "  -d <seconds>      duration of the run after the ramp up (default 600)\n"
+        "  -l <rate>         logins per second per thread during the ramp up (default 20)\n"
+        "  -s <file>         traffic script (default: query time every second, ping, say)\n"
+        "  -f <file>         PacketLogFile capture to replay\n"
+        "  -L <db info>      auth database, \"host;port;user;password;database\"\n"
+        "  -C <db info>      characters database, \"host;port;user;password;database\"\n"
+        "Accounts <prefix><index> must exist and have a character on the realm.\n"
+        "Disable Warden on the worldserver, clients don't answer its requests.\n", prg);
+}
+
+bool ParseArgs(int argc, char** argv, LoadGenOptions& options)
+{
+    options.Client.AuthHost = "127.0.0.1";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i][0] != '-' || strlen(argv[i]) != 2 || i + 1 >= argc)
+            return false;
+
+        char const* value = argv[++i];
+        switch (argv[i - 1][1])
+        {
+            case 'a': options.Client.AuthHost = value; break;
+            case 'p': options.Client.AuthPort = uint16(atoi(value)); break;
+            case 'r': options.Client.RealmName = value; break;
+            case 'u': options.AccountPrefix = value; break;
+            case 'i': options.FirstIndex = atoi(value); break;
+            case 'w': options.Client.Password = value; break;
+            case 'n': options.Clients = atoi(value); break;
+            case 't': options.Threads = atoi(value); break;
+            case 'd': options.Duration = atoi(value); break;
+            case 'l': options.LoginRate = atoi(value); break;
+            case 's': options.ScriptFile = value; break;
+            case 'f': options.ReplayFile = value; break;
+            case 'L': options.LoginDatabaseInfo = value; break;
+            case 'C': options.CharacterDatabaseInfo = value; break;
+            default:
+                return false;
+        }
+    }
+
+    for (size_t i = 0; i < options.AccountPrefix.length(); ++i)
+        options.AccountPrefix[i] = toupper(options.AccountPrefix[i]);
+
+    return options.Clients && options.Threads && !options.Client.Password.empty() &&
+        !options.LoginDatabaseInfo.empty() && !options.CharacterDatabaseInfo.empty();
+}
+
+MYSQL* ConnectDatabase(std::string const& info)
+{
+    std::vector<std::string> tokens;
+    std::string::size_type start = 0, end;
+    while ((end = info.find(';', start)) != std::string::npos)
+    {
+        tokens.push_back(info.substr(start, end - start));
+        start = end + 1;
+    }
+    tokens.push_back(info.substr(start));
+
+    if (tokens.size() != 5)
+    {
+        printf("Invalid database info \"%s\"\n", info.c_str());
+        return NULL;
+    }
+
+    MYSQL* mysql = mysql_init(NULL);
+    if (!mysql_real_connect(mysql, tokens[0].c_str(), tokens[2].c_str(), tokens[3].c_str(), tokens[4].c_str(), atoi(tokens[1].c_str()), NULL, 0))
+    {
+        printf("Can't connect to database %s: %s\n", tokens[4].c_str(), mysql_error(mysql));
+        mysql_close(mysql);
+        return NULL;
+    }
+
+    return mysql;
+}
+
+// first character of every account, accounts without one are skipped
+bool LoadAccounts(LoadGenOptions const& options, std::vector<LoadClientAccount>& accounts)
+{
+    MYSQL* loginDb = ConnectDatabase(options.LoginDatabaseInfo);
+    MYSQL* charDb = loginDb ? ConnectDatabase(options.CharacterDatabaseInfo) : NULL;
+    if (!charDb)
+    {
+        if (loginDb)
+            mysql_close(loginDb);
+        return false;
+    }
+
+    char query[256];
+    for (uint32 i = 0; i < options.Clients; ++i)
+    {
+        LoadClientAccount account;
+        snprintf(query, sizeof(query), "%s%u", options.AccountPrefix.c_str(), options.FirstIndex + i);
+        account.Name = query;
+
+        std::vector<char> escaped(account.Name.length() * 2 + 1);
+        mysql_real_escape_string(loginDb, &escaped[0], account.Name.c_str(), account.Name.length());
+
+        uint32 accountId = 0;
+        snprintf(query, sizeof(query), "SELECT id FROM account WHERE username = '%s'", &escaped[0]);
+        if (!mysql_query(loginDb, query))
+        {
+            if (MYSQL_RES* result = mysql_store_result(loginDb))
+            {
+                if (MYSQL_ROW row = mysql_fetch_row(result))
+                    accountId = atoi(row[0]);
+                mysql_free_result(result);
+            }
+        }
+
+        if (accountId)
+        {
+            snprintf(query, sizeof(query), "SELECT guid FROM characters WHERE account = %u ORDER BY guid LIMIT 1", accountId);
+            if (!mysql_query(charDb, query))
+            {
+                if (MYSQL_RES* result = mysql_store_result(charDb))
+                {
+                    if (MYSQL_ROW row = mysql_fetch_row(result))
+                        account.CharacterGuid = atoi(row[0]);
+                    mysql_free_result(result);
+                }
+            }
+        }
+
+        if (!account.CharacterGuid)
+        {
+            printf("Account %s has no character, skipped\n", account.Name.c_str());
+            continue;
+        }
+
+        accounts.push_back(account);
+    }
+
+    mysql_close(charDb);
+    mysql_close(loginDb);
+    return !accounts.empty();
+}
+
+void PrintHistogram(char const* name, LatencyHistogram const& histogram)
+{
+    if (!histogram.GetCount())
+    {
+        printf("%-24s no samples\n", name);
+        return;
+    }
+
+    printf("%-24s %8u samples, avg %5u ms, p50 %5u ms, p95 %5u ms, p99 %5u ms, max %5u ms\n", name, histogram.GetCount(),
+        histogram.GetAverage(), histogram.GetPercentile(50.0f), histogram.GetPercentile(95.0f), histogram.GetPercentile(99.0f),
+        histogram.GetMax());
+}
+
+// one minute rows written by TimeDiffMgr while the clients were in world
+void PrintServerTicks(LoadGenOptions const& options, time_t start, time_t end)
+{
+    MYSQL* charDb = ConnectDatabase(options.CharacterDatabaseInfo);
+    if (!charDb)
+        return;
+
+    char query[256];
+    snprintf(query, sizeof(query), "SELECT time, average, max, players, p50, p95, p99 FROM time_diff_log "
+        "WHERE time >= %u AND time <= %u ORDER BY time", uint32(start), uint32(end));
+
+    printf("\nWorld tick (time_diff_log, 1 minute rows):\n");
+    if (mysql_query(charDb, query))
+        printf("Can't read time_diff_log: %s\n", mysql_error(charDb));
+    else if (MYSQL_RES* result = mysql_store_result(charDb))
+    {
+        uint32 rows = 0;
+        printf("%12s %8s %8s %8s %8s %8s %8s\n", "time", "players", "avg", "p50", "p95", "p99", "max");
+        while (MYSQL_ROW row = mysql_fetch_row(result))
+        {
+            printf("%12s %8s %8s %8s %8s %8s %8s\n", row[0], row[3], row[1], row[4], row[5], row[6], row[2]);
+            ++rows;
+        }
+
+        if (!rows)
+            printf("none, the run must last more than a minute\n");
+
+        mysql_free_result(result);
+    }
+
+    mysql_close(charDb);
+}
+
+int main(int argc, char** argv)
+{
+    LoadGenOptions options;
+    if (!ParseArgs(argc, argv, options))
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    ACE::init();
+
+    LoadScript script;
+    if (!options.ScriptFile.empty())
+    {
+        if (!script.LoadFromFile(options.ScriptFile))
+            return 1;
+    }
+    else
+        script.LoadDefault();
+
+    RecordedTraffic traffic;
+    if (!options.ReplayFile.empty() && !traffic.LoadFromFile(options.ReplayFile))
+        return 1;
+
+    std::vector<LoadClientAccount> accounts;
+    if (!LoadAccounts(options, accounts))
+    {
+        printf("No usable account\n");
+        return 1;
+    }
+
+    printf("Starting %u clients on %u threads\n", uint32(accounts.size()), options.Threads);
+
+    time_t startTime = time(NULL);
+
+    std::vector<LoadWorker*> workers;
+    std::vector<ACE_Based::Thread*> threads;
+    for (uint32 i = 0; i < options.Threads; ++i)
+    {
+        // client k belongs to worker k % threads
+        std::vector<LoadClientAccount> workerAccounts;
+        for (size_t k = i; k < accounts.size(); k += options.Threads)
+            workerAccounts.push_back(accounts[k]);
+
+        if (workerAccounts.empty())
+            break;
+
+        LoadWorker* worker = new LoadWorker(options, workerAccounts, &script, options.ReplayFile.empty() ? NULL : &traffic);
+        worker->incReference();                             // keep the stats alive after the thread is gone
+        workers.push_back(worker);
+        threads.push_back(new ACE_Based::Thread(worker));
+    }
+
+    LoadClientStats stats;
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i]->wait();
+        delete threads[i];
+
+        stats.Merge(workers[i]->GetStats());
+        workers[i]->decReference();
+    }
+
+    time_t endTime = time(NULL);
+
+    printf("\nLogins: %u ok, %u failed, %u disconnected\n", stats.LoginsOk, stats.LoginsFailed, stats.Disconnects);
+    printf("Sent: " UI64FMTD " packets, " UI64FMTD " bytes\n", stats.PacketsSent, stats.BytesSent);
+    printf("Received: " UI64FMTD " packets, " UI64FMTD " bytes\n", stats.PacketsReceived, stats.BytesReceived);
+    PrintHistogram("Login time", stats.LoginTime);
+    PrintHistogram("Time to world", stats.WorldEnterTime);
+    PrintHistogram("Query time round trip", stats.QueryTimeRtt);
+    PrintHistogram("Ping round trip", stats.PingRtt);
+
+    PrintServerTicks(options, startTime, endTime);
+
+    ACE::fini();
+    return 0;
+}
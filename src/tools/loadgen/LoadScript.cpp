@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LoadScript.h"
+#include "Opcodes.h"
+#include "ByteConverter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    bool HexToBytes(std::string const& hex, std::vector<uint8>& bytes)
+    {
+        if (hex.length() % 2)
+            return false;
+
+        for (size_t i = 0; i < hex.length(); i += 2)
+        {
+            char byte[3] = { hex[i], hex[i + 1], 0 };
+            char* end = NULL;
+            long value = strtol(byte, &end, 16);
+            if (*end)
+                return false;
+
+            bytes.push_back(uint8(value));
+        }
+
+        return true;
+    }
+
+    // sent by LoadClient itself, replaying them would break the session
+    bool IsSessionOpcode(uint32 opcode)
+    {
+        switch (opcode)
+        {
+            case MSG_VERIFY_CONNECTIVITY:
+            case CMSG_AUTH_SESSION:
+            case CMSG_PLAYER_LOGIN:
+            case CMSG_PING:
+            case CMSG_KEEP_ALIVE:
+            case CMSG_TIME_SYNC_RESP:
+            case CMSG_LOGOUT_REQUEST:
+            case CMSG_LOG_DISCONNECT:
+            case CMSG_CHAR_ENUM:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+bool LoadScript::LoadFromFile(std::string const& fileName)
+{
+    std::ifstream file(fileName.c_str());
+    if (!file)
+    {
+        printf("Can't open script file %s\n", fileName.c_str());
+        return false;
+    }
+
+    _actions.clear();
+
+    std::string line;
+    uint32 lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+
+        if (!line.empty() && line[line.length() - 1] == '\r')
+            line.erase(line.length() - 1);
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        if (!ParseLine(line))
+        {
+            printf("%s:%u: can't parse \"%s\"\n", fileName.c_str(), lineNumber, line.c_str());
+            return false;
+        }
+    }
+
+    return !_actions.empty();
+}
+
+void LoadScript::LoadDefault()
+{
+    _actions.clear();
+    ParseLine("every 1000 querytime");
+    ParseLine("every 30000 ping");
+    ParseLine("every 15000 say loadgen");
+}
+
+bool LoadScript::ParseLine(std::string const& line)
+{
+    std::istringstream ss(line);
+    std::string every, type;
+    LoadAction action;
+    action.Opcode = 0;
+
+    if (!(ss >> every >> action.Interval >> type) || every != "every" || !action.Interval)
+        return false;
+
+    if (type == "querytime")
+        action.Type = LOAD_ACTION_QUERY_TIME;
+    else if (type == "ping")
+    {
+        // the server kicks clients pinging more often than every 27 seconds
+        action.Type = LOAD_ACTION_PING;
+        if (action.Interval < 30000)
+            action.Interval = 30000;
+    }
+    else if (type == "say")
+    {
+        std::string text;
+        std::getline(ss >> std::ws, text);
+        if (text.empty() || text.length() > 255)
+            return false;
+
+        action.Type = LOAD_ACTION_SAY;
+        action.Payload.assign(text.begin(), text.end());
+    }
+    else if (type == "packet")
+    {
+        std::string opcode, payload;
+        if (!(ss >> opcode))
+            return false;
+
+        ss >> payload;
+
+        char* end = NULL;
+        action.Type = LOAD_ACTION_PACKET;
+        action.Opcode = strtoul(opcode.c_str(), &end, 16);
+        if (*end || !HexToBytes(payload, action.Payload))
+            return false;
+    }
+    else
+        return false;
+
+    _actions.push_back(action);
+    return true;
+}
+
+bool RecordedTraffic::LoadFromFile(std::string const& fileName)
+{
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+    {
+        printf("Can't open packet log %s\n", fileName.c_str());
+        return false;
+    }
+
+    // PacketLog::LogPacket record: int32 opcode, int32 size, uint32 unix time, uint8 direction, payload
+    std::vector<RecordedPacket> second;                     // packets of the second being read
+    uint32 firstTime = 0;
+    uint32 secondTime = 0;
+    bool valid = true;
+
+    _packets.clear();
+
+    for (;;)
+    {
+        uint8 header[13];
+        if (fread(header, 1, sizeof(header), file) != sizeof(header))
+            break;
+
+        int32 opcode, size;
+        uint32 time;
+        memcpy(&opcode, &header[0], 4);
+        memcpy(&size, &header[4], 4);
+        memcpy(&time, &header[8], 4);
+        EndianConvert(opcode);
+        EndianConvert(size);
+        EndianConvert(time);
+
+        if (size < 0 || size > 0x10000)
+        {
+            valid = false;
+            break;
+        }
+
+        RecordedPacket packet;
+        packet.Opcode = uint32(opcode);
+        packet.Payload.resize(size);
+        if (size && fread(&packet.Payload[0], 1, size, file) != size_t(size))
+        {
+            valid = false;
+            break;
+        }
+
+        if (header[12] != 0 || IsSessionOpcode(packet.Opcode))  // CLIENT_TO_SERVER only
+            continue;
+
+        if (_packets.empty() && second.empty())
+            firstTime = secondTime = time;
+
+        if (time != secondTime)
+        {
+            for (size_t i = 0; i < second.size(); ++i)
+            {
+                second[i].Time = (secondTime - firstTime) * IN_MILLISECONDS + uint32(i * IN_MILLISECONDS / second.size());
+                _packets.push_back(second[i]);
+            }
+
+            second.clear();
+            secondTime = time;
+        }
+
+        second.push_back(packet);
+    }
+
+    for (size_t i = 0; i < second.size(); ++i)
+    {
+        second[i].Time = (secondTime - firstTime) * IN_MILLISECONDS + uint32(i * IN_MILLISECONDS / second.size());
+        _packets.push_back(second[i]);
+    }
+
+    fclose(file);
+
+    if (!valid)
+    {
+        printf("Packet log %s is truncated or corrupted\n", fileName.c_str());
+        return false;
+    }
+
+    if (_packets.empty())
+    {
+        printf("Packet log %s has no replayable client packets\n", fileName.c_str());
+        return false;
+    }
+
+    _duration = (secondTime - firstTime + 1) * IN_MILLISECONDS;
+    return true;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOADSCRIPT_H
+#define _LOADSCRIPT_H
+
+#include "Define.h"
+
+#include <string>
+#include <vector>
+
+enum LoadActionType
+{
+    LOAD_ACTION_QUERY_TIME,                                 // CMSG_QUERY_TIME, measures the world tick round trip
+    LOAD_ACTION_PING,                                       // CMSG_PING, measures the network thread round trip
+    LOAD_ACTION_SAY,                                        // CMSG_MESSAGECHAT_SAY
+    LOAD_ACTION_PACKET                                      // raw packet template
+};
+
+struct LoadAction
+{
+    LoadActionType Type;
+    uint32 Interval;                                        // ms
+    uint32 Opcode;                                          // LOAD_ACTION_PACKET only
+    std::vector<uint8> Payload;                             // LOAD_ACTION_PACKET: payload, LOAD_ACTION_SAY: text
+};
+
+// Periodic traffic sent by every client, one action per line:
+//   every <ms> querytime
+//   every <ms> ping
+//   every <ms> say <text>
+//   every <ms> packet <hex opcode> <hex payload>
+// Empty lines and lines starting with # are ignored.
+class LoadScript
+{
+    public:
+        bool LoadFromFile(std::string const& fileName);
+        void LoadDefault();
+
+        std::vector<LoadAction> const& GetActions() const { return _actions; }
+
+    private:
+        bool ParseLine(std::string const& line);
+
+        std::vector<LoadAction> _actions;
+};
+
+struct RecordedPacket
+{
+    uint32 Time;                                            // ms since the start of the capture
+    uint32 Opcode;
+    std::vector<uint8> Payload;
+};
+
+// Client to server packets of a PacketLogFile capture. PacketLog stores whole seconds only,
+// so the packets of the same second are spread evenly over it. Login, handshake and keep
+// alive opcodes are skipped: LoadClient sends its own. Packets are replayed verbatim, the
+// ones carrying the guid of the recorded character (movement, most casts) will only be
+// accepted if the capture was made with the character the client logs in with.
+class RecordedTraffic
+{
+    public:
+        RecordedTraffic() : _duration(0) { }
+
+        bool LoadFromFile(std::string const& fileName);
+
+        std::vector<RecordedPacket> const& GetPackets() const { return _packets; }
+        uint32 GetDuration() const { return _duration; }    // ms, one replay loop
+
+    private:
+        std::vector<RecordedPacket> _packets;
+        uint32 _duration;
+};
+
+#endif